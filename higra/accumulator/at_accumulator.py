@@ -12,7 +12,7 @@ import higra as hg
 import numpy as np
 
 
-def accumulate_at(indices, weights, accumulator):
+def accumulate_at(indices, weights, accumulator, dtype=None):
     """
     Accumulate the given weights located at given indices.
 
@@ -25,7 +25,8 @@ def accumulate_at(indices, weights, accumulator):
     :param indices: a 1d array of indices (entry equals to :math:`-1` are ignored)
     :param weights: a nd-array of shape :math:`(s_1, \ldots, s_n)` such that :math:`s_1=indices.size`
     :param accumulator: see :class:`~higra.Accumulators`
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: a nd-array of size :math:`(M, s_2, \ldots, s_n)`
     """
     indices = hg.cast_to_dtype(indices, np.int64)
-    return hg.cpp._accumulate_at(indices, weights, accumulator)
+    return hg.call_with_dtype(hg.cpp._accumulate_at, dtype, indices, weights, accumulator)
@@ -12,6 +12,7 @@
 
 #include "py_accumulators.hpp"
 #include "../py_common.hpp"
+#include "pybind11/numpy.h"
 
 template<typename functor_t>
 auto dispatch_accumulator(const functor_t & fun, const hg::accumulators & accumulator){
@@ -38,3 +39,17 @@ auto dispatch_accumulator(const functor_t & fun, const hg::accumulators & accumu
             return fun(hg::accumulator_argmax());
     }
 }
+
+/**
+ * Calls fun with a value of the output type described by dtype (float32 or float64) and returns its result as a
+ * python object.
+ */
+template<typename functor_t>
+pybind11::object dispatch_output_dtype(const functor_t &fun, const pybind11::dtype &dtype) {
+    if (dtype.kind() == 'f' && dtype.itemsize() == sizeof(float)) {
+        return pybind11::cast(fun(float()));
+    }
+    hg_assert(dtype.kind() == 'f' && dtype.itemsize() == sizeof(double),
+              "Unsupported output dtype: only float32 and float64 are supported.");
+    return pybind11::cast(fun(double()));
+}
@@ -11,7 +11,7 @@
 import higra as hg
 
 
-def accumulate_graph_edges(graph, edge_weights, accumulator):
+def accumulate_graph_edges(graph, edge_weights, accumulator, dtype=None):
     """
     Accumulates edge weights of the out edges of each vertex :math:`i`:
     ie :math:`output(i) = accumulator(edge\_weights(out\_edges(i)))`.
@@ -19,13 +19,14 @@ def accumulate_graph_edges(graph, edge_weights, accumulator):
     :param graph: input graph
     :param edge_weights: Weights on the edges of the graph
     :param accumulator: see :class:`~higra.Accumulators`
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new graph vertex weights
     """
-    res = hg.cpp._accumulate_graph_edges(graph, edge_weights, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_graph_edges, dtype, graph, edge_weights, accumulator)
     return res
 
 
-def accumulate_graph_vertices(graph, vertex_weights, accumulator):
+def accumulate_graph_vertices(graph, vertex_weights, accumulator, dtype=None):
     """
     Accumulates vertex weights of the adjacent vertices of each vertex :math:`i`:
     ie :math:`output(i) = accumulator(vertex\_weights(adjacent\_vertices(i)))`.
@@ -33,7 +34,8 @@ def accumulate_graph_vertices(graph, vertex_weights, accumulator):
     :param graph: input graph
     :param vertex_weights: Weights on the vertices of the graph
     :param accumulator: see :class:`~higra.Accumulators`
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new graph vertex weights
     """
-    res = hg.cpp._accumulate_graph_vertices(graph, vertex_weights, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_graph_vertices, dtype, graph, vertex_weights, accumulator)
     return res
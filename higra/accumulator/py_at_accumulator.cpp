@@ -42,6 +42,28 @@ struct def_at_accumulate {
               py::arg("weights"),
               py::arg("accumulator")
         );
+
+        c.def("_accumulate_at",
+              [](const pyarray<hg::index_t> &rag_map,
+                 const pyarray<value_t> &weights,
+                 hg::accumulators accumulator,
+                 const py::dtype &dtype) {
+                  return dispatch_output_dtype([&rag_map, &weights, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&rag_map, &weights](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_at<pyarray<value_t>, acc_t, output_t>(rag_map, weights, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("indices"),
+              py::arg("weights"),
+              py::arg("accumulator"),
+              py::arg("dtype")
+        );
     }
 };
 
@@ -43,6 +43,25 @@ struct def_accumulate_graph_edges {
               py::arg("graph"),
               py::arg("input"),
               py::arg("accumulator"));
+
+        c.def("_accumulate_graph_edges", [](const graph_t &graph, const pyarray<value_t> &input,
+                                            hg::accumulators accumulator, const py::dtype &dtype) {
+                  return dispatch_output_dtype([&graph, &input, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&graph, &input](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_graph_edges<graph_t, pyarray<value_t>, acc_t, output_t>(
+                                          graph, input, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("input"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
@@ -64,6 +83,25 @@ struct def_accumulate_graph_vertices {
               py::arg("graph"),
               py::arg("input"),
               py::arg("accumulator"));
+
+        c.def("_accumulate_graph_vertices", [](const graph_t &graph, const pyarray<value_t> &input,
+                                               hg::accumulators accumulator, const py::dtype &dtype) {
+                  return dispatch_output_dtype([&graph, &input, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&graph, &input](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_graph_vertices<graph_t, pyarray<value_t>, acc_t, output_t>(
+                                          graph, input, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("input"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
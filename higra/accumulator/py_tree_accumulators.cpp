@@ -43,6 +43,25 @@ struct def_accumulate_parallel {
               py::arg("tree"),
               py::arg("input"),
               py::arg("accumulator"));
+
+        c.def("_accumulate_parallel", [](const graph_t &tree, const pyarray<value_t> &input,
+                                         hg::accumulators accumulator, const py::dtype &dtype) {
+                  return dispatch_output_dtype([&tree, &input, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&tree, &input](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_parallel<graph_t, pyarray<value_t>, acc_t, output_t>(
+                                          tree, input, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("input"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
@@ -63,6 +82,26 @@ struct def_accumulate_sequential {
               py::arg("tree"),
               py::arg("leaf_data"),
               py::arg("accumulator"));
+
+        c.def("_accumulate_sequential",
+              [](const graph_t &tree, const pyarray<value_t> &vertex_data, hg::accumulators accumulator,
+                 const py::dtype &dtype) {
+                  return dispatch_output_dtype([&tree, &vertex_data, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&tree, &vertex_data](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_sequential<graph_t, pyarray<value_t>, acc_t, output_t>(
+                                          tree, vertex_data, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("leaf_data"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
@@ -70,14 +109,16 @@ struct def_accumulate_sequential {
 struct functorMax {
     template<typename T1, typename T2>
     auto operator()(T1 &&a, T2 &&b) {
-        return std::max(std::forward<T1>(a), std::forward<T2>(b));
+        using value_t = std::common_type_t<std::decay_t<T1>, std::decay_t<T2>>;
+        return std::max<value_t>(std::forward<T1>(a), std::forward<T2>(b));
     }
 };
 
 struct functorMin {
     template<typename T1, typename T2>
     auto operator()(T1 &&a, T2 &&b) {
-        return std::min(std::forward<T1>(a), std::forward<T2>(b));
+        using value_t = std::common_type_t<std::decay_t<T1>, std::decay_t<T2>>;
+        return std::min<value_t>(std::forward<T1>(a), std::forward<T2>(b));
     }
 };
 
@@ -115,6 +156,27 @@ struct def_accumulate_and_combine_sequential {
               py::arg("input"),
               py::arg("leaf_data"),
               py::arg("accumulator"));
+
+        c.def(name,
+              [&f](const graph_t &tree, const pyarray<value_t> &input, const pyarray<value_t> &vertex_data,
+                   hg::accumulators accumulator, const py::dtype &dtype) {
+                  return dispatch_output_dtype([&tree, &input, &vertex_data, &accumulator, &f](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&tree, &input, &vertex_data, &f](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_and_combine_sequential<graph_t, pyarray<value_t>,
+                                          pyarray<value_t>, acc_t, F, output_t>(tree, input, vertex_data, acc, f);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("input"),
+              py::arg("leaf_data"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
@@ -175,6 +237,26 @@ struct def_propagate_sequential_and_accumulate {
               py::arg("tree"),
               py::arg("vertex_data"),
               py::arg("accumulator"));
+
+        c.def("_propagate_sequential_and_accumulate",
+              [](const graph_t &tree, const pyarray<value_t> &vertex_data, hg::accumulators accumulator,
+                 const py::dtype &dtype) {
+                  return dispatch_output_dtype([&tree, &vertex_data, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&tree, &vertex_data](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::propagate_sequential_and_accumulate<graph_t, pyarray<value_t>, acc_t,
+                                          output_t>(tree, vertex_data, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("vertex_data"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
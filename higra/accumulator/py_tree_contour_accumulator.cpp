@@ -44,6 +44,32 @@ struct def_accumulate_on_contours {
               py::arg("vertex_data"),
               py::arg("depth"),
               py::arg("accumulator"));
+
+        c.def("_accumulate_on_contours",
+              [](const graph_t &graph,
+                 const tree_t &tree,
+                 const pyarray<value_t> &vertex_data,
+                 const pyarray<hg::index_t> &depth,
+                 hg::accumulators accumulator,
+                 const py::dtype &dtype) {
+                  return dispatch_output_dtype([&graph, &tree, &vertex_data, &depth, &accumulator](auto output_value) {
+                      using output_t = decltype(output_value);
+                      return dispatch_accumulator(
+                              [&graph, &tree, &vertex_data, &depth](const auto &acc) {
+                                  using acc_t = std::decay_t<decltype(acc)>;
+                                  return hg::accumulate_on_contours<graph_t, tree_t, pyarray<value_t>,
+                                          pyarray<hg::index_t>, acc_t, output_t>(graph, tree, vertex_data, depth, acc);
+                              },
+                              accumulator);
+                  }, dtype);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("tree"),
+              py::arg("vertex_data"),
+              py::arg("depth"),
+              py::arg("accumulator"),
+              py::arg("dtype"));
     }
 };
 
@@ -12,7 +12,7 @@ import higra as hg
 import numpy as np
 
 
-def accumulate_parallel(tree, node_weights, accumulator):
+def accumulate_parallel(tree, node_weights, accumulator, dtype=None):
     """
     Accumulates values of the children of every node :math:`i` in the :math:`node\_weights` array and puts the result
     in output: :math:`output(i) = accumulator(node\_weights(children(i)))`
@@ -20,14 +20,15 @@ def accumulate_parallel(tree, node_weights, accumulator):
     :param tree: input tree
     :param node_weights: Weights on the nodes of the tree
     :param accumulator: see :class:`~higra.Accumulators`
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
-    res = hg.cpp._accumulate_parallel(tree, node_weights, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_parallel, dtype, tree, node_weights, accumulator)
     return res
 
 
 @hg.argument_helper(hg.CptHierarchy)
-def accumulate_sequential(tree, leaf_data, accumulator, leaf_graph=None):
+def accumulate_sequential(tree, leaf_data, accumulator, leaf_graph=None, dtype=None):
     """
     Sequential accumulation of node values from the leaves to the root.
     For each leaf node :math:`i`, :math:`output(i) = leaf_data(i)`.
@@ -37,11 +38,12 @@ def accumulate_sequential(tree, leaf_data, accumulator, leaf_graph=None):
     :param leaf_data: array of weights on the leaves of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (optional, deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
     if leaf_graph is not None:
         leaf_data = hg.linearize_vertex_weights(leaf_data, leaf_graph)
-    res = hg.cpp._accumulate_sequential(tree, leaf_data, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_sequential, dtype, tree, leaf_data, accumulator)
     return res
 
 
@@ -60,7 +62,7 @@ def propagate_sequential(tree, node_weights, condition):
     return res
 
 
-def propagate_sequential_and_accumulate(tree, node_weights, accumulator):
+def propagate_sequential_and_accumulate(tree, node_weights, accumulator, dtype=None):
     """
     Sequentially propagates parent values to children and accumulates with current value:
     for each node :math:`i` from the root to the leaves,
@@ -69,9 +71,10 @@ def propagate_sequential_and_accumulate(tree, node_weights, accumulator):
     :param tree: input tree
     :param node_weights: Weights on the nodes of the tree
     :param accumulator: see :class:`~higra.Accumulators`
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
-    res = hg.cpp._propagate_sequential_and_accumulate(tree, node_weights, accumulator)
+    res = hg.call_with_dtype(hg.cpp._propagate_sequential_and_accumulate, dtype, tree, node_weights, accumulator)
     return res
 
 
@@ -110,7 +113,7 @@ def propagate_parallel(tree, node_weights, condition=None):
 
 
 @hg.argument_helper(("tree", hg.CptHierarchy))
-def accumulate_and_add_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None):
+def accumulate_and_add_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None, dtype=None):
     """
     Accumulates node values from the leaves to the root and add the result with the input array.
 
@@ -122,19 +125,20 @@ def accumulate_and_add_sequential(tree, node_weights, leaf_data, accumulator, le
     :param leaf_data: Weights on the leaves of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (optional, deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
     if leaf_graph is not None:
         leaf_data = hg.linearize_vertex_weights(leaf_data, leaf_graph)
 
     leaf_data, node_weights = hg.cast_to_common_type(leaf_data, node_weights)
-    res = hg.cpp._accumulate_and_add_sequential(tree, node_weights, leaf_data, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_and_add_sequential, dtype, tree, node_weights, leaf_data, accumulator)
 
     return res
 
 
 @hg.argument_helper(hg.CptHierarchy)
-def accumulate_and_multiply_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None):
+def accumulate_and_multiply_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None, dtype=None):
     """
     Accumulates node values from the leaves to the root and multiply the result with the input array.
 
@@ -146,19 +150,21 @@ def accumulate_and_multiply_sequential(tree, node_weights, leaf_data, accumulato
     :param leaf_data: Weights on the leaves of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (optional (optional, deduced from :class:`~higra.CptHierarchy`))
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
     if leaf_graph is not None:
         leaf_data = hg.linearize_vertex_weights(leaf_data, leaf_graph)
 
     leaf_data, node_weights = hg.cast_to_common_type(leaf_data, node_weights)
-    res = hg.cpp._accumulate_and_multiply_sequential(tree, node_weights, leaf_data, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_and_multiply_sequential, dtype,
+                             tree, node_weights, leaf_data, accumulator)
 
     return res
 
 
 @hg.argument_helper(hg.CptHierarchy)
-def accumulate_and_min_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None):
+def accumulate_and_min_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None, dtype=None):
     """
     Accumulates node values from the leaves to the root and takes the minimum of result and the input array.
 
@@ -171,18 +177,19 @@ def accumulate_and_min_sequential(tree, node_weights, leaf_data, accumulator, le
     :param leaf_data: Weights on the leaves of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (optional, deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
     if leaf_graph is not None:
         leaf_data = hg.linearize_vertex_weights(leaf_data, leaf_graph)
 
     leaf_data, node_weights = hg.cast_to_common_type(leaf_data, node_weights)
-    res = hg.cpp._accumulate_and_min_sequential(tree, node_weights, leaf_data, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_and_min_sequential, dtype, tree, node_weights, leaf_data, accumulator)
     return res
 
 
 @hg.argument_helper(hg.CptHierarchy)
-def accumulate_and_max_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None):
+def accumulate_and_max_sequential(tree, node_weights, leaf_data, accumulator, leaf_graph=None, dtype=None):
     """
     Accumulates node values from the leaves to the root and takes the maximum of result and the input array.
 
@@ -196,11 +203,12 @@ def accumulate_and_max_sequential(tree, node_weights, leaf_data, accumulator, le
     :param leaf_data: Weights on the leaves of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (optional, deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns new tree node weights
     """
     if leaf_graph is not None:
         leaf_data = hg.linearize_vertex_weights(leaf_data, leaf_graph)
 
     leaf_data, node_weights = hg.cast_to_common_type(leaf_data, node_weights)
-    res = hg.cpp._accumulate_and_max_sequential(tree, node_weights, leaf_data, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_and_max_sequential, dtype, tree, node_weights, leaf_data, accumulator)
     return res
@@ -13,7 +13,7 @@ import numpy as np
 
 
 @hg.argument_helper(hg.CptHierarchy)
-def accumulate_on_contours(tree, node_weights, accumulator, leaf_graph):
+def accumulate_on_contours(tree, node_weights, accumulator, leaf_graph, dtype=None):
     """
     For each edge of the leaf graph, accumulates the weights of the nodes whose contour pass by this edge.
 
@@ -31,18 +31,24 @@ def accumulate_on_contours(tree, node_weights, accumulator, leaf_graph):
 
     This algorithm runs in :math:`\mathcal{O}(n*k)` with :math:`n` the number of edges in the leaf graph and
     :math:`k` the maximal depth of the tree (i.e. the number of edges on the longest downward path between
-    the root and a leaf).
+    the root and a leaf). The counter accumulator, and the sum and mean accumulators on integral weights, are computed
+    with prefix sums and lowest common ancestors and run in :math:`\mathcal{O}(n\log(n))` in the worst case. The min
+    and max accumulators, and the sum and mean accumulators on floating point weights, are computed with binary
+    lifting tables of the ancestors and run in :math:`\mathcal{O}((n + N)\log(k) + n * k / 128)` with :math:`N` the
+    number of nodes of the tree: the number of levels of the tables is bounded to limit their memory usage, and the
+    tables are not built when all the contours are short.
 
     :param tree: input tree (Concept :class:`~higra.CptHierarchy`)
     :param node_weights: weights on the nodes of the tree
     :param accumulator: see :class:`~higra.Accumulators`
     :param leaf_graph: graph of the tree leaves (deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of the input)
     :return: returns leaf graph edge weights
     """
 
     depth = hg.attribute_depth(tree)
 
-    res = hg.cpp._accumulate_on_contours(leaf_graph, tree, node_weights, depth, accumulator)
+    res = hg.call_with_dtype(hg.cpp._accumulate_on_contours, dtype, leaf_graph, tree, node_weights, depth, accumulator)
     return res
 
 
@@ -34,6 +34,23 @@ struct def_labelisation_watershed {
     }
 };
 
+template<typename graph_t>
+struct def_labelisation_watershed_parallel {
+    template<typename value_t, typename C>
+    static
+    void def(C &c, const char *doc) {
+        c.def("_labelisation_watershed_parallel", [](const graph_t &graph,
+                                                     const pyarray<value_t> &edge_weights,
+                                                     const bool canonical_labels) {
+                  return hg::labelisation_watershed_parallel(graph, edge_weights, canonical_labels);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("canonical_labels"));
+    }
+};
+
 template<typename graph_t>
 struct def_labelisation_seeded_watershed {
     template<typename value_t, typename C>
@@ -54,12 +71,56 @@ struct def_labelisation_seeded_watershed {
     }
 };
 
+template<typename graph_t>
+struct def_labelisation_seeded_watershed_priority_flood {
+    template<typename value_t, typename C>
+    static
+    void def(C &c, const char *doc) {
+        c.def("_labelisation_seeded_watershed_priority_flood",
+              [](const graph_t &graph,
+                 const pyarray<value_t> &edge_weights,
+                 const pyarray<hg::index_t> &vertex_seeds,
+                 const hg::index_t background_label) {
+                  return hg::labelisation_seeded_watershed_priority_flood(graph, edge_weights, vertex_seeds,
+                                                                          background_label);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("vertex_seeds"),
+              py::arg("background_label"));
+    }
+};
+
+template<typename graph_t>
+struct def_labelisation_seeded_watershed_parallel {
+    template<typename value_t, typename C>
+    static
+    void def(C &c, const char *doc) {
+        c.def("_labelisation_seeded_watershed_parallel",
+              [](const graph_t &graph,
+                 const pyarray<value_t> &edge_weights,
+                 const pyarray<hg::index_t> &vertex_seeds,
+                 const hg::index_t background_label) {
+                  return hg::labelisation_seeded_watershed_parallel(graph, edge_weights, vertex_seeds,
+                                                                    background_label);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("vertex_seeds"),
+              py::arg("background_label"));
+    }
+};
 
 void py_init_watershed(pybind11::module &m) {
     xt::import_numpy();
 
     add_type_overloads<def_labelisation_watershed<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m,"");
+    add_type_overloads<def_labelisation_watershed_parallel<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m,"");
     add_type_overloads<def_labelisation_seeded_watershed<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m,"");
+    add_type_overloads<def_labelisation_seeded_watershed_priority_flood<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m,"");
+    add_type_overloads<def_labelisation_seeded_watershed_parallel<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m,"");
 }
 
 
@@ -39,9 +39,11 @@ def tree_fusion_depth_map(*trees):
 
     :Complexity:
 
-    The worst case runtime complexity of this method is :math:`\mathcal{O}(N^2D^2)` with :math:`N` the number of leaves
-    and :math:`D` the number of trees. If we denote by :math:`K` the depth of the deepest tree to merge, one can rewrite
-    the runtime complexity as :math:`\mathcal{O}(NKD^2)`.
+    The runtime complexity of this method is :math:`\mathcal{O}(N\alpha(N)D^2)` with :math:`N` the number of leaves,
+    :math:`D` the number of trees, and :math:`\alpha` the inverse Ackermann function: the smallest enclosing shapes of
+    the nodes of each pair of trees are computed with an offline lowest common ancestor algorithm (pairs of trees are
+    processed in parallel), and the depth of the nodes of the fusion graph is computed in a single topological
+    traversal. The space complexity is :math:`\mathcal{O}(ND^2)`.
 
     :param trees: at least two trees defined over the same domain
     :return: a depth map representing the fusion of the input trees
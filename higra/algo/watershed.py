@@ -40,6 +40,39 @@ def labelisation_watershed(graph, edge_weights):
     return vertex_labels
 
 
+def labelisation_watershed_parallel(graph, edge_weights, canonical_labels=True):
+    """
+    Watershed cut of the given edge weighted graph computed with a data parallel algorithm.
+
+    The result is identical to the one of :func:`~higra.labelisation_watershed` up to a permutation of the labels.
+    Vertices without flat edge (a steepest edge leading to a vertex with the same minimum adjacent edge weight) are
+    linked to the end of their steepest descending path by pointer jumping. Plateaus are explored in the order of the
+    sequential algorithm: plateaus of a same level are processed in parallel, but each plateau is explored
+    sequentially. All the other steps are performed in parallel if Higra was compiled with TBB support.
+
+    If :attr:`canonical_labels` is ``True``, labels are numbered from 1 in the order of appearance of the catchment
+    basins when scanning the vertices in increasing index order (which is the numbering used by
+    :func:`~higra.labelisation_watershed`). Otherwise, basins are numbered in the order of the smallest vertex of
+    their minimum. Both numberings are computed in parallel with a prefix sum.
+
+    :Complexity:
+
+    This algorithm has a runtime complexity of :math:`\mathcal{O}(n \log(n))` with :math:`n` the number of edges
+    in the graph. Its span (parallel time) grows with the number of distinct levels of the plateaus and with the size
+    of the largest plateaus.
+
+    :param graph: input graph
+    :param edge_weights: Weights on the edges of the graph
+    :param canonical_labels: if ``True`` (default), labels are numbered as in :func:`~higra.labelisation_watershed`
+    :return: A labelisation of the graph vertices
+    """
+    vertex_labels = hg.cpp._labelisation_watershed_parallel(graph, edge_weights, canonical_labels)
+
+    vertex_labels = hg.delinearize_vertex_weights(vertex_labels, graph)
+
+    return vertex_labels
+
+
 def labelisation_seeded_watershed(graph, edge_weights, vertex_seeds, background_label=0):
     """
     Seeded watershed cut on an edge weighted graph.
@@ -71,3 +104,70 @@ def labelisation_seeded_watershed(graph, edge_weights, vertex_seeds, background_
 
     labels = hg.delinearize_vertex_weights(labels, graph)
     return labels
+
+
+def labelisation_seeded_watershed_priority_flood(graph, edge_weights, vertex_seeds, background_label=0):
+    """
+    Seeded watershed cut on an edge weighted graph computed by priority flooding.
+
+    The graph is flooded from the seeds (see :func:`~higra.labelisation_seeded_watershed`): the unlabeled vertex
+    reached through the lowest edge (or at the lowest flooding level) is labeled first. The flooding relies on
+    a bucket queue if the edge weights are integers spanning less than :math:`2^{16}` values (eg. 8 or 16 bits
+    images) and on a radix heap otherwise.
+
+    When all edge weights are distinct, the result is identical to the one of
+    :func:`~higra.labelisation_seeded_watershed`. Otherwise, both results are valid seeded watershed cuts but they may
+    differ on plateaus.
+
+    :Complexity:
+
+    This algorithm has a linear runtime complexity :math:`\mathcal{O}(n)` with :math:`n` the number of edges in the graph
+    for low dynamic integer edge weights, and a runtime complexity in :math:`\mathcal{O}(n \log C)` otherwise, with
+    :math:`C` the number of bits of the edge weight type.
+
+    :param graph: Input graph
+    :param edge_weights: Weights on the edges of the graph
+    :param vertex_seeds: Seeds with integer label values on the vertices of the graph
+    :param background_label: Vertices whose values are equal to :attr:`background_label` (default 0) in :attr:`vertex_seeds` are not considered as seeds
+    :return: A labelisation of the graph vertices
+    """
+    if not issubclass(vertex_seeds.dtype.type, np.integer):
+        raise ValueError("vertex_seeds must be an array of integers")
+
+    vertex_seeds = hg.linearize_vertex_weights(vertex_seeds, graph)
+
+    labels = hg.cpp._labelisation_seeded_watershed_priority_flood(graph, edge_weights, vertex_seeds, background_label)
+
+    labels = hg.delinearize_vertex_weights(labels, graph)
+    return labels
+
+
+def labelisation_seeded_watershed_parallel(graph, edge_weights, vertex_seeds, background_label=0):
+    """
+    Seeded watershed cut on an edge weighted graph computed with a parallel algorithm.
+
+    The result is always identical to the one of :func:`~higra.labelisation_seeded_watershed`. The regions are grown
+    with Boruvka's minimum spanning forest algorithm: at each round, every region that does not contain a seed
+    is merged with the neighbour region linked by its lowest outgoing edge. All the rounds are processed in
+    parallel if Higra was compiled with TBB support.
+
+    :Complexity:
+
+    This algorithm has a runtime complexity in :math:`\mathcal{O}(n \log n)` with :math:`n` the number of edges in the
+    graph, and performs at most :math:`\log_2(n)` rounds of parallel operations.
+
+    :param graph: Input graph
+    :param edge_weights: Weights on the edges of the graph
+    :param vertex_seeds: Seeds with integer label values on the vertices of the graph
+    :param background_label: Vertices whose values are equal to :attr:`background_label` (default 0) in :attr:`vertex_seeds` are not considered as seeds
+    :return: A labelisation of the graph vertices
+    """
+    if not issubclass(vertex_seeds.dtype.type, np.integer):
+        raise ValueError("vertex_seeds must be an array of integers")
+
+    vertex_seeds = hg.linearize_vertex_weights(vertex_seeds, graph)
+
+    labels = hg.cpp._labelisation_seeded_watershed_parallel(graph, edge_weights, vertex_seeds, background_label)
+
+    labels = hg.delinearize_vertex_weights(labels, graph)
+    return labels
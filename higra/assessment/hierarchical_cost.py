@@ -93,6 +93,9 @@ def dasgupta_cost(tree, edge_weights, leaf_graph):
     The runtime complexity is :math:`\mathcal{O}(n\log(n) + m)` with :math:`n` the number of nodes in :math:`T` and
     :math:`m` the number of edges in :math:`E`.
 
+    The edges are processed in a single pass (in parallel on large graphs) without storing the lowest common
+    ancestors of their extremities.
+
     :param tree: Input tree
     :param edge_weights: Edge weights on the leaf graph (dissimilarities)
     :param leaf_graph: Leaf graph of the input tree (deduced from :class:`~higra.CptHierarchy`)
@@ -100,10 +103,7 @@ def dasgupta_cost(tree, edge_weights, leaf_graph):
     """
     area = hg.attribute_area(tree, leaf_graph=leaf_graph)
 
-    lcaf = hg.make_lca_fast(tree)
-    lca = lcaf.lca(leaf_graph)
-
-    return np.sum(area[lca] / edge_weights)
+    return hg.cpp._dasgupta_cost(tree, leaf_graph, edge_weights, area)
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -139,9 +139,117 @@ def tree_sampling_divergence(tree, edge_weights, leaf_graph):
     :param leaf_graph: Leaf graph of the input tree (deduced from :class:`~higra.CptHierarchy`)
     :return: a real number
     """
+    return hg.cpp._tree_sampling_divergence(tree, leaf_graph, edge_weights)
 
-    num_l = tree.num_leaves()
-    p = hg.attribute_tree_sampling_probability(tree, leaf_graph, edge_weights, 'edge')[num_l:]
-    q = hg.attribute_tree_sampling_probability(tree, leaf_graph, edge_weights, 'null')[num_l:]
-    index, = np.where(p)
-    return np.sum(p[index] * np.log(p[index] / q[index]))
+
+def __process_param_seed(seed):
+    if seed is None:
+        seed = np.random.randint(0, 2 ** 31 - 1)
+    return int(seed)
+
+
+@hg.argument_helper(hg.CptHierarchy)
+def estimate_dasgupta_cost(tree, edge_weights, num_samples, sampling="uniform", confidence=0.95, seed=None,
+                           leaf_graph=None):
+    """
+    Estimation of the Dasgupta's cost (see :func:`~higra.dasgupta_cost`) from a sample of edges of the leaf graph.
+
+    The edges are sampled with replacement according to :attr:`sampling`:
+
+        - ``'uniform'``: each edge has the same probability; the estimator is the number of edges times the mean of
+          :math:`area(lca_T(x,y)) / w(\{x,y\})` over the sampled edges;
+        - ``'importance'``: the probability of an edge is proportional to the inverse of its weight; the estimator is
+          :math:`\sum_{e\in E}1/w(e)` times the mean area of the lowest common ancestors of the sampled edges.
+
+    Both estimators are unbiased and the confidence interval relies on the normal approximation.
+    The samples and their lowest common ancestors are computed in parallel on large samples: the result only depends
+    on the seed.
+
+    :Complexity:
+
+    The runtime complexity is :math:`\mathcal{O}(n\log(n) + k)` with :math:`n` the number of nodes in :math:`T` and
+    :math:`k` the number of samples (plus :math:`\mathcal{O}(m + k\log(m))` for the importance sampling, with :math:`m`
+    the number of edges in :math:`E`: the cumulative sums of the inverse edge weights are computed on each call).
+
+    :param tree: Input tree
+    :param edge_weights: Edge weights on the leaf graph (dissimilarities)
+    :param num_samples: number of sampled edges (at least 2)
+    :param sampling: edge sampling strategy, either ``'uniform'`` (default) or ``'importance'``
+    :param confidence: confidence level of the confidence interval
+    :param seed: seed of the random generators (drawn with numpy if ``None``)
+    :param leaf_graph: Leaf graph of the input tree (deduced from :class:`~higra.CptHierarchy`)
+    :return: a :class:`~higra.HierarchicalCostEstimate`
+    """
+    area = hg.attribute_area(tree, leaf_graph=leaf_graph)
+
+    return hg.cpp._estimate_dasgupta_cost(tree, leaf_graph, edge_weights, area, num_samples, sampling, confidence,
+                                          __process_param_seed(seed))
+
+
+@hg.argument_helper(hg.CptHierarchy)
+def estimate_tree_sampling_divergence(tree, edge_weights, num_samples, sampling="uniform", confidence=0.95,
+                                      seed=None, leaf_graph=None):
+    """
+    Estimation of the tree sampling divergence (see :func:`~higra.tree_sampling_divergence`) from a sample of edges
+    of the leaf graph.
+
+    The edge sampling probability :math:`p` of the nodes of the tree is estimated from the lowest common ancestors of
+    the sampled edges while the null model :math:`q` is computed exactly (it does not require any lowest common
+    ancestor). The edges are sampled with replacement according to :attr:`sampling`:
+
+        - ``'uniform'``: each edge has the same probability;
+        - ``'importance'``: the probability of an edge is proportional to its weight (edge sampling model).
+
+    The plug-in estimator :math:`\sum_{x} \hat{p}(x) \log(\hat{p}(x) / q(x))` is consistent but biased for
+    small samples, its confidence interval is obtained with the delta method.
+    The samples and their lowest common ancestors are computed in parallel on large samples: the result only depends
+    on the seed.
+
+    :Complexity:
+
+    The runtime complexity is :math:`\mathcal{O}(n\log(n) + m + k)` with :math:`n` the number of nodes in :math:`T`,
+    :math:`m` the number of edges in :math:`E` and :math:`k` the number of samples (plus :math:`\mathcal{O}(k\log(m))`
+    for the importance sampling). Only the lowest common ancestor queries are replaced by samples: the null model
+    :math:`q` and the normalization of the sampling probabilities always require a pass over all the edges.
+
+    :param tree: Input tree
+    :param edge_weights: Edge weights on the leaf graph (similarities)
+    :param num_samples: number of sampled edges (at least 2)
+    :param sampling: edge sampling strategy, either ``'uniform'`` (default) or ``'importance'``
+    :param confidence: confidence level of the confidence interval
+    :param seed: seed of the random generators (drawn with numpy if ``None``)
+    :param leaf_graph: Leaf graph of the input tree (deduced from :class:`~higra.CptHierarchy`)
+    :return: a :class:`~higra.HierarchicalCostEstimate`
+    """
+    return hg.cpp._estimate_tree_sampling_divergence(tree, leaf_graph, edge_weights, num_samples, sampling,
+                                                     confidence, __process_param_seed(seed))
+
+
+def estimate_dendrogram_purity(tree, leaf_labels, num_samples, confidence=0.95, seed=None):
+    """
+    Estimation of the dendrogram purity (see :func:`~higra.dendrogram_purity`) from a sample of pairs of leaves.
+
+    Pairs of distinct leaves with the same label are sampled uniformly with replacement and the estimator is the
+    mean purity of the lowest common ancestors of the sampled pairs with respect to their label. The estimator is
+    unbiased and the confidence interval relies on the normal approximation.
+    The label histograms of the nodes are never computed: the purity of a node is obtained with binary searches in
+    a depth first ordering of the leaves (see :func:`~higra.attribute_leaf_ordering`).
+    The samples and their lowest common ancestors are computed in parallel on large samples: the result only depends
+    on the seed.
+
+    :Complexity:
+
+    The runtime complexity is :math:`\mathcal{O}(n\log(n) + k\log(n))` with :math:`n` the number of nodes in the
+    tree and :math:`k` the number of samples.
+
+    :param tree: input tree
+    :param leaf_labels: a 1d integral array of length `tree.num_leaves()`
+    :param num_samples: number of sampled pairs (at least 2), at least one label must be associated to two leaves
+    :param confidence: confidence level of the confidence interval
+    :param seed: seed of the random generators (drawn with numpy if ``None``)
+    :return: a :class:`~higra.HierarchicalCostEstimate`
+    """
+    if leaf_labels.ndim != 1 or leaf_labels.size != tree.num_leaves() or leaf_labels.dtype.kind != 'i':
+        raise ValueError("leaf_labels must be a 1d integral array of length `tree.num_leaves()`")
+
+    return hg.cpp._estimate_dendrogram_purity(tree, leaf_labels, num_samples, confidence, __process_param_seed(seed))
@@ -0,0 +1,164 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2019)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "py_hierarchical_cost.hpp"
+#include "../py_common.hpp"
+#include "higra/assessment/hierarchical_cost.hpp"
+#include "xtensor-python/pyarray.hpp"
+#include "xtensor-python/pytensor.hpp"
+
+using namespace hg;
+namespace py = pybind11;
+
+struct def_dasgupta_cost {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_dasgupta_cost",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const xt::pyarray<T> &edge_weights,
+                 const xt::pyarray<double> &area) {
+                  return dasgupta_cost(tree, graph, edge_weights, area);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("area"));
+    }
+};
+
+struct def_tree_sampling_divergence {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_tree_sampling_divergence",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const xt::pyarray<T> &edge_weights) {
+                  return tree_sampling_divergence(tree, graph, edge_weights);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"));
+    }
+};
+
+static hg::edge_sampling edge_sampling_from_string(const std::string &sampling) {
+    if (sampling == "uniform") {
+        return hg::edge_sampling::uniform;
+    } else if (sampling == "importance") {
+        return hg::edge_sampling::importance;
+    }
+    throw std::runtime_error("Parameter 'sampling' must be either 'uniform' or 'importance'.");
+}
+
+struct def_estimate_dasgupta_cost {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_estimate_dasgupta_cost",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const xt::pyarray<T> &edge_weights,
+                 const xt::pyarray<double> &area,
+                 index_t num_samples,
+                 const std::string &sampling,
+                 double confidence,
+                 std::uint64_t seed) {
+                  return estimate_dasgupta_cost(tree, graph, edge_weights, area, num_samples,
+                                                edge_sampling_from_string(sampling), confidence, seed);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("area"),
+              py::arg("num_samples"),
+              py::arg("sampling"),
+              py::arg("confidence"),
+              py::arg("seed"));
+    }
+};
+
+struct def_estimate_tree_sampling_divergence {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_estimate_tree_sampling_divergence",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const xt::pyarray<T> &edge_weights,
+                 index_t num_samples,
+                 const std::string &sampling,
+                 double confidence,
+                 std::uint64_t seed) {
+                  return estimate_tree_sampling_divergence(tree, graph, edge_weights, num_samples,
+                                                           edge_sampling_from_string(sampling), confidence, seed);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("num_samples"),
+              py::arg("sampling"),
+              py::arg("confidence"),
+              py::arg("seed"));
+    }
+};
+
+struct def_estimate_dendrogram_purity {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_estimate_dendrogram_purity",
+              [](const hg::tree &tree,
+                 const xt::pyarray<T> &leaf_labels,
+                 index_t num_samples,
+                 double confidence,
+                 std::uint64_t seed) {
+                  return estimate_dendrogram_purity(tree, leaf_labels, num_samples, confidence, seed);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("leaf_labels"),
+              py::arg("num_samples"),
+              py::arg("confidence"),
+              py::arg("seed"));
+    }
+};
+
+void py_init_hierarchical_cost(pybind11::module &m) {
+    xt::import_numpy();
+
+    add_type_overloads<def_dasgupta_cost, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
+    add_type_overloads<def_tree_sampling_divergence, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
+    py::class_<hierarchical_cost_estimate>(m, "HierarchicalCostEstimate",
+                                           "Estimation of a hierarchical cost from a finite number of samples.")
+            .def_readonly("value", &hierarchical_cost_estimate::value, "Estimated value of the cost.")
+            .def_readonly("standard_error", &hierarchical_cost_estimate::standard_error,
+                          "Estimated standard deviation of the estimator.")
+            .def_readonly("lower_bound", &hierarchical_cost_estimate::lower_bound,
+                          "Lower bound of the confidence interval.")
+            .def_readonly("upper_bound", &hierarchical_cost_estimate::upper_bound,
+                          "Upper bound of the confidence interval.")
+            .def_readonly("num_samples", &hierarchical_cost_estimate::num_samples,
+                          "Number of samples used for the estimation.");
+
+    add_type_overloads<def_estimate_dasgupta_cost, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
+    add_type_overloads<def_estimate_tree_sampling_divergence, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
+    add_type_overloads<def_estimate_dendrogram_purity, HG_TEMPLATE_INTEGRAL_TYPES>(m, "");
+}
@@ -11,6 +11,8 @@
 #include "py_tree_attributes.hpp"
 #include "../py_common.hpp"
 #include "higra/attribute/tree_attribute.hpp"
+#include "higra/attribute/attribute_registry.hpp"
+#include "higra/attribute/image_moments.hpp"
 #include "xtensor-python/pyarray.hpp"
 #include "xtensor-python/pytensor.hpp"
 
@@ -43,6 +45,82 @@ struct def_contour_length_component_tree {
     }
 };
 
+struct def_attribute_frontier_length {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_frontier_length",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const pyarray<T> &edge_length) {
+                  return hg::attribute_frontier_length(tree, graph, edge_length);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_length"));
+    }
+};
+
+struct def_attribute_frontier_strength {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_frontier_strength",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const pyarray<T> &edge_weights,
+                 const pyarray<T> &edge_length) {
+                  return hg::attribute_frontier_strength(tree, graph, edge_weights, edge_length);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("edge_length"));
+    }
+};
+
+struct def_attribute_contour_length {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_contour_length",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const pyarray<T> &vertex_perimeter,
+                 const pyarray<T> &edge_length) {
+                  return hg::attribute_contour_length(tree, graph, vertex_perimeter, edge_length);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("vertex_perimeter"),
+              py::arg("edge_length"));
+    }
+};
+
+struct def_attribute_contour_strength {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_contour_strength",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const pyarray<T> &edge_weights,
+                 const pyarray<T> &vertex_perimeter,
+                 const pyarray<T> &edge_length) {
+                  return hg::attribute_contour_strength(tree, graph, edge_weights, vertex_perimeter, edge_length);
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("vertex_perimeter"),
+              py::arg("edge_length"));
+    }
+};
+
 struct def_attribute_extrema {
     template<typename T>
     static
@@ -106,6 +184,56 @@ struct def_attribute_extinction_value {
     }
 };
 
+struct def_attribute_extinction_values {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_extinction_values",
+              [](const hg::tree &tree,
+                 const pyarray<T> &altitudes,
+                 const pyarray<T> &attributes,
+                 bool increasing_altitudes) {
+                  return hg::attribute_extinction_values(
+                          tree,
+                          altitudes,
+                          attributes,
+                          increasing_altitudes
+                  );
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("altitudes"),
+              py::arg("attributes"),
+              py::arg("increasing_altitudes"));
+    }
+};
+
+struct def_attribute_tree_sampling_probability {
+    template<typename T>
+    static
+    void def(pybind11::module &m, const char *doc) {
+        m.def("_attribute_tree_sampling_probability",
+              [](const hg::tree &tree,
+                 const hg::ugraph &graph,
+                 const pyarray<T> &edge_weights,
+                 const std::string &model) {
+                  if (model == "edge") {
+                      return hg::attribute_tree_sampling_probability(tree, graph, edge_weights,
+                                                                     hg::tree_sampling_model::edge);
+                  } else if (model == "null") {
+                      return hg::attribute_tree_sampling_probability(tree, graph, edge_weights,
+                                                                     hg::tree_sampling_model::null);
+                  }
+                  throw std::runtime_error("Parameter 'model' must be either 'edge' or 'null'.");
+              },
+              doc,
+              py::arg("tree"),
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("model"));
+    }
+};
+
 struct def_attribute_children_pair_sum_product {
     template<typename T>
     static
@@ -124,6 +252,75 @@ struct def_attribute_children_pair_sum_product {
     }
 };
 
+void py_init_attribute_registry(pybind11::module &m) {
+    using registry_t = hg::tree_attribute_registry<hg::tree>;
+    auto c = py::class_<registry_t>(m, "TreeAttributeRegistry",
+                                    "Lazy and shared computation of the attributes of a tree.\n\n"
+                                    "An attribute is computed the first time it is requested and its value is cached "
+                                    "for subsequent requests, directly or through other attributes (for example, the "
+                                    "area is computed once for the volume and the mean vertex weights). Setting an "
+                                    "input discards the cached values of the attributes depending on it. When the "
+                                    "memory used by the cached values exceeds the memory budget, the least recently "
+                                    "used values are discarded.\n\n"
+                                    "Available attributes: \"area\" (optional input \"vertex_area\"), \"depth\", "
+                                    "\"volume\" (input \"altitudes\") and \"mean_vertex_weights\" "
+                                    "(input \"vertex_weights\").");
+
+    c.def(py::init([](const hg::tree &tree, std::size_t memory_budget) {
+              return new registry_t(tree, memory_budget);
+          }),
+          "Create an attribute registry for the given tree (the memory budget is given in bytes).",
+          py::arg("tree"),
+          py::arg("memory_budget") = (std::numeric_limits<std::size_t>::max)(),
+          py::keep_alive<1, 2>());
+
+    c.def("set_input",
+          [](registry_t &r, const std::string &name, const pyarray<double> &value) {
+              if (value.dimension() == 1) {
+                  r.set_input(name, hg::array_1d<double>(value));
+              } else {
+                  r.set_input(name, hg::array_nd<double>(value));
+              }
+          },
+          "Set the value of the given input (values are converted to float64).",
+          py::arg("name"),
+          py::arg("value"));
+
+    c.def("get",
+          [](registry_t &r, const std::string &name) -> py::object {
+              auto type = r.type(name);
+              if (type == std::type_index(typeid(hg::array_1d<double>))) {
+                  return py::cast(hg::array_1d<double>(*r.get<hg::array_1d<double>>(name)));
+              } else if (type == std::type_index(typeid(hg::array_1d<hg::index_t>))) {
+                  return py::cast(hg::array_1d<hg::index_t>(*r.get<hg::array_1d<hg::index_t>>(name)));
+              } else if (type == std::type_index(typeid(hg::array_nd<double>))) {
+                  return py::cast(hg::array_nd<double>(*r.get<hg::array_nd<double>>(name)));
+              }
+              throw std::runtime_error("Attribute '" + name + "' cannot be converted to a numpy array.");
+          },
+          "Value of the given attribute, computed if needed.",
+          py::arg("name"));
+
+    c.def("contains", &registry_t::contains,
+          "True if name is an attribute or an input that has been set.",
+          py::arg("name"));
+    c.def("is_cached", &registry_t::is_cached,
+          "True if the value of name is available without computation.",
+          py::arg("name"));
+    c.def("evict", &registry_t::evict,
+          "Discard the cached value of the given attribute.",
+          py::arg("name"));
+    c.def("clear", &registry_t::clear,
+          "Discard the cached values of all the attributes.");
+    c.def("memory_usage", &registry_t::memory_usage,
+          "Number of bytes used by the cached values of the attributes (inputs excluded).");
+    c.def("memory_budget", &registry_t::memory_budget,
+          "Memory budget of the registry in bytes.");
+    c.def("set_memory_budget", &registry_t::set_memory_budget,
+          "Set the memory budget of the registry in bytes.",
+          py::arg("memory_budget"));
+}
+
 void py_init_attributes(pybind11::module &m) {
     xt::import_numpy();
     m.def("_attribute_sibling",
@@ -141,6 +338,37 @@ void py_init_attributes(pybind11::module &m) {
           "",
           pybind11::arg("tree"));
 
+    m.def("_attribute_leaf_ordering",
+          [](const hg::tree &tree) {
+              auto res = hg::attribute_leaf_ordering(tree);
+              return py::make_tuple(std::move(res.leaves), std::move(res.begin), std::move(res.end));
+          },
+          "",
+          pybind11::arg("tree"));
+
+    m.def("_attribute_image_moments",
+          [](const hg::tree &tree, const std::vector<size_t> &shape) {
+              hg::image_moments res;
+              if (shape.size() == 2) {
+                  res = hg::attribute_image_moments(tree, hg::embedding_grid_2d(shape));
+              } else if (shape.size() == 3) {
+                  res = hg::attribute_image_moments(tree, hg::embedding_grid_3d(shape));
+              } else {
+                  throw std::runtime_error("Only 2d and 3d images are supported.");
+              }
+              return py::make_tuple(std::move(res.area),
+                                    std::move(res.raw_moments_1),
+                                    std::move(res.raw_moments_2),
+                                    std::move(res.centroid),
+                                    std::move(res.central_moments_2),
+                                    std::move(res.bounding_box),
+                                    std::move(res.elongation),
+                                    std::move(res.orientation));
+          },
+          "",
+          pybind11::arg("tree"),
+          pybind11::arg("shape"));
+
     m.def("_attribute_child_number",
           [](const hg::tree &tree) {
               return hg::attribute_child_number(tree);
@@ -151,15 +379,35 @@ void py_init_attributes(pybind11::module &m) {
     add_type_overloads<def_contour_length_component_tree,
             HG_TEMPLATE_FLOAT_TYPES>(m, "");
 
+    add_type_overloads<def_attribute_frontier_length,
+            HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
+    add_type_overloads<def_attribute_frontier_strength,
+            HG_TEMPLATE_FLOAT_TYPES>(m, "");
+
+    add_type_overloads<def_attribute_contour_length,
+            HG_TEMPLATE_FLOAT_TYPES>(m, "");
+
+    add_type_overloads<def_attribute_contour_strength,
+            HG_TEMPLATE_FLOAT_TYPES>(m, "");
+
     add_type_overloads<def_attribute_extrema,
             HG_TEMPLATE_NUMERIC_TYPES>(m, "");
 
     add_type_overloads<def_attribute_extinction_value,
             HG_TEMPLATE_FLOAT_TYPES>(m, "");
 
+    add_type_overloads<def_attribute_extinction_values,
+            HG_TEMPLATE_FLOAT_TYPES>(m, "");
+
     add_type_overloads<def_attribute_height,
             HG_TEMPLATE_NUMERIC_TYPES>(m, "");
 
+    add_type_overloads<def_attribute_tree_sampling_probability,
+            HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
     add_type_overloads<def_attribute_children_pair_sum_product,
             int32_t, uint32_t, int64_t, uint64_t, float, double>(m, "");
+
+    py_init_attribute_registry(m);
 }
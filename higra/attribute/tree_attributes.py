@@ -15,7 +15,7 @@ import higra as hg
 
 @hg.argument_helper(hg.CptHierarchy)
 @hg.auto_cache
-def attribute_area(tree, vertex_area=None, leaf_graph=None):
+def attribute_area(tree, vertex_area=None, leaf_graph=None, dtype=None):
     """
     Area of each node the given tree.
     The area of a node is equal to the sum of the area of the leaves of the subtree rooted in the node.
@@ -23,6 +23,7 @@ def attribute_area(tree, vertex_area=None, leaf_graph=None):
     :param tree: input tree (Concept :class:`~higra.CptHierarchy`)
     :param vertex_area: area of the vertices of the leaf graph of the tree (provided by :func:`~higra.attribute_vertex_area` on `leaf_graph` )
     :param leaf_graph: (deduced from :class:`~higra.CptHierarchy`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to the data type of vertex_area)
     :return: a 1d array
     """
     if vertex_area is None:
@@ -33,11 +34,11 @@ def attribute_area(tree, vertex_area=None, leaf_graph=None):
 
     if leaf_graph is not None:
         vertex_area = hg.linearize_vertex_weights(vertex_area, leaf_graph)
-    return hg.accumulate_sequential(tree, vertex_area, hg.Accumulators.sum)
+    return hg.accumulate_sequential(tree, vertex_area, hg.Accumulators.sum, dtype=dtype)
 
 
 @hg.auto_cache
-def attribute_volume(tree, altitudes, area=None):
+def attribute_volume(tree, altitudes, area=None, dtype=None):
     """
     Volume of each node the given tree.
     The volume :math:`V(n)` of a node :math:`n` is defined recursively as:
@@ -49,6 +50,7 @@ def attribute_volume(tree, altitudes, area=None):
     :param tree: input tree
     :param altitudes: node altitudes of the input tree
     :param area: area of the nodes of the input hierarchy (provided by :func:`~higra.attribute_area` on `tree`)
+    :param dtype: data type of the result, numpy.float32 or numpy.float64 (optional, defaults to numpy.float64)
     :return: a 1d array
     """
     if area is None:
@@ -57,7 +59,7 @@ def attribute_volume(tree, altitudes, area=None):
     height = np.abs(altitudes[tree.parents()] - altitudes)
     height = height * area
     volume_leaves = np.zeros(tree.num_leaves(), dtype=np.float64)
-    return hg.accumulate_and_add_sequential(tree, height, volume_leaves, hg.Accumulators.sum)
+    return hg.accumulate_and_add_sequential(tree, height, volume_leaves, hg.Accumulators.sum, dtype=dtype)
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -89,6 +91,9 @@ def attribute_frontier_length(tree, edge_length=None, leaf_graph=None):
     This function compute the length of these common contours as the sum of the length of edges going from one of the
     merged region to the other one.
 
+    The frontier lengths are accumulated with a single pass over the edges of the leaf graph, the lowest common
+    ancestor of the extremities of each edge being computed offline.
+
     The result has the same dtype as the edge_length array.
 
     :param tree: input tree
@@ -100,11 +105,7 @@ def attribute_frontier_length(tree, edge_length=None, leaf_graph=None):
     if edge_length is None:
         edge_length = hg.attribute_edge_length(leaf_graph)
 
-    lca_map = attribute_lca_map(tree, leaf_graph)
-
-    frontier_length = np.zeros((tree.num_vertices(),), dtype=edge_length.dtype)
-    np.add.at(frontier_length, lca_map, edge_length)
-    return frontier_length
+    return hg.cpp._attribute_frontier_length(tree, leaf_graph, edge_length)
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -118,7 +119,7 @@ def attribute_frontier_strength(tree, edge_weights, leaf_graph):
     This function compute the strength of a common contour as the sum of the weights of edges going from one of the
     merged region to the other one divided by the length of the contour.
 
-    The result has the same dtype as the edge_weights array.
+    Nodes with an empty frontier (the leaves for example) have a strength equal to 0.
 
     :param tree: input tree
     :param edge_weights: weight of the edges of the leaf graph (if leaf_graph is a region adjacency graph, edge_weights might be weights on the edges of the pre-graph of the rag).
@@ -129,10 +130,10 @@ def attribute_frontier_strength(tree, edge_weights, leaf_graph):
     if hg.CptRegionAdjacencyGraph.validate(leaf_graph) and edge_weights.shape[0] != leaf_graph.num_edges():
         edge_weights = hg.rag_accumulate_on_edges(leaf_graph, hg.Accumulators.sum, edge_weights=edge_weights)
 
-    frontier_length = hg.attribute_frontier_length(tree, leaf_graph=leaf_graph)
-    frontier_strength = hg.attribute_frontier_length(tree, edge_weights, leaf_graph)
-    frontier_strength[tree.num_leaves():] = frontier_strength[tree.num_leaves():] / frontier_length[tree.num_leaves():]
-    return frontier_strength
+    edge_length = hg.attribute_edge_length(leaf_graph)
+    edge_weights, edge_length = hg.cast_to_common_type(edge_weights, edge_length, safety_level='overflow')
+
+    return hg.cpp._attribute_frontier_strength(tree, leaf_graph, edge_weights, edge_length)
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -154,12 +155,10 @@ def attribute_contour_length(tree, vertex_perimeter=None, edge_length=None, leaf
     if edge_length is None:
         edge_length = hg.attribute_edge_length(leaf_graph)
 
-    if leaf_graph is not None:
-        vertex_perimeter = hg.linearize_vertex_weights(vertex_perimeter, leaf_graph)
+    vertex_perimeter = hg.linearize_vertex_weights(vertex_perimeter, leaf_graph)
+    vertex_perimeter, edge_length = hg.cast_to_common_type(vertex_perimeter, edge_length, safety_level='overflow')
 
-    frontier_length = hg.attribute_frontier_length(tree, edge_length, leaf_graph)
-    perimeter = hg.accumulate_and_add_sequential(tree, -2 * frontier_length, vertex_perimeter,
-                                                 hg.Accumulators.sum)
+    perimeter = hg.cpp._attribute_contour_length(tree, leaf_graph, vertex_perimeter, edge_length)
 
     # hg.cpp._attribute_contour_length_component_tree is more efficient than the partition tree
     # algorithm but it does not work for tree of shapes left in original space (the problem is that
@@ -197,19 +196,16 @@ def attribute_contour_strength(tree, edge_weights, vertex_perimeter=None, edge_l
     if edge_length is None:
         edge_length = hg.attribute_edge_length(leaf_graph)
 
-    perimeter = attribute_contour_length(tree, vertex_perimeter, edge_length, leaf_graph)
-
-    # perimeter of the root may be null
-    if np.isclose(perimeter[-1], 0):
-        perimeter[-1] = 1
-
     if hg.CptRegionAdjacencyGraph.validate(leaf_graph):
         edge_weights = hg.rag_accumulate_on_edges(leaf_graph, hg.Accumulators.sum, edge_weights)
 
-    vertex_weights_sum = hg.accumulate_graph_edges(leaf_graph, edge_weights, hg.Accumulators.sum)
-    edge_weights_sum = attribute_contour_length(tree, vertex_weights_sum, edge_weights, leaf_graph)
+    vertex_perimeter = hg.linearize_vertex_weights(vertex_perimeter, leaf_graph)
+    edge_weights, vertex_perimeter, edge_length = hg.cast_to_common_type(edge_weights, vertex_perimeter, edge_length,
+                                                                         safety_level='overflow')
 
-    return edge_weights_sum / perimeter
+    # contour weights and contour lengths are computed together, the contour length of the root is replaced
+    # by 1 if it is null
+    return hg.cpp._attribute_contour_strength(tree, leaf_graph, edge_weights, vertex_perimeter, edge_length)
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -325,26 +321,76 @@ def attribute_regular_altitudes(tree, depth=None):
 
 
 @hg.auto_cache
-def attribute_vertex_list(tree):
+def attribute_leaf_ordering(tree):
     """
-    List of leaf nodes inside the sub-tree rooted in a node.
+    Depth first ordering of the leaves of the tree.
 
-    **WARNING**: This function is slow and will use O(n²) space, with n the number of leaf nodes !
+    The leaves of the sub-tree rooted in a node :math:`n` are the elements :math:`leaves[begin[n]:end[n]]` of the
+    permutation :math:`leaves`: the leaves of each node occupy a contiguous interval of the permutation.
+    For a leaf :math:`l`, :math:`begin[l]` is the rank of :math:`l` in the ordering. If a node :math:`m` belongs to
+    the sub-tree rooted in :math:`n` then :math:`begin[n] \\leq begin[m]` and :math:`end[m] \\leq end[n]`: the converse
+    does not hold when :math:`n` has a single child, as a node and its only child share the same interval.
 
-    **SHOULD ONLY BE USED FOR DEBUGGING AND TESTING**
+    Time complexity is linear in the number of nodes of the tree.
 
     :param tree: input tree
-    :return: a list of lists
+    :return: a tuple of 3 1d arrays: leaves (of size :math:`tree.num\\_leaves()`), begin and end (of size
+             :math:`tree.num\\_vertices()`)
     """
-    result = [[i] for i in tree.leaves()]
+    return hg.cpp._attribute_leaf_ordering(tree)
 
-    for i in tree.leaves_to_root_iterator(include_leaves=False):
-        tmp = []
-        for c in tree.children(i):
-            tmp.extend(result[c])
-        result.append(tmp)
 
-    return result
+@hg.argument_helper(hg.CptHierarchy, ("leaf_graph", hg.CptGridGraph))
+@hg.auto_cache
+def attribute_image_moments(tree, leaf_graph, shape):
+    """
+    Moments and shape descriptors of the nodes of a tree built on a 2d or 3d image.
+
+    The raw moments up to order 2 and the bounding box of the nodes are computed with a single leaves to root
+    traversal of the tree, the coordinates of the pixels being computed on the fly.
+
+    The result is a tuple composed of:
+
+        - area: number of pixels in each node, shape :math:`(N)`;
+        - raw_moments_1: sum of the coordinates of the pixels, shape :math:`(N, d)`;
+        - raw_moments_2: sum of the products of the coordinates of the pixels, shape :math:`(N, d, d)`;
+        - centroid: mean of the coordinates of the pixels, shape :math:`(N, d)`;
+        - central_moments_2: sum of the products of the centered coordinates of the pixels, shape :math:`(N, d, d)`;
+        - bounding_box: smallest and largest coordinates of the pixels, shape :math:`(N, 2, d)`;
+        - elongation: :math:`1 - \\sqrt{\\lambda_{min} / \\lambda_{max}}` with :math:`\\lambda_{min}` and
+          :math:`\\lambda_{max}` the smallest and largest eigenvalues of the covariance matrix of the coordinates
+          of the pixels (0 for an isotropic node, 1 for a segment), shape :math:`(N)`;
+        - orientation: unit eigenvector associated to :math:`\\lambda_{max}`, whose first non zero coordinate is
+          positive, shape :math:`(N, d)`;
+
+    with :math:`N` the number of nodes of the tree and :math:`d` the dimension of the image.
+
+    :param tree: input tree (Concept :class:`~higra.CptHierarchy`)
+    :param leaf_graph: leaf graph of the input tree (deduced from :class:`~higra.CptHierarchy`)
+    :param shape: shape of the leaf graph (deduced from :class:`~higra.CptGridGraph`)
+    :return: a tuple of 8 arrays: area, raw_moments_1, raw_moments_2, centroid, central_moments_2, bounding_box,
+             elongation and orientation
+    """
+    if len(shape) not in (2, 3):
+        raise ValueError("Leaf graph must be a grid graph of dimension 2 or 3.")
+
+    return hg.cpp._attribute_image_moments(tree, shape)
+
+
+@hg.auto_cache
+def attribute_vertex_list(tree):
+    """
+    List of leaf nodes inside the sub-tree rooted in a node.
+
+    The result is a list of views on the permutation computed by :func:`~higra.attribute_leaf_ordering` (numpy
+    arrays, previous versions returned Python lists): it uses linear space.
+
+    :param tree: input tree
+    :return: a list of 1d arrays
+    """
+    leaves, begin, end = hg.attribute_leaf_ordering(tree)
+
+    return [leaves[b:e] for b, e in zip(begin, end)]
 
 
 @hg.argument_helper(hg.CptHierarchy)
@@ -470,17 +516,23 @@ def attribute_extinction_value(tree, altitudes, attribute, increasing_altitudes=
           (ie. for any node :math:`n`, :math:`altitude(n) \geq altitude(parent(n))`.
 
 
+    If :attr:`attribute` is a 2d array, each column is considered as a different attribute and the extinction values
+    for all the attributes are computed at once (the minima and the paths to the deepest minima are computed only once).
+
     :param tree: Input tree
     :param altitudes: Tree node altitudes
-    :param attribute: Tree node attribute
+    :param attribute: Tree node attribute (1d array), or several tree node attributes (2d array, one column per attribute)
     :param increasing_altitudes: possible values 'auto', True, False, 'increasing', and 'decreasing'
-    :return: a 1d array like :attr:`attribute`
+    :return: an array like :attr:`attribute`
     """
     inc = __process_param_increasing_altitudes(tree, altitudes, increasing_altitudes)
 
     altitudes, attribute = hg.cast_to_common_type(altitudes, attribute)
 
-    res = hg.cpp._attribute_extinction_value(tree, altitudes, attribute, inc)
+    if attribute.ndim == 2:
+        res = hg.cpp._attribute_extinction_values(tree, altitudes, attribute, inc)
+    else:
+        res = hg.cpp._attribute_extinction_value(tree, altitudes, attribute, inc)
 
     return res
 
@@ -632,6 +684,9 @@ def attribute_tree_sampling_probability(tree, leaf_graph, leaf_graph_edge_weight
      - *edge*: :math:`\mathcal{O}(N\log(N) + M)` with :math:`N` the number of  nodes in the tree and :math:`M` the number of edges in the leaf graph.
      - *null*: :math:`\mathcal{O}(N\\times C^2)` with :math:`N` the number of nodes in the tree  and :math:`C` the maximal number of children of a node in the tree.
 
+    With the *edge* model, the edge weights are accumulated in the lowest common ancestors of the edge extremities
+    in a single pass over the edges (in parallel on large graphs): the lowest common ancestors are never stored.
+
     :see:
 
     The :func:`~higra.tree_sampling_divergence` is a non supervised hierarchical cost function defined as the
@@ -646,12 +701,4 @@ def attribute_tree_sampling_probability(tree, leaf_graph, leaf_graph_edge_weight
     if model not in ("edge", "null"):
         raise ValueError("Parameter 'model' must be either 'edge' or 'null'.")
 
-    if model == 'edge':
-        lca_map = hg.attribute_lca_map(tree, leaf_graph=leaf_graph)
-        leaf_graph_edge_weights = leaf_graph_edge_weights / np.sum(leaf_graph_edge_weights)
-        return hg.accumulate_at(lca_map, leaf_graph_edge_weights, hg.Accumulators.sum)
-    else:  # model = 'null'
-        leaf_graph_vertex_weights = hg.accumulate_graph_edges(leaf_graph, leaf_graph_edge_weights, hg.Accumulators.sum)
-        leaf_graph_vertex_weights = leaf_graph_vertex_weights / np.sum(leaf_graph_edge_weights)
-        tree_node_weights = hg.accumulate_sequential(tree, leaf_graph_vertex_weights, hg.Accumulators.sum)
-        return hg.attribute_children_pair_sum_product(tree, tree_node_weights)
+    return hg.cpp._attribute_tree_sampling_probability(tree, leaf_graph, leaf_graph_edge_weights, model)
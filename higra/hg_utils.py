@@ -546,6 +546,22 @@ def cast_to_dtype(array, dtype):
     return array
 
 
+def call_with_dtype(function, dtype, *args):
+    """
+    Calls the given function with the given arguments, followed by the numpy dtype :attr:`dtype` if it is not ``None``.
+
+    This is used to call the C++ functions whose last optional argument is the data type of their result.
+
+    :param function: a function
+    :param dtype: a data type or ``None``
+    :param args: arguments of the function
+    :return: the result of the function
+    """
+    if dtype is None:
+        return function(*args)
+    return function(*args, np.dtype(dtype))
+
+
 def get_include():
     """
     Return the path to higra include files.
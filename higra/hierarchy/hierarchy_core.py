@@ -45,6 +45,15 @@ def quasi_flat_zone_hierarchy(graph, edge_weights):
     The nodes of the quasi flat zone hierarchy corresponds to the connected components of all the possible
     thresholds of the edge weights.
 
+    The hierarchy is built directly by a Kruskal like sweep over the sorted edges, where the components connected by an
+    edge of equal altitude are merged on the fly (no binary partition tree is constructed).
+
+    :Complexity:
+
+    The runtime complexity is :math:`\mathcal{O}(m \log m + m \alpha(n))` with :math:`n` the number of vertices and
+    :math:`m` the number of edges of the graph (the sort is replaced by a linear time counting sort when the edge
+    weights are integers in a small range, eg. 8 or 16 bits images).
+
     :param graph: input graph
     :param edge_weights: edge weights of the input graph
     :return: a tree (Concept :class:`~higra.CptHierarchy`) and its node altitudes
@@ -39,6 +39,25 @@ struct def_watershed_hierarchy_by_attribute {
     }
 };
 
+template<typename graph_t>
+struct def_watershed_hierarchies_by_attributes {
+    template<typename value_t, typename C>
+    static
+    void def(C &c, const char *doc) {
+        c.def("_watershed_hierarchies_by_attributes",
+              [](const graph_t &graph,
+                 const pyarray<value_t> &edge_weights,
+                 const std::vector<std::function<pyarray<double>(const hg::tree &,
+                                                                 const hg::array_1d<value_t> &)>> &attribute_functors) {
+                  return hg::watershed_hierarchies_by_attributes(graph, edge_weights, attribute_functors);
+              },
+              doc,
+              py::arg("graph"),
+              py::arg("edge_weights"),
+              py::arg("attribute_functors"));
+    }
+};
+
 template<typename graph_t>
 struct def_watershed_hierarchy_by_minima_ordering {
     template<typename value_t, typename C>
@@ -65,6 +84,8 @@ void py_init_watershed_hierarchy(pybind11::module &m) {
 
     add_type_overloads<def_watershed_hierarchy_by_attribute<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
 
+    add_type_overloads<def_watershed_hierarchies_by_attributes<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
+
     add_type_overloads<def_watershed_hierarchy_by_minima_ordering<hg::ugraph>, HG_TEMPLATE_NUMERIC_TYPES>(m, "");
 }
 
@@ -208,6 +208,60 @@ def watershed_hierarchy_by_attribute(graph, edge_weights, attribute_functor):
     return tree, altitudes
 
 
+def watershed_hierarchies_by_attributes(graph, edge_weights, attribute_functors):
+    """
+    Several watershed hierarchies computed at once, one for each of the given user defined attributes.
+
+    The result is the same as calling :func:`~higra.watershed_hierarchy_by_attribute` for each attribute functor,
+    but the binary partition tree by altitude ordering of the input graph is computed only once, and the hierarchies
+    are then constructed in parallel (if Higra was compiled with TBB support).
+
+    The attribute functors are functions that take a binary partition tree and an array of altitudes as arguments
+    and return an array with the node attribute values for the given tree. They are called sequentially, in the
+    given order.
+
+    Example:
+
+    Computing the watershed hierarchies by area, volume and dynamics of the same edge weighted graph:
+
+    .. code-block:: python
+
+        (tree_area, altitudes_area), (tree_volume, altitudes_volume), (tree_dynamics, altitudes_dynamics) = \
+            hg.watershed_hierarchies_by_attributes(
+                graph,
+                edge_weights,
+                (lambda tree, _: hg.attribute_area(tree),
+                 lambda tree, altitudes: hg.attribute_volume(tree, altitudes),
+                 lambda tree, altitudes: hg.attribute_dynamics(tree, altitudes, "increasing")))
+
+    :param graph: input graph
+    :param edge_weights: edge weights of the input graph
+    :param attribute_functors: list of functions computing the regional attributes
+    :return: a list of pairs (tree, altitudes), the i-th pair being the hierarchy (Concept :class:`~higra.CptHierarchy`)
+             of the i-th attribute functor and its node altitudes
+    """
+
+    def helper_functor(attribute_functor):
+        def fun(tree, altitudes):
+            hg.CptHierarchy.link(tree, graph)
+
+            return attribute_functor(tree, altitudes)
+
+        return fun
+
+    res = hg.cpp._watershed_hierarchies_by_attributes(graph, edge_weights,
+                                                      [helper_functor(f) for f in attribute_functors])
+
+    result = []
+    for r in res:
+        tree = r.tree()
+        altitudes = r.altitudes()
+        hg.CptHierarchy.link(tree, graph)
+        result.append((tree, altitudes))
+
+    return result
+
+
 def watershed_hierarchy_by_minima_ordering(graph, edge_weights, minima_ranks, minima_altitudes):
     """
     Watershed hierarchy for the given minima ordering.
@@ -12,7 +12,8 @@ import higra as hg
 import numpy as np
 
 
-def component_tree_tree_of_shapes_image2d(image, padding='mean', original_size=True, immersion=True, exterior_vertex=0):
+def component_tree_tree_of_shapes_image2d(image, padding='mean', original_size=True, immersion=True, exterior_vertex=0,
+                                           parallel=False):
     """
     Tree of shapes of a 2d image.
 
@@ -55,6 +56,11 @@ def component_tree_tree_of_shapes_image2d(image, padding='mean', original_size=T
     (interior and exterior of a shape is defined with respect to this point). The coordinate of this point must be
     given in the padded/interpolated space.
 
+    If :attr:`parallel` is ``True``, the construction of the tree from the propagation order is done independently on
+    tiles of the interpolated space which are then merged (this is only useful if Higra was compiled with TBB). The
+    propagation itself remains sequential. The result is identical to the one obtained with :attr:`parallel` equal
+    to ``False``.
+
     .. [1] Pa. Monasse, and F. Guichard, "Fast computation of a contrast-invariant image representation," \
     Image Processing, IEEE Transactions on, vol.9, no.5, pp.860-872, May 2000
 
@@ -66,13 +72,15 @@ def component_tree_tree_of_shapes_image2d(image, padding='mean', original_size=T
     :param original_size: remove all nodes corresponding to interpolated/padded pixels (default = `True`)
     :param immersion: performs a plain map continuous immersion fo the original image (default = `True`)
     :param exterior_vertex: linear coordinate of the exterior point
+    :param parallel: use the tiled parallel tree construction (default = `False`)
     :return: a tree (Concept :class:`~higra.CptHierarchy`) and its node altitudes
     """
 
     assert len(image.shape) == 2, "This tree of shapes implementation only supports 2d images."
     immersion = bool(immersion)
 
-    res = hg.cpp._component_tree_tree_of_shapes_image2d(image, padding, original_size, immersion, exterior_vertex)
+    res = hg.cpp._component_tree_tree_of_shapes_image2d(image, padding, original_size, immersion, exterior_vertex,
+                                                        parallel)
     tree = res.tree()
     altitudes = res.altitudes()
 
@@ -93,6 +101,54 @@ def component_tree_tree_of_shapes_image2d(image, padding='mean', original_size=T
     return tree, altitudes
 
 
+def component_tree_tree_of_shapes_image3d(image, padding='mean', original_size=True, immersion=True, exterior_vertex=0):
+    """
+    Tree of shapes of a 3d image.
+
+    This is the 3d counterpart of :func:`~higra.component_tree_tree_of_shapes_image2d`: the tree is computed in the
+    interpolated multivalued 3d Khalimsky space with the 6 adjacency. The parameters :attr:`padding`,
+    :attr:`original_size`, :attr:`immersion`, and :attr:`exterior_vertex` have the same meaning as in the 2d case.
+    In practice if the size of the input image is :math:`(d, h, w)`, the leaves of the returned tree will correspond
+    to an image of size:
+
+      - :math:`(d, h, w)` if :attr:`original_size` is ``True``;
+      - :math:`(d * 2 - 1, h * 2 - 1, w * 2 - 1)` is :attr:`original_size` is ``False`` and :attr:`padding` is ``"none"``; and
+      - :math:`((d + 2) * 2 - 1, (h + 2) * 2 - 1, (w + 2) * 2 - 1)` otherwise.
+
+    The interpolated space is 8 times larger than the original space: if :attr:`original_size` is ``True``, the tree
+    is directly constructed in the original space and the tree of the interpolated space is never materialized.
+
+    :param image: must be a 3d array
+    :param padding: possible values are `'none'`, `'zero'`, and `'mean'` (default = `'mean'`)
+    :param original_size: remove all nodes corresponding to interpolated/padded voxels (default = `True`)
+    :param immersion: performs a plain map continuous immersion fo the original image (default = `True`)
+    :param exterior_vertex: linear coordinate of the exterior point
+    :return: a tree (Concept :class:`~higra.CptHierarchy`) and its node altitudes
+    """
+
+    assert len(image.shape) == 3, "This tree of shapes implementation only supports 3d images."
+    immersion = bool(immersion)
+
+    res = hg.cpp._component_tree_tree_of_shapes_image3d(image, padding, original_size, immersion, exterior_vertex)
+    tree = res.tree()
+    altitudes = res.altitudes()
+
+    if original_size or ((not immersion) and padding == "none"):
+        size = image.shape
+    else:
+        border = 0 if padding == "none" else 2
+        if immersion:
+            size = tuple((s + border) * 2 - 1 for s in image.shape)
+        else:
+            size = tuple(s + border for s in image.shape)
+
+    g = hg.RegularGraph3d(size, [[-1, 0, 0], [0, -1, 0], [0, 0, -1], [0, 0, 1], [0, 1, 0], [1, 0, 0]])
+    hg.CptGridGraph.link(g, size)
+    hg.CptHierarchy.link(tree, g)
+
+    return tree, altitudes
+
+
 def component_tree_multivariate_tree_of_shapes_image2d(image, padding='mean', original_size=True, immersion=True):
     """
     Multivariate tree of shapes for a 2d multi-band image. This tree is defined as a fusion of the marginal
@@ -112,10 +168,9 @@ def component_tree_multivariate_tree_of_shapes_image2d(image, padding='mean', or
 
     :Complexity:
 
-    The worst case runtime complexity of this method is :math:`\mathcal{O}(N^2D^2)` with :math:`N` the number of pixels
-    and :math:`D` the number of bands. If the image pixel values are quantized on :math:`K<<N` different values
-    (eg. with a color image in :math:`[0..255]^D`), then the worst case runtime complexity can be tightened to
-    :math:`\mathcal{O}(NKD^2)`.
+    The runtime complexity of the fusion of the marginal trees is :math:`\mathcal{O}(N\alpha(N)D^2)` with :math:`N`
+    the number of pixels, :math:`D` the number of bands, and :math:`\alpha` the inverse Ackermann function
+    (see :func:`~higra.tree_fusion_depth_map`).
 
     :See:
 
@@ -50,6 +50,7 @@ PYBIND11_MODULE(higram, m) {
     py_init_graph_image(m);
     py_init_graph_weights(m);
     py_init_fragmentation_curve(m);
+    py_init_hierarchical_cost(m);
     py_init_hierarchy_core(m);
     py_init_hierarchy_mean_pb(m);
     py_init_horizontal_cuts(m);
@@ -13,8 +13,13 @@
 #include "../utils.hpp"
 #include <functional>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
+#ifdef XTENSOR_USE_XSIMD
+#include "xsimd/xsimd.hpp"
+#endif
+
 namespace hg {
 
 #define HG_ACCUMULATORS (min)(max)(mean)(counter)(sum)(prod)(first)(last)
@@ -34,23 +39,215 @@ namespace hg {
 
     namespace accumulator_detail {
 
+        /**
+         * Reducers of the marginal accumulators: the same operation is applied to scalar values and,
+         * when SIMD support is enabled, to batches of values.
+         */
+        struct reducer_sum {
+            template<typename T>
+            T operator()(const T &v1, const T &v2) const {
+                return v1 + v2;
+            }
+        };
+
+        struct reducer_prod {
+            template<typename T>
+            T operator()(const T &v1, const T &v2) const {
+                return v1 * v2;
+            }
+        };
+
+        struct reducer_min {
+            template<typename T>
+            T operator()(const T &v1, const T &v2) const {
+                return (std::min)(v1, v2);
+            }
+
+#ifdef XTENSOR_USE_XSIMD
+            template<typename T, std::size_t N>
+            xsimd::batch<T, N> operator()(const xsimd::batch<T, N> &v1, const xsimd::batch<T, N> &v2) const {
+                return xsimd::min(v1, v2);
+            }
+#endif
+        };
+
+        struct reducer_max {
+            template<typename T>
+            T operator()(const T &v1, const T &v2) const {
+                return (std::max)(v1, v2);
+            }
+
+#ifdef XTENSOR_USE_XSIMD
+            template<typename T, std::size_t N>
+            xsimd::batch<T, N> operator()(const xsimd::batch<T, N> &v1, const xsimd::batch<T, N> &v2) const {
+                return xsimd::max(v1, v2);
+            }
+#endif
+        };
+
+        /**
+         * Number of values of type T processed by a SIMD instruction (1 if T has no SIMD support).
+         */
+        template<typename T>
+        struct simd_size {
+#ifdef XTENSOR_USE_XSIMD
+            static const std::size_t value = xsimd::simd_traits<T>::size;
+#else
+            static const std::size_t value = 1;
+#endif
+        };
+
+        template<typename T>
+        using has_simd = std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, char>::value &&
+                                                      (simd_size<T>::value > 1)>;
+
+        template<typename reducer_t, typename T>
+        void reduce_contiguous_rows(const reducer_t &reducer, T *storage, const T *const *rows, index_t num_rows,
+                                    index_t size, std::false_type) {
+            for (index_t r = 0; r < num_rows; r++) {
+                const T *row = rows[r];
+                for (index_t i = 0; i < size; i++) {
+                    storage[i] = reducer(row[i], storage[i]);
+                }
+            }
+        }
+
+#ifdef XTENSOR_USE_XSIMD
+
+        template<typename reducer_t, typename T>
+        void reduce_contiguous_rows(const reducer_t &reducer, T *storage, const T *const *rows, index_t num_rows,
+                                    index_t size, std::true_type) {
+            const index_t step = simd_size<T>::value;
+            index_t i = 0;
+            for (; i + step <= size; i += step) {
+                auto value = xsimd::load_unaligned(storage + i);
+                for (index_t r = 0; r < num_rows; r++) {
+                    value = reducer(xsimd::load_unaligned(rows[r] + i), value);
+                }
+                value.store_unaligned(storage + i);
+            }
+            for (; i < size; i++) {
+                for (index_t r = 0; r < num_rows; r++) {
+                    storage[i] = reducer(rows[r][i], storage[i]);
+                }
+            }
+        }
+
+#endif
+
+        /**
+         * Reduces the values of the rows (of length storage_end - storage_begin) into the storage:
+         * storage[i] = reducer(row[i], storage[i]) for each row.
+         */
+        template<typename reducer_t, typename S, typename T>
+        void reduce_rows(const reducer_t &reducer, S storage_begin, S storage_end, const T *rows, index_t num_rows) {
+            using value_type = typename std::iterator_traits<S>::value_type;
+            for (index_t r = 0; r < num_rows; r++) {
+                auto value = rows[r];
+                for (auto s = storage_begin; s != storage_end; s++, value++) {
+                    *s = reducer((value_type) *value, *s);
+                }
+            }
+        }
+
+        /**
+         * Specialization for contiguous rows: the rows are reduced together, by blocks of SIMD width if T has
+         * SIMD support.
+         */
+        template<typename reducer_t, typename T, typename T2>
+        std::enable_if_t<std::is_same<std::remove_const_t<T2>, T>::value>
+        reduce_rows(const reducer_t &reducer, T *storage_begin, T *storage_end, T2 *const *rows, index_t num_rows) {
+            reduce_contiguous_rows(reducer, storage_begin, (const T *const *) rows, num_rows,
+                                   storage_end - storage_begin, has_simd<T>());
+        }
+
+        /**
+         * Reduces a single row into the storage: storage[i] = reducer(row[i], storage[i]).
+         */
+        template<typename reducer_t, typename S, typename T>
+        void reduce_row(const reducer_t &reducer, S storage_begin, S storage_end, T row) {
+            reduce_rows(reducer, storage_begin, storage_end, &row, 1);
+        }
+
+        template<typename T>
+        void add_contiguous_rows_wide(double *sums, const T *const *rows, index_t num_rows, index_t size,
+                                      std::false_type) {
+            for (index_t r = 0; r < num_rows; r++) {
+                const T *row = rows[r];
+                for (index_t i = 0; i < size; i++) {
+                    sums[i] += row[i];
+                }
+            }
+        }
+
+#ifdef XTENSOR_USE_XSIMD
+
+        template<typename T>
+        void add_contiguous_rows_wide(double *sums, const T *const *rows, index_t num_rows, index_t size,
+                                      std::true_type) {
+            const index_t step = simd_size<double>::value;
+            index_t i = 0;
+            for (; i + step <= size; i += step) {
+                auto sum = xsimd::load_unaligned(sums + i);
+                for (index_t r = 0; r < num_rows; r++) {
+                    xsimd::batch<double, simd_size<double>::value> value;
+                    value.load_unaligned(rows[r] + i);
+                    sum += value;
+                }
+                sum.store_unaligned(sums + i);
+            }
+            for (; i < size; i++) {
+                for (index_t r = 0; r < num_rows; r++) {
+                    sums[i] += rows[r][i];
+                }
+            }
+        }
+
+#endif
+
+        /**
+         * Adds the values of the rows (of length size) to the double precision sums: sums[i] += row[i] for each row.
+         */
+        template<typename T>
+        void add_rows_wide(double *sums, const T *rows, index_t num_rows, index_t size) {
+            for (index_t r = 0; r < num_rows; r++) {
+                auto value = rows[r];
+                for (index_t i = 0; i < size; i++, value++) {
+                    sums[i] += *value;
+                }
+            }
+        }
+
+        /**
+         * Specialization for contiguous rows: the rows are added together, by blocks of SIMD width (values converted
+         * to double precision on load) if the rows contain floating point values.
+         */
+        template<typename T>
+        std::enable_if_t<std::is_arithmetic<T>::value>
+        add_rows_wide(double *sums, T *const *rows, index_t num_rows, index_t size) {
+            using value_type = std::remove_const_t<T>;
+            add_contiguous_rows_wide(sums, (const value_type *const *) rows, num_rows, size,
+                                     std::integral_constant<bool, has_simd<double>::value &&
+                                                                  std::is_floating_point<value_type>::value>());
+        }
+
         /**
         * Marginal processing accumulator
         * @tparam S the storage type
         * @tparam vectorial bool: is dimension of storage > 0 (different from scalar)
         */
-        template<typename S, bool vectorial>
+        template<typename S, bool vectorial, typename reducer_t>
         struct acc_marginal_impl {
         };
 
-        template<typename S>
-        struct acc_marginal_impl<S, true> {
+        template<typename S, typename reducer_t>
+        struct acc_marginal_impl<S, true, reducer_t> {
 
             static const bool is_vectorial = true;
 
-            using self_type = acc_marginal_impl<S, is_vectorial>;
+            using self_type = acc_marginal_impl<S, is_vectorial, reducer_t>;
             using value_type = typename std::iterator_traits<S>::value_type;
-            using reducer_type = std::function<value_type(value_type, value_type)>;
+            using reducer_type = reducer_t;
 
 
             acc_marginal_impl(const S &storage_begin, const S &storage_end, const reducer_type &reducer,
@@ -70,10 +267,16 @@ namespace hg {
             template<typename T, typename ...Args>
             void
             accumulate(T value_begin, Args &&...) {
-                auto s = m_storage_begin;
-                for (; s != m_storage_end; s++, value_begin++) {
-                    *s = m_reducer(*value_begin, *s);
-                }
+                reduce_row(m_reducer, m_storage_begin, m_storage_end, value_begin);
+            };
+
+            /**
+             * Accumulates several rows in a single pass over the storage.
+             */
+            template<typename T>
+            void
+            accumulate_rows(const T *rows_begin, index_t num_rows) {
+                reduce_rows(m_reducer, m_storage_begin, m_storage_end, rows_begin, num_rows);
             };
 
             template<typename ...Args>
@@ -99,14 +302,14 @@ namespace hg {
             S m_storage_end;
         };
 
-        template<typename S>
-        struct acc_marginal_impl<S, false> {
+        template<typename S, typename reducer_t>
+        struct acc_marginal_impl<S, false, reducer_t> {
 
             static const bool is_vectorial = false;
 
-            using self_type = acc_marginal_impl<S, is_vectorial>;
+            using self_type = acc_marginal_impl<S, is_vectorial, reducer_t>;
             using value_type = typename std::iterator_traits<S>::value_type;
-            using reducer_type = std::function<value_type(value_type, value_type)>;
+            using reducer_type = reducer_t;
 
             acc_marginal_impl(const S &storage_begin, const S &, const reducer_type &reducer,
                               const value_type &init_value) :
@@ -124,7 +327,7 @@ namespace hg {
             template<typename T, typename ...Args>
             void
             accumulate(const T value_begin, Args &&...) {
-                *m_storage_begin = m_reducer(*value_begin, *m_storage_begin);
+                *m_storage_begin = m_reducer((value_type) *value_begin, *m_storage_begin);
             };
 
             template<typename ...Args>
@@ -147,6 +350,18 @@ namespace hg {
             S m_storage_begin;
         };
 
+        /**
+         * True if the whole state of the accumulator lies in its storage: a single accumulator instance can then
+         * be used to accumulate values in several storages in any order by switching its storage with set_storage.
+         */
+        template<typename acc_t>
+        struct is_storage_only_accumulator : std::false_type {
+        };
+
+        template<typename S, bool vectorial, typename reducer_t>
+        struct is_storage_only_accumulator<acc_marginal_impl<S, vectorial, reducer_t>> : std::true_type {
+        };
+
 
         /**
          * Mean accumulator
@@ -169,12 +384,14 @@ namespace hg {
             template<typename T = self_type, typename ...Args>
             typename std::enable_if_t<T::is_vectorial>
             initialize(Args &&...) {
+                m_counter = 0;
                 std::fill(m_storage_begin, m_storage_end, 0);
             }
 
             template<typename T = self_type, typename ...Args>
             typename std::enable_if_t<!T::is_vectorial>
             initialize(Args &&...) {
+                m_counter = 0;
                 *m_storage_begin = 0;
             }
 
@@ -182,10 +399,17 @@ namespace hg {
             std::enable_if_t<T1::is_vectorial>
             accumulate(T value_begin, Args &&...) {
                 m_counter++;
-                auto s = m_storage_begin;
-                for (; s != m_storage_end; s++, value_begin++) {
-                    *s += *value_begin;
-                }
+                reduce_row(reducer_sum(), m_storage_begin, m_storage_end, value_begin);
+            }
+
+            /**
+             * Accumulates several rows in a single pass over the storage.
+             */
+            template<typename T1 = self_type, typename T>
+            std::enable_if_t<T1::is_vectorial>
+            accumulate_rows(const T *rows_begin, index_t num_rows) {
+                m_counter += num_rows;
+                reduce_rows(reducer_sum(), m_storage_begin, m_storage_end, rows_begin, num_rows);
             }
 
             template<typename T1 = self_type, typename T, typename ...Args>
@@ -230,6 +454,171 @@ namespace hg {
             S m_storage_end;
         };
 
+        /**
+         * Sum and mean accumulators for single precision storages: values are summed in double precision and the
+         * result is rounded only once in the storage by finalize. Contrarily to Kahan compensated summation, the
+         * error compensation cannot be optimized away by fast math compiler options.
+         *
+         * @tparam S the storage type
+         * @tparam vectorial bool: is dimension of storage > 0 (different from scalar)
+         * @tparam mean bool: divide the sum by the number of accumulated values
+         */
+        template<typename S, bool vectorial, bool mean>
+        struct acc_wide_sum_impl {
+        };
+
+        template<typename S, bool mean>
+        struct acc_wide_sum_impl<S, true, mean> {
+
+            static const bool is_vectorial = true;
+
+            using self_type = acc_wide_sum_impl<S, is_vectorial, mean>;
+            using value_type = typename std::iterator_traits<S>::value_type;
+
+            acc_wide_sum_impl(S storage_begin, S storage_end) :
+                    m_counter(0),
+                    m_storage_begin(storage_begin),
+                    m_storage_end(storage_end) {
+            }
+
+            template<typename ...Args>
+            void initialize(Args &&...) {
+                m_counter = 0;
+                m_sum.assign(std::distance(m_storage_begin, m_storage_end), 0);
+            }
+
+            template<typename T, typename ...Args>
+            void accumulate(T value_begin, Args &&...) {
+                m_counter++;
+                for (auto &s: m_sum) {
+                    s += *value_begin;
+                    value_begin++;
+                }
+            }
+
+            /**
+             * Accumulates several rows in a single pass over the double precision sums.
+             */
+            template<typename T>
+            void accumulate_rows(const T *rows_begin, index_t num_rows) {
+                m_counter += num_rows;
+                add_rows_wide(m_sum.data(), rows_begin, num_rows, (index_t) m_sum.size());
+            }
+
+            template<typename ...Args>
+            void finalize(Args &&...) const {
+                double scale = (mean && m_counter != 0) ? 1.0 / m_counter : 1.0;
+                auto s = m_storage_begin;
+                for (auto v: m_sum) {
+                    *s = (value_type) (v * scale);
+                    s++;
+                }
+            }
+
+            void set_storage(S storage_begin, S storage_end) {
+                m_storage_begin = storage_begin;
+                m_storage_end = storage_end;
+            }
+
+            template<typename T>
+            void set_storage(T &range) {
+                m_storage_begin = range.begin();
+                m_storage_end = range.end();
+            }
+
+        private:
+            std::size_t m_counter;
+            std::vector<double> m_sum;
+            S m_storage_begin;
+            S m_storage_end;
+        };
+
+        template<typename S, bool mean>
+        struct acc_wide_sum_impl<S, false, mean> {
+
+            static const bool is_vectorial = false;
+
+            using self_type = acc_wide_sum_impl<S, is_vectorial, mean>;
+            using value_type = typename std::iterator_traits<S>::value_type;
+
+            acc_wide_sum_impl(S storage_begin, S) :
+                    m_counter(0),
+                    m_sum(0),
+                    m_storage_begin(storage_begin) {
+            }
+
+            template<typename ...Args>
+            void initialize(Args &&...) {
+                m_counter = 0;
+                m_sum = 0;
+            }
+
+            template<typename T, typename ...Args>
+            void accumulate(const T value_begin, Args &&...) {
+                m_counter++;
+                m_sum += *value_begin;
+            }
+
+            template<typename ...Args>
+            void finalize(Args &&...) const {
+                *m_storage_begin = (value_type) ((mean && m_counter != 0) ? m_sum / m_counter : m_sum);
+            }
+
+            void set_storage(S storage_begin, S) {
+                m_storage_begin = storage_begin;
+            }
+
+            template<typename T>
+            void set_storage(T &range) {
+                m_storage_begin = range.begin();
+            }
+
+        private:
+            std::size_t m_counter;
+            double m_sum;
+            S m_storage_begin;
+        };
+
+        /**
+         * True if the accumulator is a sum or mean accumulator computed in double precision (see acc_wide_sum_impl):
+         * its state is equivalent to a double precision partial sum (and a counter for the mean), hence a storage only
+         * accumulator on a double precision buffer can be used instead (see accumulate_at).
+         */
+        template<typename acc_t>
+        struct is_wide_sum_accumulator : std::false_type {
+        };
+
+        template<typename S, bool vectorial, bool mean>
+        struct is_wide_sum_accumulator<acc_wide_sum_impl<S, vectorial, mean>> : std::true_type {
+            static const bool is_mean = mean;
+        };
+
+        /**
+         * True if sums accumulated in a storage of type T must be computed in double precision.
+         */
+        template<typename T>
+        using use_wide_sum = std::is_same<std::remove_cv_t<T>, float>;
+
+        template<bool vectorial, typename S>
+        auto make_sum_accumulator(S storage_begin, S storage_end, std::true_type) {
+            return acc_wide_sum_impl<S, vectorial, false>(storage_begin, storage_end);
+        }
+
+        template<bool vectorial, typename S>
+        auto make_sum_accumulator(S storage_begin, S storage_end, std::false_type) {
+            return acc_marginal_impl<S, vectorial, reducer_sum>(storage_begin, storage_end, reducer_sum(), 0);
+        }
+
+        template<bool vectorial, typename S>
+        auto make_mean_accumulator(S storage_begin, S storage_end, std::true_type) {
+            return acc_wide_sum_impl<S, vectorial, true>(storage_begin, storage_end);
+        }
+
+        template<bool vectorial, typename S>
+        auto make_mean_accumulator(S storage_begin, S storage_end, std::false_type) {
+            return acc_mean_impl<S, vectorial>(storage_begin, storage_end);
+        }
+
         /**
          * Counter accumulator
          * @tparam S the storage type
@@ -560,12 +949,10 @@ namespace hg {
         template<bool vectorial = true, typename S>
         auto make_accumulator(S &storage) const {
             using value_type = typename S::value_type;
-            using iterator_type = decltype(storage.begin());
-            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial>(
+            return accumulator_detail::make_sum_accumulator<vectorial>(
                     storage.begin(),
                     storage.end(),
-                    std::plus<value_type>(),
-                    0);
+                    accumulator_detail::use_wide_sum<value_type>());
         }
 
         template<typename shape_t>
@@ -581,10 +968,10 @@ namespace hg {
         auto make_accumulator(S &storage) const {
             using value_type = typename S::value_type;
             using iterator_type = decltype(storage.begin());
-            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial>(
+            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial, accumulator_detail::reducer_min>(
                     storage.begin(),
                     storage.end(),
-                    [](value_type v1, value_type v2) { return (std::min)(v1, v2); },
+                    accumulator_detail::reducer_min(),
                     (std::numeric_limits<value_type>::max)());
         }
 
@@ -601,10 +988,10 @@ namespace hg {
         auto make_accumulator(S &storage) const {
             using value_type = typename S::value_type;
             using iterator_type = decltype(storage.begin());
-            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial>(
+            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial, accumulator_detail::reducer_max>(
                     storage.begin(),
                     storage.end(),
-                    [](value_type v1, value_type v2) { return (std::max)(v1, v2); },
+                    accumulator_detail::reducer_max(),
                     std::numeric_limits<value_type>::lowest());
         }
 
@@ -621,10 +1008,10 @@ namespace hg {
         auto make_accumulator(S &storage) const {
             using value_type = typename S::value_type;
             using iterator_type = decltype(storage.begin());
-            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial>(
+            return accumulator_detail::acc_marginal_impl<iterator_type, vectorial, accumulator_detail::reducer_prod>(
                     storage.begin(),
                     storage.end(),
-                    std::multiplies<value_type>(),
+                    accumulator_detail::reducer_prod(),
                     1);
         }
 
@@ -640,8 +1027,10 @@ namespace hg {
         template<bool vectorial = true, typename S>
         auto make_accumulator(S &storage) const {
             using value_type = typename S::value_type;
-            using iterator_type = decltype(storage.begin());
-            return accumulator_detail::acc_mean_impl<iterator_type, vectorial>(storage.begin(), storage.end());
+            return accumulator_detail::make_mean_accumulator<vectorial>(
+                    storage.begin(),
+                    storage.end(),
+                    accumulator_detail::use_wide_sum<value_type>());
         }
 
         template<typename shape_t>
@@ -17,31 +17,120 @@
 namespace hg {
 
     namespace at_accumulator_internal {
-        template<bool vectorial,
-                typename T,
-                typename accumulator_t,
-                typename output_t = typename T::value_type>
-        auto
-        at_accumulate(const array_1d<index_t> &indices,
-                      const xt::xexpression<T> &xweights,
-                      const accumulator_t &accumulator) {
-            HG_TRACE();
-            auto &weights = xweights.derived_cast();
-            hg_assert(weights.shape()[0] == indices.size(), "Weights dimension does not match rag map dimension.");
 
-            index_t size = xt::amax(indices)() + 1;
-            auto data_shape = std::vector<size_t>(weights.shape().begin() + 1, weights.shape().end());
-            auto output_shape = accumulator_t::get_output_shape(data_shape);
-            output_shape.insert(output_shape.begin(), size);
-            array_nd<typename T::value_type> res = array_nd<typename T::value_type>::from_shape(output_shape);
+        /**
+         * Maximal number of output indices processed by a single task.
+         */
+        const index_t block_size = 1024;
+
+        /**
+         * Positions of the input values grouped by output index (counting sort): the positions associated to
+         * the output index i are positions[offsets[i]], ..., positions[offsets[i + 1] - 1], in increasing order.
+         */
+        struct grouped_positions {
+            std::vector<index_t> positions;
+            std::vector<index_t> offsets;
+        };
+
+        inline
+        grouped_positions group_by_index(const array_1d<index_t> &indices, index_t size) {
+            grouped_positions res;
+            res.offsets.resize(size + 1, 0);
+            index_t map_size = indices.size();
+            auto data = indices.data();
+            for (index_t i = 0; i < map_size; ++i) {
+                if (data[i] != invalid_index) {
+                    res.offsets[data[i] + 1]++;
+                }
+            }
+            for (index_t i = 0; i < size; ++i) {
+                res.offsets[i + 1] += res.offsets[i];
+            }
+            res.positions.resize(res.offsets[size]);
+            std::vector<index_t> next(res.offsets.begin(), res.offsets.end() - 1);
+            for (index_t i = 0; i < map_size; ++i) {
+                if (data[i] != invalid_index) {
+                    res.positions[next[data[i]]++] = i;
+                }
+            }
+            return res;
+        }
 
+        /**
+         * Parallel accumulation: input values are grouped by output index, then blocks of output indices are processed
+         * in parallel, each output index accumulating its values in the same order as the sequential accumulation.
+         */
+        template<bool vectorial, typename T, typename output_t, typename accumulator_t>
+        void at_accumulate_grouped(const array_1d<index_t> &indices,
+                                   const T &weights,
+                                   array_nd<output_t> &res,
+                                   const accumulator_t &accumulator) {
+            const index_t size = res.shape()[0];
+            auto groups = group_by_index(indices, size);
+            parfor_blocks(size, block_size, true, [&weights, &res, &accumulator, &groups](index_t first, index_t last) {
+                auto input_view = make_light_axis_view<vectorial>(weights);
+                auto output_view = make_light_axis_view<vectorial>(res);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+                for (index_t i = first; i < last; ++i) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    for (index_t j = groups.offsets[i]; j < groups.offsets[i + 1]; ++j) {
+                        input_view.set_position(groups.positions[j]);
+                        acc.accumulate(input_view.begin());
+                    }
+                    acc.finalize();
+                }
+            });
+        }
+
+        /**
+         * Sequential accumulation with a single accumulator whose storage is switched for each input value.
+         */
+        template<bool vectorial, typename T, typename output_t, typename accumulator_t>
+        void at_accumulate_sequential(const array_1d<index_t> &indices,
+                                      const T &weights,
+                                      array_nd<output_t> &res,
+                                      const accumulator_t &accumulator,
+                                      std::true_type) {
+            const index_t size = res.shape()[0];
+            auto input_view = make_light_axis_view<vectorial>(weights);
+            auto output_view = make_light_axis_view<vectorial>(res);
+            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+
+            for (index_t i = 0; i < size; ++i) {
+                output_view.set_position(i);
+                acc.set_storage(output_view);
+                acc.initialize();
+            }
+
+            index_t map_size = indices.size();
+            for (index_t i = 0; i < map_size; ++i) {
+                if (indices.data()[i] != invalid_index) {
+                    input_view.set_position(i);
+                    output_view.set_position(indices.data()[i]);
+                    acc.set_storage(output_view);
+                    acc.accumulate(input_view.begin());
+                }
+            }
+        }
+
+        /**
+         * Sequential accumulation with one accumulator per output index.
+         */
+        template<bool vectorial, typename T, typename output_t, typename accumulator_t>
+        void at_accumulate_sequential(const array_1d<index_t> &indices,
+                                      const T &weights,
+                                      array_nd<output_t> &res,
+                                      const accumulator_t &accumulator,
+                                      std::false_type) {
+            const index_t size = res.shape()[0];
             auto input_view = make_light_axis_view<vectorial>(weights);
             auto output_view = make_light_axis_view<vectorial>(res);
 
             std::vector<decltype(accumulator.template make_accumulator<vectorial>(output_view))> accs;
             accs.reserve(size);
 
-
             for (index_t i = 0; i < size; ++i) {
                 output_view.set_position(i);
                 accs.push_back(accumulator.template make_accumulator<vectorial>(output_view));
@@ -59,6 +148,95 @@ namespace hg {
             for (auto &acc: accs) {
                 acc.finalize();
             }
+        }
+
+        /**
+         * Sequential accumulation for the sum and mean accumulators computed in double precision: the partial sums are
+         * kept in a double precision buffer (and the number of values of each output index in a counter for the
+         * mean), and rounded once in the result.
+         */
+        template<bool vectorial, bool mean, typename T, typename output_t>
+        void at_accumulate_wide_sum(const array_1d<index_t> &indices,
+                                    const T &weights,
+                                    array_nd<output_t> &res) {
+            const index_t size = res.shape()[0];
+            const index_t row_size = (size == 0) ? 0 : (index_t) (res.size() / size);
+            std::vector<double> sums(size * row_size, 0);
+            std::vector<index_t> counts(mean ? size : 0, 0);
+            auto input_view = make_light_axis_view<vectorial>(weights);
+
+            index_t map_size = indices.size();
+            for (index_t i = 0; i < map_size; ++i) {
+                auto index = indices.data()[i];
+                if (index != invalid_index) {
+                    input_view.set_position(i);
+                    auto value = input_view.begin();
+                    auto sum = sums.data() + index * row_size;
+                    for (index_t j = 0; j < row_size; ++j, ++value) {
+                        sum[j] += *value;
+                    }
+                    if (mean) {
+                        counts[index]++;
+                    }
+                }
+            }
+
+            auto data = res.data();
+            for (index_t i = 0; i < size; ++i) {
+                double scale = (mean && counts[i] != 0) ? 1.0 / counts[i] : 1.0;
+                for (index_t j = 0; j < row_size; ++j) {
+                    data[i * row_size + j] = (output_t) (sums[i * row_size + j] * scale);
+                }
+            }
+        }
+
+        template<bool vectorial, typename acc_t, typename T, typename output_t, typename accumulator_t>
+        void at_accumulate_sequential_dispatch(const array_1d<index_t> &indices,
+                                               const T &weights,
+                                               array_nd<output_t> &res,
+                                               const accumulator_t &,
+                                               std::true_type) {
+            at_accumulate_wide_sum<vectorial, accumulator_detail::is_wide_sum_accumulator<acc_t>::is_mean>(
+                    indices, weights, res);
+        }
+
+        template<bool vectorial, typename acc_t, typename T, typename output_t, typename accumulator_t>
+        void at_accumulate_sequential_dispatch(const array_1d<index_t> &indices,
+                                               const T &weights,
+                                               array_nd<output_t> &res,
+                                               const accumulator_t &accumulator,
+                                               std::false_type) {
+            at_accumulate_sequential<vectorial>(indices, weights, res, accumulator,
+                                                accumulator_detail::is_storage_only_accumulator<acc_t>());
+        }
+
+        template<bool vectorial,
+                typename T,
+                typename accumulator_t,
+                typename output_t = typename T::value_type>
+        auto
+        at_accumulate(const array_1d<index_t> &indices,
+                      const xt::xexpression<T> &xweights,
+                      const accumulator_t &accumulator,
+                      bool parallel = false) {
+            HG_TRACE();
+            auto &weights = xweights.derived_cast();
+            hg_assert(weights.shape()[0] == indices.size(), "Weights dimension does not match rag map dimension.");
+
+            index_t size = xt::amax(indices)() + 1;
+            auto data_shape = std::vector<size_t>(weights.shape().begin() + 1, weights.shape().end());
+            auto output_shape = accumulator_t::get_output_shape(data_shape);
+            output_shape.insert(output_shape.begin(), size);
+            array_nd<output_t> res = array_nd<output_t>::from_shape(output_shape);
+
+            if (parallel) {
+                at_accumulate_grouped<vectorial>(indices, weights, res, accumulator);
+            } else {
+                auto output_view = make_light_axis_view<vectorial>(res);
+                using acc_t = decltype(accumulator.template make_accumulator<vectorial>(output_view));
+                at_accumulate_sequential_dispatch<vectorial, acc_t>(
+                        indices, weights, res, accumulator, accumulator_detail::is_wide_sum_accumulator<acc_t>());
+            }
 
             return res;
         }
@@ -73,9 +251,15 @@ namespace hg {
      *
      *      result[i] = accumulator(\{weights[j, :] \mid indices[j] = i  \})
      *
+     * When Higra is compiled with TBB, large inputs are grouped by index and the output indices are processed in
+     * parallel. The values associated to an index are accumulated in the same order as in the sequential version,
+     * hence the results are identical for marginal accumulators (sum, min, max, prod, first, last...); the results
+     * of accumulators with a final computation (mean) may differ in the last bits with aggressive floating point
+     * optimizations.
+     *
      * @tparam T
      * @tparam accumulator_t
-     * @tparam output_t
+     * @tparam output_t value type of the result (defaults to the value type of the weights)
      * @param indices a 1d array of indices (entry equals to :math:`-1` are ignored)
      * @param xweights a nd-array of shape :math:`(s_1, \ldots, s_n)` such that :math:`s_1=indices.size()`
      * @param accumulator
@@ -85,14 +269,17 @@ namespace hg {
     auto accumulate_at(const array_1d<index_t> &indices,
                        const xt::xexpression<T> &xweights,
                        const accumulator_t &accumulator) {
+        bool parallel = use_parallel((index_t) indices.size());
         if (xweights.derived_cast().dimension() == 1) {
             return at_accumulator_internal::at_accumulate<false, T, accumulator_t, output_t>(indices,
                                                                                              xweights,
-                                                                                             accumulator);
+                                                                                             accumulator,
+                                                                                             parallel);
         } else {
             return at_accumulator_internal::at_accumulate<true, T, accumulator_t, output_t>(indices,
                                                                                             xweights,
-                                                                                            accumulator);
+                                                                                            accumulator,
+                                                                                            parallel);
         }
     };
 
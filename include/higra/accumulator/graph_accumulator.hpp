@@ -18,6 +18,60 @@ namespace hg {
 
     namespace graph_accumulator_detail {
 
+        /**
+         * Number of vertices processed by a single task.
+         */
+        const index_t vertex_block_size = 4096;
+
+        /**
+         * Calls fun(first, last) on consecutive ranges of vertices covering all the vertices of the graph,
+         * the ranges are processed in parallel if parallel is true.
+         */
+        template<typename graph_t, typename fun_t>
+        void for_each_vertex_block(const graph_t &graph, bool parallel, const fun_t &fun) {
+            parfor_blocks(num_vertices(graph), vertex_block_size, parallel, fun);
+        }
+
+        /**
+         * Calls fun(ei) for the index ei of each out edge of the vertex v.
+         */
+        template<typename graph_t, typename fun_t>
+        void for_each_out_edge_index(index_t v, const graph_t &graph, const fun_t &fun) {
+            for (auto e: out_edge_iterator(v, graph)) {
+                fun(e);
+            }
+        }
+
+        /**
+         * Undirected graphs: the adjacency lists of edge indices are read directly.
+         */
+        template<typename storage_t, typename fun_t>
+        void for_each_out_edge_index(index_t v, const undirected_graph<storage_t> &graph, const fun_t &fun) {
+            for (auto it = graph.out_edges_cbegin(v), end = graph.out_edges_cend(v); it != end; ++it) {
+                fun((index_t) *it);
+            }
+        }
+
+        /**
+         * Calls fun(a) for each vertex a adjacent to the vertex v.
+         */
+        template<typename graph_t, typename fun_t>
+        void for_each_adjacent_vertex(index_t v, const graph_t &graph, const fun_t &fun) {
+            for (auto a: adjacent_vertex_iterator(v, graph)) {
+                fun(a);
+            }
+        }
+
+        /**
+         * Undirected graphs: the adjacency lists of edge indices are read directly.
+         */
+        template<typename storage_t, typename fun_t>
+        void for_each_adjacent_vertex(index_t v, const undirected_graph<storage_t> &graph, const fun_t &fun) {
+            for (auto it = graph.out_edges_cbegin(v), end = graph.out_edges_cend(v); it != end; ++it) {
+                const auto &e = graph.edge_from_index(*it);
+                fun((index_t) ((e.source == v) ? e.target : e.source));
+            }
+        }
 
         template<bool vectorial,
                 typename graph_t,
@@ -26,7 +80,8 @@ namespace hg {
                 typename output_t = typename T::value_type>
         auto accumulate_graph_edges_impl(const graph_t &graph,
                                          const xt::xexpression<T> &xinput,
-                                         const accumulator_t accumulator) {
+                                         const accumulator_t accumulator,
+                                         bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             hg_assert_edge_weights(graph, input);
@@ -37,19 +92,23 @@ namespace hg {
 
             array_nd<output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-
-            for (auto i: vertex_iterator(graph)) {
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-                for (auto e: out_edge_iterator(i, graph)) {
-                    input_view.set_position(e);
-                    acc.accumulate(input_view.begin());
+            for_each_vertex_block(graph, parallel, [&graph, &input, &output, &accumulator](index_t first,
+                                                                                            index_t last) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+
+                for (index_t i = first; i < last; i++) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    for_each_out_edge_index(i, graph, [&acc, &input_view](index_t e) {
+                        input_view.set_position(e);
+                        acc.accumulate(input_view.begin());
+                    });
+                    acc.finalize();
                 }
-            }
+            });
 
             return output;
         };
@@ -61,7 +120,8 @@ namespace hg {
                 typename output_t = typename T::value_type>
         auto accumulate_graph_vertices_impl(const graph_t &graph,
                                             const xt::xexpression<T> &xinput,
-                                            const accumulator_t accumulator) {
+                                            const accumulator_t accumulator,
+                                            bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             hg_assert_vertex_weights(graph, input);
@@ -72,24 +132,26 @@ namespace hg {
 
             array_nd<output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-
-            for (auto i: vertex_iterator(graph)) {
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-                for (auto v: adjacent_vertex_iterator(i, graph)) {
-                    input_view.set_position(v);
-                    acc.accumulate(input_view.begin());
+            for_each_vertex_block(graph, parallel, [&graph, &input, &output, &accumulator](index_t first,
+                                                                                            index_t last) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+
+                for (index_t i = first; i < last; i++) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    for_each_adjacent_vertex(i, graph, [&acc, &input_view](index_t v) {
+                        input_view.set_position(v);
+                        acc.accumulate(input_view.begin());
+                    });
+                    acc.finalize();
                 }
-            }
+            });
 
             return output;
         };
-
-
     }
 
     template<typename graph_t, typename T, typename accumulator_t, typename output_t = typename T::value_type>
@@ -97,10 +159,13 @@ namespace hg {
                                 const xt::xexpression<T> &xedge_weights,
                                 const accumulator_t &accumulator) {
         auto &edge_weights = xedge_weights.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(graph));
         if (edge_weights.dimension() == 1) {
-            return graph_accumulator_detail::accumulate_graph_edges_impl<false>(graph, xedge_weights, accumulator);
+            return graph_accumulator_detail::accumulate_graph_edges_impl<false, graph_t, T, accumulator_t, output_t>(
+                    graph, xedge_weights, accumulator, parallel);
         } else {
-            return graph_accumulator_detail::accumulate_graph_edges_impl<true>(graph, xedge_weights, accumulator);
+            return graph_accumulator_detail::accumulate_graph_edges_impl<true, graph_t, T, accumulator_t, output_t>(
+                    graph, xedge_weights, accumulator, parallel);
         }
     };
 
@@ -109,10 +174,13 @@ namespace hg {
                                    const xt::xexpression<T> &xvertex_weights,
                                    const accumulator_t &accumulator) {
         auto &vertex_weights = xvertex_weights.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(graph));
         if (vertex_weights.dimension() == 1) {
-            return graph_accumulator_detail::accumulate_graph_vertices_impl<false>(graph, xvertex_weights, accumulator);
+            return graph_accumulator_detail::accumulate_graph_vertices_impl<
+                    false, graph_t, T, accumulator_t, output_t>(graph, xvertex_weights, accumulator, parallel);
         } else {
-            return graph_accumulator_detail::accumulate_graph_vertices_impl<true>(graph, xvertex_weights, accumulator);
+            return graph_accumulator_detail::accumulate_graph_vertices_impl<
+                    true, graph_t, T, accumulator_t, output_t>(graph, xvertex_weights, accumulator, parallel);
         }
     };
 
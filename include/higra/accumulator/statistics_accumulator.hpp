@@ -0,0 +1,625 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include "../utils.hpp"
+#include "xtensor/xmath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*
+ * Mergeable statistics accumulators.
+ *
+ * The accumulators of this file do not combine raw values but statistical summaries (called states) of sets of values:
+ * the output of the accumulator is the state of the union of the accumulated states. They are thus meant to be used
+ * with accumulate_sequential (or accumulate_parallel on node states): the leaf data is first converted into leaf states
+ * with the associated *_leaf_state function, then accumulated in the tree, and the final statistics are extracted
+ * from the node states with the associated extraction functions.
+ *
+ * All states have a bounded size which does not depend on the number of values they summarize.
+ */
+
+namespace hg {
+
+    namespace statistics_accumulator_detail {
+
+        /**
+         * Base class of the statistics accumulators: the storage is always seen as a contiguous range
+         * (vectorial and scalar storages are handled the same way).
+         *
+         * @tparam S storage type
+         */
+        template<typename S>
+        struct acc_state_base {
+            using value_type = typename std::iterator_traits<S>::value_type;
+
+            acc_state_base(S storage_begin, S storage_end) :
+                    m_storage_begin(storage_begin),
+                    m_storage_end(storage_end) {
+            }
+
+            void set_storage(S storage_begin, S storage_end) {
+                m_storage_begin = storage_begin;
+                m_storage_end = storage_end;
+            }
+
+            template<typename T>
+            void set_storage(T &range) {
+                m_storage_begin = range.begin();
+                m_storage_end = range.end();
+            }
+
+        protected:
+            S m_storage_begin;
+            S m_storage_end;
+        };
+
+        /**
+         * Merges the central moments state (count, mean, M2, M3, M4) b into a.
+         *
+         * Pébay, P. (2008). Formulas for robust, one-pass parallel computation of covariances and arbitrary-order
+         * statistical moments. Sandia Report SAND2008-6212.
+         */
+        template<typename T1, typename T2>
+        void merge_moments(T1 a, T2 b) {
+            double na = a[0];
+            double nb = b[0];
+            if (nb == 0) {
+                return;
+            }
+            if (na == 0) {
+                std::copy(b, b + 5, a);
+                return;
+            }
+            double n = na + nb;
+            double delta = b[1] - a[1];
+            double delta_n = delta / n;
+            double delta_n2 = delta_n * delta_n;
+            double term = delta * delta_n * na * nb;
+            double m2a = a[2], m3a = a[3];
+            double m2b = b[2], m3b = b[3];
+
+            a[4] = a[4] + b[4]
+                   + term * delta_n2 * (na * na - na * nb + nb * nb)
+                   + 6 * delta_n2 * (na * na * m2b + nb * nb * m2a)
+                   + 4 * delta_n * (na * m3b - nb * m3a);
+            a[3] = m3a + m3b
+                   + term * delta_n * (na - nb)
+                   + 3 * delta_n * (na * m2b - nb * m2a);
+            a[2] = m2a + m2b + term;
+            a[1] = a[1] + delta_n * nb;
+            a[0] = n;
+        }
+
+        /**
+         * Merges the covariance state (count, mean, co-moment matrix) b into a.
+         *
+         * Chan, T. F., Golub, G. H., & LeVeque, R. J. (1979). Updating formulae and a pairwise algorithm for computing
+         * sample variances. Technical Report STAN-CS-79-773.
+         */
+        template<typename T1, typename T2>
+        void merge_covariance(T1 a, T2 b, index_t dim, std::vector<double> &delta) {
+            double na = a[0];
+            double nb = b[0];
+            if (nb == 0) {
+                return;
+            }
+            if (na == 0) {
+                std::copy(b, b + 1 + dim + dim * dim, a);
+                return;
+            }
+            double n = na + nb;
+            double f = na * nb / n;
+            delta.resize(dim);
+            for (index_t i = 0; i < dim; i++) {
+                delta[i] = b[1 + i] - a[1 + i];
+                a[1 + i] += delta[i] * nb / n;
+            }
+            auto ca = a + 1 + dim;
+            auto cb = b + 1 + dim;
+            for (index_t i = 0; i < dim; i++) {
+                for (index_t j = 0; j < dim; j++) {
+                    ca[i * dim + j] += cb[i * dim + j] + delta[i] * delta[j] * f;
+                }
+            }
+            a[0] = n;
+        }
+
+        /**
+         * Dimension d of the variable summarized by a covariance state of size 1 + d + d * d.
+         */
+        inline
+        index_t covariance_state_dimension(index_t state_size) {
+            index_t dim = (index_t) std::floor(std::sqrt((double) state_size));
+            while (1 + dim + dim * dim > state_size) {
+                dim--;
+            }
+            return dim;
+        }
+
+        /**
+         * Scale function of the quantile sketch: maps a quantile in [0, 1] to [0, num_units],
+         * with a finer resolution near the extreme quantiles.
+         */
+        inline
+        double sketch_scale(double q, index_t num_units) {
+            q = (std::min)(1.0, (std::max)(0.0, q));
+            return num_units * (std::asin(2 * q - 1) / xt::numeric_constants<double>::PI + 0.5);
+        }
+
+        /**
+         * Compresses a set of centroids (mean, weight) sorted by mean into at most size centroids.
+         *
+         * Consecutive centroids are merged as long as the scaled quantile range covered by the merged centroid
+         * spans at most one unit. With size / 2 units, a unit boundary is crossed at least every two centroids,
+         * hence the result has at most size centroids.
+         */
+        inline
+        void compress_centroids(std::vector<std::pair<double, double>> &centroids, index_t size) {
+            if ((index_t) centroids.size() <= size) {
+                return;
+            }
+            double total = 0;
+            for (auto &c: centroids) {
+                total += c.second;
+            }
+            index_t num_units = size / 2;
+            index_t num_out = 0;
+            double current_mean = centroids[0].first;
+            double current_weight = centroids[0].second;
+            double q_left = 0;
+            double unit_left = std::floor(sketch_scale(q_left, num_units));
+            for (index_t i = 1; i < (index_t) centroids.size(); i++) {
+                auto &c = centroids[i];
+                double q_right = (q_left * total + current_weight + c.second) / total;
+                // the last available centroid absorbs all the remaining ones (guards against rounding errors)
+                if (sketch_scale(q_right, num_units) - unit_left <= 1 || num_out == size - 1) {
+                    current_weight += c.second;
+                    current_mean += (c.first - current_mean) * c.second / current_weight;
+                } else {
+                    centroids[num_out++] = {current_mean, current_weight};
+                    q_left += current_weight / total;
+                    unit_left = std::floor(sketch_scale(q_left, num_units));
+                    current_mean = c.first;
+                    current_weight = c.second;
+                }
+            }
+            centroids[num_out++] = {current_mean, current_weight};
+            centroids.resize(num_out);
+        }
+
+        /**
+         * Accumulator of central moments states.
+         * The storage contains a sequence of states (count, mean, M2, M3, M4).
+         */
+        template<typename S>
+        struct acc_moments_impl : public acc_state_base<S> {
+            using acc_state_base<S>::acc_state_base;
+
+            template<typename ...Args>
+            void initialize(Args &&...) {
+                std::fill(this->m_storage_begin, this->m_storage_end, 0);
+            }
+
+            template<typename T, typename ...Args>
+            void accumulate(T value_begin, Args &&...) {
+                for (auto s = this->m_storage_begin; s != this->m_storage_end; s += 5, value_begin += 5) {
+                    merge_moments(s, value_begin);
+                }
+            }
+
+            template<typename ...Args>
+            void finalize(Args &&...) const {
+            }
+        };
+
+        /**
+         * Accumulator of covariance states.
+         * The storage contains a single state (count, mean (d values), co-moment matrix (d * d values)).
+         */
+        template<typename S>
+        struct acc_covariance_impl : public acc_state_base<S> {
+            using acc_state_base<S>::acc_state_base;
+
+            template<typename ...Args>
+            void initialize(Args &&...) {
+                std::fill(this->m_storage_begin, this->m_storage_end, 0);
+                m_dim = covariance_state_dimension(this->m_storage_end - this->m_storage_begin);
+            }
+
+            template<typename T, typename ...Args>
+            void accumulate(T value_begin, Args &&...) {
+                merge_covariance(this->m_storage_begin, value_begin, m_dim, m_delta);
+            }
+
+            template<typename ...Args>
+            void finalize(Args &&...) const {
+            }
+
+        private:
+            index_t m_dim = 0;
+            std::vector<double> m_delta;
+        };
+
+        /**
+         * Accumulator of quantile sketch states.
+         * The storage contains a single state (min, max, centroid means (size values), centroid weights (size values)),
+         * unused centroids have a zero weight.
+         */
+        template<typename S>
+        struct acc_quantile_sketch_impl : public acc_state_base<S> {
+            using value_type = typename acc_state_base<S>::value_type;
+
+            acc_quantile_sketch_impl(S storage_begin, S storage_end) :
+                    acc_state_base<S>(storage_begin, storage_end) {
+            }
+
+            template<typename ...Args>
+            void initialize(Args &&...) {
+                m_size = (this->m_storage_end - this->m_storage_begin - 2) / 2;
+                m_centroids.clear();
+                m_min = (std::numeric_limits<value_type>::max)();
+                m_max = std::numeric_limits<value_type>::lowest();
+            }
+
+            template<typename T, typename ...Args>
+            void accumulate(T value_begin, Args &&...) {
+                bool empty = true;
+                for (index_t i = 0; i < m_size; i++) {
+                    if (value_begin[2 + m_size + i] > 0) {
+                        m_centroids.emplace_back(value_begin[2 + i], value_begin[2 + m_size + i]);
+                        empty = false;
+                    }
+                }
+                if (!empty) {
+                    m_min = (std::min)(m_min, (value_type) value_begin[0]);
+                    m_max = (std::max)(m_max, (value_type) value_begin[1]);
+                }
+            }
+
+            template<typename ...Args>
+            void finalize(Args &&...) {
+                std::sort(m_centroids.begin(), m_centroids.end());
+                compress_centroids(m_centroids, m_size);
+                auto s = this->m_storage_begin;
+                s[0] = m_min;
+                s[1] = m_max;
+                for (index_t i = 0; i < m_size; i++) {
+                    if (i < (index_t) m_centroids.size()) {
+                        s[2 + i] = m_centroids[i].first;
+                        s[2 + m_size + i] = m_centroids[i].second;
+                    } else {
+                        s[2 + i] = 0;
+                        s[2 + m_size + i] = 0;
+                    }
+                }
+            }
+
+        private:
+            index_t m_size = 0;
+            value_type m_min;
+            value_type m_max;
+            std::vector<std::pair<double, double>> m_centroids;
+        };
+    }
+
+    /**
+     * Accumulates central moments states (count, mean, M2, M3, M4): the last axis of the data must be of size 5.
+     *
+     * Leaf states are obtained with moments_leaf_state and statistics are extracted from the accumulated states with
+     * moments_mean, moments_variance, moments_skewness and moments_kurtosis.
+     */
+    struct accumulator_moments {
+
+        template<bool vectorial = true, typename S>
+        auto make_accumulator(S &storage) const {
+            using iterator_type = decltype(storage.begin());
+            return statistics_accumulator_detail::acc_moments_impl<iterator_type>(storage.begin(), storage.end());
+        }
+
+        template<typename shape_t>
+        static
+        auto get_output_shape(const shape_t &input_shape) {
+            hg_assert(input_shape.size() > 0 && input_shape.back() == 5,
+                      "The last axis of a moments state must be of size 5.");
+            return input_shape;
+        }
+    };
+
+    /**
+     * Accumulates covariance states (count, mean, co-moment matrix) of d dimensional variables: the data must be
+     * 1d with a size equal to 1 + d + d * d.
+     *
+     * Leaf states are obtained with covariance_leaf_state and the mean and the covariance matrix are extracted from
+     * the accumulated states with covariance_mean and covariance_matrix.
+     */
+    struct accumulator_covariance {
+
+        template<bool vectorial = true, typename S>
+        auto make_accumulator(S &storage) const {
+            using iterator_type = decltype(storage.begin());
+            return statistics_accumulator_detail::acc_covariance_impl<iterator_type>(storage.begin(), storage.end());
+        }
+
+        template<typename shape_t>
+        static
+        auto get_output_shape(const shape_t &input_shape) {
+            hg_assert(input_shape.size() == 1, "A covariance state must be 1d.");
+            auto dim = statistics_accumulator_detail::covariance_state_dimension((index_t) input_shape[0]);
+            hg_assert(1 + dim + dim * dim == (index_t) input_shape[0],
+                      "The size of a covariance state must be equal to 1 + d + d * d.");
+            return input_shape;
+        }
+    };
+
+    /**
+     * Accumulates quantile sketch states (min, max, centroid means, centroid weights) made of at most size centroids:
+     * the data must be 1d with a size equal to 2 + 2 * size.
+     *
+     * The sketch is a merging t-digest: accumulated centroids are sorted and consecutive centroids are merged with
+     * a size limit that is smaller near the extreme quantiles. Leaf states are obtained with quantile_sketch_leaf_state
+     * and quantiles are estimated from the accumulated states with quantile_sketch_quantile.
+     *
+     * Dunning, T., & Ertl, O. (2019). Computing extremely accurate quantiles using t-digests. arXiv:1902.04023.
+     */
+    struct accumulator_quantile_sketch {
+
+        template<bool vectorial = true, typename S>
+        auto make_accumulator(S &storage) const {
+            using iterator_type = decltype(storage.begin());
+            return statistics_accumulator_detail::acc_quantile_sketch_impl<iterator_type>(storage.begin(),
+                                                                                          storage.end());
+        }
+
+        template<typename shape_t>
+        static
+        auto get_output_shape(const shape_t &input_shape) {
+            hg_assert(input_shape.size() == 1 && input_shape[0] >= 6 && input_shape[0] % 2 == 0,
+                      "A quantile sketch state must be 1d with a size equal to 2 + 2 * size (size >= 2).");
+            return input_shape;
+        }
+    };
+
+    /**
+     * Central moments states of the given values: the result has the shape of the values with an additional
+     * last axis of size 5 (count, mean, M2, M3, M4).
+     *
+     * @tparam T xexpression derived type of xvalues
+     * @param xvalues input values
+     * @return an array of states
+     */
+    template<typename T>
+    auto moments_leaf_state(const xt::xexpression<T> &xvalues) {
+        auto &values = xvalues.derived_cast();
+        std::vector<size_t> shape(values.shape().begin(), values.shape().end());
+        shape.push_back(5);
+        array_nd<double> state = xt::zeros<double>(shape);
+        auto flat_values = xt::flatten(values);
+        auto s = state.data();
+        for (index_t i = 0; i < (index_t) flat_values.size(); i++, s += 5) {
+            s[0] = 1;
+            s[1] = (double) flat_values(i);
+        }
+        return state;
+    };
+
+    /**
+     * Mean of a central moments state.
+     */
+    template<typename T>
+    auto moments_mean(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        return xt::eval(xt::strided_view(state, {xt::ellipsis(), 1}));
+    };
+
+    /**
+     * Variance (biased) of a central moments state.
+     */
+    template<typename T>
+    auto moments_variance(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        return xt::eval(xt::strided_view(state, {xt::ellipsis(), 2}) / xt::strided_view(state, {xt::ellipsis(), 0}));
+    };
+
+    /**
+     * Skewness of a central moments state (0 if the variance is equal to 0).
+     */
+    template<typename T>
+    auto moments_skewness(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        auto n = xt::strided_view(state, {xt::ellipsis(), 0});
+        auto m2 = xt::strided_view(state, {xt::ellipsis(), 2});
+        auto m3 = xt::strided_view(state, {xt::ellipsis(), 3});
+        return xt::eval(xt::where(m2 > 0, xt::sqrt(n) * m3 / xt::pow(m2, 1.5), 0.0));
+    };
+
+    /**
+     * Kurtosis (non excess) of a central moments state (0 if the variance is equal to 0).
+     */
+    template<typename T>
+    auto moments_kurtosis(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        auto n = xt::strided_view(state, {xt::ellipsis(), 0});
+        auto m2 = xt::strided_view(state, {xt::ellipsis(), 2});
+        auto m4 = xt::strided_view(state, {xt::ellipsis(), 4});
+        return xt::eval(xt::where(m2 > 0, n * m4 / (m2 * m2), 0.0));
+    };
+
+    /**
+     * Covariance states of the given 2d array of values (one d dimensional variable per row): the result is
+     * a 2d array with one state (count, mean, co-moment matrix) of size 1 + d + d * d per row.
+     *
+     * @tparam T xexpression derived type of xvalues
+     * @param xvalues input values
+     * @return an array of states
+     */
+    template<typename T>
+    auto covariance_leaf_state(const xt::xexpression<T> &xvalues) {
+        auto &values = xvalues.derived_cast();
+        hg_assert(values.dimension() == 2, "Values must be a 2d array.");
+        index_t num_rows = values.shape()[0];
+        index_t dim = values.shape()[1];
+        array_2d<double> state = xt::zeros<double>({(size_t) num_rows, (size_t) (1 + dim + dim * dim)});
+        for (index_t i = 0; i < num_rows; i++) {
+            state(i, 0) = 1;
+            for (index_t j = 0; j < dim; j++) {
+                state(i, 1 + j) = (double) values(i, j);
+            }
+        }
+        return state;
+    };
+
+    /**
+     * Means of a 2d array of covariance states.
+     */
+    template<typename T>
+    auto covariance_mean(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        hg_assert(state.dimension() == 2, "States must be a 2d array.");
+        index_t dim = statistics_accumulator_detail::covariance_state_dimension(state.shape()[1]);
+        return xt::eval(xt::view(state, xt::all(), xt::range(1, 1 + dim)));
+    };
+
+    /**
+     * Covariance matrices (biased) of a 2d array of covariance states.
+     */
+    template<typename T>
+    auto covariance_matrix(const xt::xexpression<T> &xstate) {
+        auto &state = xstate.derived_cast();
+        hg_assert(state.dimension() == 2, "States must be a 2d array.");
+        index_t num_rows = state.shape()[0];
+        index_t dim = statistics_accumulator_detail::covariance_state_dimension(state.shape()[1]);
+        array_3d<double> res = array_3d<double>::from_shape({(size_t) num_rows, (size_t) dim, (size_t) dim});
+        for (index_t i = 0; i < num_rows; i++) {
+            for (index_t j = 0; j < dim; j++) {
+                for (index_t k = 0; k < dim; k++) {
+                    res(i, j, k) = state(i, 1 + dim + j * dim + k) / state(i, 0);
+                }
+            }
+        }
+        return res;
+    };
+
+    /**
+     * Quantile sketch states with at most size centroids of the given 1d array of values: the result is
+     * a 2d array with one state (min, max, centroid means, centroid weights) of size 2 + 2 * size per value.
+     *
+     * @tparam T xexpression derived type of xvalues
+     * @param xvalues input values
+     * @param size maximal number of centroids of the sketch (the larger, the more accurate)
+     * @return an array of states
+     */
+    template<typename T>
+    auto quantile_sketch_leaf_state(const xt::xexpression<T> &xvalues, index_t size = 50) {
+        auto &values = xvalues.derived_cast();
+        hg_assert_1d_array(values);
+        hg_assert(size >= 2, "The size of a quantile sketch must be greater than or equal to 2.");
+        index_t num_values = values.size();
+        array_2d<double> state = xt::zeros<double>({(size_t) num_values, (size_t) (2 + 2 * size)});
+        for (index_t i = 0; i < num_values; i++) {
+            state(i, 0) = values(i);
+            state(i, 1) = values(i);
+            state(i, 2) = values(i);
+            state(i, 2 + size) = 1;
+        }
+        return state;
+    };
+
+    /**
+     * Estimates the q-th quantile (q in [0, 1]) of each state of a 2d array of quantile sketch states.
+     *
+     * The value distribution is linearly interpolated between the centers of the centroids.
+     *
+     * @tparam T xexpression derived type of xstate
+     * @param xstate quantile sketch states
+     * @param q quantile to estimate
+     * @return a 1d array
+     */
+    template<typename T>
+    auto quantile_sketch_quantile(const xt::xexpression<T> &xstate, double q) {
+        auto &state = xstate.derived_cast();
+        hg_assert(state.dimension() == 2, "States must be a 2d array.");
+        hg_assert(q >= 0 && q <= 1, "Quantile must be in [0, 1].");
+        index_t num_rows = state.shape()[0];
+        index_t size = (state.shape()[1] - 2) / 2;
+        array_1d<double> res = array_1d<double>::from_shape({(size_t) num_rows});
+        for (index_t i = 0; i < num_rows; i++) {
+            double total = 0;
+            index_t num_centroids = 0;
+            while (num_centroids < size && state(i, 2 + size + num_centroids) > 0) {
+                total += state(i, 2 + size + num_centroids);
+                num_centroids++;
+            }
+            double target = q * total;
+            // interpolation points: (0, min), (center of each centroid, mean of each centroid), (total, max)
+            double previous_position = 0;
+            double previous_value = state(i, 0);
+            double cumulated = 0;
+            double value = state(i, 1);
+            for (index_t c = 0; c <= num_centroids; c++) {
+                double position;
+                double centroid_value;
+                if (c < num_centroids) {
+                    position = cumulated + state(i, 2 + size + c) / 2;
+                    centroid_value = state(i, 2 + c);
+                    cumulated += state(i, 2 + size + c);
+                } else {
+                    position = total;
+                    centroid_value = state(i, 1);
+                }
+                if (target <= position) {
+                    value = (position > previous_position) ?
+                            previous_value + (centroid_value - previous_value) * (target - previous_position) /
+                                             (position - previous_position) :
+                            centroid_value;
+                    break;
+                }
+                previous_position = position;
+                previous_value = centroid_value;
+            }
+            res(i) = value;
+        }
+        return res;
+    };
+
+    /**
+     * Fixed bin histograms of the given 1d array of values: the result is a 2d array with one histogram of
+     * num_bins bins per value (the bin containing the value is set to 1, the others to 0).
+     *
+     * The bins split the range [min_value, max_value] into num_bins intervals of equal length, values outside of
+     * the range are counted in the first or in the last bin. Histograms are merged with accumulator_sum.
+     *
+     * @tparam T xexpression derived type of xvalues
+     * @param xvalues input values
+     * @param num_bins number of bins
+     * @param min_value lower bound of the first bin
+     * @param max_value upper bound of the last bin
+     * @return an array of histograms
+     */
+    template<typename T>
+    auto histogram_leaf_state(const xt::xexpression<T> &xvalues, index_t num_bins, double min_value,
+                              double max_value) {
+        auto &values = xvalues.derived_cast();
+        hg_assert_1d_array(values);
+        hg_assert(num_bins > 0, "The number of bins must be positive.");
+        hg_assert(max_value > min_value, "The maximal value must be greater than the minimal value.");
+        index_t num_values = values.size();
+        array_2d<index_t> state = xt::zeros<index_t>({(size_t) num_values, (size_t) num_bins});
+        double scale = num_bins / (max_value - min_value);
+        for (index_t i = 0; i < num_values; i++) {
+            auto bin = (index_t) std::floor(((double) values(i) - min_value) * scale);
+            state(i, (std::min)(num_bins - 1, (std::max)((index_t) 0, bin))) = 1;
+        }
+        return state;
+    };
+}
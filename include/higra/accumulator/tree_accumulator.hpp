@@ -18,6 +18,188 @@ namespace hg {
 
     namespace tree_accumulator_detail {
 
+        /**
+         * Maximal number of nodes of a level processed by a single task.
+         */
+        const index_t level_block_size = 1024;
+
+        /**
+         * Nodes of a tree grouped by levels: the nodes of the k-th level are
+         * nodes[offsets[k]], ..., nodes[offsets[k + 1] - 1], in increasing order.
+         */
+        struct tree_levels {
+            std::vector<index_t> nodes;
+            std::vector<index_t> offsets;
+        };
+
+        /**
+         * Contiguous sequence of node indices.
+         */
+        struct node_span {
+            const index_t *m_begin;
+            const index_t *m_end;
+
+            const index_t *begin() const {
+                return m_begin;
+            }
+
+            const index_t *end() const {
+                return m_end;
+            }
+        };
+
+        /**
+         * Groups the given nodes by level with a counting sort.
+         */
+        template<typename nodes_t>
+        tree_levels group_by_level(const nodes_t &nodes, const array_1d<index_t> &level, index_t num_levels) {
+            tree_levels res;
+            res.offsets.resize(num_levels + 1, 0);
+            for (auto i: nodes) {
+                res.offsets[level(i) + 1]++;
+            }
+            for (index_t k = 0; k < num_levels; k++) {
+                res.offsets[k + 1] += res.offsets[k];
+            }
+            res.nodes.resize(res.offsets[num_levels]);
+            std::vector<index_t> position(res.offsets.begin(), res.offsets.end() - 1);
+            for (auto i: nodes) {
+                res.nodes[position[level(i)]++] = i;
+            }
+            return res;
+        }
+
+        /**
+         * Internal nodes of the tree grouped by height (number of edges on the longest path to a leaf):
+         * the children of a node belong to lower levels.
+         */
+        template<typename tree_t>
+        tree_levels internal_nodes_by_height(const tree_t &tree) {
+            auto &parent = parents(tree);
+            array_1d<index_t> height = xt::zeros<index_t>({num_vertices(tree)});
+            for (auto i: leaves_to_root_iterator(tree, leaves_it::include, root_it::exclude)) {
+                auto p = parent(i);
+                height(p) = (std::max)(height(p), height(i) + 1);
+            }
+            return group_by_level(leaves_to_root_iterator(tree, leaves_it::exclude), height, height(root(tree)) + 1);
+        }
+
+        /**
+         * Non root nodes of the tree grouped by depth (number of edges on the path to the root):
+         * the parent of a node belongs to the previous level.
+         */
+        template<typename tree_t>
+        tree_levels non_root_nodes_by_depth(const tree_t &tree) {
+            auto &parent = parents(tree);
+            array_1d<index_t> depth = array_1d<index_t>::from_shape({num_vertices(tree)});
+            depth(root(tree)) = 0;
+            index_t max_depth = 0;
+            for (auto i: root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude)) {
+                depth(i) = depth(parent(i)) + 1;
+                max_depth = (std::max)(max_depth, depth(i));
+            }
+            return group_by_level(root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude), depth,
+                                  max_depth + 1);
+        }
+
+        /**
+         * Calls fun on blocks of nodes of each level: levels are processed one after the other
+         * and the blocks of a level are processed in parallel.
+         */
+        template<typename lambda_t>
+        void for_each_level_block(const tree_levels &levels, const lambda_t &fun) {
+            for (index_t k = 0; k + 1 < (index_t) levels.offsets.size(); k++) {
+                const index_t *first = levels.nodes.data() + levels.offsets[k];
+                const index_t size = levels.offsets[k + 1] - levels.offsets[k];
+                parfor_blocks(size, level_block_size, true, [&fun, first](index_t block_first, index_t block_last) {
+                    fun(node_span{first + block_first, first + block_last});
+                });
+            }
+        }
+
+        /**
+         * Calls fun on a range containing all the leaves of the tree (or on blocks of leaves processed in parallel).
+         */
+        template<typename tree_t, typename lambda_t>
+        void for_each_leaf_block(const tree_t &tree, bool parallel, const lambda_t &fun) {
+            if (parallel) {
+                parfor_blocks(num_leaves(tree), level_block_size, true, [&fun](index_t first, index_t last) {
+                    fun(irange<index_t>(first, last));
+                });
+            } else {
+                fun(leaves_iterator(tree));
+            }
+        }
+
+        /**
+         * Calls fun on ranges of internal nodes such that the children of a node are processed before the node:
+         * either a single range with all the internal nodes in leaves to root order, or blocks of nodes of same
+         * height processed in parallel.
+         */
+        template<typename tree_t, typename lambda_t>
+        void for_each_internal_node_block_bottom_up(const tree_t &tree, bool parallel, const lambda_t &fun) {
+            if (parallel) {
+                for_each_level_block(internal_nodes_by_height(tree), fun);
+            } else {
+                fun(leaves_to_root_iterator(tree, leaves_it::exclude));
+            }
+        }
+
+        /**
+         * Calls fun on ranges of non root nodes such that the parent of a node is processed before the node:
+         * either a single range with all the non root nodes in root to leaves order, or blocks of nodes of same
+         * depth processed in parallel.
+         */
+        template<typename tree_t, typename lambda_t>
+        void for_each_non_root_node_block_top_down(const tree_t &tree, bool parallel, const lambda_t &fun) {
+            if (parallel) {
+                for_each_level_block(non_root_nodes_by_depth(tree), fun);
+            } else {
+                fun(root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude));
+            }
+        }
+
+
+        /**
+         * True if the accumulator acc_t can reduce several rows (given by iterators of type row_t) in a single pass.
+         */
+        template<typename acc_t, typename row_t, typename = void>
+        struct has_accumulate_rows : std::false_type {
+        };
+
+        template<typename acc_t, typename row_t>
+        struct has_accumulate_rows<acc_t, row_t, decltype(std::declval<acc_t &>().accumulate_rows(
+                std::declval<const row_t *>(), index_t()), void())> : std::true_type {
+        };
+
+        /**
+         * Accumulates the values of the children of the node i (read through view) in acc.
+         * If the accumulator supports it, the rows of all the children are reduced in a single pass
+         * (rows is a buffer for the row iterators of the children).
+         */
+        template<typename tree_t, typename acc_t, typename view_t, typename rows_t>
+        void accumulate_children(const tree_t &tree, index_t i, acc_t &acc, view_t &view, rows_t &rows,
+                                 std::true_type) {
+            rows.clear();
+            for (auto c : children_iterator(i, tree)) {
+                view.set_position(c);
+                rows.push_back(view.begin());
+            }
+            acc.accumulate_rows(rows.data(), (index_t) rows.size());
+        }
+
+        template<typename tree_t, typename acc_t, typename view_t, typename rows_t>
+        void accumulate_children(const tree_t &tree, index_t i, acc_t &acc, view_t &view, rows_t &,
+                                 std::false_type) {
+            for (auto c : children_iterator(i, tree)) {
+                view.set_position(c);
+                acc.accumulate(view.begin());
+            }
+        }
+
+        template<bool vectorial, typename acc_t, typename view_t>
+        using children_rows_tag = std::integral_constant<bool, vectorial && has_accumulate_rows<
+                acc_t, decltype(std::declval<view_t &>().begin())>::value>;
 
         template<bool vectorial,
                 typename tree_t,
@@ -40,6 +222,8 @@ namespace hg {
             auto input_view = make_light_axis_view<vectorial>(input);
             auto output_view = make_light_axis_view<vectorial>(output);
             auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+            std::vector<decltype(input_view.begin())> rows;
+            children_rows_tag<vectorial, decltype(acc), decltype(input_view)> rows_tag;
 
             for (auto i: leaves_iterator(tree)) {
                 output_view.set_position(i);
@@ -52,10 +236,7 @@ namespace hg {
                 output_view.set_position(i);
                 acc.set_storage(output_view);
                 acc.initialize();
-                for (auto c : children_iterator(i, tree)) {
-                    input_view.set_position(c);
-                    acc.accumulate(input_view.begin());
-                }
+                accumulate_children(tree, i, acc, input_view, rows, rows_tag);
                 acc.finalize();
             }
 
@@ -69,7 +250,8 @@ namespace hg {
                 typename output_t = typename T::value_type>
         auto accumulate_sequential_impl(const tree_t &tree,
                                         const xt::xexpression<T> &xvertex_data,
-                                        const accumulator_t &accumulator) {
+                                        const accumulator_t &accumulator,
+                                        bool parallel = false) {
             HG_TRACE();
             auto &vertex_data = xvertex_data.derived_cast();
             hg_assert_leaf_weights(tree, vertex_data);
@@ -80,27 +262,30 @@ namespace hg {
 
             array_nd <output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto vertex_data_view = make_light_axis_view<vectorial>(vertex_data);
-            auto input_view = make_light_axis_view<vectorial>(output);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-
-            for (auto i: leaves_iterator(tree)) {
-                output_view.set_position(i);
-                vertex_data_view.set_position(i);
-                output_view = vertex_data_view;
-            }
-
-            for (auto i : leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-                for (auto c : children_iterator(i, tree)) {
-                    input_view.set_position(c);
-                    acc.accumulate(input_view.begin());
+            for_each_leaf_block(tree, parallel, [&vertex_data, &output](const auto &leaves) {
+                auto vertex_data_view = make_light_axis_view<vectorial>(vertex_data);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                for (auto i: leaves) {
+                    output_view.set_position(i);
+                    vertex_data_view.set_position(i);
+                    output_view = vertex_data_view;
                 }
-                acc.finalize();
-            }
+            });
+
+            for_each_internal_node_block_bottom_up(tree, parallel, [&tree, &output, &accumulator](const auto &nodes) {
+                auto input_view = make_light_axis_view<vectorial>(output);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+                std::vector<decltype(input_view.begin())> rows;
+                children_rows_tag<vectorial, decltype(acc), decltype(input_view)> rows_tag;
+                for (auto i : nodes) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    accumulate_children(tree, i, acc, input_view, rows, rows_tag);
+                    acc.finalize();
+                }
+            });
             return output;
         };
 
@@ -114,8 +299,9 @@ namespace hg {
         auto accumulate_and_combine_sequential_impl(const tree_t &tree,
                                                     const xt::xexpression<T1> &xinput,
                                                     const xt::xexpression<T2> &xvertex_data,
-                                                    accumulator_t &accumulator,
-                                                    combination_fun_t combine) {
+                                                    const accumulator_t &accumulator,
+                                                    combination_fun_t combine,
+                                                    bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             hg_assert_node_weights(tree, input);
@@ -137,32 +323,33 @@ namespace hg {
 
             array_nd <output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto inout_view = make_light_axis_view<vectorial>(output);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-
-            auto vertex_data_view = make_light_axis_view<vectorial>(vertex_data);
-
-            for (auto i: leaves_iterator(tree)) {
-                output_view.set_position(i);
-                vertex_data_view.set_position(i);
-                output_view = vertex_data_view;
-            }
-
-            for (auto i : leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-                for (auto c : children_iterator(i, tree)) {
-
-                    inout_view.set_position(c);
-                    acc.accumulate(inout_view.begin());
+            for_each_leaf_block(tree, parallel, [&vertex_data, &output](const auto &leaves) {
+                auto vertex_data_view = make_light_axis_view<vectorial>(vertex_data);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                for (auto i: leaves) {
+                    output_view.set_position(i);
+                    vertex_data_view.set_position(i);
+                    output_view = vertex_data_view;
                 }
-                acc.finalize();
-                input_view.set_position(i);
-                output_view.combine(input_view, combine);
-            }
+            });
+
+            for_each_internal_node_block_bottom_up(tree, parallel, [&](const auto &nodes) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto inout_view = make_light_axis_view<vectorial>(output);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+                std::vector<decltype(inout_view.begin())> rows;
+                children_rows_tag<vectorial, decltype(acc), decltype(inout_view)> rows_tag;
+                for (auto i : nodes) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    accumulate_children(tree, i, acc, inout_view, rows, rows_tag);
+                    acc.finalize();
+                    input_view.set_position(i);
+                    output_view.combine(input_view, combine);
+                }
+            });
 
             return output;
         };
@@ -232,7 +419,8 @@ namespace hg {
                 typename output_t = typename T1::value_type>
         auto propagate_sequential_impl(const tree_t &tree,
                                        const xt::xexpression<T1> &xinput,
-                                       const xt::xexpression<T2> &xcondition) {
+                                       const xt::xexpression<T2> &xcondition,
+                                       bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             auto &condition = xcondition.derived_cast();
@@ -241,28 +429,29 @@ namespace hg {
 
             array_nd <output_t> output = array_nd<output_t>::from_shape(input.shape());
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto inout_view = make_light_axis_view<vectorial>(output);
-
             auto aparents = parents(tree).storage_begin();
 
             // root cannot be deleted
-            output_view.set_position(root(tree));
-            input_view.set_position(root(tree));
-            output_view = input_view;
+            auto root_input_view = make_light_axis_view<vectorial>(input, root(tree));
+            auto root_output_view = make_light_axis_view<vectorial>(output, root(tree));
+            root_output_view = root_input_view;
+
+            for_each_non_root_node_block_top_down(tree, parallel, [&](const auto &nodes) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto inout_view = make_light_axis_view<vectorial>(output);
+                for (auto i: nodes) {
+                    output_view.set_position(i);
+                    if (condition(i)) {
+                        inout_view.set_position(aparents[i]);
+                        output_view = inout_view;
+                    } else {
+                        input_view.set_position(i);
+                        output_view = input_view;
+                    }
 
-            for (auto i: root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude)) {
-                output_view.set_position(i);
-                if (condition(i)) {
-                    inout_view.set_position(aparents[i]);
-                    output_view = inout_view;
-                } else {
-                    input_view.set_position(i);
-                    output_view = input_view;
                 }
-
-            }
+            });
             return output;
         };
 
@@ -273,7 +462,8 @@ namespace hg {
                 typename output_t = typename T::value_type>
         auto propagate_sequential_and_accumulate_impl(const tree_t &tree,
                                                       const xt::xexpression<T> &xinput,
-                                                      accumulator_t &accumulator) {
+                                                      const accumulator_t &accumulator,
+                                                      bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             hg_assert_node_weights(tree, input);
@@ -288,33 +478,36 @@ namespace hg {
             output_shape.insert(output_shape.begin(), num_vertices(tree));
             array_nd <output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto parent_view = make_light_axis_view<vectorial>(output);
-
             auto aparents = parents(tree).storage_begin();
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-            // root cannot be deleted
-            output_view.set_position(root(tree));
-            input_view.set_position(root(tree));
-            acc.set_storage(output_view);
-            acc.initialize();
-            acc.accumulate(input_view.begin());
-            acc.finalize();
 
-            for (auto i: root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude)) {
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-
-                parent_view.set_position(aparents[i]);
-                acc.accumulate(parent_view.begin());
+            // root cannot be deleted
+            auto root_input_view = make_light_axis_view<vectorial>(input, root(tree));
+            auto root_output_view = make_light_axis_view<vectorial>(output, root(tree));
+            auto root_acc = accumulator.template make_accumulator<vectorial>(root_output_view);
+            root_acc.set_storage(root_output_view);
+            root_acc.initialize();
+            root_acc.accumulate(root_input_view.begin());
+            root_acc.finalize();
+
+            for_each_non_root_node_block_top_down(tree, parallel, [&](const auto &nodes) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto parent_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+                for (auto i: nodes) {
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+
+                    parent_view.set_position(aparents[i]);
+                    acc.accumulate(parent_view.begin());
 
-                input_view.set_position(i);
-                acc.accumulate(input_view.begin());
+                    input_view.set_position(i);
+                    acc.accumulate(input_view.begin());
 
-                acc.finalize();
-            }
+                    acc.finalize();
+                }
+            });
 
             return output;
         };
@@ -327,9 +520,11 @@ namespace hg {
                              const accumulator_t &accumulator) {
         auto &input = xinput.derived_cast();
         if (input.dimension() == 1) {
-            return tree_accumulator_detail::accumulate_parallel_impl<false>(tree, xinput, accumulator);
+            return tree_accumulator_detail::accumulate_parallel_impl<false, tree_t, T, accumulator_t, output_t>(
+                    tree, xinput, accumulator);
         } else {
-            return tree_accumulator_detail::accumulate_parallel_impl<true>(tree, xinput, accumulator);
+            return tree_accumulator_detail::accumulate_parallel_impl<true, tree_t, T, accumulator_t, output_t>(
+                    tree, xinput, accumulator);
         }
     };
 
@@ -339,11 +534,14 @@ namespace hg {
                                const xt::xexpression<T> &xvertex_data,
                                const accumulator_t &accumulator) {
         auto &vertex_data = xvertex_data.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(tree));
 
         if (vertex_data.dimension() == 1) {
-            return tree_accumulator_detail::accumulate_sequential_impl<false>(tree, xvertex_data, accumulator);
+            return tree_accumulator_detail::accumulate_sequential_impl<false, tree_t, T, accumulator_t, output_t>(
+                    tree, xvertex_data, accumulator, parallel);
         } else {
-            return tree_accumulator_detail::accumulate_sequential_impl<true>(tree, xvertex_data, accumulator);
+            return tree_accumulator_detail::accumulate_sequential_impl<true, tree_t, T, accumulator_t, output_t>(
+                    tree, xvertex_data, accumulator, parallel);
         }
     };
 
@@ -354,13 +552,16 @@ namespace hg {
                                            const accumulator_t &accumulator,
                                            const combination_fun_t &combine) {
         auto &input = xinput.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(tree));
 
         if (input.dimension() == 1) {
-            return tree_accumulator_detail::accumulate_and_combine_sequential_impl<false>(tree, xinput, xvertex_data,
-                                                                                          accumulator, combine);
+            return tree_accumulator_detail::accumulate_and_combine_sequential_impl<
+                    false, tree_t, T1, T2, accumulator_t, combination_fun_t, output_t>(
+                    tree, xinput, xvertex_data, accumulator, combine, parallel);
         } else {
-            return tree_accumulator_detail::accumulate_and_combine_sequential_impl<true>(tree, xinput, xvertex_data,
-                                                                                         accumulator, combine);
+            return tree_accumulator_detail::accumulate_and_combine_sequential_impl<
+                    true, tree_t, T1, T2, accumulator_t, combination_fun_t, output_t>(
+                    tree, xinput, xvertex_data, accumulator, combine, parallel);
         }
     };
 
@@ -394,24 +595,28 @@ namespace hg {
                               const xt::xexpression<T1> &xinput,
                               const xt::xexpression<T2> &xcondition) {
         auto &input = xinput.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(tree));
 
         if (input.dimension() == 1) {
-            return tree_accumulator_detail::propagate_sequential_impl<false>(tree, xinput, xcondition);
+            return tree_accumulator_detail::propagate_sequential_impl<false>(tree, xinput, xcondition, parallel);
         } else {
-            return tree_accumulator_detail::propagate_sequential_impl<true>(tree, xinput, xcondition);
+            return tree_accumulator_detail::propagate_sequential_impl<true>(tree, xinput, xcondition, parallel);
         }
     };
 
-    template<typename tree_t, typename T, typename accumulator_t>
+    template<typename tree_t, typename T, typename accumulator_t, typename output_t = typename T::value_type>
     auto propagate_sequential_and_accumulate(const tree_t &tree,
                               const xt::xexpression<T> &xinput,
                               const accumulator_t &accumulator) {
         auto &input = xinput.derived_cast();
+        bool parallel = use_parallel((index_t) num_vertices(tree));
 
         if (input.dimension() == 1) {
-            return tree_accumulator_detail::propagate_sequential_and_accumulate_impl<false>(tree, xinput, accumulator);
+            return tree_accumulator_detail::propagate_sequential_and_accumulate_impl<
+                    false, tree_t, T, accumulator_t, output_t>(tree, xinput, accumulator, parallel);
         } else {
-            return tree_accumulator_detail::propagate_sequential_and_accumulate_impl<true>(tree, xinput, accumulator);
+            return tree_accumulator_detail::propagate_sequential_and_accumulate_impl<
+                    true, tree_t, T, accumulator_t, output_t>(tree, xinput, accumulator, parallel);
         }
     };
 
@@ -13,11 +13,150 @@
 #include "../graph.hpp"
 #include "accumulator.hpp"
 #include "../structure/details/light_axis_view.hpp"
+#include "../structure/lca_fast.hpp"
+#include <atomic>
 
 namespace hg {
 
     namespace tree_contour_accumulator_detail {
 
+        /**
+         * Number of edges (or of tree nodes when building the binary lifting tables) processed by a single task.
+         */
+        const index_t edge_block_size = 4096;
+
+        /**
+         * Maximal number of steps of the walk from the extremities of an edge to their lowest common ancestor before
+         * falling back to the lowest common ancestor preprocessing.
+         */
+        const index_t lca_walk_max_steps = 32;
+
+        /**
+         * Maximal number of levels of the binary lifting tables (the first level is not stored): paths longer than
+         * 2^(lifting_max_levels - 1) nodes are covered by repeated jumps of the highest level.
+         */
+        const index_t lifting_max_levels = 8;
+
+        /**
+         * Calls fun(first, last) on consecutive ranges of edge indices covering all the edges of the graph,
+         * the ranges are processed in parallel if parallel is true.
+         */
+        template<typename graph_t, typename fun_t>
+        void for_each_edge_block(const graph_t &graph, bool parallel, const fun_t &fun) {
+            parfor_blocks(num_edges(graph), edge_block_size, parallel, fun);
+        }
+
+        /**
+         * Accumulators whose result on a path of the tree can be computed from accumulations along the paths from
+         * the root: accumulating a value x on the path from n1 to its ancestor n2 (n2 excluded) is equal to
+         * prefix(n1) - prefix(n2) where prefix(n) is the sum of the values on the path from the root to n.
+         */
+        inline
+        bool prefix_accumulator(const accumulator_sum &, accumulators &kind) {
+            kind = accumulators::sum;
+            return true;
+        }
+
+        inline
+        bool prefix_accumulator(const accumulator_mean &, accumulators &kind) {
+            kind = accumulators::mean;
+            return true;
+        }
+
+        inline
+        bool prefix_accumulator(const accumulator_counter &, accumulators &kind) {
+            kind = accumulators::counter;
+            return true;
+        }
+
+        template<typename accumulator_t>
+        bool prefix_accumulator(const accumulator_t &, accumulators &) {
+            return false;
+        }
+
+        /**
+         * Idempotent accumulators whose result on a path of the tree can be computed by combining the results on
+         * overlapping or adjacent sub-paths (binary lifting).
+         */
+        inline
+        bool lifting_accumulator(const accumulator_min &) {
+            return true;
+        }
+
+        inline
+        bool lifting_accumulator(const accumulator_max &) {
+            return true;
+        }
+
+        template<typename accumulator_t>
+        bool lifting_accumulator(const accumulator_t &) {
+            return false;
+        }
+
+        /**
+         * Type of the prefix sums of integral values: differences of 64 bits integer prefix sums are exact. Floating
+         * point sums are not computed with prefix sums as their differences suffer from cancellation when the values
+         * on the root paths are large compared to the values on the contours.
+         */
+        template<typename T>
+        using prefix_value_t = std::conditional_t<std::is_floating_point<T>::value, T,
+                std::conditional_t<std::is_signed<T>::value, int64_t, uint64_t>>;
+
+        /**
+         * Lowest common ancestor of the extremities of each edge of the graph: found by walking up the tree from both
+         * extremities when they are close, otherwise computed with the lowest common ancestor preprocessing (only
+         * built if needed).
+         */
+        template<typename graph_t, typename tree_t, typename T>
+        array_1d<index_t> contour_lowest_common_ancestors(const graph_t &graph,
+                                                          const tree_t &tree,
+                                                          const T &depth,
+                                                          bool parallel) {
+            array_1d<index_t> lcas = array_1d<index_t>::from_shape({num_edges(graph)});
+            std::atomic<bool> missing_lca(false);
+            for_each_edge_block(graph, parallel, [&](index_t first, index_t last) {
+                bool missing = false;
+                for (index_t i = first; i < last; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    index_t n1 = source(e, graph);
+                    index_t n2 = target(e, graph);
+                    index_t steps = 0;
+                    while (n1 != n2 && steps < lca_walk_max_steps) {
+                        auto dn1 = depth(n1);
+                        auto dn2 = depth(n2);
+                        if (dn1 >= dn2) {
+                            n1 = parent(n1, tree);
+                        }
+                        if (dn2 >= dn1) {
+                            n2 = parent(n2, tree);
+                        }
+                        steps++;
+                    }
+                    lcas(i) = (n1 == n2) ? n1 : invalid_index;
+                    missing = missing || n1 != n2;
+                }
+                if (missing) {
+                    missing_lca = true;
+                }
+            });
+            if (missing_lca) {
+                lca_internal::lca_fast<tree_t> lca(tree);
+                for_each_edge_block(graph, parallel, [&](index_t first, index_t last) {
+                    for (index_t i = first; i < last; i++) {
+                        if (lcas(i) == invalid_index) {
+                            const auto &e = edge_from_index(i, graph);
+                            lcas(i) = lca.lca(source(e, graph), target(e, graph));
+                        }
+                    }
+                });
+            }
+            return lcas;
+        }
+
+        /**
+         * Accumulation on contours with the nodes of the path between the extremities of each edge walked
+         * one parent at a time: any accumulator can be used and the complexity is O(E * depth(tree)).
+         */
         template<bool vectorial,
                 typename graph_t,
                 typename tree_t,
@@ -29,7 +168,8 @@ namespace hg {
                                          const tree_t &tree,
                                          const xt::xexpression<T> &xinput,
                                          const xt::xexpression<T2> &xdetph,
-                                         const accumulator_t accumulator) {
+                                         const accumulator_t accumulator,
+                                         bool parallel = false) {
             HG_TRACE();
             auto &input = xinput.derived_cast();
             hg_assert_node_weights(tree, input);
@@ -44,65 +184,348 @@ namespace hg {
 
             array_nd<output_t> output = array_nd<output_t>::from_shape(output_shape);
 
-            auto input_view = make_light_axis_view<vectorial>(input);
-            auto output_view = make_light_axis_view<vectorial>(output);
-            auto acc = accumulator.template make_accumulator<vectorial>(output_view);
-
-            for (auto e: edge_iterator(graph)) {
-                auto n1 = source(e, graph);
-                auto n2 = target(e, graph);
-                auto i = index(e, graph);
-
-                output_view.set_position(i);
-                acc.set_storage(output_view);
-                acc.initialize();
-
-                while (n1 != n2) {
-                    auto dn1 = depth(n1);
-                    auto dn2 = depth(n2);
-                    auto new_n1 = n1;
-                    auto new_n2 = n2;
-                    if (dn1 >= dn2) {
-                        input_view.set_position(n1);
-                        acc.accumulate(input_view.begin());
-                        new_n1 = parent(n1, tree);
+            for_each_edge_block(graph, parallel, [&](index_t first, index_t last) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+
+                for (index_t i = first; i < last; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    auto n1 = source(e, graph);
+                    auto n2 = target(e, graph);
+
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+
+                    while (n1 != n2) {
+                        auto dn1 = depth(n1);
+                        auto dn2 = depth(n2);
+                        auto new_n1 = n1;
+                        auto new_n2 = n2;
+                        if (dn1 >= dn2) {
+                            input_view.set_position(n1);
+                            acc.accumulate(input_view.begin());
+                            new_n1 = parent(n1, tree);
+                        }
+                        if (dn2 >= dn1) {
+                            input_view.set_position(n2);
+                            acc.accumulate(input_view.begin());
+                            new_n2 = parent(n2, tree);
+                        }
+                        n1 = new_n1;
+                        n2 = new_n2;
                     }
-                    if (dn2 >= dn1) {
-                        input_view.set_position(n2);
-                        acc.accumulate(input_view.begin());
-                        new_n2 = parent(n2, tree);
+                    acc.finalize();
+                }
+            });
+
+            return output;
+        };
+
+        /**
+         * Accumulation on contours for the sum, mean and counter accumulators: with l = lca(n1, n2), the sum of the
+         * values on the contour of the edge (n1, n2) is equal to prefix(n1) + prefix(n2) - 2 * prefix(l), and the
+         * number of nodes on the contour is equal to depth(n1) + depth(n2) - 2 * depth(l).
+         *
+         * Prefix sums are computed on 64 bits integers, this implementation is only used for integral values and for
+         * the counter accumulator. Lowest common ancestors are found with a bounded walk from the edge extremities
+         * (most contours of a leaf graph are short), or with the lowest common ancestor preprocessing for the
+         * remaining edges: the complexity is O(N + E) if all contours are short and O(N log(N) + E) in the worst
+         * case.
+         */
+        template<bool vectorial,
+                typename graph_t,
+                typename tree_t,
+                typename T,
+                typename T2,
+                typename accumulator_t,
+                typename output_t = typename T::value_type>
+        auto accumulate_on_contours_prefix_impl(const graph_t &graph,
+                                                const tree_t &tree,
+                                                const xt::xexpression<T> &xinput,
+                                                const xt::xexpression<T2> &xdetph,
+                                                const accumulator_t,
+                                                accumulators kind,
+                                                bool parallel = false) {
+            HG_TRACE();
+            auto &input = xinput.derived_cast();
+            hg_assert_node_weights(tree, input);
+            auto &depth = xdetph.derived_cast();
+            hg_assert_node_weights(tree, depth);
+            hg_assert_1d_array(depth);
+            hg_assert_integral_value_type(depth);
+            using prefix_t = prefix_value_t<typename T::value_type>;
+
+            auto data_shape = std::vector<size_t>(input.shape().begin() + 1, input.shape().end());
+            auto output_shape = accumulator_t::get_output_shape(data_shape);
+            output_shape.insert(output_shape.begin(), num_edges(graph));
+
+            array_nd<output_t> output = array_nd<output_t>::from_shape(output_shape);
+            const index_t row_size = (kind == accumulators::counter) ? 0 : (index_t) (input.size() /
+                                                                                      input.shape()[0]);
+
+            std::vector<prefix_t> prefix(num_vertices(tree) * row_size);
+            if (row_size > 0) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto r = root(tree);
+                input_view.set_position(r);
+                std::copy(input_view.begin(), input_view.end(), prefix.begin() + r * row_size);
+                for (auto n: root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude)) {
+                    input_view.set_position(n);
+                    auto value = input_view.begin();
+                    auto p = prefix.begin() + n * row_size;
+                    auto pp = prefix.begin() + parent(n, tree) * row_size;
+                    for (index_t k = 0; k < row_size; k++) {
+                        p[k] = pp[k] + (prefix_t) value[k];
                     }
-                    n1 = new_n1;
-                    n2 = new_n2;
                 }
-                acc.finalize();
             }
 
+            auto lcas = contour_lowest_common_ancestors(graph, tree, depth, parallel);
+
+            for_each_edge_block(graph, parallel, [&](index_t first, index_t last) {
+                for (index_t i = first; i < last; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    auto n1 = source(e, graph);
+                    auto n2 = target(e, graph);
+                    auto l = lcas(i);
+                    auto count = (index_t) depth(n1) + (index_t) depth(n2) - 2 * (index_t) depth(l);
+                    if (kind == accumulators::counter) {
+                        output.data()[i] = (output_t) count;
+                        continue;
+                    }
+                    auto out = output.data() + i * row_size;
+                    auto p1 = prefix.begin() + n1 * row_size;
+                    auto p2 = prefix.begin() + n2 * row_size;
+                    auto pl = prefix.begin() + l * row_size;
+                    for (index_t k = 0; k < row_size; k++) {
+                        out[k] = (output_t) (p1[k] + p2[k] - 2 * pl[k]);
+                        if (kind == accumulators::mean && count != 0) {
+                            out[k] /= (output_t) count;
+                        }
+                    }
+                }
+            });
+
+            return output;
+        };
+
+        /**
+         * Accumulation on contours for the min and max accumulators, and for the sum accumulator on floating point
+         * values, with binary lifting: for each node n and each k > 0, the table of level k stores the 2^k-th
+         * ancestor of n and the accumulation of the values of the 2^k nodes starting at n on the path to the root
+         * (level 0 is given by the input values and the parents). With l = lca(n1, n2), the path from n1 to l
+         * (l excluded) is then covered by the disjoint sub-paths given by the binary decomposition of
+         * depth(n1) - depth(l). If mean is true, the results are divided by the lengths of the contours.
+         *
+         * Levels are only built up to the length L of the longest path between an edge extremity and the lowest
+         * common ancestor, and at most lifting_max_levels levels are used: longer paths are covered by repeated
+         * jumps of the highest level. The tables use O(N min(log(L), K)) values with K = lifting_max_levels and
+         * the complexity is O(N min(log(L), K) + E (min(log(L), K) + L / 2^(K - 1))).
+         */
+        template<bool vectorial,
+                typename graph_t,
+                typename tree_t,
+                typename T,
+                typename T2,
+                typename accumulator_t,
+                typename output_t = typename T::value_type>
+        auto accumulate_on_contours_lifting_impl(const graph_t &graph,
+                                                 const tree_t &tree,
+                                                 const xt::xexpression<T> &xinput,
+                                                 const xt::xexpression<T2> &xdetph,
+                                                 const accumulator_t accumulator,
+                                                 bool parallel = false,
+                                                 bool mean = false) {
+            HG_TRACE();
+            auto &input = xinput.derived_cast();
+            hg_assert_node_weights(tree, input);
+            auto &depth = xdetph.derived_cast();
+            hg_assert_node_weights(tree, depth);
+            hg_assert_1d_array(depth);
+            hg_assert_integral_value_type(depth);
+            using value_type = typename T::value_type;
+            const index_t num_v = num_vertices(tree);
+
+            auto data_shape = std::vector<size_t>(input.shape().begin() + 1, input.shape().end());
+            auto output_shape = accumulator_t::get_output_shape(data_shape);
+            output_shape.insert(output_shape.begin(), num_edges(graph));
+
+            array_nd<output_t> output = array_nd<output_t>::from_shape(output_shape);
+
+            auto lcas = contour_lowest_common_ancestors(graph, tree, depth, parallel);
+
+            index_t max_length = 0;
+            for (index_t i = 0; i < (index_t) num_edges(graph); i++) {
+                const auto &e = edge_from_index(i, graph);
+                auto dl = (index_t) depth(lcas(i));
+                max_length = (std::max)(max_length, (index_t) depth(source(e, graph)) - dl);
+                max_length = (std::max)(max_length, (index_t) depth(target(e, graph)) - dl);
+            }
+            index_t top = 0;
+            while (top + 1 < lifting_max_levels && ((index_t) 1 << (top + 1)) <= max_length) {
+                top++;
+            }
+
+            // level k > 0 of the tables is stored in rows (k - 1) * num_v, ..., k * num_v - 1
+            std::vector<index_t> ancestor(top * num_v);
+            std::vector<size_t> lifting_shape(input.shape().begin(), input.shape().end());
+            lifting_shape[0] = top * num_v;
+            array_nd<value_type> lifting = array_nd<value_type>::from_shape(lifting_shape);
+
+            for (index_t k = 1; k <= top; k++) {
+                parfor_blocks(num_v, edge_block_size, parallel, [&](index_t first, index_t last) {
+                    auto input_view = make_light_axis_view<vectorial>(input);
+                    auto lifting_view = make_light_axis_view<vectorial>(lifting);
+                    auto lifting_input_view = make_light_axis_view<vectorial>(lifting);
+                    auto acc = accumulator.template make_accumulator<vectorial>(lifting_view);
+                    const index_t row = (k - 1) * num_v;
+                    const index_t previous = row - num_v;
+                    for (index_t n = first; n < last; n++) {
+                        lifting_view.set_position(row + n);
+                        acc.set_storage(lifting_view);
+                        acc.initialize();
+                        if (k == 1) {
+                            index_t middle = parent(n, tree);
+                            ancestor[n] = parent(middle, tree);
+                            input_view.set_position(n);
+                            acc.accumulate(input_view.begin());
+                            input_view.set_position(middle);
+                            acc.accumulate(input_view.begin());
+                        } else {
+                            index_t middle = ancestor[previous + n];
+                            ancestor[row + n] = ancestor[previous + middle];
+                            lifting_input_view.set_position(previous + n);
+                            acc.accumulate(lifting_input_view.begin());
+                            lifting_input_view.set_position(previous + middle);
+                            acc.accumulate(lifting_input_view.begin());
+                        }
+                        acc.finalize();
+                    }
+                });
+            }
+
+            const index_t top_length = (index_t) 1 << top;
+            for_each_edge_block(graph, parallel, [&](index_t first, index_t last) {
+                auto input_view = make_light_axis_view<vectorial>(input);
+                auto lifting_view = make_light_axis_view<vectorial>(lifting);
+                auto output_view = make_light_axis_view<vectorial>(output);
+                auto acc = accumulator.template make_accumulator<vectorial>(output_view);
+
+                // accumulates the values of the 2^k nodes starting at n and returns the 2^k-th ancestor of n
+                auto jump = [&](index_t k, index_t n) {
+                    if (k == 0) {
+                        input_view.set_position(n);
+                        acc.accumulate(input_view.begin());
+                        return (index_t) parent(n, tree);
+                    }
+                    lifting_view.set_position((k - 1) * num_v + n);
+                    acc.accumulate(lifting_view.begin());
+                    return ancestor[(k - 1) * num_v + n];
+                };
+
+                for (index_t i = first; i < last; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    auto l = lcas(i);
+
+                    output_view.set_position(i);
+                    acc.set_storage(output_view);
+                    acc.initialize();
+                    index_t count = 0;
+                    for (index_t n: {(index_t) source(e, graph), (index_t) target(e, graph)}) {
+                        auto length = (index_t) depth(n) - (index_t) depth(l);
+                        count += length;
+                        for (; length >= top_length; length -= top_length) {
+                            n = jump(top, n);
+                        }
+                        for (index_t k = 0; length != 0; k++, length >>= 1) {
+                            if (length & 1) {
+                                n = jump(k, n);
+                            }
+                        }
+                    }
+                    acc.finalize();
+                    if (mean && count != 0) {
+                        for (auto v = output_view.begin(); v != output_view.end(); v++) {
+                            *v /= (output_t) count;
+                        }
+                    }
+                }
+            });
+
             return output;
         };
 
     }
 
-    template<typename graph_t, typename tree_t, typename T, typename T1, typename accumulator_t, typename output_t = typename T::value_type>
+    /**
+     * Accumulates node values of a tree on the edges of its leaf graph: the result of an edge (n1, n2) is the
+     * accumulation of the values of the nodes on the path from n1 to n2 in the tree, their lowest common ancestor
+     * excluded.
+     *
+     * The counter accumulator, and the sum and mean accumulators on integral values, are computed from prefix sums
+     * along the root paths and lowest common ancestor queries, the min and max accumulators, and the sum and mean
+     * accumulators on floating point values, with binary lifting tables of the ancestors and lowest common ancestor
+     * queries, other accumulators walk the paths. When Higra is compiled with TBB, edges are processed
+     * in parallel on large graphs.
+     *
+     * @tparam graph_t leaf graph type
+     * @tparam tree_t tree type
+     * @tparam output_t value type of the result (defaults to the value type of the input)
+     * @param graph leaf graph of the tree
+     * @param tree input tree
+     * @param xinput node values
+     * @param xdepth depth of the tree nodes
+     * @param accumulator accumulator
+     * @return an array of edge values
+     */
+    template<typename graph_t, typename tree_t, typename T, typename T1, typename accumulator_t,
+            typename output_t = typename T::value_type>
     auto accumulate_on_contours(const graph_t &graph,
                                 const tree_t &tree,
                                 const xt::xexpression<T> &xinput,
                                 const xt::xexpression<T1> &xdepth,
                                 const accumulator_t &accumulator) {
+        using namespace tree_contour_accumulator_detail;
         auto &input = xinput.derived_cast();
+        bool parallel = use_parallel((index_t) num_edges(graph));
+        accumulators kind;
+        if (prefix_accumulator(accumulator, kind) && kind != accumulators::counter &&
+            std::is_floating_point<typename T::value_type>::value) {
+            if (input.dimension() == 1) {
+                return accumulate_on_contours_lifting_impl<false, graph_t, tree_t, T, T1, accumulator_sum, output_t>(
+                        graph, tree, xinput, xdepth, accumulator_sum(), parallel, kind == accumulators::mean);
+            } else {
+                return accumulate_on_contours_lifting_impl<true, graph_t, tree_t, T, T1, accumulator_sum, output_t>(
+                        graph, tree, xinput, xdepth, accumulator_sum(), parallel, kind == accumulators::mean);
+            }
+        }
+        if (prefix_accumulator(accumulator, kind)) {
+            if (input.dimension() == 1) {
+                return accumulate_on_contours_prefix_impl<false, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                        graph, tree, xinput, xdepth, accumulator, kind, parallel);
+            } else {
+                return accumulate_on_contours_prefix_impl<true, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                        graph, tree, xinput, xdepth, accumulator, kind, parallel);
+            }
+        }
+        if (lifting_accumulator(accumulator)) {
+            if (input.dimension() == 1) {
+                return accumulate_on_contours_lifting_impl<false, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                        graph, tree, xinput, xdepth, accumulator, parallel);
+            } else {
+                return accumulate_on_contours_lifting_impl<true, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                        graph, tree, xinput, xdepth, accumulator, parallel);
+            }
+        }
         if (input.dimension() == 1) {
-            return tree_contour_accumulator_detail::accumulate_on_contours_impl<false>(graph,
-                                                                                       tree,
-                                                                                       xinput,
-                                                                                       xdepth,
-                                                                                       accumulator);
+            return accumulate_on_contours_impl<false, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                    graph, tree, xinput, xdepth, accumulator, parallel);
         } else {
-            return tree_contour_accumulator_detail::accumulate_on_contours_impl<true>(graph,
-                                                                                      tree,
-                                                                                      xinput,
-                                                                                      xdepth,
-                                                                                      accumulator);
+            return accumulate_on_contours_impl<true, graph_t, tree_t, T, T1, accumulator_t, output_t>(
+                    graph, tree, xinput, xdepth, accumulator, parallel);
         }
     };
 
-}
\ No newline at end of file
+}
@@ -14,7 +14,7 @@
 #include "../attribute/tree_attribute.hpp"
 #include <xtensor/xnoalias.hpp>
 #include <vector>
-#include <stack>
+#include <iterator>
 
 namespace hg {
 
@@ -24,139 +24,134 @@ namespace hg {
 
         template<typename tree_iterator>
         auto tree_fusion_depth_map(const tree_iterator first, const tree_iterator last) {
-
-            index_t i, j;
-            tree_iterator ti, tj;
-            auto ntrees = last - first;
+            HG_TRACE();
+            const index_t ntrees = last - first;
             hg_assert(ntrees > 1, "Fusion requires at least two trees");
-            auto nleaves = num_leaves(**first);
+            const index_t nleaves = num_leaves(**first);
             for (tree_iterator t = first; t != last; t++) {
-                hg_assert(num_leaves(**t), "All trees must have the same number of leaves.");
+                hg_assert((index_t) num_leaves(**t) == nleaves, "All trees must have the same number of leaves.");
             }
-
-            // cheap digraph!
-            vector<vector<index_t>> adj_lists;
-
-            // precompute areas and smallest enclosing shapes
-            vector<array_1d<index_t>> areas;
-            array_2d<array_1d<index_t>> ses = xt::empty<array_1d<index_t>>({ntrees, ntrees});
-            for (ti = first, i = 0; ti != last; ti++, i++) {
-                areas.push_back(attribute_area(**ti));
-                for (tj = first, j = 0; tj != last; tj++, j++) {
-                    if (j != i) {
-                        ses(i, j) = attribute_smallest_enclosing_shape(**ti, **tj);
-                    }
+            vector<typename std::iterator_traits<tree_iterator>::value_type> trees(first, last);
+
+            // precompute areas and smallest enclosing shapes: ses[i * ntrees + j] gives, for each node of the i-th
+            // tree, the smallest enclosing node in the j-th tree
+            vector<array_1d<index_t>> areas(ntrees);
+            parfor(0, ntrees, [&areas, &trees](index_t i) {
+                areas[i] = attribute_area(*trees[i]);
+            });
+            vector<array_1d<index_t>> ses(ntrees * ntrees);
+            parfor(0, ntrees * ntrees, [&ses, &trees, &ntrees](index_t k) {
+                index_t i = k / ntrees;
+                index_t j = k % ntrees;
+                if (i != j) {
+                    ses[k] = attribute_smallest_enclosing_shape(*trees[i], *trees[j]);
                 }
-            }
+            });
 
             /* ***************
              * Add nodes to the graph of shapes (GOS)
              */
 
-            // associate each node of each tree to a node of the GOS
+            // associate each node of each tree to a node of the GOS: leaves first, then internal nodes (except
+            // roots) without duplication, and finally the common root
             vector<array_1d<index_t>> node_maps;
-
-            // add leaves
-            adj_lists.resize(nleaves);
-
-            // add internal nodes (except root) and avoid duplication
-            for (ti = first, i = 0; ti != last; ti++, i++) {
-                node_maps.emplace_back(array_1d<index_t>::from_shape({num_vertices(**ti)}));
-                // create leaves association
+            index_t nnodes = nleaves;
+            for (index_t i = 0; i < ntrees; i++) {
+                auto &t = *trees[i];
+                node_maps.emplace_back(array_1d<index_t>::from_shape({num_vertices(t)}));
                 xt::noalias(xt::view(node_maps[i], xt::range(0, nleaves))) = xt::arange<index_t>(nleaves);
 
-                for (index_t n: leaves_to_root_iterator(**ti, leaves_it::exclude, root_it::exclude)) {
+                for (index_t n: leaves_to_root_iterator(t, leaves_it::exclude, root_it::exclude)) {
                     bool keep = true;
                     for (index_t j = 0; j < i && keep; j++) {
-                        auto ses_ij_n = ses(i, j)(n);
+                        auto ses_ij_n = ses[i * ntrees + j](n);
                         if (areas[j](ses_ij_n) == areas[i](n)) {
                             keep = false;
                             node_maps[i](n) = node_maps[j](ses_ij_n);
                         }
                     }
                     if (keep) {
-                        node_maps[i](n) = adj_lists.size();
-                        adj_lists.emplace_back();
+                        node_maps[i](n) = nnodes++;
                     }
                 }
             }
-
-            // add root
-            auto rootn = adj_lists.size();
-            adj_lists.emplace_back();
-            for (ti = first, i = 0; ti != last; ti++, i++) {
-                node_maps[i](root(**ti)) = rootn;
+            const index_t rootn = nnodes++;
+            for (index_t i = 0; i < ntrees; i++) {
+                node_maps[i](root(*trees[i])) = rootn;
             }
 
-
             /* ***************
-             * Add edges to the graph of shapes (GOS)
+             * Add edges to the graph of shapes (GOS), stored in compressed sparse row format
              */
-            for (ti = first, i = 0; ti != last; ti++, i++) {
-                for (index_t n: leaves_to_root_iterator(**ti, leaves_it::include, root_it::exclude)) {
-                    auto represent_n = node_maps[i](n);
-                    adj_lists[node_maps[i](parent(n, **ti))].push_back(represent_n);
-                    for (j = 0; j < (index_t) ntrees; j++) {
-                        if (i != j) {
-                            auto ses_ij_n = ses(i, j)(n);
-                            if (areas[j](ses_ij_n) != areas[i](n)) {
-                                adj_lists[node_maps[j](ses_ij_n)].push_back(represent_n);
+            auto for_each_edge = [&](const auto &fun) {
+                for (index_t i = 0; i < ntrees; i++) {
+                    auto &t = *trees[i];
+                    for (index_t n: leaves_to_root_iterator(t, leaves_it::include, root_it::exclude)) {
+                        auto represent_n = node_maps[i](n);
+                        auto represent_p = node_maps[i](parent(n, t));
+                        fun(represent_p, represent_n);
+                        for (index_t j = 0; j < ntrees; j++) {
+                            if (i != j) {
+                                auto ses_ij_n = ses[i * ntrees + j](n);
+                                if (areas[j](ses_ij_n) != areas[i](n)) {
+                                    fun(node_maps[j](ses_ij_n), represent_n);
+                                }
                             }
                         }
-
                     }
                 }
-            }
-
-            /* ***************
-            * Transitive reduction of the GOS
-            */
-
-            // perhaps one day, doesn't bring anything in terms of complexity
-
-            /* ***************
-            * Topological sort of the GOS
-            */
-            auto nnodes = adj_lists.size();
-            array_1d<index_t> sorted_nodes = xt::empty<index_t>({nnodes});
-            // marks: 0 = never seen, 1 = being visited (not finalized and sucessors on the stack), 2 = sorted
-            array_1d<char> marks = xt::zeros<char>({nnodes});
-            stack<index_t> s;
-
-            index_t count = 0;
-            s.push(rootn);
-            while (!s.empty()) {
-                auto n = s.top();
-                if (marks(n) > 0) {
-                    s.pop();
-                    if (marks(n) == 1) {
-                        sorted_nodes(count++) = n;
-                        marks(n) = 2;
-                    }
+            };
+
+            // a node of a tree and its parent may correspond to the same node of the GOS: such self loops are
+            // not stored as edges but they increase the depth of the node
+            array_1d<index_t> out_begin = xt::zeros<index_t>({(size_t) nnodes + 1});
+            array_1d<index_t> in_degree = xt::zeros<index_t>({(size_t) nnodes});
+            array_1d<index_t> self_loops = xt::zeros<index_t>({(size_t) nnodes});
+            for_each_edge([&out_begin, &in_degree, &self_loops](index_t s, index_t t) {
+                if (s != t) {
+                    out_begin(s + 1)++;
+                    in_degree(t)++;
                 } else {
-                    marks(n) = 1;
-                    for (auto o: adj_lists[n]) {
-                        if (marks(o) != 2) {
-                            s.push(o);
-                        }
-                    }
+                    self_loops(s)++;
                 }
+            });
+            for (index_t n = 0; n < nnodes; n++) {
+                out_begin(n + 1) += out_begin(n);
             }
+            array_1d<index_t> out_edges = array_1d<index_t>::from_shape({(size_t) out_begin(nnodes)});
+            {
+                array_1d<index_t> position = xt::view(out_begin, xt::range(0, nnodes));
+                for_each_edge([&out_edges, &position](index_t s, index_t t) {
+                    if (s != t) {
+                        out_edges(position(s)++) = t;
+                    }
+                });
+            }
+
+            // the smallest enclosing shapes are not needed anymore
+            vector<array_1d<index_t>>().swap(ses);
 
             /* ***************
-            * Depth of the nodes of the GOS
+            * Depth of the nodes of the GOS: longest path from the root, computed in topological order (Kahn's
+            * algorithm) in linear time
             */
-            array_1d<index_t> depth = xt::zeros<index_t>({nnodes});
-            for (index_t i = nnodes - 1; i >= 0; i--) {
-                index_t n = sorted_nodes[i];
-                for (auto o: adj_lists[n]) {
+            array_1d<index_t> depth = xt::zeros<index_t>({(size_t) nnodes});
+            array_1d<index_t> queue = array_1d<index_t>::from_shape({(size_t) nnodes});
+            index_t queue_begin = 0;
+            index_t queue_end = 0;
+            queue(queue_end++) = rootn;
+            while (queue_begin < queue_end) {
+                auto n = queue(queue_begin++);
+                depth(n) += self_loops(n);
+                for (index_t e = out_begin(n); e < out_begin(n + 1); e++) {
+                    auto o = out_edges(e);
                     depth(o) = (std::max)(depth(o), depth(n) + 1);
+                    if (--in_degree(o) == 0) {
+                        queue(queue_end++) = o;
+                    }
                 }
             }
 
-            /* ***************
-            * Depth of the nodes of the GOS
-            */
             return xt::eval(xt::view(depth, xt::range(0, nleaves)));
         }
 
@@ -15,8 +15,10 @@
 #include "../structure/array.hpp"
 #include "higra/structure/unionfind.hpp"
 #include "higra/sorting.hpp"
+#include "../structure/monotone_queue.hpp"
 #include <vector>
 #include <stack>
+#include <atomic>
 
 namespace hg {
 
@@ -120,6 +122,318 @@ namespace hg {
     };
 
 
+    namespace watershed_internal {
+
+        /**
+         * Pointer jumping in the forest represented by the given parent array: on return, parent(v) is the root of
+         * v for every vertex v of active. Each round computes the jumps of the active vertices in a separate buffer,
+         * writes them back in parallel, and compacts the vertices whose parent is not a root yet.
+         *
+         * @param parent parent array of the forest (a root is its own parent)
+         * @param active vertices to process (used as storage)
+         */
+        template<typename array_t>
+        void pointer_jumping(array_t &parent, std::vector<index_t> &active) {
+            std::vector<index_t> next_active;
+            std::vector<index_t> jump;
+            while (!active.empty()) {
+                const index_t num_active = (index_t) active.size();
+                jump.resize(num_active);
+                parfor(0, num_active, [&active, &jump, &parent](index_t i) {
+                    jump[i] = parent(parent(active[i]));
+                });
+                parfor(0, num_active, [&active, &jump, &parent](index_t i) {
+                    parent(active[i]) = jump[i];
+                });
+                compact(num_active, use_parallel(num_active),
+                        [&jump, &parent](index_t i) { return parent(jump[i]) != jump[i]; },
+                        [&active](index_t i) { return active[i]; },
+                        next_active);
+                std::swap(active, next_active);
+            }
+        }
+
+        /**
+         * Pointer jumping on all the vertices of the forest represented by the given parent array.
+         */
+        template<typename array_t>
+        void pointer_jumping(array_t &parent) {
+            const index_t size = (index_t) parent.size();
+            std::vector<index_t> active;
+            compact(size, use_parallel(size),
+                    [&parent](index_t v) { return parent(parent(v)) != parent(v); },
+                    [](index_t v) { return v; },
+                    active);
+            pointer_jumping(parent, active);
+        }
+    }
+
+    /**
+     * Parallel watershed cut algorithm.
+     *
+     * Computes the same labelisation as labelisation_watershed, whose streams are reproduced as follows:
+     *  - a vertex without flat edge (a steepest edge leading to a vertex with the same minimum adjacent edge
+     *    weight) always leaves through its first steepest edge: it gets the label of the plateau vertex at the
+     *    end of its descending path, found in parallel by pointer jumping;
+     *  - the plateaus (connected components of flat edges, found with a union find processing chunks of vertices in
+     *    parallel) are explored as in the sequential algorithm: the vertices of a plateau are processed in the order
+     *    of the first stream reaching them (the smallest index of a vertex whose stream leads to them), and each
+     *    vertex not labeled yet starts an exploration of the plateau that stops at the first steepest edge leading
+     *    to a lower vertex or to a vertex explored before;
+     *  - the plateaus are processed by decreasing level, plateaus of a same level being processed in parallel;
+     *  - the labels are finally propagated from the minima by pointer jumping.
+     *
+     * The exploration of a plateau is sequential: inputs with large non minimal plateaus, or with plateaus at many
+     * different levels, thus benefit less from parallelism.
+     *
+     * @tparam graph_t
+     * @tparam T
+     * @param graph
+     * @param xedge_weights
+     * @param canonical_labels if true, basins are numbered in the order of their smallest vertex, as in
+     * labelisation_watershed, otherwise in the order of the smallest vertex of their minimum
+     * @return array of labels on graph vertices, numbered from 1 to n with n the number of minima
+     */
+    template<typename graph_t, typename T>
+    auto
+    labelisation_watershed_parallel(const graph_t &graph,
+                                    const xt::xexpression<T> &xedge_weights,
+                                    bool canonical_labels = true) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_edge_weights(graph, edge_weights);
+        hg_assert_1d_array(edge_weights);
+
+        using value_type = typename T::value_type;
+        using namespace watershed_internal;
+        const index_t num_v = num_vertices(graph);
+        const bool parallel = use_parallel(num_v);
+
+        auto fminus = array_1d<value_type>::from_shape({(size_t) num_v});
+        parfor(0, num_v, [&graph, &edge_weights, &fminus](index_t v) {
+            auto min_value = (std::numeric_limits<value_type>::max)();
+            for (auto e: out_edge_iterator(v, graph)) {
+                min_value = (std::min)(min_value, edge_weights(e));
+            }
+            fminus(v) = min_value;
+        });
+
+        // edges of a plateau: steepest edges for both extremities
+        auto is_flat = [&graph, &edge_weights, &fminus](index_t v, const auto &e) {
+            return edge_weights(e) == fminus(v) && fminus(target(e, graph)) == fminus(v);
+        };
+
+        // a vertex without flat edge points to the target of its first steepest edge, a plateau vertex to itself
+        array_1d<index_t> parent = array_1d<index_t>::from_shape({(size_t) num_v});
+        array_1d<char> plateau = array_1d<char>::from_shape({(size_t) num_v});
+        parfor(0, num_v, [&graph, &edge_weights, &fminus, &is_flat, &parent, &plateau](index_t v) {
+            index_t first = v;
+            bool flat = false;
+            for (auto e: out_edge_iterator(v, graph)) {
+                if (is_flat(v, e)) {
+                    flat = true;
+                    break;
+                }
+                if (first == v && edge_weights(e) == fminus(v)) {
+                    first = target(e, graph);
+                }
+            }
+            plateau(v) = flat;
+            parent(v) = flat ? v : first;
+        });
+
+        // plateau vertex at the end of the descending path of each vertex
+        pointer_jumping(parent);
+
+        // plateaus: union find with linking towards the smallest root, chunks of consecutive vertices are processed
+        // in parallel and the edges between chunks are processed afterward
+        array_1d<index_t> zone = xt::arange<index_t>(num_v);
+        auto find = [&zone](index_t v) {
+            index_t r = v;
+            while (zone(r) != r) {
+                r = zone(r);
+            }
+            while (zone(v) != r) {
+                auto n = zone(v);
+                zone(v) = r;
+                v = n;
+            }
+            return r;
+        };
+        auto unite = [&zone, &find](index_t v1, index_t v2) {
+            v1 = find(v1);
+            v2 = find(v2);
+            if (v1 < v2) {
+                zone(v2) = v1;
+            } else if (v2 < v1) {
+                zone(v1) = v2;
+            }
+        };
+
+        const index_t chunk_size = 1 << 16;
+        const index_t num_chunks = (num_v + chunk_size - 1) / chunk_size;
+        std::vector<std::vector<std::pair<index_t, index_t>>> chunk_edges(num_chunks);
+        parfor_blocks(num_v, chunk_size, true, [&](index_t first, index_t last) {
+            for (index_t v = first; v < last; v++) {
+                if (plateau(v)) {
+                    for (auto e: out_edge_iterator(v, graph)) {
+                        index_t n = target(e, graph);
+                        if (n < v && is_flat(v, e)) {
+                            if (n >= first) {
+                                unite(v, n);
+                            } else {
+                                chunk_edges[first / chunk_size].emplace_back(v, n);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+        for (auto &edges: chunk_edges) {
+            for (auto &e: edges) {
+                unite(e.first, e.second);
+            }
+        }
+        pointer_jumping(zone);
+
+        // time of the first stream reaching each plateau vertex: the smallest index of the vertices whose
+        // descending path ends on it (including itself), updated with the streams leaving the upper plateaus
+        std::vector<std::atomic<index_t>> arrival(num_v);
+        parfor(0, num_v, [&arrival](index_t v) {
+            arrival[v].store(v, std::memory_order_relaxed);
+        });
+        auto arrive = [&arrival](index_t v, index_t time) {
+            auto current = arrival[v].load(std::memory_order_relaxed);
+            while (time < current && !arrival[v].compare_exchange_weak(current, time, std::memory_order_relaxed)) {}
+        };
+        parfor(0, num_v, [&parent, &arrive](index_t v) {
+            if (parent(v) != v) {
+                arrive(parent(v), v);
+            }
+        });
+
+        // plateau vertices grouped by plateau, plateaus being sorted by decreasing level
+        std::vector<index_t> members;
+        compact(num_v, parallel,
+                [&plateau](index_t v) { return plateau(v) != 0; },
+                [](index_t v) { return v; },
+                members);
+        hg::sort(members.begin(), members.end(), [&fminus, &zone](index_t v1, index_t v2) {
+            return fminus(v1) > fminus(v2) || (fminus(v1) == fminus(v2) && (zone(v1) < zone(v2) ||
+                                                                           (zone(v1) == zone(v2) && v1 < v2)));
+        });
+        const index_t num_members = (index_t) members.size();
+        std::vector<index_t> zone_start;
+        compact(num_members, parallel,
+                [&members, &zone](index_t i) { return i == 0 || zone(members[i]) != zone(members[i - 1]); },
+                [](index_t i) { return i; },
+                zone_start);
+        const index_t num_zones = (index_t) zone_start.size();
+        zone_start.push_back(num_members);
+        std::vector<index_t> level_start;
+        compact(num_zones, parallel,
+                [&members, &zone_start, &fminus](index_t z) {
+                    return z == 0 || fminus(members[zone_start[z]]) != fminus(members[zone_start[z - 1]]);
+                },
+                [](index_t z) { return z; },
+                level_start);
+        level_start.push_back(num_zones);
+
+        // exploration of the plateaus, the streams are reproduced in the order of their starting vertex: the vertices
+        // explored by a stream point to the vertex where the stream leaves the plateau, or to the smallest vertex
+        // of the plateau if it is a minimum; basin_start receives the vertex starting the stream of each minimum
+        const char unexplored = 0;
+        const char in_stream = 1;
+        const char explored = 2;
+        array_1d<char> state = xt::zeros<char>({(size_t) num_v});
+        array_1d<index_t> basin_start = xt::arange<index_t>(num_v);
+        auto explore_plateau = [&](index_t z, std::vector<index_t> &stream, std::vector<index_t> &stack) {
+            auto first = members.begin() + zone_start[z];
+            auto last = members.begin() + zone_start[z + 1];
+            std::sort(first, last, [&arrival](index_t v1, index_t v2) {
+                return arrival[v1].load(std::memory_order_relaxed) < arrival[v2].load(std::memory_order_relaxed);
+            });
+            for (auto it = first; it != last; it++) {
+                auto x = *it;
+                if (state(x) != unexplored) {
+                    continue;
+                }
+                auto time = arrival[x].load(std::memory_order_relaxed);
+                stream.clear();
+                stack.clear();
+                stream.push_back(x);
+                stack.push_back(x);
+                state(x) = in_stream;
+                index_t exit = invalid_index;
+                while (exit == invalid_index && !stack.empty()) {
+                    auto y = stack.back();
+                    stack.pop_back();
+                    for (auto e: out_edge_iterator(y, graph)) {
+                        auto n = target(e, graph);
+                        if (state(n) != in_stream && edge_weights(e) == fminus(y)) {
+                            if (state(n) == explored || fminus(n) < fminus(y)) {
+                                exit = n;
+                                break;
+                            }
+                            stream.push_back(n);
+                            stack.push_back(n);
+                            state(n) = in_stream;
+                        }
+                    }
+                }
+                index_t next;
+                if (exit == invalid_index) {
+                    next = zone(x);
+                    basin_start(next) = time;
+                } else if (state(exit) == explored) {
+                    next = exit;
+                } else {
+                    next = parent(exit);
+                    arrive(next, time);
+                }
+                for (auto v: stream) {
+                    state(v) = explored;
+                    parent(v) = next;
+                }
+            }
+        };
+
+        const index_t plateau_block_size = 64;
+        for (index_t l = 0; l < (index_t) level_start.size() - 1; l++) {
+            const index_t first_zone = level_start[l];
+            parfor_blocks(level_start[l + 1] - first_zone, plateau_block_size, true,
+                          [&explore_plateau, first_zone](index_t first, index_t last) {
+                              std::vector<index_t> stream;
+                              std::vector<index_t> stack;
+                              for (index_t z = first; z < last; z++) {
+                                  explore_plateau(first_zone + z, stream, stack);
+                              }
+                          });
+        }
+
+        // root of each vertex: the smallest vertex of its minimum
+        pointer_jumping(parent);
+
+        // basins are numbered in the order of their key with a prefix sum: the smallest vertex of the basin (the
+        // vertex starting the stream of its minimum) for canonical labels, the smallest vertex of the minimum otherwise
+        auto key = [&basin_start, canonical_labels](index_t r) {
+            return canonical_labels ? basin_start(r) : r;
+        };
+        array_1d<index_t> rank = xt::zeros<index_t>({(size_t) num_v});
+        parfor(0, num_v, [&parent, &rank, &key](index_t v) {
+            if (parent(v) == v) {
+                rank(key(v)) = 1;
+            }
+        });
+        exclusive_prefix_sum(rank, rank);
+        array_1d<index_t> labels = array_1d<index_t>::from_shape({(size_t) num_v});
+        parfor(0, num_v, [&labels, &rank, &parent, &key](index_t v) {
+            labels(v) = rank(key(parent(v))) + 1;
+        });
+        return labels;
+    };
+
+
     template<typename graph_t, typename T1, typename T2>
     auto labelisation_seeded_watershed(
             const graph_t &graph,
@@ -173,4 +487,264 @@ namespace hg {
         return labels;
     };
 
+
+    namespace watershed_internal {
+
+        /**
+         * Priority flood from the labeled vertices: the unlabeled vertex reached with the smallest
+         * priority max(flooding level, edge priority) is labeled first.
+         *
+         * @param graph
+         * @param labels on input: seeds labels, on output: labelisation
+         * @param background_label label of non seed vertices
+         * @param queue monotone priority queue
+         * @param edge_priority edge index -> priority in queue
+         */
+        template<typename graph_t, typename label_t, typename queue_t, typename priority_fun_t>
+        void seeded_priority_flood(const graph_t &graph,
+                                   array_1d<label_t> &labels,
+                                   const label_t background_label,
+                                   queue_t &queue,
+                                   const priority_fun_t &edge_priority) {
+            using priority_t = decltype(edge_priority(0));
+            const index_t num_v = num_vertices(graph);
+
+            array_1d<bool> done = xt::not_equal(labels, background_label);
+            std::vector<priority_t> best(num_v, (std::numeric_limits<priority_t>::max)());
+
+            auto flood_from = [&graph, &edge_priority, &labels, &done, &best, &queue](index_t v, priority_t level) {
+                for (auto e: out_edge_iterator(v, graph)) {
+                    auto n = target(e, graph);
+                    if (!done(n)) {
+                        auto priority = (std::max)(level, edge_priority(index(e, graph)));
+                        if (priority < best[n]) {
+                            best[n] = priority;
+                            labels(n) = labels(v);
+                            queue.push(priority, n);
+                        }
+                    }
+                }
+            };
+
+            for (index_t v = 0; v < num_v; v++) {
+                if (done(v)) {
+                    flood_from(v, (std::numeric_limits<priority_t>::lowest)());
+                }
+            }
+
+            while (!queue.empty()) {
+                auto level = queue.top_priority();
+                auto v = queue.top();
+                queue.pop();
+                if (!done(v)) {
+                    done(v) = true;
+                    flood_from(v, level);
+                }
+            }
+        }
+    }
+
+    /**
+     * Seeded watershed cut by priority flooding.
+     *
+     * Computes a seeded watershed cut (see labelisation_seeded_watershed) by flooding the graph from the seeds with a
+     * monotone priority queue: a bucket queue if the edge weights are integers spanning less than 2^16 values and
+     * a radix heap otherwise. The runtime complexity is thus linear for low dynamic integer edge weights and in
+     * O(n log(C)) otherwise, with n the number of edges and C the number of bits of the edge weight type.
+     *
+     * When all edge weights are distinct, the result is identical to the one of labelisation_seeded_watershed.
+     * Otherwise, both results are valid seeded watershed cuts but they may differ on plateaus.
+     *
+     * @tparam graph_t
+     * @tparam T1
+     * @tparam T2
+     * @param graph
+     * @param xedge_weights
+     * @param xvertex_seeds seed labels on graph vertices
+     * @param background_label vertices whose seed label is equal to background_label are not seeds
+     * @return array of labels on graph vertices
+     */
+    template<typename graph_t, typename T1, typename T2>
+    auto labelisation_seeded_watershed_priority_flood(
+            const graph_t &graph,
+            const xt::xexpression<T1> &xedge_weights,
+            const xt::xexpression<T2> &xvertex_seeds,
+            const typename T2::value_type background_label = 0) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        auto &vertex_seeds = xvertex_seeds.derived_cast();
+        hg_assert_edge_weights(graph, edge_weights);
+        hg_assert_node_weights(graph, vertex_seeds);
+        hg_assert_1d_array(edge_weights);
+        hg_assert_1d_array(vertex_seeds);
+
+        using value_type = typename T1::value_type;
+        using label_type = typename T2::value_type;
+
+        array_1d<label_type> labels = vertex_seeds;
+
+        // number of buckets if the edge weights are integers spanning less than 2^16 values, 0 otherwise
+        size_t num_buckets = 0;
+        value_type min_weight = 0;
+        if (std::is_integral<value_type>::value && edge_weights.size() > 0) {
+            auto minmax = std::minmax_element(edge_weights.begin(), edge_weights.end());
+            min_weight = *minmax.first;
+            if ((double) *minmax.second - (double) *minmax.first < (1 << 16)) {
+                num_buckets = (size_t) (*minmax.second - *minmax.first) + 1;
+            }
+        }
+
+        if (num_buckets > 0) {
+            bucket_queue<index_t> queue(num_buckets);
+            watershed_internal::seeded_priority_flood(graph, labels, background_label, queue,
+                                                      [&edge_weights, min_weight](index_t ei) {
+                                                          return (index_t) (edge_weights(ei) - min_weight);
+                                                      });
+        } else {
+            radix_heap<index_t> queue;
+            watershed_internal::seeded_priority_flood(graph, labels, background_label, queue,
+                                                      [&edge_weights](index_t ei) {
+                                                          return radix_heap<index_t>::key(edge_weights(ei));
+                                                      });
+        }
+
+        return labels;
+    };
+
+    /**
+     * Parallel seeded watershed cut.
+     *
+     * Computes the same result as labelisation_seeded_watershed with a parallel Boruvka algorithm: at each round,
+     * every region without seed selects its lightest outgoing edge (in parallel) and the regions are merged along the
+     * selected edges with pointer jumping. A region stops growing as soon as it is merged with a seed. The number of
+     * rounds is at most logarithmic in the number of vertices.
+     *
+     * Ties between edges of equal weights are broken with the edge indices, as in labelisation_seeded_watershed,
+     * so both functions always return the same labelisation.
+     *
+     * @tparam graph_t
+     * @tparam T1
+     * @tparam T2
+     * @param graph
+     * @param xedge_weights
+     * @param xvertex_seeds seed labels on graph vertices
+     * @param background_label vertices whose seed label is equal to background_label are not seeds
+     * @return array of labels on graph vertices
+     */
+    template<typename graph_t, typename T1, typename T2>
+    auto labelisation_seeded_watershed_parallel(
+            const graph_t &graph,
+            const xt::xexpression<T1> &xedge_weights,
+            const xt::xexpression<T2> &xvertex_seeds,
+            const typename T2::value_type background_label = 0) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        auto &vertex_seeds = xvertex_seeds.derived_cast();
+        hg_assert_edge_weights(graph, edge_weights);
+        hg_assert_node_weights(graph, vertex_seeds);
+        hg_assert_1d_array(edge_weights);
+        hg_assert_1d_array(vertex_seeds);
+
+        using label_type = typename T2::value_type;
+        const index_t num_v = num_vertices(graph);
+        const index_t no_edge = invalid_index;
+
+        array_1d<label_type> labels = vertex_seeds;
+
+        auto lighter = [&edge_weights](index_t e1, index_t e2) {
+            return edge_weights(e1) < edge_weights(e2) || (edge_weights(e1) == edge_weights(e2) && e1 < e2);
+        };
+
+        // region of each vertex, seeds are regions that never change
+        array_1d<index_t> region = xt::arange<index_t>(num_v);
+        array_1d<index_t> next = xt::arange<index_t>(num_v);
+        std::vector<std::atomic<index_t>> lightest_edge(num_v);
+
+        // vertices of growing regions (unlabeled regions with at least one outgoing edge)
+        std::vector<index_t> active;
+        compact(num_v, use_parallel(num_v),
+                [&labels, background_label](index_t v) { return labels(v) == background_label; },
+                [](index_t v) { return v; },
+                active);
+
+        std::vector<index_t> roots;
+        std::vector<index_t> pending;
+        std::vector<index_t> next_active;
+        while (!active.empty()) {
+            const index_t num_active = (index_t) active.size();
+            compact(num_active, use_parallel(num_active),
+                    [&active, &region](index_t i) { return region(active[i]) == active[i]; },
+                    [&active](index_t i) { return active[i]; },
+                    roots);
+
+            parfor(0, roots.size(), [&roots, &lightest_edge, no_edge](index_t i) {
+                lightest_edge[roots[i]].store(no_edge, std::memory_order_relaxed);
+            });
+
+            // lightest outgoing edge of each region
+            parfor(0, active.size(), [&graph, &active, &region, &lightest_edge, &lighter, no_edge](index_t i) {
+                auto v = active[i];
+                auto r = region(v);
+                index_t best = no_edge;
+                for (auto e: out_edge_iterator(v, graph)) {
+                    if (region(target(e, graph)) != r) {
+                        auto ei = index(e, graph);
+                        if (best == no_edge || lighter(ei, best)) {
+                            best = ei;
+                        }
+                    }
+                }
+                if (best != no_edge) {
+                    auto current = lightest_edge[r].load(std::memory_order_relaxed);
+                    while ((current == no_edge || lighter(best, current)) &&
+                           !lightest_edge[r].compare_exchange_weak(current, best)) {}
+                }
+            });
+
+            // hooking, a region and its target may select the same edge: the smallest one becomes the root
+            parfor(0, roots.size(), [&graph, &roots, &region, &next, &lightest_edge, no_edge](index_t i) {
+                auto r = roots[i];
+                auto ei = lightest_edge[r].load(std::memory_order_relaxed);
+                if (ei != no_edge) {
+                    auto e = edge_from_index(ei, graph);
+                    auto rs = region(source(e, graph));
+                    next(r) = (rs != r) ? rs : region(target(e, graph));
+                }
+            });
+            parfor(0, roots.size(), [&roots, &next](index_t i) {
+                auto r = roots[i];
+                auto n = next(r);
+                if (r < n && next(n) == r) {
+                    next(r) = r;
+                }
+            });
+
+            pending = roots;
+            watershed_internal::pointer_jumping(next, pending);
+
+            parfor(0, active.size(), [&active, &region, &next](index_t i) {
+                auto v = active[i];
+                region(v) = next(region(v));
+            });
+
+            compact(num_active, use_parallel(num_active),
+                    [&active, &region, &labels, &lightest_edge, background_label, no_edge](index_t i) {
+                        auto r = region(active[i]);
+                        return labels(r) == background_label &&
+                               lightest_edge[r].load(std::memory_order_relaxed) != no_edge;
+                    },
+                    [&active](index_t i) { return active[i]; },
+                    next_active);
+            std::swap(active, next_active);
+        }
+
+        parfor(0, num_v, [&labels, &region, background_label](index_t v) {
+            if (labels(v) == background_label) {
+                labels(v) = labels(region(v));
+            }
+        });
+
+        return labels;
+    };
+
 }
@@ -0,0 +1,553 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2019)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include "../graph.hpp"
+#include "../attribute/tree_attribute.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace hg {
+
+    namespace hierarchical_cost_internal {
+
+        /**
+         * Minimal number of samples for the parallel computation of the sampling estimators.
+         */
+        const index_t sampling_parallel_min_size = 1 << 14;
+
+        /**
+         * Number of samples drawn by a single task (with its own random generator).
+         */
+        const index_t sample_block_size = 4096;
+
+        /**
+         * Calls fun(generator, first, last) on consecutive blocks of sample indices covering [0, num_samples), the
+         * blocks being processed in parallel if parallel is true.
+         *
+         * The random generator of a block is seeded with seed and the index of the block: the samples do not depend
+         * on the number of threads.
+         */
+        template<typename fun_t>
+        void for_each_sample_block(index_t num_samples, std::uint64_t seed, bool parallel, const fun_t &fun) {
+            parfor_blocks(num_samples, sample_block_size, parallel, [&fun, seed](index_t first, index_t last) {
+                const auto b = (std::uint32_t) (first / sample_block_size);
+                std::seed_seq seq{(std::uint32_t) seed, (std::uint32_t) (seed >> 32), b};
+                std::mt19937_64 generator(seq);
+                fun(generator, first, last);
+            });
+        }
+
+        /**
+         * Draws indices in [0, n) with probabilities proportional to the given non negative weights (inverse
+         * transform sampling on the cumulative sums of the weights): indices with a zero weight are never drawn.
+         */
+        struct discrete_sampler {
+            std::vector<double> cumulative;
+            // largest index with a positive weight
+            index_t last_positive = invalid_index;
+
+            template<typename fun_t>
+            discrete_sampler(index_t n, const fun_t &weight) : cumulative(n) {
+                double sum = 0;
+                for (index_t i = 0; i < n; i++) {
+                    double w = weight(i);
+                    if (w > 0) {
+                        sum += w;
+                        last_positive = i;
+                    }
+                    cumulative[i] = sum;
+                }
+                hg_assert(n > 0 && sum > 0, "Sampling weights must have a positive sum.");
+            }
+
+            double total() const {
+                return cumulative.back();
+            }
+
+            template<typename generator_t>
+            index_t operator()(generator_t &generator) const {
+                std::uniform_real_distribution<double> distribution(0, total());
+                auto it = std::upper_bound(cumulative.begin(), cumulative.end(), distribution(generator));
+                // the drawn value may be rounded to the total sum
+                return (std::min)((index_t) (it - cumulative.begin()), last_positive);
+            }
+        };
+
+        /**
+         * Quantile function of the standard normal distribution.
+         */
+        inline
+        double normal_quantile(double p) {
+            double low = -40;
+            double high = 40;
+            for (index_t i = 0; i < 200; i++) {
+                double mid = (low + high) / 2;
+                if (0.5 * std::erfc(-mid / std::sqrt(2.0)) < p) {
+                    low = mid;
+                } else {
+                    high = mid;
+                }
+            }
+            return (low + high) / 2;
+        }
+    }
+
+    /**
+     * Sampling strategies of the edges of a graph for the estimation of hierarchical costs.
+     */
+    enum class edge_sampling {
+        uniform,
+        importance
+    };
+
+    /**
+     * Estimation of a hierarchical cost from a finite number of samples.
+     */
+    struct hierarchical_cost_estimate {
+        // estimated value of the cost
+        double value;
+        // estimated standard deviation of the estimator
+        double standard_error;
+        // bounds of the (asymptotic) confidence interval
+        double lower_bound;
+        double upper_bound;
+        // number of samples used for the estimation
+        index_t num_samples;
+    };
+
+    namespace hierarchical_cost_internal {
+
+        /**
+         * Estimate of the mean of the per sample values psi (value can differ from the mean of psi for plug-in
+         * estimators): the standard error is the standard deviation of psi divided by the square root of the number of
+         * samples, and the confidence interval is given by the normal approximation.
+         */
+        inline
+        hierarchical_cost_estimate make_estimate(double value, const std::vector<double> &psi, double confidence) {
+            hg_assert(confidence > 0 && confidence < 1, "Confidence level must be in (0, 1).");
+            const index_t num_samples = psi.size();
+            double mean = 0;
+            for (auto v: psi) {
+                mean += v;
+            }
+            mean /= num_samples;
+            double variance = 0;
+            for (auto v: psi) {
+                variance += (v - mean) * (v - mean);
+            }
+            variance /= (num_samples - 1);
+            double standard_error = std::sqrt(variance / num_samples);
+            double half_width = normal_quantile(0.5 + confidence / 2) * standard_error;
+            return {value, standard_error, value - half_width, value + half_width, num_samples};
+        }
+    }
+
+    /**
+     * Dasgupta's cost is an unsupervised measure of the quality of a hierarchical clustering of an edge weighted graph.
+     *
+     * Let :math:`T` be a tree representing a hierarchical clustering of the graph :math:`G=(V, E)`.
+     * Let :math:`w` be a dissimilarity function on the edges :math:`E` of the graph.
+     *
+     * The Dasgupta's cost is define as:
+     *
+     * .. math::
+     *
+     *     dasgupta(T, V, E, w) = \sum_{\{x,y\}\in E} \frac{area(lca_T(x,y))}{w(\{x,y\})}
+     *
+     * The cost is computed in a single pass over the edges, in parallel on large graphs: the lowest common ancestors
+     * of the edges are never materialized.
+     *
+     * S. Dasgupta. "A cost function for similarity-based hierarchical clustering." In Proc. STOC, pages 118–127,
+     * Cambridge, MA, USA, 2016
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T1 xexpression derived type of xedge_weights
+     * @tparam T2 xexpression derived type of xarea
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (dissimilarities)
+     * @param xarea area of the nodes of the tree
+     * @return a real number
+     */
+    template<typename tree_t, typename graph_t, typename T1, typename T2>
+    double dasgupta_cost(const tree_t &tree,
+                         const graph_t &leaf_graph,
+                         const xt::xexpression<T1> &xedge_weights,
+                         const xt::xexpression<T2> &xarea) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        auto &area = xarea.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        hg_assert_node_weights(tree, area);
+        hg_assert_1d_array(area);
+        hg_assert((index_t) num_vertices(leaf_graph) == (index_t) num_leaves(tree),
+                  "The number of vertices of the leaf graph does not match the number of leaves of the tree.");
+
+        lca_internal::lca_fast<tree_t> lca(tree);
+        return tree_attribute_internal::sum_over_edges_lowest_common_ancestor(
+                lca, leaf_graph,
+                [&area, &edge_weights](index_t i, index_t n) {
+                    return (double) area(n) / (double) edge_weights(i);
+                },
+                use_parallel((index_t) num_edges(leaf_graph)));
+    }
+
+    /**
+     * Dasgupta's cost with an area of 1 for each leaf of the tree (see above).
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T xexpression derived type of xedge_weights
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (dissimilarities)
+     * @return a real number
+     */
+    template<typename tree_t, typename graph_t, typename T>
+    double dasgupta_cost(const tree_t &tree,
+                         const graph_t &leaf_graph,
+                         const xt::xexpression<T> &xedge_weights) {
+        return dasgupta_cost(tree, leaf_graph, xedge_weights, attribute_area(tree));
+    }
+
+    /**
+     * Tree sampling divergence is an unsupervised measure of the quality of a hierarchical clustering of an
+     * edge weighted graph.
+     * It measures how well the given edge weighted graph can be reconstructed from the tree alone.
+     * It is equal to 0 if and only if the given graph can be fully recovered from the tree.
+     *
+     * It is defined as the Kullback-Leibler divergence between the edge sampling model :math:`p` and the independent
+     * (null) sampling model :math:`q` of the nodes of a tree (see attribute_tree_sampling_probability):
+     *
+     * .. math::
+     *
+     *     TSD(T) = \sum_{x \in T} p(x) \log\frac{p(x)}{q(x)}
+     *
+     * Charpentier, B. & Bonald, T. (2019). "Tree Sampling Divergence: An Information-Theoretic Metric for
+     * Hierarchical Graph Clustering." Proceedings of IJCAI.
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T xexpression derived type of xedge_weights
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (similarities)
+     * @return a real number
+     */
+    template<typename tree_t, typename graph_t, typename T>
+    double tree_sampling_divergence(const tree_t &tree,
+                                    const graph_t &leaf_graph,
+                                    const xt::xexpression<T> &xedge_weights) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        auto p = attribute_tree_sampling_probability(tree, leaf_graph, edge_weights, tree_sampling_model::edge);
+        auto q = attribute_tree_sampling_probability(tree, leaf_graph, edge_weights, tree_sampling_model::null);
+
+        double res = 0;
+        for (index_t n = num_leaves(tree); n < (index_t) num_vertices(tree); n++) {
+            if (p(n) != 0) {
+                res += p(n) * std::log(p(n) / q(n));
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Estimation of the Dasgupta's cost (see dasgupta_cost) from a sample of edges of the leaf graph.
+     *
+     * Edges are sampled with replacement:
+     *
+     *  - with the uniform strategy, each edge has the same probability: the estimator is the number of edges times
+     *    the mean of :math:`area(lca_T(x,y)) / w(\{x,y\})` over the sampled edges; and
+     *  - with the importance strategy, the probability of an edge is proportional to the inverse of its weight: the
+     *    estimator is :math:`\sum_{e\in E}1/w(e)` times the mean area of the lowest common ancestors of the sampled
+     *    edges (its variance is smaller when the area varies less than the inverse of the edge weights).
+     *
+     * Both estimators are unbiased, the confidence interval relies on the normal approximation.
+     * Edges are sampled and their lowest common ancestors are computed in parallel on large samples: the result only
+     * depends on the seed. The cost of the estimation is dominated by the preprocessing of the tree for the lowest
+     * common ancestor queries. The importance strategy additionally requires a pass over all the edge weights (to
+     * build the cumulative sums of their inverses) on each call: it is linear in the number of edges, whereas the
+     * uniform strategy (the default) does not depend on the number of edges.
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T1 xexpression derived type of xedge_weights
+     * @tparam T2 xexpression derived type of xarea
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (dissimilarities)
+     * @param xarea area of the nodes of the tree
+     * @param num_samples number of sampled edges (at least 2)
+     * @param sampling edge sampling strategy
+     * @param confidence confidence level of the confidence interval
+     * @param seed seed of the random generators
+     * @return a hierarchical_cost_estimate
+     */
+    template<typename tree_t, typename graph_t, typename T1, typename T2>
+    auto estimate_dasgupta_cost(const tree_t &tree,
+                                const graph_t &leaf_graph,
+                                const xt::xexpression<T1> &xedge_weights,
+                                const xt::xexpression<T2> &xarea,
+                                index_t num_samples,
+                                edge_sampling sampling = edge_sampling::uniform,
+                                double confidence = 0.95,
+                                std::uint64_t seed = 42) {
+        HG_TRACE();
+        using namespace hierarchical_cost_internal;
+        auto &edge_weights = xedge_weights.derived_cast();
+        auto &area = xarea.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        hg_assert_node_weights(tree, area);
+        hg_assert_1d_array(area);
+        hg_assert((index_t) num_vertices(leaf_graph) == (index_t) num_leaves(tree),
+                  "The number of vertices of the leaf graph does not match the number of leaves of the tree.");
+        hg_assert(num_samples >= 2, "The number of samples must be at least 2.");
+        const index_t num_e = num_edges(leaf_graph);
+        hg_assert(num_e > 0, "The leaf graph must have at least one edge.");
+
+        lca_internal::lca_fast<tree_t> lca(tree);
+        std::vector<double> psi(num_samples);
+        auto lca_area = [&](index_t i) {
+            const auto &e = edge_from_index(i, leaf_graph);
+            return (double) area(lca.lca(source(e, leaf_graph), target(e, leaf_graph)));
+        };
+        if (sampling == edge_sampling::uniform) {
+            for_each_sample_block(num_samples, seed, use_parallel(num_samples, sampling_parallel_min_size),
+                                  [&](std::mt19937_64 &generator, index_t first, index_t last) {
+                                      std::uniform_int_distribution<index_t> distribution(0, num_e - 1);
+                                      for (index_t s = first; s < last; s++) {
+                                          auto i = distribution(generator);
+                                          psi[s] = num_e * lca_area(i) / (double) edge_weights(i);
+                                      }
+                                  });
+        } else {
+            discrete_sampler sampler(num_e, [&edge_weights](index_t i) { return 1.0 / edge_weights(i); });
+            for_each_sample_block(num_samples, seed, use_parallel(num_samples, sampling_parallel_min_size),
+                                  [&](std::mt19937_64 &generator, index_t first, index_t last) {
+                                      for (index_t s = first; s < last; s++) {
+                                          psi[s] = sampler.total() * lca_area(sampler(generator));
+                                      }
+                                  });
+        }
+        double value = 0;
+        for (auto v: psi) {
+            value += v;
+        }
+        return make_estimate(value / num_samples, psi, confidence);
+    }
+
+    /**
+     * Estimation of the tree sampling divergence (see tree_sampling_divergence) from a sample of edges of the leaf
+     * graph.
+     *
+     * The edge sampling probability :math:`p` of the nodes of the tree is estimated from the lowest common ancestors
+     * of the sampled edges, weighted by the ratio between the probability of the edge in the edge model and its
+     * sampling probability; the null model :math:`q` is computed exactly (it only requires the weighted degrees of the
+     * vertices, no lowest common ancestor query). The estimator is then :math:`\sum_{x} \hat{p}(x)
+     * \log(\hat{p}(x) / q(x))`.
+     *
+     * Edges are sampled with replacement, either uniformly or with a probability proportional to their weight
+     * (importance strategy, the edge model itself). This plug-in estimator is consistent but biased for small
+     * samples; its standard error and its confidence interval are obtained with the delta method.
+     * Edges are sampled and their lowest common ancestors are computed in parallel on large samples: the result only
+     * depends on the seed.
+     *
+     * Whatever the sampling strategy, the estimation requires a pass over all the edges of the leaf graph to compute
+     * the null model q (weighted degrees of the vertices), plus another one to compute the total weight of the edges
+     * (uniform strategy) or to build the cumulative sums of the edge weights (importance strategy): its cost is
+     * linear in the number of edges and only the lowest common ancestor queries are replaced by samples.
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T xexpression derived type of xedge_weights
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (similarities)
+     * @param num_samples number of sampled edges (at least 2)
+     * @param sampling edge sampling strategy
+     * @param confidence confidence level of the confidence interval
+     * @param seed seed of the random generators
+     * @return a hierarchical_cost_estimate
+     */
+    template<typename tree_t, typename graph_t, typename T>
+    auto estimate_tree_sampling_divergence(const tree_t &tree,
+                                           const graph_t &leaf_graph,
+                                           const xt::xexpression<T> &xedge_weights,
+                                           index_t num_samples,
+                                           edge_sampling sampling = edge_sampling::uniform,
+                                           double confidence = 0.95,
+                                           std::uint64_t seed = 42) {
+        HG_TRACE();
+        using namespace hierarchical_cost_internal;
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        hg_assert((index_t) num_vertices(leaf_graph) == (index_t) num_leaves(tree),
+                  "The number of vertices of the leaf graph does not match the number of leaves of the tree.");
+        hg_assert(num_samples >= 2, "The number of samples must be at least 2.");
+        const index_t num_e = num_edges(leaf_graph);
+        hg_assert(num_e > 0, "The leaf graph must have at least one edge.");
+
+        auto q = attribute_tree_sampling_probability(tree, leaf_graph, edge_weights, tree_sampling_model::null);
+        lca_internal::lca_fast<tree_t> lca(tree);
+
+        // lowest common ancestor and weight of each sample
+        std::vector<index_t> sample_lca(num_samples);
+        std::vector<double> sample_weight(num_samples);
+        auto draw = [&](index_t s, index_t i, double weight) {
+            const auto &e = edge_from_index(i, leaf_graph);
+            sample_lca[s] = lca.lca(source(e, leaf_graph), target(e, leaf_graph));
+            sample_weight[s] = weight;
+        };
+        if (sampling == edge_sampling::uniform) {
+            double total = std::accumulate(edge_weights.begin(), edge_weights.end(), 0.0);
+            for_each_sample_block(num_samples, seed, use_parallel(num_samples, sampling_parallel_min_size),
+                                  [&](std::mt19937_64 &generator, index_t first, index_t last) {
+                                      std::uniform_int_distribution<index_t> distribution(0, num_e - 1);
+                                      for (index_t s = first; s < last; s++) {
+                                          auto i = distribution(generator);
+                                          draw(s, i, num_e * (double) edge_weights(i) / total);
+                                      }
+                                  });
+        } else {
+            discrete_sampler sampler(num_e, [&edge_weights](index_t i) { return (double) edge_weights(i); });
+            for_each_sample_block(num_samples, seed, use_parallel(num_samples, sampling_parallel_min_size),
+                                  [&](std::mt19937_64 &generator, index_t first, index_t last) {
+                                      for (index_t s = first; s < last; s++) {
+                                          draw(s, sampler(generator), 1);
+                                      }
+                                  });
+        }
+
+        array_1d<double> p = xt::zeros<double>({num_vertices(tree)});
+        for (index_t s = 0; s < num_samples; s++) {
+            p(sample_lca[s]) += sample_weight[s] / num_samples;
+        }
+
+        double value = 0;
+        std::vector<double> psi(num_samples);
+        for (index_t s = 0; s < num_samples; s++) {
+            if (sample_weight[s] != 0) {
+                double log_ratio = std::log(p(sample_lca[s]) / q(sample_lca[s]));
+                value += sample_weight[s] * log_ratio;
+                psi[s] = sample_weight[s] * (log_ratio + 1);
+            } else {
+                psi[s] = 0;
+            }
+        }
+        return make_estimate(value / num_samples, psi, confidence);
+    }
+
+    /**
+     * Estimation of the dendrogram purity (see dendrogram_purity) from a sample of pairs of leaves.
+     *
+     * Pairs of distinct leaves with the same label are sampled uniformly with replacement (a label is drawn with a
+     * probability proportional to its number of pairs, then a pair of leaves of this label): the estimator is the mean
+     * purity of the lowest common ancestors of the sampled pairs with respect to their label. It is unbiased and the
+     * confidence interval relies on the normal approximation.
+     *
+     * The purity of a node for a label is obtained by counting the leaves of the label in the interval of the node
+     * in a depth first ordering of the leaves (see attribute_leaf_ordering) with binary searches: the label histograms
+     * of the nodes are never computed. Pairs are sampled and their lowest common ancestors are computed in parallel on
+     * large samples: the result only depends on the seed.
+     *
+     * @tparam tree_t tree type
+     * @tparam T xexpression derived type of xleaf_labels
+     * @param tree input tree
+     * @param xleaf_labels must be a 1d array with values in [0, max_label], at least one label must be associated to
+     * two leaves or more
+     * @param num_samples number of sampled pairs (at least 2)
+     * @param confidence confidence level of the confidence interval
+     * @param seed seed of the random generators
+     * @return a hierarchical_cost_estimate
+     */
+    template<typename tree_t, typename T>
+    auto estimate_dendrogram_purity(const tree_t &tree,
+                                    const xt::xexpression<T> &xleaf_labels,
+                                    index_t num_samples,
+                                    double confidence = 0.95,
+                                    std::uint64_t seed = 42) {
+        HG_TRACE();
+        using namespace hierarchical_cost_internal;
+        auto &leaf_labels = xleaf_labels.derived_cast();
+        hg_assert_1d_array(leaf_labels);
+        hg_assert_leaf_weights(tree, leaf_labels);
+        hg_assert_integral_value_type(leaf_labels);
+        hg_assert(num_samples >= 2, "The number of samples must be at least 2.");
+        const index_t num_l = num_leaves(tree);
+
+        // ranks of the leaves of each label in the depth first ordering, in increasing order
+        auto ordering = attribute_leaf_ordering(tree);
+        const index_t num_labels = (index_t) xt::amax(leaf_labels)() + 1;
+        std::vector<index_t> label_begin(num_labels + 1, 0);
+        for (index_t i = 0; i < num_l; i++) {
+            label_begin[leaf_labels(i) + 1]++;
+        }
+        for (index_t k = 0; k < num_labels; k++) {
+            label_begin[k + 1] += label_begin[k];
+        }
+        std::vector<index_t> label_ranks(num_l);
+        {
+            std::vector<index_t> position(label_begin.begin(), label_begin.end() - 1);
+            for (index_t r = 0; r < num_l; r++) {
+                auto l = ordering.leaves(r);
+                label_ranks[position[leaf_labels(l)]++] = r;
+            }
+        }
+
+        bool has_pair = false;
+        for (index_t k = 0; k < num_labels && !has_pair; k++) {
+            has_pair = label_begin[k + 1] - label_begin[k] >= 2;
+        }
+        hg_assert(has_pair, "At least one label must be associated to two leaves or more.");
+        discrete_sampler sampler(num_labels, [&label_begin](index_t k) {
+            double n = (double) (label_begin[k + 1] - label_begin[k]);
+            return n * (n - 1) / 2;
+        });
+        lca_internal::lca_fast<tree_t> lca(tree);
+
+        std::vector<double> psi(num_samples);
+        for_each_sample_block(num_samples, seed, use_parallel(num_samples, sampling_parallel_min_size),
+                              [&](std::mt19937_64 &generator, index_t first, index_t last) {
+                                  for (index_t s = first; s < last; s++) {
+                                      auto k = sampler(generator);
+                                      auto ranks_begin = label_ranks.begin() + label_begin[k];
+                                      auto ranks_end = label_ranks.begin() + label_begin[k + 1];
+                                      const index_t size = ranks_end - ranks_begin;
+                                      std::uniform_int_distribution<index_t> distribution1(0, size - 1);
+                                      std::uniform_int_distribution<index_t> distribution2(0, size - 2);
+                                      auto i = distribution1(generator);
+                                      auto j = distribution2(generator);
+                                      if (j >= i) {
+                                          j++;
+                                      }
+                                      auto n = lca.lca(ordering.leaves(ranks_begin[i]),
+                                                       ordering.leaves(ranks_begin[j]));
+                                      auto count = std::lower_bound(ranks_begin, ranks_end, ordering.end(n)) -
+                                                   std::lower_bound(ranks_begin, ranks_end, ordering.begin(n));
+                                      psi[s] = (double) count / (double) ordering.num_leaves(n);
+                                  }
+                              });
+        double value = 0;
+        for (auto v: psi) {
+            value += v;
+        }
+        return make_estimate(value / num_samples, psi, confidence);
+    }
+}
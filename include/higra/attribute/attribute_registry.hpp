@@ -0,0 +1,352 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include "tree_attribute.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hg {
+
+    namespace attribute_registry_internal {
+
+        /**
+         * Number of bytes used by an array (or by an object of any other type).
+         */
+        template<typename T>
+        auto memory_size(const T &value, int) -> decltype(value.size() * sizeof(typename T::value_type)) {
+            return value.size() * sizeof(typename T::value_type);
+        }
+
+        template<typename T>
+        std::size_t memory_size(const T &, long) {
+            return sizeof(T);
+        }
+
+        /**
+         * Value of an attribute with its type erased.
+         */
+        struct erased_value {
+            std::shared_ptr<const void> value;
+            std::size_t memory_size;
+        };
+    }
+
+    /**
+     * Lazy and shared computation of the attributes of a tree.
+     *
+     * An attribute is declared with a name, the names of the attributes it depends on, its type and a function that
+     * computes it from the tree and the registry (the function obtains the values of its dependencies with get).
+     * An attribute is computed the first time it is requested and its value is cached for subsequent requests,
+     * directly or through other attributes: for example, the area is computed once for the volume and the mean
+     * vertex weights.
+     *
+     * Inputs (for example the altitudes of the nodes) are attributes whose value is given with set_input: changing an
+     * input discards the cached values of all the attributes that depend on it, directly or indirectly.
+     *
+     * Values are returned as shared pointers: discarding a value from the registry does not invalidate the pointers
+     * held by the caller and the registry does not keep alive the values it has discarded. When the memory used by
+     * the cached values (inputs excluded) exceeds the memory budget of the registry, the least recently used values
+     * are discarded: they will be recomputed if they are requested again.
+     *
+     * The registry holds a reference to the tree: the tree must outlive the registry.
+     *
+     * The following attributes are declared by default:
+     *
+     *  - "area" (array_1d<double>): area of the nodes, depends on the optional input "vertex_area"
+     *    (array_1d<double>, area of the leaves, 1 by default);
+     *  - "depth" (array_1d<index_t>): depth of the nodes;
+     *  - "volume" (array_1d<double>): volume of the nodes, depends on the input "altitudes" (array_1d<double>)
+     *    and on "area";
+     *  - "mean_vertex_weights" (array_nd<double>): mean weight of the leaves of the nodes weighted by their area,
+     *    depends on the input "vertex_weights" (array_1d<double> or array_nd<double>, weights of the leaves) and on
+     *    "area".
+     *
+     * @tparam tree_t tree type
+     */
+    template<typename tree_t>
+    struct tree_attribute_registry {
+
+        using self_type = tree_attribute_registry<tree_t>;
+
+        tree_attribute_registry(const tree_t &tree,
+                                std::size_t memory_budget = (std::numeric_limits<std::size_t>::max)()) :
+                m_tree(tree),
+                m_memory_budget(memory_budget) {
+            declare_default_attributes();
+        }
+
+        const tree_t &tree() const {
+            return m_tree;
+        }
+
+        /**
+         * Declares (or replaces) the attribute name of type T: fun(tree, registry) must return its value.
+         * The cached values of the attributes depending on name are discarded.
+         */
+        template<typename T, typename fun_t>
+        void declare(const std::string &name, const std::vector<std::string> &dependencies, const fun_t &fun) {
+            auto &e = m_entries[name];
+            if (e.compute) {
+                discard(e);
+            } else {
+                e.value.reset();
+            }
+            invalidate_dependents(name);
+            e.dependencies = dependencies;
+            e.type = std::type_index(typeid(T));
+            e.compute = [fun](self_type &registry) {
+                auto value = std::make_shared<const T>(fun(registry.tree(), registry));
+                return attribute_registry_internal::erased_value{
+                        value, attribute_registry_internal::memory_size(*value, 0)};
+            };
+        }
+
+        /**
+         * Sets the value of the input name. The cached values of the attributes depending on name are discarded.
+         */
+        template<typename T>
+        void set_input(const std::string &name, T value) {
+            auto &e = m_entries[name];
+            hg_assert(!e.compute, "Cannot set the value of the computed attribute '" + name + "'.");
+            e.type = std::type_index(typeid(T));
+            e.value = std::make_shared<const T>(std::move(value));
+            invalidate_dependents(name);
+        }
+
+        /**
+         * Value of the attribute name: the attribute (and its dependencies) are computed if needed.
+         */
+        template<typename T>
+        std::shared_ptr<const T> get(const std::string &name) {
+            auto it = m_entries.find(name);
+            hg_assert(it != m_entries.end(), "Unknown attribute '" + name + "'.");
+            auto &e = it->second;
+            hg_assert(e.type == std::type_index(typeid(T)), "Wrong type requested for attribute '" + name + "'.");
+            if (!e.value) {
+                hg_assert(e.compute, "The input '" + name + "' has not been set.");
+                hg_assert(!e.computing, "Cyclic dependency on attribute '" + name + "'.");
+                e.computing = true;
+                attribute_registry_internal::erased_value value;
+                try {
+                    value = e.compute(*this);
+                } catch (...) {
+                    e.computing = false;
+                    throw;
+                }
+                e.computing = false;
+                e.value = value.value;
+                e.memory_size = value.memory_size;
+                m_memory_usage += value.memory_size;
+                enforce_memory_budget(name);
+            }
+            e.last_access = ++m_clock;
+            return std::static_pointer_cast<const T>(e.value);
+        }
+
+        /**
+         * True if name is a declared attribute or an input that has been set.
+         */
+        bool contains(const std::string &name) const {
+            auto it = m_entries.find(name);
+            return it != m_entries.end() && (it->second.compute || it->second.value);
+        }
+
+        /**
+         * True if the value of name is available without computation.
+         */
+        bool is_cached(const std::string &name) const {
+            auto it = m_entries.find(name);
+            return it != m_entries.end() && it->second.value;
+        }
+
+        /**
+         * Type of the attribute name.
+         */
+        std::type_index type(const std::string &name) const {
+            auto it = m_entries.find(name);
+            hg_assert(it != m_entries.end(), "Unknown attribute '" + name + "'.");
+            return it->second.type;
+        }
+
+        /**
+         * Discards the cached value of the computed attribute name (inputs are never discarded).
+         */
+        void evict(const std::string &name) {
+            auto it = m_entries.find(name);
+            if (it != m_entries.end()) {
+                discard(it->second);
+            }
+        }
+
+        /**
+         * Discards the cached values of all the computed attributes.
+         */
+        void clear() {
+            for (auto &e: m_entries) {
+                discard(e.second);
+            }
+        }
+
+        /**
+         * Number of bytes used by the cached values of the computed attributes.
+         */
+        std::size_t memory_usage() const {
+            return m_memory_usage;
+        }
+
+        std::size_t memory_budget() const {
+            return m_memory_budget;
+        }
+
+        void set_memory_budget(std::size_t memory_budget) {
+            m_memory_budget = memory_budget;
+            enforce_memory_budget("");
+        }
+
+    private:
+
+        struct entry {
+            std::vector<std::string> dependencies;
+            std::function<attribute_registry_internal::erased_value(self_type &)> compute;
+            std::type_index type = std::type_index(typeid(void));
+            std::shared_ptr<const void> value;
+            std::size_t memory_size = 0;
+            std::size_t last_access = 0;
+            bool computing = false;
+        };
+
+        void discard(entry &e) {
+            if (e.compute && e.value) {
+                e.value.reset();
+                m_memory_usage -= e.memory_size;
+                e.memory_size = 0;
+            }
+        }
+
+        /**
+         * Discards the cached values of all the attributes depending on name, directly or indirectly. The dependency
+         * graph is walked whatever the cache state of the intermediate attributes: an attribute may still be cached
+         * while one of its dependencies has been evicted.
+         */
+        void invalidate_dependents(const std::string &name) {
+            std::vector<std::string> stack{name};
+            std::unordered_set<std::string> visited{name};
+            while (!stack.empty()) {
+                auto current = std::move(stack.back());
+                stack.pop_back();
+                for (auto &e: m_entries) {
+                    if (visited.count(e.first) == 0 &&
+                        std::find(e.second.dependencies.begin(), e.second.dependencies.end(), current) !=
+                        e.second.dependencies.end()) {
+                        discard(e.second);
+                        visited.insert(e.first);
+                        stack.push_back(e.first);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Discards the least recently used computed values (except the value of keep) until the memory usage is
+         * below the memory budget.
+         */
+        void enforce_memory_budget(const std::string &keep) {
+            while (m_memory_usage > m_memory_budget) {
+                entry *lru = nullptr;
+                for (auto &e: m_entries) {
+                    if (e.second.compute && e.second.value && e.first != keep &&
+                        (lru == nullptr || e.second.last_access < lru->last_access)) {
+                        lru = &e.second;
+                    }
+                }
+                if (lru == nullptr) {
+                    break;
+                }
+                discard(*lru);
+            }
+        }
+
+        void declare_default_attributes() {
+            declare<array_1d<double>>("area", {"vertex_area"}, [](const tree_t &t, self_type &registry) {
+                if (registry.contains("vertex_area")) {
+                    return array_1d<double>(attribute_area(t, *registry.template get<array_1d<double>>("vertex_area")));
+                }
+                return array_1d<double>(attribute_area(t, xt::ones<double>({num_leaves(t)})));
+            });
+
+            declare<array_1d<index_t>>("depth", {}, [](const tree_t &t, self_type &) {
+                return attribute_depth(t);
+            });
+
+            declare<array_1d<double>>("volume", {"altitudes", "area"}, [](const tree_t &t, self_type &registry) {
+                auto altitudes = registry.template get<array_1d<double>>("altitudes");
+                auto area = registry.template get<array_1d<double>>("area");
+                return attribute_volume(t, *altitudes, *area);
+            });
+
+            declare<array_nd<double>>("mean_vertex_weights", {"vertex_weights", "area"},
+                                      [](const tree_t &t, self_type &registry) {
+                                          auto area = registry.template get<array_1d<double>>("area");
+                                          if (registry.type("vertex_weights") ==
+                                              std::type_index(typeid(array_1d<double>))) {
+                                              return mean_vertex_weights(
+                                                      t, *registry.template get<array_1d<double>>("vertex_weights"),
+                                                      *area);
+                                          }
+                                          return mean_vertex_weights(
+                                                  t, *registry.template get<array_nd<double>>("vertex_weights"),
+                                                  *area);
+                                      });
+        }
+
+        template<typename T>
+        static array_nd<double> mean_vertex_weights(const tree_t &t, const T &vertex_weights,
+                                                    const array_1d<double> &area) {
+            array_nd<double> weighted = vertex_weights;
+            index_t row_size = (index_t) weighted.size() / num_leaves(t);
+            for (index_t i = 0; i < (index_t) num_leaves(t); i++) {
+                for (index_t j = 0; j < row_size; j++) {
+                    weighted.data()[i * row_size + j] *= area(i);
+                }
+            }
+            array_nd<double> res = accumulate_sequential(t, weighted, accumulator_sum());
+            for (index_t i = 0; i < (index_t) num_vertices(t); i++) {
+                for (index_t j = 0; j < row_size; j++) {
+                    res.data()[i * row_size + j] /= area(i);
+                }
+            }
+            return res;
+        }
+
+        const tree_t &m_tree;
+        std::unordered_map<std::string, entry> m_entries;
+        std::size_t m_memory_usage = 0;
+        std::size_t m_memory_budget;
+        std::size_t m_clock = 0;
+    };
+
+    /**
+     * Creates an attribute registry for the given tree (see tree_attribute_registry).
+     */
+    template<typename tree_t>
+    auto make_tree_attribute_registry(const tree_t &tree,
+                                      std::size_t memory_budget = (std::numeric_limits<std::size_t>::max)()) {
+        return tree_attribute_registry<tree_t>(tree, memory_budget);
+    }
+}
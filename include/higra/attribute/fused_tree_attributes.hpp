@@ -0,0 +1,540 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include "../graph.hpp"
+#include "../accumulator/accumulator.hpp"
+#include "../structure/embedding.hpp"
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+namespace hg {
+
+    /*
+     * Fused attribute computation: several attributes of the nodes of a tree computed with a single traversal.
+     *
+     * An attribute is described by a component type providing:
+     *
+     *  - value_type: type of the attribute values;
+     *  - std::vector<size_t> shape() const: shape of the attribute value of a node (empty for a scalar attribute);
+     *  - static const bool top_down: false if the attribute of a node is computed from the attributes of its children,
+     *    true if it is computed from the attribute of its parent;
+     *  - void prepare(const tree_t & tree): called once before the traversal;
+     *  - void initialize(index_t n, value_type * row): computes the attribute of a leaf (bottom-up attributes)
+     *    or of the root (top-down attributes);
+     *  - void process(const tree_t & tree, index_t n, value_type * row, const value_type * rows, index_t row_size):
+     *    computes the attribute of any other node n, the attribute of a node m being stored in
+     *    rows[m * row_size], ..., rows[(m + 1) * row_size - 1].
+     */
+
+    namespace fused_tree_attributes_internal {
+
+        /**
+         * Contiguous range used as the storage of a standard accumulator.
+         */
+        template<typename T>
+        struct row_range {
+            using value_type = T;
+
+            T *m_begin;
+            T *m_end;
+
+            T *begin() const {
+                return m_begin;
+            }
+
+            T *end() const {
+                return m_end;
+            }
+        };
+
+        inline
+        index_t row_size(const std::vector<size_t> &shape) {
+            index_t size = 1;
+            for (auto s: shape) {
+                size *= s;
+            }
+            return size;
+        }
+
+        template<typename component_t>
+        auto make_output(const component_t &component, size_t num_nodes) {
+            std::vector<size_t> shape = component.shape();
+            shape.insert(shape.begin(), num_nodes);
+            return array_nd<typename component_t::value_type>::from_shape(shape);
+        }
+
+        template<typename F, typename tuple1_t, typename tuple2_t, std::size_t... I>
+        void for_each_pair(F &&fun, tuple1_t &tuple1, tuple2_t &tuple2, std::index_sequence<I...>) {
+            int dummy[] = {0, (fun(std::get<I>(tuple1), std::get<I>(tuple2)), 0)...};
+            (void) dummy;
+        }
+
+        /**
+         * Calls fun(c, o) for each component c of the tuple components and its output o.
+         */
+        template<typename F, typename... components_t, typename... outputs_t>
+        void for_each_component(F &&fun, std::tuple<components_t...> &components,
+                                std::tuple<outputs_t...> &outputs) {
+            for_each_pair(std::forward<F>(fun), components, outputs, std::index_sequence_for<components_t...>());
+        }
+
+        template<typename component_t>
+        using is_top_down = std::integral_constant<bool, component_t::top_down>;
+
+        template<typename... components_t>
+        struct any_top_down;
+
+        template<>
+        struct any_top_down<> : std::false_type {
+        };
+
+        template<typename component_t, typename... components_t>
+        struct any_top_down<component_t, components_t...> : std::integral_constant<bool,
+                component_t::top_down || any_top_down<components_t...>::value> {
+        };
+
+        template<typename... components_t>
+        struct any_bottom_up;
+
+        template<>
+        struct any_bottom_up<> : std::false_type {
+        };
+
+        template<typename component_t, typename... components_t>
+        struct any_bottom_up<component_t, components_t...> : std::integral_constant<bool,
+                !component_t::top_down || any_bottom_up<components_t...>::value> {
+        };
+
+        template<typename component_t, typename output_t>
+        void initialize_node(component_t &component, output_t &output, index_t n, bool top_down) {
+            if (component_t::top_down == top_down) {
+                auto size = (index_t) (output.size() / output.shape()[0]);
+                component.initialize(n, output.data() + n * size);
+            }
+        }
+
+        template<typename tree_t, typename component_t, typename output_t>
+        void process_node(const tree_t &tree, component_t &component, output_t &output, index_t n, bool top_down) {
+            if (component_t::top_down == top_down) {
+                auto size = (index_t) (output.size() / output.shape()[0]);
+                component.process(tree, n, output.data() + n * size, output.data(), size);
+            }
+        }
+    }
+
+    /**
+     * Area of the nodes of a tree: sum of the area of the leaves of the sub-tree rooted in the node
+     * (same as attribute_area).
+     *
+     * The component holds a reference to the leaf area: the array must outlive the component.
+     *
+     * @tparam T type of the leaf area array
+     */
+    template<typename T = array_1d<double>>
+    struct fused_area {
+        using value_type = double;
+        static const bool top_down = false;
+
+        /**
+         * All leaves have an area equal to one.
+         */
+        fused_area() {
+        }
+
+        fused_area(const T &leaf_area) : m_leaf_area(&leaf_area) {
+        }
+
+        std::vector<size_t> shape() const {
+            return {};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            if (m_leaf_area != nullptr) {
+                const auto &leaf_area = *m_leaf_area;
+                hg_assert_leaf_weights(tree, leaf_area);
+                hg_assert_1d_array(leaf_area);
+            }
+        }
+
+        void initialize(index_t n, value_type *row) const {
+            *row = (m_leaf_area == nullptr) ? 1 : (value_type) (*m_leaf_area)(n);
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) const {
+            value_type sum = 0;
+            for (auto c: children_iterator(n, tree)) {
+                sum += rows[c];
+            }
+            *row = sum;
+        }
+
+    private:
+        // nullptr if all leaves have an area equal to one
+        const T *m_leaf_area = nullptr;
+    };
+
+    /**
+     * Volume of the nodes of a tree (same as attribute_volume):
+     *    volume(n) = abs(altitude(n) - altitude(parent(n)) * area(n) + sum_{c in children(n, t)} volume(c)
+     * with volume(l) = 0 for any leaf l.
+     *
+     * The area of the nodes is computed with the volume, from the given leaf area.
+     *
+     * The component holds references to the node altitude and to the leaf area: the arrays must outlive the
+     * component.
+     *
+     * @tparam T1 type of the node altitude array
+     * @tparam T2 type of the leaf area array
+     */
+    template<typename T1, typename T2 = array_1d<double>>
+    struct fused_volume {
+        using value_type = double;
+        static const bool top_down = false;
+
+        /**
+         * All leaves have an area equal to one.
+         */
+        fused_volume(const T1 &node_altitude) : m_node_altitude(node_altitude) {
+        }
+
+        fused_volume(const T1 &node_altitude, const T2 &leaf_area) :
+                m_node_altitude(node_altitude), m_leaf_area(&leaf_area) {
+        }
+
+        std::vector<size_t> shape() const {
+            return {};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            hg_assert_node_weights(tree, m_node_altitude);
+            hg_assert_1d_array(m_node_altitude);
+            if (m_leaf_area != nullptr) {
+                const auto &leaf_area = *m_leaf_area;
+                hg_assert_leaf_weights(tree, leaf_area);
+                hg_assert_1d_array(leaf_area);
+            }
+            m_parents = parents(tree).data();
+            m_area.resize(num_vertices(tree));
+        }
+
+        void initialize(index_t n, value_type *row) {
+            m_area[n] = (m_leaf_area == nullptr) ? 1 : (double) (*m_leaf_area)(n);
+            *row = 0;
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) {
+            double area = 0;
+            double volume = 0;
+            for (auto c: children_iterator(n, tree)) {
+                area += m_area[c];
+                volume += rows[c];
+            }
+            m_area[n] = area;
+            *row = std::fabs((double) m_node_altitude(n) - (double) m_node_altitude(m_parents[n])) * area + volume;
+        }
+
+    private:
+        const T1 &m_node_altitude;
+        // nullptr if all leaves have an area equal to one
+        const T2 *m_leaf_area = nullptr;
+        const index_t *m_parents = nullptr;
+        std::vector<double> m_area;
+    };
+
+    /**
+     * Depth of the nodes of a tree: number of ancestors of the node (same as attribute_depth).
+     */
+    struct fused_depth {
+        using value_type = index_t;
+        static const bool top_down = true;
+
+        std::vector<size_t> shape() const {
+            return {};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &) {
+        }
+
+        void initialize(index_t, value_type *row) const {
+            *row = 0;
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) const {
+            *row = rows[parent(n, tree)] + 1;
+        }
+    };
+
+    /**
+     * Accumulation of leaf data with a standard accumulator (same as accumulate_sequential).
+     *
+     * The leaf data must be stored in a contiguous row major container and the accumulator output shape must
+     * be equal to the shape of the leaf data (accumulator_counter, accumulator_argmin and accumulator_argmax
+     * are not supported).
+     *
+     * The component holds a reference to the leaf data: the array must outlive the component.
+     *
+     * @tparam T type of the leaf data array
+     * @tparam accumulator_t standard accumulator type (accumulator_sum, accumulator_min...)
+     */
+    template<typename T, typename accumulator_t>
+    struct fused_accumulator {
+        using value_type = typename T::value_type;
+        static const bool top_down = false;
+
+        fused_accumulator(const T &leaf_data, const accumulator_t &accumulator = accumulator_t()) :
+                m_leaf_data(leaf_data), m_accumulator(accumulator) {
+        }
+
+        std::vector<size_t> shape() const {
+            std::vector<size_t> data_shape(m_leaf_data.shape().begin() + 1, m_leaf_data.shape().end());
+            auto output_shape = accumulator_t::get_output_shape(data_shape);
+            return std::vector<size_t>(output_shape.begin(), output_shape.end());
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            hg_assert_leaf_weights(tree, m_leaf_data);
+            hg_assert(fused_tree_attributes_internal::row_size(shape()) ==
+                      (index_t) (m_leaf_data.size() / m_leaf_data.shape()[0]),
+                      "The accumulator output shape must be equal to the shape of the leaf data.");
+        }
+
+        void initialize(index_t n, value_type *row) const {
+            auto size = (index_t) (m_leaf_data.size() / m_leaf_data.shape()[0]);
+            auto data = m_leaf_data.data() + n * size;
+            std::copy(data, data + size, row);
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t row_size) const {
+            fused_tree_attributes_internal::row_range<value_type> storage{row, row + row_size};
+            auto acc = m_accumulator.template make_accumulator<true>(storage);
+            acc.initialize();
+            for (auto c: children_iterator(n, tree)) {
+                acc.accumulate(rows + c * row_size);
+            }
+            acc.finalize();
+        }
+
+    private:
+        const T &m_leaf_data;
+        accumulator_t m_accumulator;
+    };
+
+    /**
+     * Mean of the weights of the leaves in each node: sum of the leaf weights multiplied by the leaf area in the node,
+     * divided by the area of the node.
+     *
+     * The leaf weights must be stored in a contiguous row major container. The component holds references to the
+     * leaf weights and to the leaf area: the arrays must outlive the component.
+     *
+     * @tparam T1 type of the leaf weights array
+     * @tparam T2 type of the leaf area array
+     */
+    template<typename T1, typename T2 = array_1d<double>>
+    struct fused_mean_vertex_weights {
+        using value_type = double;
+        static const bool top_down = false;
+
+        /**
+         * All leaves have an area equal to one.
+         */
+        fused_mean_vertex_weights(const T1 &leaf_weights) : m_leaf_weights(leaf_weights) {
+        }
+
+        fused_mean_vertex_weights(const T1 &leaf_weights, const T2 &leaf_area) :
+                m_leaf_weights(leaf_weights), m_leaf_area(&leaf_area) {
+        }
+
+        std::vector<size_t> shape() const {
+            return std::vector<size_t>(m_leaf_weights.shape().begin() + 1, m_leaf_weights.shape().end());
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            hg_assert_leaf_weights(tree, m_leaf_weights);
+            if (m_leaf_area != nullptr) {
+                const auto &leaf_area = *m_leaf_area;
+                hg_assert_leaf_weights(tree, leaf_area);
+                hg_assert_1d_array(leaf_area);
+            }
+            m_row_size = (index_t) (m_leaf_weights.size() / m_leaf_weights.shape()[0]);
+            m_area.resize(num_vertices(tree));
+        }
+
+        void initialize(index_t n, value_type *row) {
+            m_area[n] = (m_leaf_area == nullptr) ? 1 : (double) (*m_leaf_area)(n);
+            auto data = m_leaf_weights.data() + n * m_row_size;
+            for (index_t i = 0; i < m_row_size; i++) {
+                row[i] = (double) data[i];
+            }
+        }
+
+        /**
+         * The weighted sum of a child is recovered from its mean and its area: the sum is accumulated in the row of
+         * the node and divided in place.
+         */
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) {
+            std::fill(row, row + m_row_size, 0);
+            double area = 0;
+            for (auto c: children_iterator(n, tree)) {
+                area += m_area[c];
+                auto child_row = rows + c * m_row_size;
+                for (index_t i = 0; i < m_row_size; i++) {
+                    row[i] += child_row[i] * m_area[c];
+                }
+            }
+            m_area[n] = area;
+            for (index_t i = 0; i < m_row_size; i++) {
+                row[i] /= area;
+            }
+        }
+
+    private:
+        const T1 &m_leaf_weights;
+        // nullptr if all leaves have an area equal to one
+        const T2 *m_leaf_area = nullptr;
+        index_t m_row_size = 0;
+        std::vector<double> m_area;
+    };
+
+    /**
+     * Bounding box of the leaves of each node, the leaves being the points of a grid embedding.
+     *
+     * The bounding box of a node is an array of shape (2, dim): the first row contains the smallest coordinates and
+     * the second one the largest coordinates.
+     *
+     * @tparam dim dimension of the embedding
+     */
+    template<int dim>
+    struct fused_bounding_box {
+        using value_type = index_t;
+        static const bool top_down = false;
+
+        fused_bounding_box(const embedding_grid<dim> &embedding) : m_embedding(embedding) {
+        }
+
+        std::vector<size_t> shape() const {
+            return {2, (size_t) dim};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            hg_assert((index_t) num_leaves(tree) == (index_t) m_embedding.size(),
+                      "The number of leaves of the tree does not match the size of the embedding.");
+        }
+
+        void initialize(index_t n, value_type *row) const {
+            auto coordinates = m_embedding.lin2grid(n);
+            for (index_t i = 0; i < dim; i++) {
+                row[i] = coordinates(i);
+                row[dim + i] = coordinates(i);
+            }
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) const {
+            for (index_t i = 0; i < dim; i++) {
+                row[i] = (std::numeric_limits<value_type>::max)();
+                row[dim + i] = std::numeric_limits<value_type>::lowest();
+            }
+            for (auto c: children_iterator(n, tree)) {
+                auto child_row = rows + c * 2 * dim;
+                for (index_t i = 0; i < dim; i++) {
+                    row[i] = (std::min)(row[i], child_row[i]);
+                    row[dim + i] = (std::max)(row[dim + i], child_row[dim + i]);
+                }
+            }
+        }
+
+    private:
+        embedding_grid<dim> m_embedding;
+    };
+
+    /**
+     * Computes several attributes of the nodes of a tree with a single traversal of the tree.
+     *
+     * Each attribute is given by a component (fused_area, fused_volume, fused_depth, fused_accumulator,
+     * fused_mean_vertex_weights, fused_bounding_box, or any type satisfying the requirements described at the
+     * beginning of this file). All bottom-up attributes are computed during a single leaves to root traversal
+     * and all top-down attributes during a single root to leaves traversal.
+     *
+     * Example:
+     *
+     *     auto res = accumulate_attributes(tree, fused_area<>(), fused_depth(), make_fused_accumulator(data, accumulator_max()));
+     *     auto &area = std::get<0>(res);
+     *     auto &depth = std::get<1>(res);
+     *
+     * @tparam tree_t tree type
+     * @tparam components_t types of the attribute components
+     * @param tree input tree
+     * @param components attribute components
+     * @return a tuple containing an array for each attribute (with one row per node)
+     */
+    template<typename tree_t, typename... components_t>
+    auto accumulate_attributes(const tree_t &tree, components_t... components) {
+        HG_TRACE();
+        using namespace fused_tree_attributes_internal;
+        auto num_nodes = num_vertices(tree);
+
+        // outputs are shaped before the components are moved in the tuple
+        auto outputs = std::make_tuple(make_output(components, num_nodes)...);
+        std::tuple<components_t...> components_tuple(std::move(components)...);
+
+        for_each_component([&tree](auto &component, auto &) {
+            component.prepare(tree);
+        }, components_tuple, outputs);
+
+        if (any_bottom_up<components_t...>::value) {
+            for (auto n: leaves_iterator(tree)) {
+                for_each_component([n](auto &component, auto &output) {
+                    initialize_node(component, output, n, false);
+                }, components_tuple, outputs);
+            }
+            for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
+                for_each_component([&tree, n](auto &component, auto &output) {
+                    process_node(tree, component, output, n, false);
+                }, components_tuple, outputs);
+            }
+        }
+
+        if (any_top_down<components_t...>::value) {
+            auto r = root(tree);
+            for_each_component([r](auto &component, auto &output) {
+                initialize_node(component, output, r, true);
+            }, components_tuple, outputs);
+            for (auto n: root_to_leaves_iterator(tree, leaves_it::include, root_it::exclude)) {
+                for_each_component([&tree, n](auto &component, auto &output) {
+                    process_node(tree, component, output, n, true);
+                }, components_tuple, outputs);
+            }
+        }
+
+        return outputs;
+    }
+
+    /**
+     * Helper to create a fused_accumulator with template argument deduction.
+     */
+    template<typename T, typename accumulator_t>
+    auto make_fused_accumulator(const T &leaf_data, const accumulator_t &accumulator) {
+        return fused_accumulator<T, accumulator_t>(leaf_data, accumulator);
+    }
+}
@@ -0,0 +1,244 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include "fused_tree_attributes.hpp"
+#include <array>
+#include <cmath>
+
+namespace hg {
+
+    namespace image_moments_internal {
+
+        /**
+         * Eigen decomposition of a symmetric matrix with the cyclic Jacobi method.
+         *
+         * On return, a is diagonal (its diagonal contains the eigenvalues) and the columns of vectors are the
+         * corresponding unit eigenvectors.
+         */
+        template<int dim>
+        void symmetric_eigen(std::array<std::array<double, dim>, dim> &a,
+                             std::array<std::array<double, dim>, dim> &vectors) {
+            for (index_t i = 0; i < dim; i++) {
+                for (index_t j = 0; j < dim; j++) {
+                    vectors[i][j] = (i == j) ? 1 : 0;
+                }
+            }
+            for (index_t sweep = 0; sweep < 50; sweep++) {
+                double off = 0;
+                double diag = 0;
+                for (index_t p = 0; p < dim; p++) {
+                    diag += a[p][p] * a[p][p];
+                    for (index_t q = p + 1; q < dim; q++) {
+                        off += a[p][q] * a[p][q];
+                    }
+                }
+                if (off <= 1e-30 * diag || off == 0) {
+                    return;
+                }
+                for (index_t p = 0; p < dim; p++) {
+                    for (index_t q = p + 1; q < dim; q++) {
+                        if (a[p][q] == 0) {
+                            continue;
+                        }
+                        double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                        double t = ((theta >= 0) ? 1 : -1) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+                        double c = 1 / std::sqrt(t * t + 1);
+                        double s = t * c;
+                        for (index_t k = 0; k < dim; k++) {
+                            double akp = a[k][p];
+                            double akq = a[k][q];
+                            a[k][p] = c * akp - s * akq;
+                            a[k][q] = s * akp + c * akq;
+                        }
+                        for (index_t k = 0; k < dim; k++) {
+                            double apk = a[p][k];
+                            double aqk = a[q][k];
+                            a[p][k] = c * apk - s * aqk;
+                            a[q][k] = s * apk + c * aqk;
+                        }
+                        for (index_t k = 0; k < dim; k++) {
+                            double vkp = vectors[k][p];
+                            double vkq = vectors[k][q];
+                            vectors[k][p] = c * vkp - s * vkq;
+                            vectors[k][q] = s * vkp + c * vkq;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Raw moments up to order 2 of the leaves of each node, the leaves being the points of a grid embedding.
+     *
+     * The raw moments of a node are stored in a row of size 1 + dim + dim * dim: the area (number of leaves), the sum
+     * of the coordinates of the leaves (dim values) and the sum of the products of their coordinates (dim * dim
+     * values, row major). The coordinates of a leaf are computed on the fly from its index.
+     * Sums of integer coordinates are exact as long as they are smaller than 2^53.
+     *
+     * @tparam dim dimension of the embedding
+     */
+    template<int dim>
+    struct fused_image_moments {
+        using value_type = double;
+        static const bool top_down = false;
+        static const index_t row_size = 1 + dim + dim * dim;
+
+        fused_image_moments(const embedding_grid<dim> &embedding) : m_embedding(embedding) {
+        }
+
+        std::vector<size_t> shape() const {
+            return {(size_t) row_size};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &tree) {
+            hg_assert((index_t) num_leaves(tree) == (index_t) m_embedding.size(),
+                      "The number of leaves of the tree does not match the size of the embedding.");
+        }
+
+        void initialize(index_t n, value_type *row) const {
+            auto coordinates = m_embedding.lin2grid(n);
+            row[0] = 1;
+            for (index_t i = 0; i < dim; i++) {
+                row[1 + i] = (double) coordinates(i);
+                for (index_t j = 0; j < dim; j++) {
+                    row[1 + dim + i * dim + j] = (double) coordinates(i) * (double) coordinates(j);
+                }
+            }
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &tree, index_t n, value_type *row, const value_type *rows, index_t) const {
+            std::fill(row, row + row_size, 0);
+            for (auto c: children_iterator(n, tree)) {
+                auto child_row = rows + c * row_size;
+                for (index_t i = 0; i < row_size; i++) {
+                    row[i] += child_row[i];
+                }
+            }
+        }
+
+    private:
+        embedding_grid<dim> m_embedding;
+    };
+
+    /**
+     * Moments and shape descriptors of the nodes of a tree built on an image (see attribute_image_moments).
+     * Each array has one row per node.
+     */
+    struct image_moments {
+        // raw moment of order 0: number of leaves in the node
+        array_1d<double> area;
+        // raw moments of order 1: sum of the coordinates of the leaves, shape (num_nodes, dim)
+        array_2d<double> raw_moments_1;
+        // raw moments of order 2: sum of the products of the coordinates of the leaves, shape (num_nodes, dim, dim)
+        array_3d<double> raw_moments_2;
+        // mean of the coordinates of the leaves, shape (num_nodes, dim)
+        array_2d<double> centroid;
+        // central moments of order 2: sum of the products of the centered coordinates, shape (num_nodes, dim, dim)
+        array_3d<double> central_moments_2;
+        // smallest and largest coordinates of the leaves, shape (num_nodes, 2, dim)
+        array_3d<index_t> bounding_box;
+        // 1 - sqrt(smallest eigenvalue / largest eigenvalue) of the covariance matrix, in [0, 1]
+        array_1d<double> elongation;
+        // unit eigenvector of the largest eigenvalue of the covariance matrix, shape (num_nodes, dim)
+        array_2d<double> orientation;
+    };
+
+    /**
+     * Moments and shape descriptors of the nodes of a tree whose leaves are the pixels (or voxels) of an image.
+     *
+     * The raw moments up to order 2 and the bounding box of all the nodes are computed during a single leaves to root
+     * traversal of the tree (see fused_image_moments and fused_bounding_box): the coordinates of the leaves are never
+     * materialized. The centroid, the central moments, the elongation and the orientation of each node are then
+     * deduced from its raw moments.
+     *
+     * The elongation and the orientation are given by the eigen decomposition of the covariance matrix of the
+     * coordinates of the leaves of the node: the elongation is equal to 1 - sqrt(l_min / l_max), with l_min and l_max
+     * the smallest and the largest eigenvalues (0 for an isotropic node, 1 for a segment), and the orientation is the
+     * unit eigenvector associated to l_max (the sign is chosen such that its first non zero coordinate is positive).
+     * The orientation of an isotropic node is arbitrary.
+     *
+     * @tparam tree_t tree type
+     * @tparam dim dimension of the embedding
+     * @param tree input tree
+     * @param embedding grid embedding of the leaves of the tree
+     * @return an image_moments structure
+     */
+    template<typename tree_t, int dim>
+    auto attribute_image_moments(const tree_t &tree, const embedding_grid<dim> &embedding) {
+        HG_TRACE();
+        using namespace image_moments_internal;
+        auto fused = accumulate_attributes(tree,
+                                           fused_image_moments<dim>(embedding),
+                                           fused_bounding_box<dim>(embedding));
+        const auto &raw = std::get<0>(fused);
+        const index_t num_nodes = num_vertices(tree);
+        const index_t row_size = fused_image_moments<dim>::row_size;
+
+        image_moments res;
+        res.area = array_1d<double>::from_shape({(size_t) num_nodes});
+        res.raw_moments_1 = array_2d<double>::from_shape({(size_t) num_nodes, (size_t) dim});
+        res.raw_moments_2 = array_3d<double>::from_shape({(size_t) num_nodes, (size_t) dim, (size_t) dim});
+        res.centroid = array_2d<double>::from_shape({(size_t) num_nodes, (size_t) dim});
+        res.central_moments_2 = array_3d<double>::from_shape({(size_t) num_nodes, (size_t) dim, (size_t) dim});
+        res.bounding_box = array_3d<index_t>::from_shape({(size_t) num_nodes, 2, (size_t) dim});
+        std::copy(std::get<1>(fused).begin(), std::get<1>(fused).end(), res.bounding_box.begin());
+        res.elongation = array_1d<double>::from_shape({(size_t) num_nodes});
+        res.orientation = array_2d<double>::from_shape({(size_t) num_nodes, (size_t) dim});
+
+        std::array<std::array<double, dim>, dim> covariance;
+        std::array<std::array<double, dim>, dim> vectors;
+        for (index_t n = 0; n < num_nodes; n++) {
+            auto row = raw.data() + n * row_size;
+            double area = row[0];
+            res.area(n) = area;
+            for (index_t i = 0; i < dim; i++) {
+                res.raw_moments_1(n, i) = row[1 + i];
+                res.centroid(n, i) = row[1 + i] / area;
+            }
+            for (index_t i = 0; i < dim; i++) {
+                for (index_t j = 0; j < dim; j++) {
+                    double m2 = row[1 + dim + i * dim + j];
+                    double mu2 = m2 - row[1 + i] * row[1 + j] / area;
+                    res.raw_moments_2(n, i, j) = m2;
+                    res.central_moments_2(n, i, j) = mu2;
+                    covariance[i][j] = mu2 / area;
+                }
+            }
+
+            symmetric_eigen<dim>(covariance, vectors);
+            index_t largest = 0;
+            double l_min = covariance[0][0];
+            for (index_t i = 1; i < dim; i++) {
+                if (covariance[i][i] > covariance[largest][largest]) {
+                    largest = i;
+                }
+                l_min = (std::min)(l_min, covariance[i][i]);
+            }
+            double l_max = covariance[largest][largest];
+            res.elongation(n) = (l_max > 0) ? 1 - std::sqrt((std::max)(l_min, 0.0) / l_max) : 0;
+
+            double sign = 0;
+            for (index_t i = 0; i < dim && sign == 0; i++) {
+                if (std::fabs(vectors[i][largest]) > 1e-12) {
+                    sign = (vectors[i][largest] > 0) ? 1 : -1;
+                }
+            }
+            for (index_t i = 0; i < dim; i++) {
+                res.orientation(n, i) = sign * vectors[i][largest];
+            }
+        }
+        return res;
+    }
+}
@@ -12,12 +12,312 @@
 
 #include "../graph.hpp"
 #include "../accumulator/tree_accumulator.hpp"
+#include "../accumulator/graph_accumulator.hpp"
+#include "../structure/lca_fast.hpp"
+#include "../structure/unionfind.hpp"
 #include "xtensor/xview.hpp"
 #include "xtensor/xindex_view.hpp"
 #include "xtensor/xnoalias.hpp"
+#include <numeric>
+#include <stack>
 
 namespace hg {
 
+    namespace tree_attribute_internal {
+
+        /**
+         * Depth first traversal of a tree (children are visited in their order in the tree): on_leaf(l) is called
+         * when the leaf l is reached and on_child_done(n, c) is called when the sub-tree rooted in the child c of n
+         * has been traversed.
+         */
+        template<typename tree_t, typename on_leaf_t, typename on_child_done_t>
+        void depth_first_traversal(const tree_t &tree, const on_leaf_t &on_leaf, const on_child_done_t &on_child_done) {
+            if (is_leaf(root(tree), tree)) {
+                on_leaf(root(tree));
+                return;
+            }
+            std::stack<std::pair<index_t, index_t>> stack;
+            stack.push({(index_t) root(tree), 0});
+            while (!stack.empty()) {
+                auto &e = stack.top();
+                index_t n = e.first;
+                if (e.second < (index_t) num_children(n, tree)) {
+                    index_t c = child(e.second++, n, tree);
+                    if (is_leaf(c, tree)) {
+                        on_leaf(c);
+                        on_child_done(n, c);
+                    } else {
+                        stack.push({c, 0});
+                    }
+                } else {
+                    stack.pop();
+                    if (!stack.empty()) {
+                        on_child_done(stack.top().first, n);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Calls fun(i, l) for each edge i of the leaf graph of the tree, with l the lowest common ancestor of the
+         * extremities of i.
+         *
+         * Lowest common ancestors are computed offline with Tarjan's algorithm: the edges are bucketed by extremity
+         * and each edge is processed when its second extremity is reached by a depth first traversal of the tree.
+         * Time complexity is quasi linear and space complexity is linear.
+         */
+        template<typename tree_t, typename graph_t, typename fun_t>
+        void for_each_edge_lowest_common_ancestor(const tree_t &tree, const graph_t &graph, const fun_t &fun) {
+            const index_t num_l = num_leaves(tree);
+            const index_t num_e = num_edges(graph);
+            hg_assert((index_t) num_vertices(graph) == num_l,
+                      "The number of vertices of the graph does not match the number of leaves of the tree.");
+
+            array_1d<index_t> query_begin({(size_t) num_l + 1}, 0);
+            for (index_t i = 0; i < num_e; i++) {
+                const auto &e = edge_from_index(i, graph);
+                query_begin(source(e, graph) + 1)++;
+                if (source(e, graph) != target(e, graph)) {
+                    query_begin(target(e, graph) + 1)++;
+                }
+            }
+            for (index_t l = 0; l < num_l; l++) {
+                query_begin(l + 1) += query_begin(l);
+            }
+            array_1d<index_t> queries = array_1d<index_t>::from_shape({(size_t) query_begin(num_l)});
+            {
+                array_1d<index_t> position = xt::view(query_begin, xt::range(0, num_l));
+                for (index_t i = 0; i < num_e; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    queries(position(source(e, graph))++) = i;
+                    if (source(e, graph) != target(e, graph)) {
+                        queries(position(target(e, graph))++) = i;
+                    }
+                }
+            }
+
+            std::vector<char> visited(num_l, false);
+            union_find uf(num_vertices(tree));
+            array_1d<index_t> ancestor = xt::arange<index_t>(num_vertices(tree));
+            depth_first_traversal(tree,
+                                  [&](index_t l) {
+                                      visited[l] = true;
+                                      for (index_t q = query_begin(l); q < query_begin(l + 1); q++) {
+                                          auto i = queries(q);
+                                          const auto &e = edge_from_index(i, graph);
+                                          index_t other = (source(e, graph) == l) ? target(e, graph) : source(e, graph);
+                                          if (visited[other]) {
+                                              fun(i, ancestor(uf.find(other)));
+                                          }
+                                      }
+                                  },
+                                  [&](index_t n, index_t c) {
+                                      ancestor(uf.link(uf.find(n), uf.find(c))) = n;
+                                  });
+        }
+
+        /**
+         * Number of edges processed by a single task.
+         */
+        const index_t edge_block_size = 4096;
+
+        /**
+         * Number of edges whose lowest common ancestors are computed before being accumulated.
+         */
+        const index_t edge_lca_buffer_size = 1 << 16;
+
+        /**
+         * Sum of edge_values(i) for the edges i whose lowest common ancestor is n, for each node n of the tree
+         * represented by lca (an lca_fast structure).
+         *
+         * Lowest common ancestors are computed by buffers of edge_lca_buffer_size edges (in parallel if parallel is
+         * true) and then accumulated sequentially: the summation order does not depend on the number of threads and
+         * no array of the size of the edge set is allocated.
+         */
+        template<typename lca_t, typename graph_t, typename T>
+        array_1d<double> accumulate_edges_at_lowest_common_ancestor(const lca_t &lca,
+                                                                    const graph_t &graph,
+                                                                    const T &edge_values,
+                                                                    bool parallel) {
+            const index_t num_e = num_edges(graph);
+            array_1d<double> res = xt::zeros<double>({lca.num_vertices()});
+            std::vector<index_t> buffer((std::min)(num_e, edge_lca_buffer_size));
+            for (index_t first = 0; first < num_e; first += edge_lca_buffer_size) {
+                const index_t size = (std::min)(edge_lca_buffer_size, num_e - first);
+                parfor_blocks(size, edge_block_size, parallel, [&](index_t block_first, index_t block_last) {
+                    for (index_t i = block_first; i < block_last; i++) {
+                        const auto &e = edge_from_index(first + i, graph);
+                        buffer[i] = lca.lca(source(e, graph), target(e, graph));
+                    }
+                });
+                for (index_t i = 0; i < size; i++) {
+                    res(buffer[i]) += edge_values(first + i);
+                }
+            }
+            return res;
+        }
+
+        /**
+         * Sum of fun(i, n) over the edges i of the graph, n being the lowest common ancestor of the extremities of i in
+         * the tree represented by lca (an lca_fast structure).
+         *
+         * Edges are processed by blocks of edge_block_size edges (in parallel if parallel is true) and the partial sums
+         * of the blocks are added in order: the result does not depend on the number of threads.
+         */
+        template<typename lca_t, typename graph_t, typename fun_t>
+        double sum_over_edges_lowest_common_ancestor(const lca_t &lca,
+                                                     const graph_t &graph,
+                                                     const fun_t &fun,
+                                                     bool parallel) {
+            const index_t num_e = num_edges(graph);
+            const index_t num_blocks = (num_e + edge_block_size - 1) / edge_block_size;
+            std::vector<double> partial_sums(num_blocks, 0);
+            parfor_blocks(num_e, edge_block_size, parallel, [&](index_t first, index_t last) {
+                double sum = 0;
+                for (index_t i = first; i < last; i++) {
+                    const auto &e = edge_from_index(i, graph);
+                    sum += fun(i, (index_t) lca.lca(source(e, graph), target(e, graph)));
+                }
+                partial_sums[first / edge_block_size] = sum;
+            });
+            double res = 0;
+            for (auto v: partial_sums) {
+                res += v;
+            }
+            return res;
+        }
+
+        /**
+         * Altitude of the deepest non leaf node in the subtree of each non leaf node (the values of the leaves are left
+         * uninitialized): the deepest node is the one with the lowest altitude if increasing_altitudes is true and the
+         * one with the highest altitude otherwise.
+         * If ref_son is not null, (*ref_son)(n) is set to the child of n on the path to its deepest node
+         * (invalid_index if the children of n are all leaves).
+         */
+        template<typename tree_t, typename T>
+        auto deepest_node_altitude(const tree_t &tree,
+                                   const T &altitudes,
+                                   bool increasing_altitudes,
+                                   bool parallel,
+                                   array_1d<index_t> *ref_son = nullptr) {
+            using value_type = typename T::value_type;
+            array_1d<value_type> depth = array_1d<value_type>::from_shape({num_vertices(tree)});
+            const value_type init = increasing_altitudes ? (std::numeric_limits<value_type>::max)() :
+                                    std::numeric_limits<value_type>::lowest();
+            tree_accumulator_detail::for_each_internal_node_block_bottom_up(tree, parallel, [&](const auto &nodes) {
+                for (auto n: nodes) {
+                    depth(n) = init;
+                    bool flag = true;
+                    for (auto c: children_iterator(n, tree)) {
+                        if (!is_leaf(c, tree)) {
+                            flag = false;
+                            if (increasing_altitudes ? depth(c) < depth(n) : depth(c) > depth(n)) {
+                                depth(n) = depth(c);
+                                if (ref_son != nullptr) {
+                                    (*ref_son)(n) = c;
+                                }
+                            }
+                        }
+                    }
+                    if (flag) {
+                        depth(n) = altitudes(n);
+                    }
+                }
+            });
+            return depth;
+        }
+
+        template<typename tree_t, typename T>
+        auto attribute_height_impl(const tree_t &tree,
+                                   const T &altitudes,
+                                   bool increasing_altitudes,
+                                   bool parallel) {
+            using value_type = typename T::value_type;
+            auto depth = deepest_node_altitude(tree, altitudes, increasing_altitudes, parallel);
+            const index_t num_v = num_vertices(tree);
+            array_1d<value_type> height = array_1d<value_type>::from_shape({(size_t) num_v});
+            auto compute = [&](index_t n) {
+                auto altitude_parent = altitudes(parent(n, tree));
+                auto d = is_leaf(n, tree) ? altitude_parent : depth(n);
+                height(n) = increasing_altitudes ? altitude_parent - d : d - altitude_parent;
+            };
+            if (parallel) {
+                parfor(0, num_v, compute);
+            } else {
+                for (index_t n = 0; n < num_v; n++) {
+                    compute(n);
+                }
+            }
+            return height;
+        }
+
+        template<typename tree_t, typename T>
+        auto attribute_extrema_impl(const tree_t &tree,
+                                    const T &altitudes,
+                                    bool parallel) {
+            // a node only writes the values of its children: the nodes of a level can be processed in parallel
+            array_1d<bool> extrema = xt::zeros<bool>({num_vertices(tree)});
+            tree_accumulator_detail::for_each_internal_node_block_bottom_up(tree, parallel, [&](const auto &nodes) {
+                for (auto n: nodes) {
+                    bool flag = true;
+                    for (auto c: children_iterator(n, tree)) {
+                        bool c_non_canonical = altitudes(c) == altitudes(n);
+                        if (!(is_leaf(c, tree) || (c_non_canonical && extrema(c)))) {
+                            flag = false;
+                        }
+                        extrema(c) = extrema(c) && !c_non_canonical;
+                    }
+                    extrema(n) = flag;
+                }
+            });
+            return extrema;
+        }
+
+        /**
+         * Node whose attribute value is the extinction value of each node of the tree (see attribute_extinction_value),
+         * invalid_index for the leaves that do not belong to any extremum (their extinction value is 0).
+         *
+         * The representative of a non leaf node n is the highest node of the path to the deepest extremum that
+         * contains n, and the representative of a leaf is the representative of the extremum containing it.
+         * If parallel is true, the bottom-up and top-down passes are done level by level.
+         */
+        template<typename tree_t, typename T>
+        array_1d<index_t> extinction_representatives(const tree_t &tree,
+                                                     const T &altitudes,
+                                                     bool increasing_altitudes,
+                                                     bool parallel) {
+            const index_t num_l = num_leaves(tree);
+            const index_t num_v = num_vertices(tree);
+            const index_t r = root(tree);
+
+            // identify path to the deepest extrema
+            array_1d<index_t> ref_son({num_vertices(tree)}, invalid_index);
+            deepest_node_altitude(tree, altitudes, increasing_altitudes, parallel, &ref_son);
+
+            auto extrema = attribute_extrema_impl(tree, altitudes, parallel);
+
+            // representative of each node (rep) and closest extremum containing each non leaf node (ext): the
+            // parent of a node is processed before the node and the representative of a leaf is the representative
+            // of the closest extremum containing it
+            array_1d<index_t> rep = array_1d<index_t>::from_shape({(size_t) num_v});
+            array_1d<index_t> ext = array_1d<index_t>::from_shape({(size_t) num_v});
+            rep(r) = r;
+            ext(r) = extrema(r) ? r : invalid_index;
+            tree_accumulator_detail::for_each_non_root_node_block_top_down(tree, parallel, [&](const auto &nodes) {
+                for (auto n: nodes) {
+                    auto p = parent(n, tree);
+                    if (n < num_l) {
+                        rep(n) = (ext(p) != invalid_index) ? rep(ext(p)) : invalid_index;
+                    } else {
+                        rep(n) = (n == ref_son(p)) ? rep(p) : n;
+                        ext(n) = extrema(n) ? n : ext(p);
+                    }
+                }
+            });
+            return rep;
+        }
+    }
+
     /**
      * The area  of a node n of the tree t is equal to the sum of the area of the leaves in the subtree rooted in n.
      *
@@ -25,16 +325,17 @@ namespace hg {
      *
      * @tparam tree_t tree type
      * @tparam T xexpression derived type of xleaf_area
+     * @tparam output_t value type of the result
      * @param tree input tree
      * @param xleaf_area area of the leaves of the input tree
      * @return an array with the area of each node of the tree
      */
-    template<typename tree_t, typename T>
+    template<typename tree_t, typename T, typename output_t = typename T::value_type>
     auto attribute_area(const tree_t &tree, const xt::xexpression<T> &xleaf_area) {
         auto &leaf_area = xleaf_area.derived_cast();
         hg_assert_leaf_weights(tree, leaf_area);
 
-        return accumulate_sequential(tree, leaf_area, accumulator_sum());
+        return accumulate_sequential<tree_t, T, accumulator_sum, output_t>(tree, leaf_area, accumulator_sum());
     }
 
     /**
@@ -58,12 +359,13 @@ namespace hg {
      * @tparam tree_t tree type
      * @tparam T1 xexpression derived type of xnode_altitude
      * @tparam T2 xexpression derived type of xnode_area
+     * @tparam output_t value type of the result
      * @param tree input tree
      * @param xnode_altitude altitude of the nodes of the input tree
      * @param xnode_area area of the nodes of the input tree
      * @return an array with the volume of each node of the tree
      */
-    template<typename tree_t, typename T1, typename T2>
+    template<typename tree_t, typename T1, typename T2, typename output_t = double>
     auto attribute_volume(const tree_t &tree, const xt::xexpression<T1> &xnode_altitude,
                           const xt::xexpression<T2> &xnode_area) {
         auto &node_area = xnode_area.derived_cast();
@@ -74,13 +376,14 @@ namespace hg {
         hg_assert_1d_array(node_altitude);
 
         auto &parent = tree.parents();
-        array_1d<double> volume = xt::empty<double>({tree.num_vertices()});
+        array_1d<output_t> volume = xt::empty<output_t>({tree.num_vertices()});
         xt::view(volume, xt::range(0, num_leaves(tree))) = 0;
         for (auto i: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-            volume(i) = std::fabs(node_altitude(i) - node_altitude(parent(i))) * node_area(i);
+            double v = std::fabs(node_altitude(i) - node_altitude(parent(i))) * node_area(i);
             for (auto c: tree.children(i)) {
-                volume(i) += volume(c);
+                v += volume(c);
             }
+            volume(i) = (output_t) v;
         }
         return volume;
     }
@@ -127,49 +430,9 @@ namespace hg {
         auto &altitudes = xaltitudes.derived_cast();
         hg_assert_node_weights(tree, altitudes);
         hg_assert_1d_array(altitudes);
-        using value_type = typename T::value_type;
 
-        if (increasing_altitudes) {
-            auto min_depth = xt::empty_like(altitudes);
-            xt::noalias(xt::view(min_depth, xt::range(0, num_leaves(tree)))) =
-                    xt::view(xt::index_view(altitudes, tree.parents()), xt::range(0, num_leaves(tree)));
-            for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                min_depth(n) = (std::numeric_limits<value_type>::max)();
-                bool flag = true;
-                for (auto c: children_iterator(n, tree)) {
-                    if (!is_leaf(c, tree)) {
-                        flag = false;
-                        if (min_depth(c) < min_depth(n)) {
-                            min_depth(n) = min_depth(c);
-                        }
-                    }
-                }
-                if (flag) {
-                    min_depth(n) = altitudes(n);
-                }
-            }
-            return xt::eval(xt::index_view(altitudes, tree.parents()) - min_depth);
-        } else {
-            auto max_depth = xt::empty_like(altitudes);
-            xt::noalias(xt::view(max_depth, xt::range(0, num_leaves(tree)))) =
-                    xt::view(xt::index_view(altitudes, tree.parents()), xt::range(0, num_leaves(tree)));
-            for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                max_depth(n) = std::numeric_limits<value_type>::lowest();
-                bool flag = true;
-                for (auto c: children_iterator(n, tree)) {
-                    if (!is_leaf(c, tree)) {
-                        flag = false;
-                        if (max_depth(c) > max_depth(n)) {
-                            max_depth(n) = max_depth(c);
-                        }
-                    }
-                }
-                if (flag) {
-                    max_depth(n) = altitudes(n);
-                }
-            }
-            return xt::eval(max_depth - xt::index_view(altitudes, tree.parents()));
-        }
+        return tree_attribute_internal::attribute_height_impl(tree, altitudes, increasing_altitudes,
+                                                              use_parallel((index_t) num_vertices(tree)));
     };
 
     /**
@@ -195,19 +458,8 @@ namespace hg {
         hg_assert_node_weights(tree, altitudes);
         hg_assert_1d_array(altitudes);
 
-        array_1d<bool> extrema = xt::zeros<bool>({num_vertices(tree)});
-        for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-            bool flag = true;
-            for (auto c: children_iterator(n, tree)) {
-                bool c_non_canonical = altitudes(c) == altitudes(n);
-                if (!(is_leaf(c, tree) || (c_non_canonical && extrema(c)))) {
-                    flag = false;
-                }
-                extrema(c) = extrema(c) && !c_non_canonical;
-            }
-            extrema(n) = flag;
-        }
-        return extrema;
+        return tree_attribute_internal::attribute_extrema_impl(tree, altitudes,
+                                                               use_parallel((index_t) num_vertices(tree)));
     }
 
     /**
@@ -251,79 +503,78 @@ namespace hg {
                                     bool increasing_altitudes) {
         auto &altitudes = xaltitudes.derived_cast();
         auto &attribute = xattribute.derived_cast();
-        using value_type = typename T1::value_type;
         hg_assert_node_weights(tree, altitudes);
         hg_assert_1d_array(altitudes);
         hg_assert_node_weights(tree, attribute);
         hg_assert_1d_array(attribute);
+        using value_type = typename T2::value_type;
 
-        // identify path to the deepest extrema
-        array_1d<index_t> ref_son({num_vertices(tree)}, invalid_index);
-        if (increasing_altitudes) {
-            auto min_depth = xt::empty_like(altitudes);
-            for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                min_depth(n) = (std::numeric_limits<value_type>::max)();
-                bool flag = true;
-                for (auto c: children_iterator(n, tree)) {
-                    if (!is_leaf(c, tree)) {
-                        flag = false;
-                        if (min_depth(c) < min_depth(n)) {
-                            min_depth(n) = min_depth(c);
-                            ref_son(n) = c;
-                        }
-                    }
-                }
-                if (flag) {
-                    min_depth(n) = altitudes(n);
-                }
-            }
+        bool parallel = use_parallel((index_t) num_vertices(tree));
+        auto rep = tree_attribute_internal::extinction_representatives(tree, altitudes, increasing_altitudes, parallel);
+        const index_t num_v = num_vertices(tree);
+        array_1d<value_type> extinction = array_1d<value_type>::from_shape({(size_t) num_v});
+        auto compute = [&](index_t n) {
+            extinction(n) = (rep(n) != invalid_index) ? attribute(rep(n)) : 0;
+        };
+        if (parallel) {
+            parfor(0, num_v, compute);
         } else {
-            auto max_depth = xt::empty_like(altitudes);
-            for (auto n: leaves_to_root_iterator(tree, leaves_it::exclude)) {
-                max_depth(n) = std::numeric_limits<value_type>::lowest();
-                bool flag = true;
-                for (auto c: children_iterator(n, tree)) {
-                    if (!is_leaf(c, tree)) {
-                        flag = false;
-                        if (max_depth(c) > max_depth(n)) {
-                            max_depth(n) = max_depth(c);
-                            ref_son(n) = c;
-                        }
-                    }
-                }
-                if (flag) {
-                    max_depth(n) = altitudes(n);
-                }
+            for (index_t n = 0; n < num_v; n++) {
+                compute(n);
             }
         }
+        return extinction;
+    };
 
-        // extinction of non leaf nodes
-        array_1d<typename T2::value_type> extinction = array_1d<typename T2::value_type>::from_shape(
-                {num_vertices(tree)});
-        extinction(root(tree)) = attribute(root(tree));
-        for (auto n: root_to_leaves_iterator(tree, leaves_it::exclude, root_it::exclude)) {
-            auto pn = parent(n, tree);
-            if (n == ref_son(pn)) {
-                extinction(n) = extinction(pn);
-            } else {
-                extinction(n) = attribute(n);
-            }
-        }
+    /**
+     * Extinction values of the nodes of the input tree for several attributes (see attribute_extinction_value).
+     *
+     * The attributes are given as a 2d array of shape (num_vertices(tree), k): the column i of the result is the
+     * extinction value for the attribute stored in the column i of xattributes. The paths to the deepest extrema and
+     * the extrema of the tree are computed once for all the attributes.
+     *
+     * @tparam tree_t tree type
+     * @tparam T1 xexpression derived type of xaltitude
+     * @tparam T2 xexpression derived type of xattributes
+     * @param tree input tree
+     * @param xaltitudes altitude of the nodes of the input tree
+     * @param xattributes attributes used for filtering, one column per attribute
+     * @param increasing_altitudes must be true if altitude is increasing, false if it is decreasing
+     * @return an array with the extinction values of each node of the tree, one column per attribute
+     */
+    template<typename tree_t,
+            typename T1,
+            typename T2>
+    auto attribute_extinction_values(const tree_t &tree,
+                                     const xt::xexpression<T1> &xaltitudes,
+                                     const xt::xexpression<T2> &xattributes,
+                                     bool increasing_altitudes) {
+        auto &altitudes = xaltitudes.derived_cast();
+        auto &attributes = xattributes.derived_cast();
+        hg_assert_node_weights(tree, altitudes);
+        hg_assert_1d_array(altitudes);
+        hg_assert_node_weights(tree, attributes);
+        hg_assert(attributes.dimension() == 2, "attributes must be a 2d array.");
+        using value_type = typename T2::value_type;
 
-        auto extrema = attribute_extrema(tree, altitudes);
-        auto indices = xt::eval(xt::arange<index_t>(num_vertices(tree)));
-        if (!extrema(root(tree))) {
-            indices(root(tree)) = -1;
-        }
-        auto extrema_leaves = propagate_sequential(tree, indices, !extrema);
-        for (auto n: leaves_iterator(tree)) {
-            if (extrema_leaves(n) != -1) {
-                extinction(n) = extinction(extrema_leaves(n));
-            } else {
-                extinction(n) = 0;
+        bool parallel = use_parallel((index_t) num_vertices(tree));
+        auto rep = tree_attribute_internal::extinction_representatives(tree, altitudes, increasing_altitudes, parallel);
+        const index_t num_v = num_vertices(tree);
+        const index_t num_attributes = attributes.shape()[1];
+        array_2d<value_type> extinction = array_2d<value_type>::from_shape({(size_t) num_v, (size_t) num_attributes});
+        auto compute = [&](index_t n) {
+            auto r = rep(n);
+            for (index_t i = 0; i < num_attributes; i++) {
+                extinction(n, i) = (r != invalid_index) ? attributes(r, i) : 0;
+            }
+        };
+        if (parallel) {
+            parfor(0, num_v, compute);
+        } else {
+            for (index_t n = 0; n < num_v; n++) {
+                compute(n);
             }
         }
-
         return extinction;
     };
 
@@ -448,6 +699,201 @@ namespace hg {
         return res;
     }
 
+    /**
+     * Length of the frontier represented by each node of a partition tree.
+     *
+     * Each node represents the merging of 2 or more regions: its frontier is the common contour between the merged
+     * regions, its length is the sum of the length of the edges of the leaf graph whose lowest common ancestor is
+     * the node.
+     *
+     * Edges are streamed with the offline lowest common ancestor algorithm: the lowest common ancestors are never
+     * stored and the complexity is quasi linear.
+     *
+     * @tparam tree_t
+     * @tparam graph_t
+     * @tparam T
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of tree
+     * @param xedge_length length of each edge of the leaf graph
+     * @return a 1d array with the same value type as edge_length
+     */
+    template<typename tree_t, typename graph_t, typename T>
+    auto attribute_frontier_length(const tree_t &tree,
+                                   const graph_t &leaf_graph,
+                                   const xt::xexpression<T> &xedge_length) {
+        HG_TRACE();
+        auto &edge_length = xedge_length.derived_cast();
+        hg_assert_1d_array(edge_length);
+        hg_assert_edge_weights(leaf_graph, edge_length);
+        using value_type = typename T::value_type;
+
+        array_1d<value_type> res = xt::zeros<value_type>({num_vertices(tree)});
+        tree_attribute_internal::for_each_edge_lowest_common_ancestor(
+                tree, leaf_graph, [&res, &edge_length](index_t i, index_t l) {
+                    res(l) += edge_length(i);
+                });
+        return res;
+    }
+
+    /**
+     * Mean edge weight along the frontier represented by each node of a partition tree (see attribute_frontier_length):
+     * sum of the weights of the edges of the frontier divided by the length of the frontier.
+     *
+     * Nodes with an empty frontier (the leaves for example) have a strength equal to 0.
+     *
+     * @tparam tree_t
+     * @tparam graph_t
+     * @tparam T1
+     * @tparam T2
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of tree
+     * @param xedge_weights weight of each edge of the leaf graph
+     * @param xedge_length length of each edge of the leaf graph
+     * @return a 1d array with the same value type as edge_weights
+     */
+    template<typename tree_t, typename graph_t, typename T1, typename T2>
+    auto attribute_frontier_strength(const tree_t &tree,
+                                     const graph_t &leaf_graph,
+                                     const xt::xexpression<T1> &xedge_weights,
+                                     const xt::xexpression<T2> &xedge_length) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        auto &edge_length = xedge_length.derived_cast();
+        hg_assert_1d_array(edge_length);
+        hg_assert_edge_weights(leaf_graph, edge_length);
+        using value_type = typename T1::value_type;
+
+        std::vector<double> weight_sum(num_vertices(tree), 0);
+        std::vector<double> length_sum(num_vertices(tree), 0);
+        tree_attribute_internal::for_each_edge_lowest_common_ancestor(
+                tree, leaf_graph, [&](index_t i, index_t l) {
+                    weight_sum[l] += (double) edge_weights(i);
+                    length_sum[l] += (double) edge_length(i);
+                });
+
+        array_1d<value_type> res = array_1d<value_type>::from_shape({num_vertices(tree)});
+        for (index_t n = 0; n < (index_t) num_vertices(tree); n++) {
+            res(n) = (length_sum[n] != 0) ? (value_type) (weight_sum[n] / length_sum[n]) : 0;
+        }
+        return res;
+    }
+
+    /**
+     * Length of the contour (perimeter) of each node of a tree: the perimeter of a node is equal to the sum of the
+     * perimeters of its children minus twice the length of its frontier (see attribute_frontier_length).
+     *
+     * The frontier lengths are accumulated while streaming the edges of the leaf graph (offline lowest common
+     * ancestors) and the perimeters are then propagated with a single leaves to root traversal.
+     *
+     * @tparam tree_t
+     * @tparam graph_t
+     * @tparam T1
+     * @tparam T2
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of tree
+     * @param xvertex_perimeter perimeter of each vertex of the leaf graph
+     * @param xedge_length length of each edge of the leaf graph
+     * @return a 1d array of double
+     */
+    template<typename tree_t, typename graph_t, typename T1, typename T2>
+    auto attribute_contour_length(const tree_t &tree,
+                                  const graph_t &leaf_graph,
+                                  const xt::xexpression<T1> &xvertex_perimeter,
+                                  const xt::xexpression<T2> &xedge_length) {
+        HG_TRACE();
+        auto &vertex_perimeter = xvertex_perimeter.derived_cast();
+        hg_assert_1d_array(vertex_perimeter);
+        hg_assert_leaf_weights(tree, vertex_perimeter);
+        auto &edge_length = xedge_length.derived_cast();
+        hg_assert_1d_array(edge_length);
+        hg_assert_edge_weights(leaf_graph, edge_length);
+
+        array_1d<double> res = xt::zeros<double>({num_vertices(tree)});
+        tree_attribute_internal::for_each_edge_lowest_common_ancestor(
+                tree, leaf_graph, [&res, &edge_length](index_t i, index_t l) {
+                    res(l) -= 2.0 * edge_length(i);
+                });
+        xt::noalias(xt::view(res, xt::range(0, num_leaves(tree)))) = vertex_perimeter;
+        for (auto i: leaves_to_root_iterator(tree, leaves_it::exclude)) {
+            for (auto c: children_iterator(i, tree)) {
+                res(i) += res(c);
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Strength of the contour of each node of a tree: mean edge weight on the contour of the node.
+     *
+     * The contour weight of a leaf is the sum of the weights of the edges adjacent to the leaf and the contour weight
+     * of any other node is equal to the sum of the contour weights of its children minus twice the sum of the weights
+     * of its frontier. The strength is the contour weight divided by the contour length (see
+     * attribute_contour_length); if the contour length of the root is null, it is replaced by 1.
+     *
+     * Contour weights and lengths are computed together, with a single stream of the edges of the leaf graph and a
+     * single leaves to root traversal.
+     *
+     * @tparam tree_t
+     * @tparam graph_t
+     * @tparam T1
+     * @tparam T2
+     * @tparam T3
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of tree
+     * @param xedge_weights weight of each edge of the leaf graph
+     * @param xvertex_perimeter perimeter of each vertex of the leaf graph
+     * @param xedge_length length of each edge of the leaf graph
+     * @return a 1d array of double
+     */
+    template<typename tree_t, typename graph_t, typename T1, typename T2, typename T3>
+    auto attribute_contour_strength(const tree_t &tree,
+                                    const graph_t &leaf_graph,
+                                    const xt::xexpression<T1> &xedge_weights,
+                                    const xt::xexpression<T2> &xvertex_perimeter,
+                                    const xt::xexpression<T3> &xedge_length) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        auto &vertex_perimeter = xvertex_perimeter.derived_cast();
+        hg_assert_1d_array(vertex_perimeter);
+        hg_assert_leaf_weights(tree, vertex_perimeter);
+        auto &edge_length = xedge_length.derived_cast();
+        hg_assert_1d_array(edge_length);
+        hg_assert_edge_weights(leaf_graph, edge_length);
+
+        const index_t num_l = num_leaves(tree);
+        array_1d<double> weight = xt::zeros<double>({num_vertices(tree)});
+        array_1d<double> length = xt::zeros<double>({num_vertices(tree)});
+        tree_attribute_internal::for_each_edge_lowest_common_ancestor(
+                tree, leaf_graph, [&](index_t i, index_t l) {
+                    weight(l) -= 2.0 * edge_weights(i);
+                    length(l) -= 2.0 * edge_length(i);
+                });
+        xt::noalias(xt::view(weight, xt::range(0, num_l))) = xt::zeros<double>({num_l});
+        for (index_t i = 0; i < (index_t) num_edges(leaf_graph); i++) {
+            const auto &e = edge_from_index(i, leaf_graph);
+            weight(source(e, leaf_graph)) += edge_weights(i);
+            weight(target(e, leaf_graph)) += edge_weights(i);
+        }
+        xt::noalias(xt::view(length, xt::range(0, num_l))) = vertex_perimeter;
+        for (auto i: leaves_to_root_iterator(tree, leaves_it::exclude)) {
+            for (auto c: children_iterator(i, tree)) {
+                weight(i) += weight(c);
+                length(i) += length(c);
+            }
+        }
+
+        auto r = root(tree);
+        if (std::fabs(length(r)) <= 1e-8) {
+            length(r) = 1;
+        }
+        array_1d<double> res = weight / length;
+        return res;
+    }
+
 
     /**
      * Given a node :math:`n` whose parent is :math:`p`, the attribute value of :math:`n` is the rank of :math:`n`
@@ -474,10 +920,98 @@ namespace hg {
     }
 
 
+    /**
+     * Depth first ordering of the leaves of a tree.
+     *
+     * The leaves of the sub-tree rooted in a node n are the elements leaves(begin(n)), ..., leaves(end(n) - 1) of the
+     * permutation leaves: the leaves of each node occupy a contiguous interval [begin(n), end(n)). For a leaf l,
+     * begin(l) is the rank of l in the ordering.
+     */
+    struct leaf_ordering {
+        array_1d<index_t> leaves;
+        array_1d<index_t> begin;
+        array_1d<index_t> end;
+
+        /**
+         * Number of leaves in the sub-tree rooted in n.
+         */
+        index_t num_leaves(index_t n) const {
+            return end(n) - begin(n);
+        }
+
+        /**
+         * True if the leaves of the sub-tree rooted in m are leaves of the sub-tree rooted in n (the interval of m is
+         * included in the interval of n).
+         *
+         * If m is in the sub-tree rooted in n then the leaves of m are leaves of n, but the converse is false when n
+         * has a single child: a node and its only child have the same interval.
+         */
+        bool has_leaves_included(index_t m, index_t n) const {
+            return begin(n) <= begin(m) && end(m) <= end(n);
+        }
+
+        /**
+         * View on the leaves of the sub-tree rooted in n.
+         */
+        auto leaves_of(index_t n) const {
+            return xt::view(leaves, xt::range(begin(n), end(n)));
+        }
+    };
+
+    /**
+     * Depth first ordering of the leaves of the tree (see leaf_ordering): the children of a node are visited in
+     * their order in the tree.
+     *
+     * Time complexity is linear: the number of leaves of each node is computed bottom-up, then each node shares
+     * the interval of its parent between its children top-down.
+     *
+     * @tparam tree_t
+     * @param tree
+     * @return a leaf_ordering
+     */
+    template<typename tree_t>
+    auto attribute_leaf_ordering(const tree_t &tree) {
+        HG_TRACE();
+        const index_t num_l = num_leaves(tree);
+        array_1d<index_t> begin = array_1d<index_t>::from_shape({num_vertices(tree)});
+        array_1d<index_t> end = array_1d<index_t>::from_shape({num_vertices(tree)});
+
+        // end(n) temporarily holds the number of leaves of n
+        xt::noalias(xt::view(end, xt::range(0, num_l))) = xt::ones<index_t>({num_l});
+        for (auto i: leaves_to_root_iterator(tree, leaves_it::exclude)) {
+            index_t size = 0;
+            for (auto c: children_iterator(i, tree)) {
+                size += end(c);
+            }
+            end(i) = size;
+        }
+
+        begin(root(tree)) = 0;
+        end(root(tree)) = num_l;
+        for (auto i: root_to_leaves_iterator(tree, leaves_it::exclude)) {
+            index_t position = begin(i);
+            for (auto c: children_iterator(i, tree)) {
+                begin(c) = position;
+                position += end(c);
+                end(c) = position;
+            }
+        }
+
+        array_1d<index_t> leaves = array_1d<index_t>::from_shape({(size_t) num_l});
+        for (index_t l = 0; l < num_l; l++) {
+            leaves(begin(l)) = l;
+        }
+        return leaf_ordering{std::move(leaves), std::move(begin), std::move(end)};
+    }
+
     /**
      * Given two trees :math:`t_1` and :math:`t_2` defined over the same domain, ie sharing the same set of leaves.
      * For each node :math:`n` of :math:`t1`, computes the index of the smallest node of :math:`t2` containing :math:`n`.
      *
+     * The smallest node of :math:`t2` containing :math:`n` is the lowest common ancestor in :math:`t2` of the first
+     * and last leaves of :math:`n` in a depth first order of :math:`t2`. Those lowest common ancestors are computed
+     * offline with Tarjan's algorithm: time complexity is quasi linear and space complexity is linear.
+     *
      * @tparam tree_t
      * @param t1
      * @param t2
@@ -485,18 +1019,60 @@ namespace hg {
      */
     template<typename tree_t>
     auto attribute_smallest_enclosing_shape(const tree_t &t1, const tree_t &t2) {
-        array_1d<index_t> attr({num_vertices(t1)}, invalid_index);
-        xt::noalias(xt::view(attr, xt::range(0, num_leaves(t1)))) = xt::arange(num_leaves(t1));
+        HG_TRACE();
+        hg_assert(num_leaves(t1) == num_leaves(t2), "Trees must have the same number of leaves.");
+        const index_t num_l = num_leaves(t1);
+        const index_t num_v1 = num_vertices(t1);
 
-        for (auto i: leaves_to_root_iterator(t1)) {
+        // rank of each leaf in the depth first order of t2
+        array_1d<index_t> leaf_rank = std::move(attribute_leaf_ordering(t2).begin);
+
+        // first and last leaves of each node of t1 in the depth first order of t2
+        array_1d<index_t> first_leaf({(size_t) num_v1}, invalid_index);
+        array_1d<index_t> last_leaf({(size_t) num_v1}, invalid_index);
+        xt::noalias(xt::view(first_leaf, xt::range(0, num_l))) = xt::arange(num_l);
+        xt::noalias(xt::view(last_leaf, xt::range(0, num_l))) = xt::arange(num_l);
+        for (auto i: leaves_to_root_iterator(t1, leaves_it::include, root_it::exclude)) {
             auto p = parent(i, t1);
-            if (attr(p) == -1) {
-                attr(p) = attr(i);
-            } else {
-                attr(p) = lowest_common_ancestor(attr(p), attr(i), t2);
+            if (first_leaf(p) == invalid_index || leaf_rank(first_leaf(i)) < leaf_rank(first_leaf(p))) {
+                first_leaf(p) = first_leaf(i);
+            }
+            if (last_leaf(p) == invalid_index || leaf_rank(last_leaf(i)) > leaf_rank(last_leaf(p))) {
+                last_leaf(p) = last_leaf(i);
+            }
+        }
+
+        // queries are answered when the last leaf is reached
+        array_1d<index_t> query_begin({(size_t) num_l + 1}, 0);
+        for (index_t n = 0; n < num_v1; n++) {
+            query_begin(last_leaf(n) + 1)++;
+        }
+        for (index_t l = 0; l < num_l; l++) {
+            query_begin(l + 1) += query_begin(l);
+        }
+        array_1d<index_t> queries = array_1d<index_t>::from_shape({(size_t) num_v1});
+        {
+            array_1d<index_t> position = xt::view(query_begin, xt::range(0, num_l));
+            for (index_t n = 0; n < num_v1; n++) {
+                queries(position(last_leaf(n))++) = n;
             }
         }
 
+        array_1d<index_t> attr = array_1d<index_t>::from_shape({(size_t) num_v1});
+        union_find uf(num_vertices(t2));
+        array_1d<index_t> ancestor = xt::arange<index_t>(num_vertices(t2));
+        tree_attribute_internal::depth_first_traversal(
+                t2,
+                [&](index_t l) {
+                    for (index_t q = query_begin(l); q < query_begin(l + 1); q++) {
+                        auto n = queries(q);
+                        attr(n) = ancestor(uf.find(first_leaf(n)));
+                    }
+                },
+                [&](index_t n, index_t c) {
+                    ancestor(uf.link(uf.find(n), uf.find(c))) = n;
+                });
+
         return attr;
     }
 
@@ -556,4 +1132,67 @@ namespace hg {
         return res;
     }
 
+    /**
+     * Sampling models of the pairs of vertices of a graph (see attribute_tree_sampling_probability).
+     */
+    enum class tree_sampling_model {
+        edge,
+        null
+    };
+
+    /**
+     * Given a tree :math:`T`, estimate the probability that a node :math:`n` of the tree represents the smallest
+     * cluster containing a pair of vertices :math:`\{a, b\}` of the graph :math:`G=(V, E)` with edge weights
+     * :math:`w`.
+     *
+     * The probability :math:`P(\{a,b\})` of a pair of vertices :math:`\{a,b\}` is :math:`w(\{a,b\}) / Z` with
+     * :math:`Z=\sum_{e\in E}w(E)` if :math:`\{a,b\}` is an edge of :math:`G` and 0 otherwise, and the probability
+     * :math:`P(a)` of a vertex :math:`a` is :math:`\sum_{b\in V}P(\{a, b\})`. Pairs of vertices are sampled:
+     *
+     *  - with the edge model: with probability :math:`P(\{a, b\})`; and
+     *  - with the null model: with probability :math:`P(a)*P(b)`.
+     *
+     * With the edge model, the weight of each edge is accumulated in the lowest common ancestor of its extremities
+     * in a single pass over the edges (in parallel on large graphs), without materializing the lowest common
+     * ancestors of the edges.
+     *
+     * Charpentier, B. & Bonald, T. (2019). "Tree Sampling Divergence: An Information-Theoretic Metric for
+     * Hierarchical Graph Clustering." Proceedings of IJCAI.
+     *
+     * @tparam tree_t tree type
+     * @tparam graph_t graph type
+     * @tparam T xexpression derived type of xedge_weights
+     * @param tree input tree
+     * @param leaf_graph graph on the leaves of the tree
+     * @param xedge_weights weights of the edges of the leaf graph (similarities)
+     * @param model sampling model
+     * @return a 1d array of probabilities (double)
+     */
+    template<typename tree_t, typename graph_t, typename T>
+    auto attribute_tree_sampling_probability(const tree_t &tree,
+                                             const graph_t &leaf_graph,
+                                             const xt::xexpression<T> &xedge_weights,
+                                             tree_sampling_model model = tree_sampling_model::edge) {
+        HG_TRACE();
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_1d_array(edge_weights);
+        hg_assert_edge_weights(leaf_graph, edge_weights);
+        hg_assert((index_t) num_vertices(leaf_graph) == (index_t) num_leaves(tree),
+                  "The number of vertices of the leaf graph does not match the number of leaves of the tree.");
+
+        double total = std::accumulate(edge_weights.begin(), edge_weights.end(), 0.0);
+        if (model == tree_sampling_model::edge) {
+            lca_internal::lca_fast<tree_t> lca(tree);
+            array_1d<double> res = tree_attribute_internal::accumulate_edges_at_lowest_common_ancestor(
+                    lca, leaf_graph, edge_weights, use_parallel((index_t) num_edges(leaf_graph)));
+            res /= total;
+            return res;
+        } else {
+            array_1d<double> vertex_weights = accumulate_graph_edges(leaf_graph, edge_weights, accumulator_sum());
+            vertex_weights /= total;
+            auto node_weights = accumulate_sequential(tree, vertex_weights, accumulator_sum());
+            array_1d<double> res = attribute_children_pair_sum_product(tree, node_weights);
+            return res;
+        }
+    }
 }
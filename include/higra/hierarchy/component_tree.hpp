@@ -125,17 +125,54 @@ namespace hg {
             return std::make_pair(std::move(new_parents), std::move(altitudes));
         }
 
-        template<typename graph_t, typename T1, typename T2>
-        auto
-        tree_from_sorted_vertices(const graph_t &graph, const T1 &vertex_weights, const T2 &sorted_vertex_indices) {
-            auto parents = pre_tree_construction(graph, sorted_vertex_indices);
-            canonize_tree(parents, vertex_weights, sorted_vertex_indices);
+        /**
+         * Component tree from a canonized parent relation (see canonize_tree).
+         *
+         * @tparam T0
+         * @tparam T1
+         * @tparam T2
+         * @param parents a canonized parent relation
+         * @param vertex_weights the node levels associated to the canonized parent relation
+         * @param sorted_vertex_indices the sorted vertex indices
+         * @return a node weighted tree
+         */
+        template<typename T0, typename T1, typename T2>
+        auto tree_from_canonized_parent_relation(const T0 &parents,
+                                                 const T1 &vertex_weights,
+                                                 const T2 &sorted_vertex_indices) {
             auto res = expand_canonized_parent_relation(parents, vertex_weights, sorted_vertex_indices);
             array_1d<typename T1::value_type> altitudes = xt::adapt(res.second, {res.second.size()});
             return make_node_weighted_tree(
                     tree(xt::adapt(res.first, {res.first.size()}), tree_category::component_tree),
                     std::move(altitudes));
         }
+
+        /**
+         * Component tree from a pre-parent relation (as constructed by pre_tree_construction).
+         *
+         * Parent relation is modified in-place!
+         *
+         * @tparam T0
+         * @tparam T1
+         * @tparam T2
+         * @param parents a pre-parent relation
+         * @param vertex_weights the node levels associated to the pre-parent relation
+         * @param sorted_vertex_indices the sorted vertex indices
+         * @return a node weighted tree
+         */
+        template<typename T0, typename T1, typename T2>
+        auto
+        tree_from_pre_tree(T0 &parents, const T1 &vertex_weights, const T2 &sorted_vertex_indices) {
+            canonize_tree(parents, vertex_weights, sorted_vertex_indices);
+            return tree_from_canonized_parent_relation(parents, vertex_weights, sorted_vertex_indices);
+        }
+
+        template<typename graph_t, typename T1, typename T2>
+        auto
+        tree_from_sorted_vertices(const graph_t &graph, const T1 &vertex_weights, const T2 &sorted_vertex_indices) {
+            auto parents = pre_tree_construction(graph, sorted_vertex_indices);
+            return tree_from_pre_tree(parents, vertex_weights, sorted_vertex_indices);
+        }
     }
 
     /**
@@ -21,6 +21,9 @@
 #include <utility>
 #include <tuple>
 #include <queue>
+#include <numeric>
+#include <cmath>
+#include <atomic>
 
 namespace hg {
 
@@ -53,6 +56,184 @@ namespace hg {
                                                                      std::forward<array_1d<index_t> >(mst_edge_map)};
     }
 
+    namespace hierarchy_core_internal {
+
+        /**
+         * Indices of the edges sorted by increasing weights, edges of equal weights being sorted by increasing index
+         * (same result as a stable sort).
+         *
+         * If the weights are integer values spanning a range smaller than max(number of edges, 2^16), a counting
+         * sort is used.
+         *
+         * @tparam T
+         * @param edge_weights
+         * @return
+         */
+        template<typename T>
+        array_1d<index_t> stable_arg_sort_edge_weights(const T &edge_weights) {
+            using value_type = typename T::value_type;
+            const index_t num_e = edge_weights.size();
+            array_1d<index_t> sorted_edges_indices = array_1d<index_t>::from_shape({(size_t) num_e});
+            if (num_e == 0) {
+                return sorted_edges_indices;
+            }
+
+            auto minmax = std::minmax_element(edge_weights.begin(), edge_weights.end());
+            value_type min_weight = *minmax.first;
+            double range = (double) *minmax.second - (double) *minmax.first;
+            bool counting_sort = range < (double) (std::max)(num_e, (index_t) 1 << 16);
+            if (counting_sort && !std::is_integral<value_type>::value) {
+                for (index_t i = 0; counting_sort && i < num_e; i++) {
+                    counting_sort = edge_weights(i) == std::floor(edge_weights(i));
+                }
+            }
+
+            if (counting_sort) {
+                std::vector<index_t> start((size_t) range + 2, 0);
+                for (index_t i = 0; i < num_e; i++) {
+                    start[(index_t) (edge_weights(i) - min_weight) + 1]++;
+                }
+                for (index_t i = 1; i < (index_t) start.size(); i++) {
+                    start[i] += start[i - 1];
+                }
+                for (index_t i = 0; i < num_e; i++) {
+                    sorted_edges_indices(start[(index_t) (edge_weights(i) - min_weight)]++) = i;
+                }
+            } else {
+                std::iota(sorted_edges_indices.begin(), sorted_edges_indices.end(), 0);
+                stable_sort(sorted_edges_indices.begin(), sorted_edges_indices.end(),
+                            [&edge_weights](index_t i, index_t j) { return edge_weights(i) < edge_weights(j); });
+            }
+            return sorted_edges_indices;
+        }
+
+        /**
+         * Canonical quasi-flat zone hierarchy of a connected edge weighted graph, computed directly from its edges
+         * sorted by increasing weights.
+         *
+         * The result is identical to the simplification of the canonical binary partition tree, where every node of same
+         * altitude as its parent is removed, but no binary tree is built: when two components are merged at the
+         * altitude of one of their nodes, this node absorbs the other component.
+         *
+         * @tparam graph_t
+         * @tparam T
+         * @param graph connected graph
+         * @param edge_weights
+         * @param sorted_edges_indices edge indices sorted by increasing weights (see stable_arg_sort_edge_weights)
+         * @return a node_weighted_tree
+         */
+        template<typename graph_t, typename T>
+        auto quasi_flat_zone_hierarchy_from_sorted_edges(const graph_t &graph,
+                                                         const T &edge_weights,
+                                                         const array_1d<index_t> &sorted_edges_indices) {
+            using value_type = typename T::value_type;
+            const index_t num_points = num_vertices(graph);
+            const index_t num_edge_mst = num_points - 1;
+
+            union_find uf(num_points);
+            array_1d<index_t> roots = xt::arange(num_points);
+            std::vector<index_t> parents(num_points);
+            std::iota(parents.begin(), parents.end(), 0);
+            // attributes of the non leaf nodes (node n is at position n - num_points), non leaf nodes are only
+            // created when needed: the result is often much smaller than a binary tree
+            std::vector<value_type> levels;
+            std::vector<bool> absorbed;
+            // index of the last merge performed by each node
+            std::vector<index_t> last_merge;
+
+            auto is_flat = [&levels, num_points](index_t n, const value_type &level) {
+                return n >= num_points && levels[n - num_points] == level;
+            };
+
+            index_t num_edge_found = 0;
+            for (index_t i = 0; num_edge_found < num_edge_mst && i < (index_t) sorted_edges_indices.size(); i++) {
+                auto ei = sorted_edges_indices(i);
+                auto e = edge_from_index(ei, graph);
+                auto c1 = uf.find(source(e, graph));
+                auto c2 = uf.find(target(e, graph));
+                if (c1 != c2) {
+                    auto level = edge_weights(ei);
+                    auto n1 = roots(c1);
+                    auto n2 = roots(c2);
+                    bool flat1 = is_flat(n1, level);
+                    bool flat2 = is_flat(n2, level);
+                    index_t new_node;
+                    if (flat1) {
+                        new_node = n1;
+                        parents[n2] = n1;
+                        if (flat2) {
+                            absorbed[n2 - num_points] = true;
+                        }
+                    } else if (flat2) {
+                        new_node = n2;
+                        parents[n1] = n2;
+                    } else {
+                        new_node = parents.size();
+                        parents.push_back(new_node);
+                        levels.push_back(level);
+                        absorbed.push_back(false);
+                        last_merge.push_back(0);
+                        parents[n1] = new_node;
+                        parents[n2] = new_node;
+                    }
+                    last_merge[new_node - num_points] = num_edge_found;
+                    roots(uf.link(c1, c2)) = new_node;
+                    num_edge_found++;
+                }
+            }
+            hg_assert(num_edge_found == num_edge_mst, "Input graph must be connected.");
+            const index_t num_nodes = parents.size();
+
+            // children of absorbed nodes are attached to the absorbing node
+            auto is_absorbed = [&absorbed, num_points](index_t n) {
+                return n >= num_points && absorbed[n - num_points];
+            };
+            auto final_parent = [&parents, &is_absorbed](index_t n) {
+                index_t p = parents[n];
+                while (is_absorbed(p)) {
+                    p = parents[p];
+                }
+                while (is_absorbed(parents[n])) {
+                    auto next = parents[n];
+                    parents[n] = p;
+                    n = next;
+                }
+                return p;
+            };
+
+            // remaining nodes are numbered in the order of their last merge, as in the canonical binary partition tree
+            std::vector<index_t> node_of_merge(num_edge_mst, invalid_index);
+            for (index_t n = num_points; n < num_nodes; n++) {
+                if (!is_absorbed(n)) {
+                    node_of_merge[last_merge[n - num_points]] = n;
+                }
+            }
+            std::vector<index_t> new_index(num_nodes, invalid_index);
+            index_t num_nodes_res = num_points;
+            for (index_t n = 0; n < num_points; n++) {
+                new_index[n] = n;
+            }
+            for (auto n: node_of_merge) {
+                if (n != invalid_index) {
+                    new_index[n] = num_nodes_res++;
+                }
+            }
+
+            array_1d<index_t> res_parents = array_1d<index_t>::from_shape({(size_t) num_nodes_res});
+            array_1d<value_type> res_levels = xt::zeros<value_type>({(size_t) num_nodes_res});
+            for (index_t n = 0; n < num_nodes; n++) {
+                if (!is_absorbed(n)) {
+                    res_parents(new_index[n]) = new_index[final_parent(n)];
+                    if (n >= num_points) {
+                        res_levels(new_index[n]) = levels[n - num_points];
+                    }
+                }
+            }
+
+            return make_node_weighted_tree(tree(std::move(res_parents)), std::move(res_levels));
+        }
+    }
+
     /**
      * Compute the canonical binary partition tree (or binary partition tree by altitude ordering) of the given
      * edge weighted graph.
@@ -78,9 +259,7 @@ namespace hg {
         hg_assert_edge_weights(graph, edge_weights);
         hg_assert_1d_array(edge_weights);
 
-        array_1d<index_t> sorted_edges_indices = xt::arange(num_edges(graph));
-        stable_sort(sorted_edges_indices.begin(), sorted_edges_indices.end(),
-                    [&edge_weights](index_t i, index_t j) { return edge_weights[i] < edge_weights[j]; });
+        auto sorted_edges_indices = hierarchy_core_internal::stable_arg_sort_edge_weights(edge_weights);
 
         auto num_points = num_vertices(graph);
 
@@ -132,7 +311,12 @@ namespace hg {
      * Also returns an array that maps any node index i of the new tree, to the index of this node in the original tree.
      *
      * The criterion function is a predicate that associates true (this node must be deleted) or
-     * false (do not delete this node) to a node index (with operator ()).
+     * false (do not delete this node) to a node index (with operator ()). The criterion may be evaluated concurrently
+     * on several nodes.
+     *
+     * New indices are computed with parallel prefix sums and the parent of each remaining node (its nearest non deleted
+     * ancestor) is found by pointer jumping. If process_leaves is true, the new internal nodes are numbered with a level
+     * synchronous top-down traversal. The result does not depend on the number of threads.
      *
      * @tparam criterion_t
      * @param t input tree
@@ -143,6 +327,18 @@ namespace hg {
     template<typename criterion_t>
     auto simplify_tree(const tree &t, const criterion_t &criterion, bool process_leaves = false) {
         HG_TRACE();
+        using namespace hierarchy_core_internal;
+
+        const index_t n_nodes = num_vertices(t);
+        const index_t n_leaves = num_leaves(t);
+        const index_t root_node = root(t);
+        const auto &parent = parents(t);
+
+        array_1d<char> deleted = array_1d<char>::from_shape({(size_t) n_nodes});
+        parfor(0, n_nodes, [&deleted, &criterion, process_leaves, n_leaves](index_t i) {
+            deleted(i) = ((process_leaves || i >= n_leaves) && criterion(i)) ? 1 : 0;
+        });
+        deleted(root_node) = 0;
 
         // this case is significantly harder because a reordering of the nodes
         // may append if an internal node becomes a leaf
@@ -150,139 +346,166 @@ namespace hg {
 
             // ********************************
             // identification of deleted sub-trees
-            // true if all nodes below a given  node are deleted
-            // a non deleted non leaf node i such that removed_branch(i) && !removed_branch(parent(i)) is thus a new leaf
-            array_1d<bool> removed_branch = xt::zeros<bool>({num_vertices(t)});
-            for (index_t i = 0; i < (index_t) num_leaves(t); i++) {
-                removed_branch(i) = criterion(i);
-            }
-
-            for (index_t i = num_leaves(t); i < (index_t) num_vertices(t); i++) {
-                bool flag = true;
-                for (index_t c = 0; flag && c < (index_t) num_children(i, t); c++) {
-                    auto cc = child(c, i, t);
-                    flag = flag && removed_branch(cc) && criterion(cc);
+            // a node is marked if one of its strict descendants is not deleted,
+            // a non deleted non marked node is thus a leaf of the new tree
+            std::vector<std::atomic<char>> marked(n_nodes);
+            parfor(0, n_nodes, [&marked](index_t i) {
+                marked[i].store(0, std::memory_order_relaxed);
+            });
+            parfor(0, n_nodes, [&marked, &deleted, &parent, root_node](index_t i) {
+                if (!deleted(i)) {
+                    index_t n = i;
+                    while (n != root_node) {
+                        n = parent(n);
+                        if (marked[n].exchange(1, std::memory_order_relaxed)) {
+                            break;
+                        }
+                    }
                 }
-                removed_branch(i) = flag;
-            }
+            });
 
             // ********************************
             // Identification and labeling of leaves
-
-            std::vector<index_t> new_leaves;
+            // new leaves keep the order of their index in the original tree
+            array_1d<char> is_new_leaf = array_1d<char>::from_shape({(size_t) n_nodes});
+            parfor(0, n_nodes, [&is_new_leaf, &marked, &deleted](index_t i) {
+                is_new_leaf(i) = (!deleted(i) && !marked[i].load(std::memory_order_relaxed)) ? 1 : 0;
+            });
+            array_1d<index_t> new_order = array_1d<index_t>::from_shape({(size_t) n_nodes});
+            exclusive_prefix_sum(is_new_leaf, new_order);
             index_t removed = 0;
-
-            for (index_t i : leaves_iterator(t)) {
-                if (!removed_branch(i)) {
-                    new_leaves.push_back(i);
-                } else {
-                    removed++;
-                }
-            }
-
-            for (index_t i : leaves_to_root_iterator(t, leaves_it::exclude, root_it::exclude)) {
-                if (!criterion(i)) {
-                    if (removed_branch(i) && !removed_branch(parent(i, t))) {
-                        new_leaves.push_back(i);
-                    }
-                } else {
-                    removed++;
-                }
+            for (index_t i = 0; i < n_nodes; i++) {
+                removed += deleted(i);
             }
 
-            if (removed_branch(root(t))) {
-                new_leaves.push_back(root(t));
-            }
+            auto num_nodes_new_tree = n_nodes - removed;
+            array_1d<index_t> new_parent = array_1d<index_t>::from_shape({(size_t) num_nodes_new_tree});
+            array_1d<index_t> node_map = array_1d<index_t>::from_shape({(size_t) num_nodes_new_tree});
 
             // *******************************
             // Topological sort of remaining vertices
-            // (with top-down traversal)
+            // (with a level synchronous top-down traversal, nodes of a same level are processed in parallel)
             // *******************************
-            auto num_nodes_new_tree = num_vertices(t) - removed;
-            array_1d<index_t> new_parent = xt::empty<index_t>({num_nodes_new_tree});
-            array_1d<index_t> node_map = xt::empty<index_t>({num_nodes_new_tree});
-            index_t node_number = num_nodes_new_tree - 1;
-
-            std::queue<index_t> queue;
-
-            // new index of each node
-            array_1d<index_t> new_order({num_vertices(t)}, invalid_index);
-            for (index_t i = 0; i < (index_t) new_leaves.size(); i++) {
-                new_order(new_leaves[i]) = i;
-            }
-
-
-            queue.push(root(t));
-            while (!queue.empty()) {
-                auto e = queue.front();
-                queue.pop();
-                if (!criterion(e) || e == root(t)) {
-                    new_order(e) = node_number;
-                    new_parent(node_number) = new_order(parent(e, t));
-                    node_map(node_number) = e;
-                    node_number--;
+            const index_t parallel_level_size = 1 << 12;
+            auto for_each_in_level = [parallel_level_size](index_t size, const auto &fun) {
+                if (size >= parallel_level_size) {
+                    parfor(0, size, fun);
                 } else {
-                    new_order(e) = new_order(parent(e, t));
-                }
-
-                for (auto c: children_iterator(e, t)) {
-                    if (new_order(c) == invalid_index) { // new leaves
-                        queue.push(c);
+                    for (index_t i = 0; i < size; i++) {
+                        fun(i);
                     }
                 }
-            }
+            };
 
-            index_t i = 0;
-            for (auto n: new_leaves) {
-                new_parent(i) = new_order(parent(n, t));
-                node_map(i) = n;
-                i++;
-            }
-            return make_remapped_tree(tree(new_parent, t.category()), std::move(node_map));
-        } else {
-            auto n_nodes = num_vertices(t);
-            auto copy_parent = parents(t);
-
-            std::size_t count = 0;
-            array_1d<tree::vertex_descriptor> deleted_map = xt::zeros<tree::vertex_descriptor>(copy_parent.shape());
-            array_1d<bool> deleted = xt::zeros<bool>(copy_parent.shape());
-
-            // from root to leaves, compute the new parent relation,
-            // don't care of the  holes in the parent tab
-            for (auto i: root_to_leaves_iterator(t, leaves_it::exclude, root_it::exclude)) {
-                auto parent = copy_parent(i);
-                if (criterion(i)) {
-                    for (auto c: children_iterator(i, t)) {
-                        copy_parent(c) = parent;
+            std::vector<index_t> level{root_node};
+            std::vector<index_t> next_level;
+            std::vector<index_t> offsets;
+            index_t node_number = num_nodes_new_tree - 1;
+
+            while (!level.empty()) {
+                auto level_size = (index_t) level.size();
+                offsets.resize(level_size);
+                for_each_in_level(level_size, [&level, &offsets, &deleted](index_t i) {
+                    offsets[i] = 1 - deleted(level[i]);
+                });
+                auto num_kept = exclusive_prefix_sum(offsets, offsets);
+                for_each_in_level(level_size, [&](index_t i) {
+                    auto e = level[i];
+                    if (!deleted(e)) {
+                        auto n = node_number - offsets[i];
+                        new_order(e) = n;
+                        new_parent(n) = (e == root_node) ? n : new_order(parent(e));
+                        node_map(n) = e;
+                    } else {
+                        new_order(e) = new_order(parent(e));
                     }
-                    count++;
-                }
-                // number of deleted nodes after node i
-                deleted_map(i) = count;
+                });
+                node_number -= num_kept;
+
+                // next level: children having a non deleted strict descendant
+                for_each_in_level(level_size, [&level, &offsets, &marked, &t](index_t i) {
+                    index_t count = 0;
+                    for (auto c: children_iterator(level[i], t)) {
+                        count += marked[c].load(std::memory_order_relaxed);
+                    }
+                    offsets[i] = count;
+                });
+                next_level.resize(exclusive_prefix_sum(offsets, offsets));
+                for_each_in_level(level_size, [&level, &next_level, &offsets, &marked, &t](index_t i) {
+                    index_t j = offsets[i];
+                    for (auto c: children_iterator(level[i], t)) {
+                        if (marked[c].load(std::memory_order_relaxed)) {
+                            next_level[j++] = c;
+                        }
+                    }
+                });
+                std::swap(level, next_level);
             }
 
-            //correct the mapping
-            deleted_map = count - deleted_map;
-
-            array_1d<tree::vertex_descriptor> new_parent = xt::arange<tree::vertex_descriptor>(0, n_nodes - count);
-            array_1d<tree::vertex_descriptor> node_map = xt::zeros<tree::vertex_descriptor>({n_nodes - count});
-
-            count = 0;
-
-            for (auto i: leaves_to_root_iterator(t, leaves_it::include, root_it::exclude)) {
-                if (!criterion(i) || is_leaf(i, t)) {
-                    auto par = copy_parent(i);
-                    auto new_par = par - deleted_map(par);
-                    node_map(count) = i;
-                    new_parent(count) = new_par;
-                    count++;
+            parfor(0, n_nodes, [&](index_t i) {
+                if (is_new_leaf(i)) {
+                    auto n = new_order(i);
+                    new_parent(n) = new_order(parent(i));
+                    node_map(n) = i;
                 }
-            }
+            });
 
-            node_map(node_map.size() - 1) = root(t);
+            return make_remapped_tree(tree(std::move(new_parent), t.category()), std::move(node_map));
+        } else {
+            // new index of each non deleted node
+            array_1d<index_t> new_index = array_1d<index_t>::from_shape({(size_t) n_nodes});
+            parfor(0, n_nodes, [&new_index, &deleted](index_t i) {
+                new_index(i) = 1 - deleted(i);
+            });
+            auto num_nodes_new_tree = exclusive_prefix_sum(new_index, new_index);
+
+            // nearest non deleted ancestor of each deleted node, computed with pointer jumping
+            array_1d<index_t> ancestor = array_1d<index_t>::from_shape({(size_t) n_nodes});
+            parfor(0, n_nodes, [&ancestor, &parent](index_t i) {
+                ancestor(i) = parent(i);
+            });
+            // each round writes the jumps back from a separate buffer, and compacts the nodes whose ancestor is
+            // still deleted into a second list
+            std::vector<index_t> active;
+            std::vector<index_t> next_active;
+            std::vector<index_t> jump;
+            compact(n_nodes - n_leaves, use_parallel(n_nodes - n_leaves),
+                    [&deleted, &parent, n_leaves](index_t i) {
+                        return deleted(n_leaves + i) && deleted(parent(n_leaves + i));
+                    },
+                    [n_leaves](index_t i) { return n_leaves + i; },
+                    active);
+            while (!active.empty()) {
+                const index_t num_active = (index_t) active.size();
+                jump.resize(num_active);
+                parfor(0, num_active, [&active, &jump, &ancestor](index_t i) {
+                    jump[i] = ancestor(ancestor(active[i]));
+                });
+                parfor(0, num_active, [&active, &jump, &ancestor](index_t i) {
+                    ancestor(active[i]) = jump[i];
+                });
+                compact(num_active, use_parallel(num_active),
+                        [&jump, &deleted](index_t i) { return deleted(jump[i]) != 0; },
+                        [&active](index_t i) { return active[i]; },
+                        next_active);
+                std::swap(active, next_active);
+            }
 
+            array_1d<index_t> new_parent = array_1d<index_t>::from_shape({(size_t) num_nodes_new_tree});
+            array_1d<index_t> node_map = array_1d<index_t>::from_shape({(size_t) num_nodes_new_tree});
+            parfor(0, n_nodes, [&](index_t i) {
+                if (!deleted(i)) {
+                    auto par = parent(i);
+                    if (deleted(par)) {
+                        par = ancestor(par);
+                    }
+                    auto n = new_index(i);
+                    new_parent(n) = new_index(par);
+                    node_map(n) = i;
+                }
+            });
 
-            return make_remapped_tree(tree(new_parent, t.category()), std::move(node_map));
+            return make_remapped_tree(tree(std::move(new_parent), t.category()), std::move(node_map));
         }
 
     };
@@ -298,6 +521,9 @@ namespace hg {
      * The quasi-flat zone hierarchy is composed of the sequence of lambda-partitions obtained
      * for all lambda in edge_weights.
      *
+     * The hierarchy is built directly with a single Kruskal like sweep over the sorted edges, equal altitude
+     * components being merged on the fly: no binary partition tree is computed.
+     *
      * @tparam graph_t Input graph type
      * @tparam T xepression derived type of input edge weights
      * @param graph Input graph
@@ -311,19 +537,8 @@ namespace hg {
         hg_assert_edge_weights(graph, edge_weights);
         hg_assert_1d_array(edge_weights);
 
-        auto bpt = bpt_canonical(graph, edge_weights);
-        auto &tree = bpt.tree;
-        auto &altitudes = bpt.altitudes;
-
-        auto altitude_parents = propagate_parallel(tree, altitudes);
-
-        auto qfz = simplify_tree(tree, xt::equal(altitudes, altitude_parents));
-        auto &qfz_tree = qfz.tree;
-        auto &node_map = qfz.node_map;
-
-        auto qfz_altitude = xt::eval(xt::index_view(altitudes, node_map));
-
-        return make_node_weighted_tree(std::move(qfz_tree), std::move(qfz_altitude));
+        return hierarchy_core_internal::quasi_flat_zone_hierarchy_from_sorted_edges(
+                graph, edge_weights, hierarchy_core_internal::stable_arg_sort_edge_weights(edge_weights));
     }
 
     /**
@@ -23,8 +23,9 @@ namespace hg {
         auto correct_attribute_BPT(const tree_t &tree,
                                    const T1 &altitude,
                                    const T2 &attribute) {
+            HG_TRACE();
             using value_type = typename T2::value_type;
-            array_1d<value_type> result = xt::empty_like(attribute);
+            array_1d<value_type> result = array_1d<value_type>::from_shape({attribute.size()});
             for (auto n: leaves_iterator(tree)) {
                 result(n) = 0;
             }
@@ -42,6 +43,26 @@ namespace hg {
             result(root(tree)) = attribute(root(tree));
             return result;
         };
+
+        /**
+         * Second stage of the hierarchical watershed: the minimum spanning tree is reweighted by the persistence of
+         * the given attribute of the binary partition tree by altitude ordering, and the watershed hierarchy is the
+         * quasi-flat zone hierarchy of the reweighted minimum spanning tree.
+         */
+        template<typename tree_t, typename T1, typename mst_t, typename T2>
+        auto watershed_hierarchy_from_bpt_attribute(const tree_t &bpt,
+                                                    const T1 &altitude,
+                                                    const mst_t &mst,
+                                                    const T2 &bpt_attribute) {
+            auto corrected_attribute = correct_attribute_BPT(bpt, altitude, bpt_attribute);
+            auto persistence = accumulate_parallel(bpt, corrected_attribute, accumulator_min());
+            xt::view(persistence, xt::range(0, num_leaves(bpt))) = 0;
+
+            auto mst_edge_weights = xt::view(persistence, xt::range(num_leaves(bpt), num_vertices(bpt)));
+
+            return hierarchy_core_internal::quasi_flat_zone_hierarchy_from_sorted_edges(
+                    mst, mst_edge_weights, hierarchy_core_internal::stable_arg_sort_edge_weights(mst_edge_weights));
+        }
     }
 
     /**
@@ -81,22 +102,58 @@ namespace hg {
         auto &mst = bptc.mst;
 
         auto bpt_attribute = attribute_functor(bpt, altitude);
-        auto corrected_attribute = watershed_hierarchy_internal::correct_attribute_BPT(bpt, altitude, bpt_attribute);
-        auto persistence = accumulate_parallel(bpt, corrected_attribute, accumulator_min());
-        xt::view(persistence, xt::range(0, num_leaves(bpt))) = 0;
+        return watershed_hierarchy_internal::watershed_hierarchy_from_bpt_attribute(bpt, altitude, mst, bpt_attribute);
+    };
 
-        auto mst_edge_weights = xt::view(persistence, xt::range(num_leaves(bpt), num_vertices(bpt)));
+    /**
+     * Computes several hierarchical watersheds, one for each of the given regional attributes.
+     *
+     * The result is the same as calling watershed_hierarchy_by_attribute for each attribute functor, but the
+     * binary partition tree by altitude ordering of the input graph is computed only once, and the second stages of
+     * the algorithm (reweighting of the minimum spanning tree by the persistence of the attribute and
+     * construction of the corresponding hierarchy) are computed in parallel.
+     *
+     * The attribute functors are called sequentially, in the given order.
+     *
+     * @tparam graph_t
+     * @tparam T
+     * @tparam F
+     * @param graph: input graph
+     * @param xedge_weights: input graph edge weights
+     * @param attribute_functors: functions that compute the attribute value from a tree and its node altitudes
+     * @return a vector of node_weighted_tree, the i-th hierarchy corresponds to the i-th attribute functor
+     */
+    template<typename graph_t, typename T, typename F>
+    auto watershed_hierarchies_by_attributes(
+            const graph_t &graph,
+            const xt::xexpression<T> &xedge_weights,
+            const std::vector<F> &attribute_functors) {
+        auto &edge_weights = xedge_weights.derived_cast();
+        hg_assert_edge_weights(graph, edge_weights);
+        hg_assert_1d_array(edge_weights);
 
-        auto bptc2 = bpt_canonical(mst, mst_edge_weights);
-        auto &bpt2 = bptc2.tree;
-        auto &altitude2 = bptc2.altitudes;
+        auto bptc = bpt_canonical(graph, edge_weights);
+        auto &bpt = bptc.tree;
+        auto &altitude = bptc.altitudes;
+        auto &mst = bptc.mst;
+
+        // functor results are copied into plain xtensor containers: the second stages run in worker threads and
+        // must not allocate containers owned by a foreign runtime (e.g. numpy arrays)
+        using value_type = typename std::decay_t<decltype(xt::eval(attribute_functors[0](bpt, altitude)))>::value_type;
+        std::vector<array_1d<value_type>> bpt_attributes;
+        for (const auto &attribute_functor: attribute_functors) {
+            bpt_attributes.push_back(attribute_functor(bpt, altitude));
+        }
 
-        auto canonical_tree = simplify_tree(bpt2, [&altitude2, &bpt2](index_t i) {
-            return altitude2(i) == altitude2(parent(i, bpt2));
+        using result_type = decltype(watershed_hierarchy_internal::watershed_hierarchy_from_bpt_attribute(
+                bpt, altitude, mst, bpt_attributes[0]));
+        std::vector<result_type> results(attribute_functors.size());
+        parfor(0, attribute_functors.size(), [&bpt, &altitude, &mst, &bpt_attributes, &results](index_t i) {
+            results[i] = watershed_hierarchy_internal::watershed_hierarchy_from_bpt_attribute(
+                    bpt, altitude, mst, bpt_attributes[i]);
         });
-        auto canonical_altitude = xt::eval(xt::index_view(altitude2, canonical_tree.node_map));
 
-        return make_node_weighted_tree(std::move(canonical_tree.tree), std::move(canonical_altitude));
+        return results;
     };
 
     /**
@@ -156,16 +213,9 @@ namespace hg {
 
         auto mst_edge_weights = xt::view(persistence, xt::range(num_leaves(bpt), num_vertices(bpt)));
 
-        auto bptc2 = bpt_canonical(mst, mst_edge_weights);
-        auto &bpt2 = bptc2.tree;
-        auto &altitude2 = bptc2.altitudes;
-
-        auto canonical_tree = simplify_tree(bpt2, [&altitude2, &bpt2](index_t i) {
-            return altitude2(i) == altitude2(parent(i, bpt2));
-        });
-        auto canonical_altitude = xt::eval(
-                xt::index_view(minima_altitudes,
-                               xt::index_view(altitude2, canonical_tree.node_map)));
+        auto canonical_tree = hierarchy_core_internal::quasi_flat_zone_hierarchy_from_sorted_edges(
+                mst, mst_edge_weights, hierarchy_core_internal::stable_arg_sort_edge_weights(mst_edge_weights));
+        auto canonical_altitude = xt::eval(xt::index_view(minima_altitudes, canonical_tree.altitudes));
 
         return make_node_weighted_tree(std::move(canonical_tree.tree), std::move(canonical_altitude));
     };
@@ -49,6 +49,23 @@ namespace hg {
         return regular_grid_graph_2d(embedding, std::move(neighbours));
     }
 
+    /**
+     * Create a 6 adjacency implicit regular graph for the given 3d embedding
+     * @param embedding
+     * @return
+     */
+    inline
+    auto get_6_adjacency_implicit_graph(const embedding_grid_3d &embedding) {
+        std::vector<point_3d_i> neighbours{{{-1, 0,  0}},
+                                           {{0,  -1, 0}},
+                                           {{0,  0,  -1}},
+                                           {{0,  0,  1}},
+                                           {{0,  1,  0}},
+                                           {{1,  0,  0}}}; // 6 adjacency
+
+        return regular_grid_graph_3d(embedding, std::move(neighbours));
+    }
+
     /**
      * Create of 4 adjacency explicit regular graph for the given embedding
      * @param embedding
@@ -21,11 +21,17 @@
 
 #include <map>
 #include <deque>
+#include <queue>
 
 namespace hg {
 
     namespace tree_of_shapes_internal {
 
+        /**
+         * Width and height of the tiles of the parallel tree construction (see pre_tree_construction_tiled_2d).
+         */
+        const index_t tiled_construction_tile_size = 256;
+
         /**
          * A simple multi-level priority queue with fixed number of integer levels in [min_level, nax_level].
          *
@@ -229,19 +235,118 @@ namespace hg {
             return plain_map;
         }
 
+        /**
+         * Plain map of an image computed on the fly from the image values.
+         *
+         * If immersion is true, the plain map is the interpolation of the image in the Khalimsky grid: the grid
+         * has a size (s * 2 - 1) in each dimension and the interval associated to a face is given by the minimum
+         * and the maximum value of the (up to 2^dim) pixels around this face.
+         * Otherwise each pixel is simply associated to the degenerated interval [v, v] where v is its value.
+         *
+         * Contrarily to interpolate_plain_map_khalimsky_2d, the plain map is never stored: its memory footprint is
+         * the one of the input image.
+         *
+         * @tparam value_t type of the image values
+         * @tparam dim dimension of the image
+         */
+        template<typename value_t, int dim>
+        struct implicit_plain_map {
+            using value_type = value_t;
+
+            /**
+             * @param image flat image values (moved inside the plain map)
+             * @param shape shape of the image
+             * @param immersion if true, the plain map is interpolated in the Khalimsky grid
+             */
+            implicit_plain_map(array_1d<value_type> &&image, const std::array<index_t, dim> &shape, bool immersion) :
+                    m_image(std::move(image)),
+                    m_immersion(immersion) {
+                index_t stride = 1;
+                for (index_t k = dim - 1; k >= 0; k--) {
+                    m_shape[k] = (immersion) ? shape[k] * 2 - 1 : shape[k];
+                    m_strides[k] = stride;
+                    stride *= shape[k];
+                }
+            }
+
+            /**
+             * Shape of the plain map grid
+             */
+            const auto &shape() const {
+                return m_shape;
+            }
+
+            /**
+             * Number of faces of the plain map
+             */
+            index_t size() const {
+                index_t res = 1;
+                for (auto s: m_shape) {
+                    res *= s;
+                }
+                return res;
+            }
+
+            value_type min_value() const {
+                return xt::amin(m_image)();
+            }
+
+            value_type max_value() const {
+                return xt::amax(m_image)();
+            }
+
+            /**
+             * Lower (k = 0) or upper (k = 1) bound of the interval associated to the face v.
+             */
+            value_type operator()(index_t v, index_t k) const {
+                if (!m_immersion) {
+                    return m_image(v);
+                }
+                index_t offset = 0;
+                index_t num_odd = 0;
+                std::array<index_t, dim> odd_strides;
+                for (index_t d = dim - 1; d >= 0; d--) {
+                    index_t c = v % m_shape[d];
+                    v /= m_shape[d];
+                    offset += (c / 2) * m_strides[d];
+                    if (c % 2 == 1) {
+                        odd_strides[num_odd++] = m_strides[d];
+                    }
+                }
+                value_type res = m_image(offset);
+                for (index_t m = 1; m < ((index_t) 1 << num_odd); m++) {
+                    index_t i = offset;
+                    for (index_t b = 0; b < num_odd; b++) {
+                        if ((m >> b) & 1) {
+                            i += odd_strides[b];
+                        }
+                    }
+                    res = (k == 0) ? (std::min)(res, m_image(i)) : (std::max)(res, m_image(i));
+                }
+                return res;
+            }
+
+        private:
+            array_1d<value_type> m_image;
+            bool m_immersion;
+            std::array<index_t, dim> m_shape;
+            std::array<index_t, dim> m_strides;
+        };
+
         template<typename graph_t,
-                typename T,
-                typename value_type = typename T::value_type,
+                typename plain_map_t,
+                typename value_type = typename plain_map_t::value_type,
                 typename std::enable_if_t<sizeof(value_type) <= 2 && std::is_integral<value_type>::value, int> = 0>
-        auto sort_vertices_tree_of_shapes(const graph_t &graph,
-                                          const xt::xexpression<T> &xplain_map, index_t exterior_vertex = 0) {
-
-            auto &plain_map = xplain_map.derived_cast();
+        auto sort_vertices_tree_of_shapes_impl(const graph_t &graph,
+                                               const plain_map_t &plain_map,
+                                               value_type min_level,
+                                               value_type max_level,
+                                               index_t exterior_vertex) {
             auto num_v = num_vertices(graph);
             array_1d<bool> dejavu({num_v}, false);
             array_1d<index_t> sorted_vertex_indices = array_1d<index_t>::from_shape({num_v});
             array_1d<value_type> enqueued_level = array_1d<value_type>::from_shape({num_v});
-            integer_level_multi_queue<value_type, index_t> queue(xt::amin(plain_map)(), xt::amax(plain_map)());
+            integer_level_multi_queue<value_type, index_t> queue(min_level, max_level);
 
             value_type current_level = (value_type) ((plain_map(exterior_vertex, 0) + plain_map(exterior_vertex, 1)) /
                                                      2.0);
@@ -268,16 +373,14 @@ namespace hg {
         }
 
         template<typename graph_t,
-                typename T,
-                typename value_type = typename T::value_type,
+                typename plain_map_t,
+                typename value_type = typename plain_map_t::value_type,
                 typename std::enable_if_t<3 <= sizeof(value_type) || !std::is_integral<value_type>::value, int> = 0>
-        auto sort_vertices_tree_of_shapes(const graph_t &graph,
-                                          const xt::xexpression<T> &xplain_map, index_t exterior_vertex = 0) {
-
-            auto &plain_map = xplain_map.derived_cast();
-            hg_assert(plain_map.dimension() == 2, "Invalid plain map");
-            hg_assert(plain_map.shape()[1] == 2, "Invalid plain map");
-            hg_assert_vertex_weights(graph, plain_map);
+        auto sort_vertices_tree_of_shapes_impl(const graph_t &graph,
+                                               const plain_map_t &plain_map,
+                                               value_type /*min_level*/,
+                                               value_type /*max_level*/,
+                                               index_t exterior_vertex) {
             auto num_v = num_vertices(graph);
             array_1d<bool> dejavu({num_v}, false);
             array_1d<index_t> sorted_vertex_indices = array_1d<index_t>::from_shape({num_v});
@@ -328,6 +431,431 @@ namespace hg {
             return std::make_pair(std::move(sorted_vertex_indices), std::move(enqueued_level));
         }
 
+        /**
+         * Sorts the vertices of the graph in the propagation order of the tree of shapes algorithm.
+         *
+         * @param graph graph of the plain map
+         * @param xplain_map explicit plain map: 2d array of shape (num_vertices(graph), 2)
+         * @param exterior_vertex starting point of the propagation
+         * @return a pair (sorted vertex indices, enqueued levels)
+         */
+        template<typename graph_t, typename T>
+        auto sort_vertices_tree_of_shapes(const graph_t &graph,
+                                          const xt::xexpression<T> &xplain_map, index_t exterior_vertex = 0) {
+            auto &plain_map = xplain_map.derived_cast();
+            hg_assert(plain_map.dimension() == 2, "Invalid plain map");
+            hg_assert(plain_map.shape()[1] == 2, "Invalid plain map");
+            hg_assert_vertex_weights(graph, plain_map);
+            return sort_vertices_tree_of_shapes_impl(graph, plain_map, xt::amin(plain_map)(), xt::amax(plain_map)(),
+                                                     exterior_vertex);
+        }
+
+        /**
+         * Sorts the vertices of the graph in the propagation order of the tree of shapes algorithm.
+         *
+         * @param graph graph of the plain map
+         * @param plain_map implicit plain map
+         * @param exterior_vertex starting point of the propagation
+         * @return a pair (sorted vertex indices, enqueued levels)
+         */
+        template<typename graph_t, typename value_t, int dim>
+        auto sort_vertices_tree_of_shapes(const graph_t &graph,
+                                          const implicit_plain_map<value_t, dim> &plain_map,
+                                          index_t exterior_vertex = 0) {
+            hg_assert((index_t) num_vertices(graph) == plain_map.size(), "Invalid plain map");
+            return sort_vertices_tree_of_shapes_impl(graph, plain_map, plain_map.min_value(), plain_map.max_value(),
+                                                     exterior_vertex);
+        }
+
+        /**
+         * Maps the vertices of a padded and/or interpolated grid to the vertices of the original grid.
+         *
+         * A vertex of coordinates c in the padded/interpolated grid corresponds to the vertex of coordinates
+         * (c - border) / step of the original grid if (c - border) is a non negative multiple of step smaller
+         * than step * original_shape. Other vertices are mapped to invalid_index.
+         *
+         * @tparam dim grid dimension
+         */
+        template<int dim>
+        struct original_space_leaf_map {
+            std::array<index_t, dim> shape;
+            std::array<index_t, dim> original_shape;
+            index_t border;
+            index_t step;
+
+            index_t operator()(index_t v) const {
+                index_t res = 0;
+                index_t stride = 1;
+                for (index_t k = dim - 1; k >= 0; k--) {
+                    index_t c = v % shape[k] - border;
+                    v /= shape[k];
+                    if (c < 0 || c % step != 0) {
+                        return invalid_index;
+                    }
+                    c /= step;
+                    if (c >= original_shape[k]) {
+                        return invalid_index;
+                    }
+                    res += c * stride;
+                    stride *= original_shape[k];
+                }
+                return res;
+            }
+        };
+
+        /**
+         * Parallel computation of the parent relation of the tree of shapes on a 2d grid with the 4 adjacency,
+         * from the sorted vertices and enqueued levels given by sort_vertices_tree_of_shapes.
+         *
+         * The tree of shapes is the max-tree of the image giving, for each vertex, the number of level changes
+         * that occurred in the propagation before the vertex was dequeued [1]. This max-tree is computed
+         * independently on square tiles of the grid which are then merged pairwise along their borders [2].
+         * Tiles, and merges of disjoint pairs of regions, are processed in parallel.
+         *
+         * The canonical element of each node is the first vertex of the node in the propagation order, hence the
+         * result is identical to the parent relation obtained with pre_tree_construction followed by canonize_tree.
+         *
+         * [1] S. Crozet and Th. Géraud, "A first parallel algorithm to compute the morphological tree of shapes
+         *     of nD images," ICIP 2014.
+         *
+         * [2] M. H. F. Wilkinson, H. Gao, W. H. Hesselink, J. E. Jonker, and A. Meijster, "Concurrent computation
+         *     of attribute filters on shared memory parallel machines," PAMI, vol. 30, no. 10, 2008.
+         *
+         * @tparam T1
+         * @tparam T2
+         * @param shape shape of the grid
+         * @param vertex_weights enqueued levels of the vertices
+         * @param sorted_vertex_indices sorted vertices
+         * @param tile_size width and height of the tiles
+         * @return the canonized parent relation
+         */
+        template<typename T1, typename T2>
+        auto pre_tree_construction_tiled_2d(const std::array<index_t, 2> &shape,
+                                            const T1 &vertex_weights,
+                                            const T2 &sorted_vertex_indices,
+                                            index_t tile_size) {
+            hg_assert(tile_size > 0, "Tile size must be positive.");
+            const index_t h = shape[0];
+            const index_t w = shape[1];
+            const index_t num_v = h * w;
+            const index_t num_tiles_y = (h + tile_size - 1) / tile_size;
+            const index_t num_tiles_x = (w + tile_size - 1) / tile_size;
+            const index_t num_tiles = num_tiles_y * num_tiles_x;
+
+            array_1d<index_t> parent = array_1d<index_t>::from_shape({(size_t) num_v});
+            array_1d<index_t> depth = array_1d<index_t>::from_shape({(size_t) num_v});
+
+            {
+                array_1d<index_t> rank = array_1d<index_t>::from_shape({(size_t) num_v});
+                index_t current_depth = 0;
+                for (index_t i = 0; i < num_v; i++) {
+                    auto v = sorted_vertex_indices[i];
+                    if (i > 0 && vertex_weights[v] != vertex_weights[sorted_vertex_indices[i - 1]]) {
+                        current_depth++;
+                    }
+                    rank(v) = i;
+                    depth(v) = current_depth;
+                }
+
+                // vertices of each tile in propagation order
+                auto tile_of = [&w, &tile_size, &num_tiles_x](index_t v) {
+                    return ((v / w) / tile_size) * num_tiles_x + (v % w) / tile_size;
+                };
+                array_1d<index_t> tile_begin({(size_t) num_tiles + 1}, 0);
+                for (index_t v = 0; v < num_v; v++) {
+                    tile_begin(tile_of(v) + 1)++;
+                }
+                for (index_t t = 0; t < num_tiles; t++) {
+                    tile_begin(t + 1) += tile_begin(t);
+                }
+                array_1d<index_t> tile_vertices = array_1d<index_t>::from_shape({(size_t) num_v});
+                {
+                    array_1d<index_t> position = xt::view(tile_begin, xt::range(0, num_tiles));
+                    for (index_t i = 0; i < num_v; i++) {
+                        auto v = sorted_vertex_indices[i];
+                        tile_vertices(position(tile_of(v))++) = v;
+                    }
+                }
+
+                // max-tree of each tile: union find with path compression on disjoint parts of zpar
+                array_1d<index_t> zpar = array_1d<index_t>::from_shape({(size_t) num_v});
+                auto find_root = [&zpar](index_t x) {
+                    index_t r = x;
+                    while (zpar(r) != r) {
+                        r = zpar(r);
+                    }
+                    while (zpar(x) != r) {
+                        auto n = zpar(x);
+                        zpar(x) = r;
+                        x = n;
+                    }
+                    return r;
+                };
+
+                parfor(0, num_tiles, [&](index_t t) {
+                    index_t y0 = (t / num_tiles_x) * tile_size;
+                    index_t x0 = (t % num_tiles_x) * tile_size;
+                    index_t y1 = (std::min)(h, y0 + tile_size);
+                    index_t x1 = (std::min)(w, x0 + tile_size);
+
+                    auto process_neighbour = [&](index_t v, index_t n) {
+                        if (rank(n) > rank(v)) {
+                            auto r = find_root(n);
+                            if (r != v) {
+                                parent(r) = v;
+                                zpar(r) = v;
+                            }
+                        }
+                    };
+
+                    for (index_t i = tile_begin(t + 1) - 1; i >= tile_begin(t); i--) {
+                        auto v = tile_vertices(i);
+                        parent(v) = v;
+                        zpar(v) = v;
+                        index_t y = v / w;
+                        index_t x = v % w;
+                        if (y > y0) {
+                            process_neighbour(v, v - w);
+                        }
+                        if (x > x0) {
+                            process_neighbour(v, v - 1);
+                        }
+                        if (x + 1 < x1) {
+                            process_neighbour(v, v + 1);
+                        }
+                        if (y + 1 < y1) {
+                            process_neighbour(v, v + w);
+                        }
+                    }
+                });
+            }
+
+            auto levroot = [&parent, &depth](index_t x) {
+                index_t r = x;
+                while (parent(r) != r && depth(parent(r)) == depth(r)) {
+                    r = parent(r);
+                }
+                while (x != r) {
+                    auto n = parent(x);
+                    parent(x) = r;
+                    x = n;
+                }
+                return r;
+            };
+
+            // merges the branches of the trees containing x and y
+            auto connect = [&parent, &depth, &levroot](index_t x, index_t y) {
+                x = levroot(x);
+                y = levroot(y);
+                if (depth(y) > depth(x)) {
+                    std::swap(x, y);
+                }
+                while (x != y) {
+                    auto px = parent(x);
+                    if (px == x) {
+                        parent(x) = y;
+                        return;
+                    }
+                    auto z = levroot(px);
+                    if (depth(z) >= depth(y)) {
+                        x = z;
+                    } else {
+                        parent(x) = y;
+                        x = y;
+                        y = z;
+                    }
+                }
+            };
+
+            // merge tiles horizontally inside each row of tiles, then rows of tiles vertically
+            for (index_t s = 1; s < num_tiles_x; s *= 2) {
+                index_t num_pairs = (num_tiles_x + 2 * s - 1) / (2 * s);
+                parfor(0, num_tiles_y * num_pairs, [&](index_t k) {
+                    index_t c = ((k % num_pairs) * 2 * s + s) * tile_size;
+                    if (c >= w) {
+                        return;
+                    }
+                    index_t y0 = (k / num_pairs) * tile_size;
+                    index_t y1 = (std::min)(h, y0 + tile_size);
+                    for (index_t y = y0; y < y1; y++) {
+                        connect(y * w + c - 1, y * w + c);
+                    }
+                });
+            }
+            for (index_t s = 1; s < num_tiles_y; s *= 2) {
+                index_t num_pairs = (num_tiles_y + 2 * s - 1) / (2 * s);
+                parfor(0, num_pairs, [&](index_t k) {
+                    index_t r = (k * 2 * s + s) * tile_size;
+                    if (r >= h) {
+                        return;
+                    }
+                    for (index_t x = 0; x < w; x++) {
+                        connect((r - 1) * w + x, r * w + x);
+                    }
+                });
+            }
+
+            // canonical element of each node: first vertex of the node in propagation order
+            array_1d<index_t> canonical({(size_t) num_v}, invalid_index);
+            for (index_t i = 0; i < num_v; i++) {
+                auto v = sorted_vertex_indices[i];
+                auto r = levroot(v);
+                if (canonical(r) == invalid_index) {
+                    canonical(r) = v;
+                }
+            }
+
+            // all paths are now compressed
+            auto levroot_compressed = [&parent, &depth](index_t x) {
+                return (parent(x) != x && depth(parent(x)) == depth(x)) ? parent(x) : x;
+            };
+            array_1d<index_t> res = array_1d<index_t>::from_shape({(size_t) num_v});
+            parfor(0, num_v, [&](index_t v) {
+                auto r = levroot_compressed(v);
+                auto c = canonical(r);
+                res(v) = (v != c) ? c : canonical(levroot_compressed(parent(r)));
+            });
+            return res;
+        }
+
+        /**
+         * Tree of shapes in the original space from the pre-tree of the padded/interpolated space.
+         *
+         * The result is the same as calling component_tree_internal::tree_from_pre_tree, deleting every node
+         * that does not contain any original vertex, and calling simplify_tree with process_leaves = true.
+         * However, neither the tree of the padded/interpolated space nor its simplification are materialized:
+         * the canonized parent relation is directly expanded to the canonical elements containing at least one
+         * original vertex, and only original vertices become leaves.
+         *
+         * @tparam T1
+         * @tparam T2
+         * @tparam leaf_map_t
+         * @param pre_parents pre-parent relation of the padded/interpolated space (see pre_tree_construction)
+         * @param vertex_weights enqueued levels of the vertices of the padded/interpolated space
+         * @param sorted_vertex_indices sorted vertices of the padded/interpolated space
+         * @param num_original_vertices number of vertices in the original space
+         * @param leaf_map maps a vertex of the padded/interpolated space to its index in the original space, or to invalid_index
+         * @param canonized true if pre_parents is already a canonized parent relation (see canonize_tree)
+         * @return a node weighted tree
+         */
+        template<typename T1, typename T2, typename leaf_map_t>
+        auto tree_from_pre_tree_original_space(array_1d<index_t> &&pre_parents,
+                                               const T1 &vertex_weights,
+                                               const T2 &sorted_vertex_indices,
+                                               index_t num_original_vertices,
+                                               const leaf_map_t &leaf_map,
+                                               bool canonized = false) {
+            using value_type = typename T1::value_type;
+
+            array_1d<index_t> new_parents;
+            array_1d<value_type> altitudes;
+            index_t num_nodes = num_original_vertices;
+            {
+                array_1d<index_t> parents = std::move(pre_parents);
+                if (!canonized) {
+                    component_tree_internal::canonize_tree(parents, vertex_weights, sorted_vertex_indices);
+                }
+                index_t num_v = parents.size();
+
+                auto canonical_element = [&parents, &vertex_weights](index_t i) {
+                    return (vertex_weights[i] != vertex_weights[parents[i]]) ? i : parents[i];
+                };
+
+                // canonical elements whose component contains at least one original vertex
+                array_1d<bool> has_leaf({(size_t) num_v}, false);
+                for (index_t j = num_v - 1; j >= 0; j--) {
+                    auto i = sorted_vertex_indices[j];
+                    if (leaf_map(i) != invalid_index) {
+                        has_leaf(canonical_element(i)) = true;
+                    }
+                    if (has_leaf(i)) {
+                        has_leaf(parents[i]) = true;
+                    }
+                }
+
+                // same creation order as in component_tree_internal::expand_canonized_parent_relation
+                array_1d<index_t> node_index({(size_t) num_v}, invalid_index);
+                for (index_t j = num_v - 1; j >= 0; j--) {
+                    auto c = canonical_element(sorted_vertex_indices[j]);
+                    if (has_leaf(c) && node_index(c) == invalid_index) {
+                        node_index(c) = num_nodes++;
+                    }
+                }
+
+                new_parents.resize({(size_t) num_nodes});
+                altitudes.resize({(size_t) num_nodes});
+                for (index_t i = 0; i < num_v; i++) {
+                    auto l = leaf_map(i);
+                    if (l != invalid_index) {
+                        new_parents(l) = node_index(canonical_element(i));
+                        altitudes(l) = vertex_weights[i];
+                    }
+                    if (node_index(i) != invalid_index) {
+                        new_parents(node_index(i)) = node_index(parents[i]);
+                        altitudes(node_index(i)) = vertex_weights[i];
+                    }
+                }
+            }
+
+            // internal nodes are renumbered with a top-down breadth first traversal as in simplify_tree
+            hg::tree t(new_parents, tree_category::component_tree);
+            array_1d<index_t> new_order = array_1d<index_t>::from_shape({(size_t) num_nodes});
+            for (index_t i = 0; i < num_original_vertices; i++) {
+                new_order(i) = i;
+            }
+            index_t node_number = num_nodes - 1;
+            std::queue<index_t> queue;
+            queue.push(root(t));
+            while (!queue.empty()) {
+                auto e = queue.front();
+                queue.pop();
+                new_order(e) = node_number--;
+                for (auto c: children_iterator(e, t)) {
+                    if (!is_leaf(c, t)) {
+                        queue.push(c);
+                    }
+                }
+            }
+
+            array_1d<index_t> sparents = array_1d<index_t>::from_shape({(size_t) num_nodes});
+            array_1d<value_type> saltitudes = array_1d<value_type>::from_shape({(size_t) num_nodes});
+            for (index_t i = 0; i < num_nodes; i++) {
+                sparents(new_order(i)) = new_order(new_parents(i));
+                saltitudes(new_order(i)) = altitudes(i);
+            }
+            return make_node_weighted_tree(hg::tree(sparents, tree_category::component_tree),
+                                           std::move(saltitudes));
+        }
+
+        /**
+         * Tree of shapes in the original space from the sorted vertices of the padded/interpolated space.
+         *
+         * See tree_from_pre_tree_original_space.
+         *
+         * @tparam graph_t
+         * @tparam T1
+         * @tparam T2
+         * @tparam leaf_map_t
+         * @param graph graph of the padded/interpolated space
+         * @param vertex_weights enqueued levels of the vertices of the padded/interpolated space
+         * @param sorted_vertex_indices sorted vertices of the padded/interpolated space
+         * @param num_original_vertices number of vertices in the original space
+         * @param leaf_map maps a vertex of the padded/interpolated space to its index in the original space, or to invalid_index
+         * @return a node weighted tree
+         */
+        template<typename graph_t, typename T1, typename T2, typename leaf_map_t>
+        auto tree_from_sorted_vertices_original_space(const graph_t &graph,
+                                                      const T1 &vertex_weights,
+                                                      const T2 &sorted_vertex_indices,
+                                                      index_t num_original_vertices,
+                                                      const leaf_map_t &leaf_map) {
+            return tree_from_pre_tree_original_space(
+                    component_tree_internal::pre_tree_construction(graph, sorted_vertex_indices),
+                    vertex_weights,
+                    sorted_vertex_indices,
+                    num_original_vertices,
+                    leaf_map);
+        }
     }
 
     /**
@@ -346,7 +874,8 @@ namespace hg {
      * The algorithm used in this implementation was first described in [2].
      *
      * The tree is computed in the interpolated multivalued Khalimsky space to provide a continuous and autodual representation of
-     * input image.
+     * input image. The plain map of the interpolated space is never stored: the value of each face is computed on the fly
+     * from the pixels of the input image.
      *
      * If padding is different from tos_padding::none, an extra border of pixels is added to the input image before
      * anything else. This will ensure the existence of a shape encompassing all the shapes inside the input image
@@ -356,7 +885,8 @@ namespace hg {
      *   - the mean value of the boundary pixels of the input image if padding == tos_padding::mean
      *
      * If original_size is true, all the nodes corresponding to pixels not belonging to the input image are removed
-     * (except for the root node).
+     * (except for the root node). In this case, the tree of the padded/interpolated space is not materialized:
+     * only the pixels of the input image become leaves when the sorted vertices are transformed into a tree.
      * If original_size is false, the returned tree is the tree constructed in the interpolated/padded space.
      * In practice if the size of the input image is (h, w), the leaves of the returned tree will correspond to an image of size:
      *   - (h, w) if original_size is true;
@@ -376,6 +906,11 @@ namespace hg {
      * of a shape is defined with respect to this point). The coordinate of this point must be given in the
      * padded/interpolated space.
      *
+     * If parallel is true, the union-find step that transforms the propagation order into a tree is done on
+     * independent tiles of the interpolated space which are then merged pairwise (see
+     * tree_of_shapes_internal::pre_tree_construction_tiled_2d). The propagation itself remains sequential.
+     * The resulting tree is identical to the one obtained with parallel = false.
+     *
      * [1] Pa. Monasse, and F. Guichard, "Fast computation of a contrast-invariant image representation,"
      *     Image Processing, IEEE Transactions on, vol.9, no.5, pp.860-872, May 2000
      *
@@ -387,6 +922,7 @@ namespace hg {
      * @param padding Defines if an extra boundary of pixels is added to the original image (see enum tos_padding).
      * @param original_size remove all nodes corresponding to interpolated/padded pixels
      * @param exterior_vertex linear coordinate of the exterior point
+     * @param parallel use the tiled parallel tree construction
      * @return a node weighted tree
      */
     template<typename T>
@@ -394,7 +930,8 @@ namespace hg {
                                                tos_padding padding = tos_padding::mean,
                                                bool original_size = true,
                                                bool immersion = true,
-                                               index_t exterior_vertex = 0) {
+                                               index_t exterior_vertex = 0,
+                                               bool parallel = false) {
         HG_TRACE();
         auto &image = ximage.derived_cast();
         hg_assert(image.dimension() == 2, "image must be a 2d array");
@@ -402,14 +939,8 @@ namespace hg {
         auto shape = embedding.shape();
         size_t h = shape[0];
         size_t w = shape[1];
-        auto vertex_weights = xt::flatten(image);
         using value_type = typename T::value_type;
 
-        size_t rh;
-        size_t rw;
-
-        array_2d<value_type> cooked_vertex_values;
-
         auto do_padding = [&padding, &h, &w](const auto &image) {
             value_type pad_value;
             switch (padding) {
@@ -441,94 +972,165 @@ namespace hg {
             return padded_vertices;
         };
 
-        auto process_sorted_pixels = [&original_size, &padding, &rh, &rw, &immersion](auto &graph,
-                                                                                      auto &sorted_vertex_indices,
-                                                                                      auto &enqueued_levels) {
-            auto res_tree = component_tree_internal::tree_from_sorted_vertices(graph, enqueued_levels,
-                                                                               sorted_vertex_indices);
-            auto &tree = res_tree.tree;
-            auto &altitudes = res_tree.altitudes;
+        auto process_vertices = [&](array_1d<value_type> &&vertex_values, const std::array<index_t, 2> &vshape) {
+            index_t step = (immersion) ? 2 : 1;
+            std::array<index_t, 2> rshape{(vshape[0] - 1) * step + 1,
+                                          (vshape[1] - 1) * step + 1};
+            auto graph = get_4_adjacency_implicit_graph(rshape);
 
-            if (!original_size || (!immersion && padding == tos_padding::none)) {
-                return res_tree;
+            std::pair<array_1d<index_t>, array_1d<value_type>> res_sort;
+            {
+                tree_of_shapes_internal::implicit_plain_map<value_type, 2> plain_map(std::move(vertex_values),
+                                                                                     vshape,
+                                                                                     immersion);
+                res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, plain_map, exterior_vertex);
             }
 
-            array_1d<bool> deleted_vertices({num_leaves(res_tree.tree)}, true);
-            auto deleted = xt::reshape_view(deleted_vertices, {rh, rw});
-            if (immersion) {
-                if (padding != tos_padding::none) {
-                    xt::view(deleted, xt::range(2, rh - 2, 2), xt::range(2, rw - 2, 2)) = false;
-                } else {
-                    xt::view(deleted, xt::range(0, rh, 2), xt::range(0, rw, 2)) = false;
-                }
+            // the tiled construction directly gives a canonized parent relation
+            array_1d<index_t> pre_parents;
+            if (parallel) {
+                pre_parents = tree_of_shapes_internal::pre_tree_construction_tiled_2d(
+                        rshape,
+                        res_sort.second,
+                        res_sort.first,
+                        tree_of_shapes_internal::tiled_construction_tile_size);
             } else {
-                if (padding != tos_padding::none) {
-                    xt::view(deleted, xt::range(1, rh - 1), xt::range(1, rw - 1)) = false;
-                } // else handled by bypass if on top
+                pre_parents = component_tree_internal::pre_tree_construction(graph, res_sort.first);
+                component_tree_internal::canonize_tree(pre_parents, res_sort.second, res_sort.first);
             }
 
-            auto all_deleted = accumulate_sequential(tree, deleted_vertices, accumulator_min());
+            if (!original_size || (!immersion && padding == tos_padding::none)) {
+                return component_tree_internal::tree_from_canonized_parent_relation(pre_parents,
+                                                                                    res_sort.second,
+                                                                                    res_sort.first);
+            }
 
-            auto stree = simplify_tree(tree, all_deleted, true);
-            array_1d<value_type> saltitudes = xt::index_view(altitudes, stree.node_map);
-            return make_node_weighted_tree(std::move(stree.tree), std::move(saltitudes));
+            tree_of_shapes_internal::original_space_leaf_map<2> leaf_map{
+                    rshape,
+                    {(index_t) h, (index_t) w},
+                    (padding != tos_padding::none) ? step : 0,
+                    step};
+            return tree_of_shapes_internal::tree_from_pre_tree_original_space(std::move(pre_parents),
+                                                                              res_sort.second,
+                                                                              res_sort.first,
+                                                                              h * w,
+                                                                              leaf_map,
+                                                                              true);
         };
 
-        if (immersion) {
-            if (padding != tos_padding::none) {
+        if (padding != tos_padding::none) {
+            return process_vertices(do_padding(image), {(index_t) h + 2, (index_t) w + 2});
+        } else {
+            return process_vertices(xt::flatten(image), {(index_t) h, (index_t) w});
+        }
+    }
 
+    /**
+     * Computes the tree of shapes of a 3d image.
+     *
+     * This is the 3d counterpart of component_tree_tree_of_shapes_image2d: the tree is computed in the interpolated
+     * multivalued 3d Khalimsky space with the 6 adjacency, and the parameters padding, original_size, immersion, and
+     * exterior_vertex have the same meaning. In practice, if the size of the input image is (d, h, w), the leaves
+     * of the returned tree will correspond to an image of size:
+     *   - (d, h, w) if original_size is true;
+     *   - (d * 2 - 1, h * 2 - 1, w * 2 - 1) is original_size is false and padding is tos_padding::none; and
+     *   - ((d + 2) * 2 - 1, (h + 2) * 2 - 1, (w + 2) * 2 - 1) otherwise.
+     *
+     * As the interpolated space is 8 times larger than the original space, the plain map is never stored (face values
+     * are computed on the fly from the voxel values) and, when original_size is true, the tree is never materialized
+     * in the interpolated space: only the canonized parent relation of the interpolated space is computed, and it is
+     * directly expanded in the original space.
+     *
+     * @tparam T
+     * @param ximage Must be a 3d array
+     * @param padding Defines if an extra boundary of voxels is added to the original image (see enum tos_padding).
+     * @param original_size remove all nodes corresponding to interpolated/padded voxels
+     * @param immersion performs a plain map continuous immersion of the original image
+     * @param exterior_vertex linear coordinate of the exterior point
+     * @return a node weighted tree
+     */
+    template<typename T>
+    auto component_tree_tree_of_shapes_image3d(const xt::xexpression<T> &ximage,
+                                               tos_padding padding = tos_padding::mean,
+                                               bool original_size = true,
+                                               bool immersion = true,
+                                               index_t exterior_vertex = 0) {
+        HG_TRACE();
+        auto &image = ximage.derived_cast();
+        hg_assert(image.dimension() == 3, "image must be a 3d array");
+        using value_type = typename T::value_type;
+        std::array<index_t, 3> shape{(index_t) image.shape()[0], (index_t) image.shape()[1], (index_t) image.shape()[2]};
+        index_t d = shape[0];
+        index_t h = shape[1];
+        index_t w = shape[2];
 
-                auto cooked_vertex_values =
-                        tree_of_shapes_internal::interpolate_plain_map_khalimsky_2d(
-                                do_padding(image),
-                                {(index_t) (h + 2), (index_t) (w + 2)});
-                rh = (h + 2) * 2 - 1;
-                rw = (w + 2) * 2 - 1;
-                auto graph = get_4_adjacency_implicit_graph({(index_t) rh, (index_t) rw});
-                auto res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, cooked_vertex_values,
-                                                                                      exterior_vertex);
-                return process_sorted_pixels(graph, res_sort.first, res_sort.second);
-            } else {
-                auto cooked_vertex_values =
-                        tree_of_shapes_internal::interpolate_plain_map_khalimsky_2d(
-                                vertex_weights,
-                                embedding);
-                rh = h * 2 - 1;
-                rw = w * 2 - 1;
-                auto graph = get_4_adjacency_implicit_graph({(index_t) rh, (index_t) rw});
-                auto res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, cooked_vertex_values,
-                                                                                      exterior_vertex);
-                return process_sorted_pixels(graph, res_sort.first, res_sort.second);
+        auto do_padding = [&padding, &d, &h, &w](const auto &image) {
+            value_type pad_value;
+            switch (padding) {
+                case tos_padding::zero:
+                    pad_value = 0;
+                    break;
+                case tos_padding::mean: {
+                    double tmp = 0;
+                    index_t count = 0;
+                    for (index_t z = 0; z < d; z++) {
+                        for (index_t y = 0; y < h; y++) {
+                            for (index_t x = 0; x < w; x++) {
+                                if (z == 0 || z == d - 1 || y == 0 || y == h - 1 || x == 0 || x == w - 1) {
+                                    tmp += image(z, y, x);
+                                    count++;
+                                }
+                            }
+                        }
+                    }
+                    pad_value = (value_type) (tmp / count);
+                    break;
+                }
+                case none:
+                default:
+                    throw std::runtime_error("Incorrect padding value.");
             }
-        } else {
-            if (padding != tos_padding::none) {
-                auto padded_vertices = do_padding(image);
-
-                rh = h + 2;
-                rw = w + 2;
-                auto graph = get_4_adjacency_implicit_graph({(index_t) rh, (index_t) rw});
-
-                // clearly not optimal
-                array_2d<value_type> plain_map = array_2d<value_type>::from_shape({rh * rw, 2});
-                xt::noalias(xt::view(plain_map, xt::all(), 0)) = padded_vertices;
-                xt::noalias(xt::view(plain_map, xt::all(), 1)) = padded_vertices;
-                auto res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, plain_map,
-                                                                                      exterior_vertex);
-                return process_sorted_pixels(graph, res_sort.first, res_sort.second);
-            } else {
-                rh = h;
-                rw = w;
-                auto graph = get_4_adjacency_implicit_graph({(index_t) rh, (index_t) rw});
-                array_2d<value_type> plain_map = array_2d<value_type>::from_shape({rh * rw, 2});
-                xt::noalias(xt::view(plain_map, xt::all(), 0)) = xt::ravel(image);
-                xt::noalias(xt::view(plain_map, xt::all(), 1)) = xt::ravel(image);
-                auto res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, plain_map,
-                                                                                      exterior_vertex);
-                return process_sorted_pixels(graph, res_sort.first, res_sort.second);
+            array_1d<value_type> padded_vertices({(size_t) ((d + 2) * (h + 2) * (w + 2))}, pad_value);
+            auto padded_image = xt::reshape_view(padded_vertices, {(size_t) d + 2, (size_t) h + 2, (size_t) w + 2});
+            xt::noalias(xt::view(padded_image, xt::range(1, d + 1), xt::range(1, h + 1), xt::range(1, w + 1))) = image;
+            return padded_vertices;
+        };
+
+        auto process_vertices = [&](array_1d<value_type> &&vertex_values, const std::array<index_t, 3> &vshape) {
+            index_t step = (immersion) ? 2 : 1;
+            std::array<index_t, 3> rshape{(vshape[0] - 1) * step + 1,
+                                          (vshape[1] - 1) * step + 1,
+                                          (vshape[2] - 1) * step + 1};
+            auto graph = get_6_adjacency_implicit_graph(rshape);
+
+            std::pair<array_1d<index_t>, array_1d<value_type>> res_sort;
+            {
+                tree_of_shapes_internal::implicit_plain_map<value_type, 3> plain_map(std::move(vertex_values),
+                                                                                     vshape,
+                                                                                     immersion);
+                res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, plain_map, exterior_vertex);
             }
 
-        }
+            if (!original_size || (!immersion && padding == tos_padding::none)) {
+                return component_tree_internal::tree_from_sorted_vertices(graph, res_sort.second, res_sort.first);
+            }
 
+            tree_of_shapes_internal::original_space_leaf_map<3> leaf_map{
+                    rshape,
+                    shape,
+                    (padding != tos_padding::none) ? step : 0,
+                    step};
+            return tree_of_shapes_internal::tree_from_sorted_vertices_original_space(graph,
+                                                                                     res_sort.second,
+                                                                                     res_sort.first,
+                                                                                     d * h * w,
+                                                                                     leaf_map);
+        };
 
+        if (padding != tos_padding::none) {
+            return process_vertices(do_padding(image), {d + 2, h + 2, w + 2});
+        } else {
+            return process_vertices(xt::flatten(image), shape);
+        }
     }
 };
@@ -10,11 +10,33 @@
 
 #pragma once
 #include "../../utils.hpp"
+#include "xtensor/xcontainer.hpp"
+#include <type_traits>
 
 namespace hg {
 
     namespace details {
 
+        /**
+         * True if T is an xtensor container with a contiguous row major storage (whose rows can thus be accessed
+         * with raw pointers).
+         */
+        template<typename T>
+        struct is_row_major_container {
+            using container_type = std::remove_const_t<T>;
+            static const bool value = std::is_base_of<xt::xcontainer<container_type>, container_type>::value &&
+                                      container_type::static_layout == xt::layout_type::row_major;
+        };
+
+        template<typename T>
+        auto data_begin(T &data, std::true_type) {
+            return data.data();
+        }
+
+        template<typename T>
+        auto data_begin(T &data, std::false_type) {
+            return data.begin();
+        }
 
         /**
          * An efficient and simple view over the first axis of an xtensor container
@@ -22,6 +44,8 @@ namespace hg {
          *
          * Mostly provide range functions (begin, end) and an assignement operator.
          *
+         * If the underlying container is a row major xtensor container, the range functions return raw pointers.
+         *
          * The view must know at compile time if the underlying container has more than one dimension
          * (i.e. if the view contain a scalar or more elements) in order to perform compile time optimization.
          *
@@ -57,42 +81,42 @@ namespace hg {
 
             template<typename T1=self_type>
             auto begin(typename std::enable_if_t<T1::is_vectorial> * = 0) {
-                return m_data.begin() + m_position * m_stride;
+                return data_begin() + m_position * m_stride;
             }
 
             template<typename T1=self_type>
             auto begin(typename std::enable_if_t<!T1::is_vectorial> * = 0) {
-                return m_data.begin() + m_position;
+                return data_begin() + m_position;
             }
 
             template<typename T1=self_type>
             auto end(typename std::enable_if_t<T1::is_vectorial> * = 0) {
-                return m_data.begin() + (m_position + 1) * m_stride;
+                return data_begin() + (m_position + 1) * m_stride;
             }
 
             template<typename T1=self_type>
             auto end(typename std::enable_if_t<!T1::is_vectorial> * = 0) {
-                return m_data.begin() + (m_position + 1);
+                return data_begin() + (m_position + 1);
             }
 
             template<typename T1=self_type>
             auto begin(typename std::enable_if_t<T1::is_vectorial> * = 0) const {
-                return m_data.begin() + m_position * m_stride;
+                return data_begin() + m_position * m_stride;
             }
 
             template<typename T1=self_type>
             auto begin(typename std::enable_if_t<!T1::is_vectorial> * = 0) const {
-                return m_data.begin() + m_position;
+                return data_begin() + m_position;
             }
 
             template<typename T1=self_type>
             auto end(typename std::enable_if_t<T1::is_vectorial> * = 0) const {
-                return m_data.begin() + (m_position + 1) * m_stride;
+                return data_begin() + (m_position + 1) * m_stride;
             }
 
             template<typename T1=self_type>
             auto end(typename std::enable_if_t<!T1::is_vectorial> * = 0) const {
-                return m_data.storage_begin() + (m_position + 1);
+                return data_begin() + (m_position + 1);
             }
 
             template<bool vectorial2, typename T2>
@@ -126,6 +150,14 @@ namespace hg {
 
         private:
 
+            auto data_begin() {
+                return details::data_begin(m_data, std::integral_constant<bool, is_row_major_container<T>::value>());
+            }
+
+            auto data_begin() const {
+                return details::data_begin(m_data, std::integral_constant<bool, is_row_major_container<T>::value>());
+            }
+
             template<typename T1, typename T2>
             std::enable_if_t<T1::is_vectorial> assign(T1 &lhs, const T2 &rhs) {
                 static_assert(T1::is_vectorial == T2::is_vectorial,
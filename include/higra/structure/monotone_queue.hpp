@@ -0,0 +1,234 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "../utils.hpp"
+
+namespace hg {
+
+    namespace monotone_queue_internal {
+
+        /**
+         * Order preserving conversion of a numeric value into an unsigned 64 bits integer.
+         */
+        template<typename T, typename = void>
+        struct radix_key;
+
+        template<typename T>
+        struct radix_key<T, std::enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>> {
+            static uint64_t convert(T value) {
+                return (uint64_t) value;
+            }
+        };
+
+        template<typename T>
+        struct radix_key<T, std::enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>> {
+            static uint64_t convert(T value) {
+                return ((uint64_t) (int64_t) value) ^ (((uint64_t) 1) << 63);
+            }
+        };
+
+        template<>
+        struct radix_key<float> {
+            static uint64_t convert(float value) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(float));
+                bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+                return (uint64_t) bits;
+            }
+        };
+
+        template<>
+        struct radix_key<double> {
+            static uint64_t convert(double value) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(double));
+                return (bits & (((uint64_t) 1) << 63)) ? ~bits : (bits | (((uint64_t) 1) << 63));
+            }
+        };
+
+        /**
+         * Number of significant bits of a non zero value.
+         */
+        inline
+        index_t bit_width(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+            return 64 - __builtin_clzll(value);
+#else
+            index_t res = 0;
+            while (value != 0) {
+                value >>= 1;
+                res++;
+            }
+            return res;
+#endif
+        }
+    }
+
+    /**
+     * Bucket based priority queue for small integer priorities in [0, num_buckets[.
+     *
+     * Elements with the same priority are poped in last in first out order.
+     * Push and pop operations are in constant amortized time, finding the next non empty bucket costs O(1) amortized
+     * if the queue is used monotonically (i.e. if no element is pushed with a priority lower than the priority of the last
+     * poped element) and O(num_buckets) otherwise.
+     *
+     * @tparam value_t type of the stored elements
+     */
+    template<typename value_t = index_t>
+    struct bucket_queue {
+
+        bucket_queue(size_t num_buckets) : m_buckets(num_buckets), m_current(num_buckets) {
+        }
+
+        void push(index_t priority, const value_t &value) {
+            m_buckets[priority].push_back(value);
+            m_size++;
+            if (priority < m_current) {
+                m_current = priority;
+            }
+        }
+
+        /**
+         * Priority of the top element (undefined if the queue is empty)
+         */
+        index_t top_priority() {
+            while (m_buckets[m_current].empty()) {
+                m_current++;
+            }
+            return m_current;
+        }
+
+        /**
+         * Element with the smallest priority (undefined if the queue is empty)
+         */
+        const value_t &top() {
+            return m_buckets[top_priority()].back();
+        }
+
+        void pop() {
+            m_buckets[top_priority()].pop_back();
+            m_size--;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+    private:
+        std::vector<std::vector<value_t>> m_buckets;
+        index_t m_current;
+        size_t m_size = 0;
+    };
+
+    /**
+     * Monotone priority queue with 64 bits unsigned integer priorities.
+     *
+     * The queue is monotone: an element cannot be pushed with a priority lower than the priority of the last poped element.
+     * Push is in constant time and pop is in O(log(C)) amortized time where C is the difference between the largest and
+     * the smallest priorities in the queue.
+     *
+     * Numeric priorities (including floating point numbers) can be converted into radix heap priorities with the
+     * static function key.
+     *
+     * Ahuja, R. K., Mehlhorn, K., Orlin, J., & Tarjan, R. E. (1990). Faster algorithms for the shortest path problem.
+     * Journal of the ACM, 37(2), 213-223.
+     *
+     * @tparam value_t type of the stored elements
+     */
+    template<typename value_t = index_t>
+    struct radix_heap {
+
+        using priority_type = uint64_t;
+
+        /**
+         * Order preserving conversion of a numeric value into a radix heap priority
+         */
+        template<typename T>
+        static priority_type key(T value) {
+            return monotone_queue_internal::radix_key<T>::convert(value);
+        }
+
+        void push(priority_type priority, const value_t &value) {
+            m_buckets[bucket_index(priority)].emplace_back(priority, value);
+            m_size++;
+        }
+
+        /**
+         * Priority of the top element (undefined if the queue is empty)
+         */
+        priority_type top_priority() {
+            refill();
+            return m_last;
+        }
+
+        /**
+         * Element with the smallest priority (undefined if the queue is empty)
+         */
+        const value_t &top() {
+            refill();
+            return m_buckets[0].back().second;
+        }
+
+        void pop() {
+            refill();
+            m_buckets[0].pop_back();
+            m_size--;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        size_t size() const {
+            return m_size;
+        }
+
+    private:
+
+        index_t bucket_index(priority_type priority) const {
+            return (priority == m_last) ? 0 : monotone_queue_internal::bit_width(priority ^ m_last);
+        }
+
+        void refill() {
+            if (!m_buckets[0].empty()) {
+                return;
+            }
+            index_t i = 1;
+            while (m_buckets[i].empty()) {
+                i++;
+            }
+            auto &bucket = m_buckets[i];
+            priority_type new_last = bucket[0].first;
+            for (const auto &element: bucket) {
+                new_last = (std::min)(new_last, element.first);
+            }
+            m_last = new_last;
+            for (const auto &element: bucket) {
+                m_buckets[bucket_index(element.first)].push_back(element);
+            }
+            bucket.clear();
+        }
+
+        std::array<std::vector<std::pair<priority_type, value_t>>, 65> m_buckets;
+        priority_type m_last = 0;
+        size_t m_size = 0;
+    };
+}
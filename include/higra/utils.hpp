@@ -15,6 +15,8 @@
 #include <string>
 #include <iostream>
 #include <stack>
+#include <vector>
+#include <algorithm>
 #include "xtensor/xstrided_view.hpp"
 #include "xtensor/xio.hpp"
 #include "detail/log.hpp"
@@ -234,6 +236,121 @@ namespace hg {
 #endif
     }
 
+    /**
+     * Minimal size of a problem (number of values, vertices, edges...) for its parallel processing.
+     */
+    const index_t parallel_min_size = 1 << 16;
+
+    /**
+     * True if a problem of the given size should be processed in parallel: Higra is compiled with TBB and the size
+     * is at least min_size.
+     */
+    inline
+    bool use_parallel(index_t size, index_t min_size = parallel_min_size) {
+#ifdef HG_USE_TBB
+        return size >= min_size;
+#else
+        (void) size;
+        (void) min_size;
+        return false;
+#endif
+    }
+
+    /**
+     * Calls fun(first, last) on the consecutive blocks [b * block_size, min(size, (b + 1) * block_size)) covering
+     * [0, size). Blocks are processed in parallel if parallel is true and if there are several of them, and
+     * sequentially in increasing order otherwise.
+     */
+    template<typename lambda_t>
+    void parfor_blocks(index_t size, index_t block_size, bool parallel, const lambda_t &fun) {
+        const index_t num_blocks = (size + block_size - 1) / block_size;
+        auto process = [&fun, size, block_size](index_t b) {
+            fun(b * block_size, (std::min)(size, (b + 1) * block_size));
+        };
+        if (parallel && num_blocks > 1) {
+            parfor(0, num_blocks, process);
+        } else {
+            for (index_t b = 0; b < num_blocks; b++) {
+                process(b);
+            }
+        }
+    }
+
+    /**
+     * Block size of the parallel prefix sums.
+     */
+    const index_t prefix_sum_block_size = 1 << 16;
+
+    /**
+     * Exclusive prefix sum of the given values: result[i] = values[0] + ... + values[i - 1].
+     * The sum is computed by blocks in parallel.
+     *
+     * @param values input values (random access container of integral values)
+     * @param result output container (must have the same size as values, may be values itself)
+     * @return the sum of all values
+     */
+    template<typename T1, typename T2>
+    index_t exclusive_prefix_sum(const T1 &values, T2 &result) {
+        const index_t size = (index_t) values.size();
+        const index_t num_blocks = (size + prefix_sum_block_size - 1) / prefix_sum_block_size;
+        std::vector<index_t> block_sums(num_blocks + 1, 0);
+        parfor_blocks(size, prefix_sum_block_size, true, [&values, &block_sums](index_t first, index_t last) {
+            index_t sum = 0;
+            for (index_t i = first; i < last; i++) {
+                sum += values[i];
+            }
+            block_sums[first / prefix_sum_block_size + 1] = sum;
+        });
+        for (index_t b = 0; b < num_blocks; b++) {
+            block_sums[b + 1] += block_sums[b];
+        }
+        parfor_blocks(size, prefix_sum_block_size, true, [&values, &result, &block_sums](index_t first, index_t last) {
+            index_t sum = block_sums[first / prefix_sum_block_size];
+            for (index_t i = first; i < last; i++) {
+                auto value = values[i];
+                result[i] = sum;
+                sum += value;
+            }
+        });
+        return block_sums[num_blocks];
+    }
+
+    /**
+     * Stream compaction: result receives, in increasing order of i, the values value(i) of the indices i in [0, size)
+     * such that keep(i) is true. The output positions are given by an exclusive prefix sum of the block counts,
+     * blocks being processed in parallel if parallel is true. keep is evaluated twice for each index.
+     *
+     * @param size number of indices
+     * @param parallel process the blocks in parallel
+     * @param keep predicate on indices
+     * @param value function giving the output value of a kept index
+     * @param result output vector, resized to the number of kept indices
+     */
+    template<typename T, typename keep_t, typename value_t>
+    void compact(index_t size, bool parallel, const keep_t &keep, const value_t &value, std::vector<T> &result) {
+        const index_t num_blocks = (size + prefix_sum_block_size - 1) / prefix_sum_block_size;
+        std::vector<index_t> block_counts(num_blocks + 1, 0);
+        parfor_blocks(size, prefix_sum_block_size, parallel, [&keep, &block_counts](index_t first, index_t last) {
+            index_t count = 0;
+            for (index_t i = first; i < last; i++) {
+                count += keep(i) ? 1 : 0;
+            }
+            block_counts[first / prefix_sum_block_size + 1] = count;
+        });
+        for (index_t b = 0; b < num_blocks; b++) {
+            block_counts[b + 1] += block_counts[b];
+        }
+        result.resize(block_counts[num_blocks]);
+        parfor_blocks(size, prefix_sum_block_size, parallel,
+                      [&keep, &value, &block_counts, &result](index_t first, index_t last) {
+                          index_t j = block_counts[first / prefix_sum_block_size];
+                          for (index_t i = first; i < last; i++) {
+                              if (keep(i)) {
+                                  result[j++] = value(i);
+                              }
+                          }
+                      });
+    }
 
     /**
      * Insert all elements of collection b at the end of collection a.
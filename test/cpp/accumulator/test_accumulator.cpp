@@ -11,6 +11,7 @@
 #include "higra/structure/array.hpp"
 #include "higra/accumulator/accumulator.hpp"
 #include "higra/structure/details/light_axis_view.hpp"
+#include "xtensor/xrandom.hpp"
 #include <vector>
 
 namespace accumulator {
@@ -110,4 +111,43 @@ namespace accumulator {
         REQUIRE(res7 == 2);
 
     }
-}
\ No newline at end of file
+
+    template<typename T, typename acc_t>
+    void check_accumulate_rows(acc_t accFactory) {
+        const hg::index_t num_rows = 5;
+        const hg::index_t size = 19;
+        hg::array_2d<T> values = xt::cast<T>(xt::random::randint<int>({num_rows, size}, 1, 4));
+        hg::array_1d<T> storage1 = hg::array_1d<T>::from_shape({size});
+        hg::array_1d<T> storage2 = hg::array_1d<T>::from_shape({size});
+
+        auto acc1 = accFactory.template make_accumulator<true>(storage1);
+        acc1.initialize();
+        for (hg::index_t i = 0; i < num_rows; i++) {
+            acc1.accumulate(&values(i, 0));
+        }
+        acc1.finalize();
+
+        std::vector<T *> rows;
+        for (hg::index_t i = 0; i < num_rows; i++) {
+            rows.push_back(&values(i, 0));
+        }
+        auto acc2 = accFactory.template make_accumulator<true>(storage2);
+        acc2.initialize();
+        acc2.accumulate_rows(rows.data(), num_rows);
+        acc2.finalize();
+
+        REQUIRE((storage1 == storage2));
+    }
+
+    TEST_CASE("accumulator vectorial rows", "[accumulator]") {
+        xt::random::seed(42);
+        check_accumulate_rows<int>(hg::accumulator_sum());
+        check_accumulate_rows<int>(hg::accumulator_max());
+        check_accumulate_rows<float>(hg::accumulator_min());
+        check_accumulate_rows<float>(hg::accumulator_prod());
+        check_accumulate_rows<double>(hg::accumulator_mean());
+        check_accumulate_rows<double>(hg::accumulator_sum());
+        check_accumulate_rows<float>(hg::accumulator_sum());
+        check_accumulate_rows<float>(hg::accumulator_mean());
+    }
+}
@@ -9,6 +9,7 @@
 ****************************************************************************/
 #include "../test_utils.hpp"
 #include "higra/accumulator/at_accumulator.hpp"
+#include "xtensor/xrandom.hpp"
 
 using namespace hg;
 
@@ -35,4 +36,105 @@ namespace accumulator {
                 {4, 9}};
         REQUIRE((res_vec == expected_res_vec));
     }
-}
\ No newline at end of file
+
+    template<typename T>
+    void check_same_result(const T &res1, const T &res2, bool exact) {
+        if (exact) {
+            REQUIRE((res1 == res2));
+        } else {
+            REQUIRE(xt::allclose(res1, res2));
+        }
+    }
+
+    /*
+     * Values are accumulated in the same order by both versions: results are identical, except for the accumulators
+     * with a final division (mean) whose rounding may differ depending on how the compiler optimized each path.
+     */
+    template<typename T, typename accumulator_t>
+    void check_at_accumulate(const array_1d<index_t> &indices, const T &weights, const accumulator_t &accumulator,
+                             bool exact = true) {
+        if (weights.dimension() == 1) {
+            auto res1 = at_accumulator_internal::at_accumulate<false>(indices, weights, accumulator, false);
+            auto res2 = at_accumulator_internal::at_accumulate<false>(indices, weights, accumulator, true);
+            check_same_result(res1, res2, exact);
+        } else {
+            auto res1 = at_accumulator_internal::at_accumulate<true>(indices, weights, accumulator, false);
+            auto res2 = at_accumulator_internal::at_accumulate<true>(indices, weights, accumulator, true);
+            check_same_result(res1, res2, exact);
+        }
+    }
+
+    TEST_CASE("test at_accumulator parallel", "at_accumulator") {
+        xt::random::seed(42);
+        size_t size = 5000;
+        array_1d<index_t> indices = xt::random::randint<index_t>({size}, -1, 500);
+        array_1d<double> weights = xt::random::rand<double>({size});
+        array_2d<double> weights_vec = xt::random::rand<double>({size, (size_t) 3});
+
+        check_at_accumulate(indices, weights, accumulator_sum());
+        check_at_accumulate(indices, weights, accumulator_min());
+        check_at_accumulate(indices, weights, accumulator_mean(), false);
+        check_at_accumulate(indices, weights, accumulator_first());
+        check_at_accumulate(indices, weights, accumulator_last());
+        check_at_accumulate(indices, weights_vec, accumulator_max());
+        check_at_accumulate(indices, weights_vec, accumulator_prod());
+        check_at_accumulate(indices, weights_vec, accumulator_mean(), false);
+        check_at_accumulate(indices, weights_vec, accumulator_last());
+
+        auto res = accumulate_at(indices, weights, accumulator_counter());
+        for (index_t i = 0; i < (index_t) res.size(); i++) {
+            REQUIRE(res(i) == xt::sum(xt::equal(indices, i))());
+        }
+    }
+
+    TEST_CASE("test at_accumulator single precision sums", "at_accumulator") {
+        xt::random::seed(42);
+        size_t size = 5000;
+        array_1d<index_t> indices = xt::random::randint<index_t>({size}, -1, 500);
+        array_1d<float> weights = xt::random::rand<float>({size});
+        array_2d<float> weights_vec = xt::random::rand<float>({size, (size_t) 3});
+        array_1d<double> weights_d = weights;
+        array_2d<double> weights_vec_d = weights_vec;
+
+        check_at_accumulate(indices, weights, accumulator_sum(), false);
+        check_at_accumulate(indices, weights_vec, accumulator_mean(), false);
+
+        REQUIRE(xt::allclose(accumulate_at(indices, weights, accumulator_sum()),
+                             accumulate_at(indices, weights_d, accumulator_sum())));
+        REQUIRE(xt::allclose(accumulate_at(indices, weights, accumulator_mean()),
+                             accumulate_at(indices, weights_d, accumulator_mean())));
+        REQUIRE(xt::allclose(accumulate_at(indices, weights_vec, accumulator_sum()),
+                             accumulate_at(indices, weights_vec_d, accumulator_sum())));
+        REQUIRE(xt::allclose(accumulate_at(indices, weights_vec, accumulator_mean()),
+                             accumulate_at(indices, weights_vec_d, accumulator_mean())));
+    }
+
+    TEST_CASE("test at_accumulator output type", "at_accumulator") {
+        array_1d<index_t> indices{0, 0, -1, 1, 1, 1};
+        array_1d<int> weights{1, 2, 7, 3, 4, 4};
+        array_2d<int> weights_vec{{1, 2},
+                                  {2, 2},
+                                  {7, 7},
+                                  {3, 1},
+                                  {4, 1},
+                                  {4, 2}};
+        array_1d<double> expected_mean{1.5, 11.0 / 3};
+        array_2d<double> expected_mean_vec{{1.5, 2},
+                                           {11.0 / 3, 4.0 / 3}};
+
+        auto res = accumulate_at<array_1d<int>, accumulator_mean, double>(indices, weights, accumulator_mean());
+        REQUIRE(xt::allclose(res, expected_mean));
+        auto res_vec = accumulate_at<array_2d<int>, accumulator_mean, double>(indices, weights_vec,
+                                                                              accumulator_mean());
+        REQUIRE(xt::allclose(res_vec, expected_mean_vec));
+
+        for (bool parallel: {false, true}) {
+            auto res_sum = at_accumulator_internal::at_accumulate<false, array_1d<int>, accumulator_sum, float>(
+                    indices, weights, accumulator_sum(), parallel);
+            REQUIRE((res_sum == array_1d<float>{3, 11}));
+            auto res_mean = at_accumulator_internal::at_accumulate<true, array_2d<int>, accumulator_mean, double>(
+                    indices, weights_vec, accumulator_mean(), parallel);
+            REQUIRE(xt::allclose(res_mean, expected_mean_vec));
+        }
+    }
+}
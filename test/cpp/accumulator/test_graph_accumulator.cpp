@@ -11,6 +11,7 @@
 #include "../test_utils.hpp"
 #include "higra/accumulator/graph_accumulator.hpp"
 #include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
 
 namespace graph_accumulator {
 
@@ -75,4 +76,53 @@ namespace graph_accumulator {
         };
         REQUIRE(xt::allclose(ref2, res2));
     }
-}
\ No newline at end of file
+
+    TEST_CASE("accumulator graph mean", "[graph_accumulator]") {
+
+        ugraph g = get_4_adjacency_graph({2, 3});
+
+        array_1d<double> edge_weights{1, 2, 3, 4, 6, 5, 7};
+        auto res1 = accumulate_graph_edges(g, edge_weights, accumulator_mean());
+        array_1d<double> ref1{1.5, 8 / 3.0, 4.5, 3.5, 16 / 3.0, 6.5};
+        REQUIRE(xt::allclose(ref1, res1));
+
+        array_1d<double> vertex_weights{1, 2, 3, 4, 5, 6};
+        auto res2 = accumulate_graph_vertices(get_4_adjacency_implicit_graph({2, 3}), vertex_weights,
+                                              accumulator_mean());
+        array_1d<double> ref2{3, 3, 4, 3, 4, 4};
+        REQUIRE(xt::allclose(ref2, res2));
+
+        array_1d<int> edge_weights2{1, 2, 3, 4, 6, 5, 7};
+        auto res3 = accumulate_graph_edges<ugraph, array_1d<int>, accumulator_mean, float>(g, edge_weights2,
+                                                                                         accumulator_mean());
+        static_assert(std::is_same<decltype(res3)::value_type, float>::value, "Wrong output type.");
+        REQUIRE(xt::allclose(ref1, res3));
+    }
+
+    TEST_CASE("accumulator graph parallel", "[graph_accumulator]") {
+        using namespace graph_accumulator_detail;
+        xt::random::seed(42);
+        embedding_grid_2d embedding{150, 100};
+        ugraph g = get_4_adjacency_graph(embedding);
+        auto gi = get_8_adjacency_implicit_graph(embedding);
+
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(g)});
+        array_2d<double> edge_weights2 = xt::random::rand<double>({num_edges(g), (size_t) 3});
+        array_1d<double> vertex_weights = xt::random::rand<double>({num_vertices(g)});
+        array_2d<double> vertex_weights2 = xt::random::rand<double>({num_vertices(g), (size_t) 3});
+
+        REQUIRE((accumulate_graph_edges_impl<false>(g, edge_weights, accumulator_sum(), true) ==
+                 accumulate_graph_edges_impl<false>(g, edge_weights, accumulator_sum(), false)));
+        REQUIRE((accumulate_graph_edges_impl<true>(g, edge_weights2, accumulator_mean(), true) ==
+                 accumulate_graph_edges_impl<true>(g, edge_weights2, accumulator_mean(), false)));
+        REQUIRE((accumulate_graph_vertices_impl<false>(g, vertex_weights, accumulator_max(), true) ==
+                 accumulate_graph_vertices_impl<false>(g, vertex_weights, accumulator_max(), false)));
+        REQUIRE((accumulate_graph_vertices_impl<true>(gi, vertex_weights2, accumulator_min(), true) ==
+                 accumulate_graph_vertices_impl<true>(gi, vertex_weights2, accumulator_min(), false)));
+
+        // explicit and implicit graphs
+        REQUIRE((accumulate_graph_vertices(g, vertex_weights2, accumulator_sum()) ==
+                 accumulate_graph_vertices(get_4_adjacency_implicit_graph(embedding), vertex_weights2,
+                                           accumulator_sum())));
+    }
+}
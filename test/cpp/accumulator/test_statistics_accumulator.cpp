@@ -0,0 +1,150 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "../test_utils.hpp"
+#include "higra/accumulator/statistics_accumulator.hpp"
+#include "higra/accumulator/tree_accumulator.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
+#include "xtensor/xsort.hpp"
+
+namespace statistics_accumulator {
+
+    using namespace hg;
+    using namespace std;
+
+    TEST_CASE("moments accumulator", "[statistics_accumulator]") {
+        tree t(xt::xarray<index_t>{5, 5, 6, 6, 6, 7, 7, 7});
+        array_1d<double> values{1, 3, 2, 7, 3};
+
+        auto state = accumulate_sequential(t, moments_leaf_state(values), accumulator_moments());
+
+        array_1d<double> ref_mean{1, 3, 2, 7, 3, 2, 4, 3.2};
+        array_1d<double> ref_variance{0, 0, 0, 0, 0, 1, 14.0 / 3, 4.16};
+        REQUIRE(xt::allclose(moments_mean(state), ref_mean));
+        REQUIRE(xt::allclose(moments_variance(state), ref_variance));
+
+        // root: centered values -2.2, -0.2, -1.2, 3.8, -0.2
+        double m2 = 20.8;
+        double m3 = -10.648 - 0.008 - 1.728 + 54.872 - 0.008;
+        double m4 = 23.4256 + 0.0016 + 2.0736 + 208.5136 + 0.0016;
+        REQUIRE(almost_equal(moments_skewness(state)(7), std::sqrt(5.0) * m3 / std::pow(m2, 1.5)));
+        REQUIRE(almost_equal(moments_kurtosis(state)(7), 5 * m4 / (m2 * m2)));
+        REQUIRE(moments_skewness(state)(0) == 0);
+    }
+
+    TEST_CASE("moments accumulator random", "[statistics_accumulator]") {
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({30, 30});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(graph)}) * 10);
+        auto qfz = quasi_flat_zone_hierarchy(graph, edge_weights);
+        auto &t = qfz.tree;
+        auto n_leaves = num_leaves(t);
+
+        array_2d<double> values = xt::random::rand<double>({n_leaves, (size_t) 2}) * 100;
+        auto state = accumulate_sequential(t, moments_leaf_state(values), accumulator_moments());
+        REQUIRE((state.shape() == std::vector<size_t>{num_vertices(t), 2, 5}));
+
+        auto area = accumulate_sequential(t, xt::ones<double>({n_leaves}), accumulator_sum());
+        array_2d<double> mean = accumulate_sequential(t, values, accumulator_sum()) /
+                                xt::view(area, xt::all(), xt::newaxis());
+        array_2d<double> mean2 = accumulate_sequential(t, xt::eval(values * values), accumulator_sum()) /
+                                 xt::view(area, xt::all(), xt::newaxis());
+        REQUIRE(xt::allclose(moments_mean(state), mean));
+        REQUIRE(xt::allclose(moments_variance(state), mean2 - mean * mean, 1e-05, 1e-06));
+    }
+
+    TEST_CASE("covariance accumulator", "[statistics_accumulator]") {
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({30, 30});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(graph)}) * 10);
+        auto qfz = quasi_flat_zone_hierarchy(graph, edge_weights);
+        auto &t = qfz.tree;
+        auto n_leaves = num_leaves(t);
+
+        array_2d<double> values = xt::random::rand<double>({n_leaves, (size_t) 3});
+        auto state = accumulate_sequential(t, covariance_leaf_state(values), accumulator_covariance());
+        REQUIRE((state.shape() == std::vector<size_t>{num_vertices(t), 13}));
+
+        auto mean = covariance_mean(state);
+        auto covariance = covariance_matrix(state);
+
+        auto area = accumulate_sequential(t, xt::ones<double>({n_leaves}), accumulator_sum());
+        array_2d<double> ref_mean = accumulate_sequential(t, values, accumulator_sum()) /
+                                    xt::view(area, xt::all(), xt::newaxis());
+        array_3d<double> products = xt::view(values, xt::all(), xt::all(), xt::newaxis()) *
+                                    xt::view(values, xt::all(), xt::newaxis(), xt::all());
+        array_3d<double> ref_mean2 = accumulate_sequential(t, products, accumulator_sum()) /
+                                     xt::view(area, xt::all(), xt::newaxis(), xt::newaxis());
+        array_3d<double> ref_covariance = ref_mean2 - xt::view(ref_mean, xt::all(), xt::all(), xt::newaxis()) *
+                                                      xt::view(ref_mean, xt::all(), xt::newaxis(), xt::all());
+        REQUIRE(xt::allclose(mean, ref_mean));
+        REQUIRE(xt::allclose(covariance, ref_covariance, 1e-05, 1e-07));
+    }
+
+    TEST_CASE("histogram accumulator", "[statistics_accumulator]") {
+        tree t(xt::xarray<index_t>{5, 5, 6, 6, 6, 7, 7, 7});
+        array_1d<double> values{0.5, 3.5, 2, 10, -1};
+
+        auto state = accumulate_sequential(t, histogram_leaf_state(values, 4, 0, 4), accumulator_sum());
+        array_2d<index_t> ref{{1, 0, 0, 0},
+                              {0, 0, 0, 1},
+                              {0, 0, 1, 0},
+                              {0, 0, 0, 1},
+                              {1, 0, 0, 0},
+                              {1, 0, 0, 1},
+                              {1, 0, 1, 1},
+                              {2, 0, 1, 2}};
+        REQUIRE((state == ref));
+    }
+
+    TEST_CASE("quantile sketch accumulator", "[statistics_accumulator]") {
+        xt::random::seed(42);
+        // chain of nodes covering larger and larger sets of leaves
+        index_t n_leaves = 5000;
+        index_t n_internal = 50;
+        array_1d<index_t> parents = array_1d<index_t>::from_shape({(size_t) (n_leaves + n_internal)});
+        for (index_t i = 0; i < n_leaves; i++) {
+            parents(i) = n_leaves + (i * n_internal) / n_leaves;
+        }
+        for (index_t i = n_leaves; i < n_leaves + n_internal - 1; i++) {
+            parents(i) = i + 1;
+        }
+        parents(n_leaves + n_internal - 1) = n_leaves + n_internal - 1;
+        tree t(parents);
+
+        array_1d<double> values = xt::random::randn<double>({(size_t) n_leaves});
+        index_t size = 100;
+        auto state = accumulate_sequential(t, quantile_sketch_leaf_state(values, size), accumulator_quantile_sketch());
+        REQUIRE((state.shape() == std::vector<size_t>{(size_t) num_vertices(t), (size_t) (2 + 2 * size)}));
+
+        // bounded memory
+        for (index_t n = 0; n < (index_t) num_vertices(t); n++) {
+            REQUIRE(xt::sum(xt::view(state, n, xt::range(2 + size, 2 + 2 * size)))() ==
+                    (double) (n < n_leaves ? 1 : (n - n_leaves + 1) * (n_leaves / n_internal)));
+        }
+
+        for (double q: {0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0}) {
+            auto estimation = quantile_sketch_quantile(state, q);
+            REQUIRE(estimation(3) == values(3));
+            for (index_t n: {n_leaves, n_leaves + n_internal / 2, n_leaves + n_internal - 1}) {
+                index_t num_values = (n - n_leaves + 1) * (n_leaves / n_internal);
+                array_1d<double> sorted = xt::sort(xt::view(values, xt::range(0, num_values)));
+                // rank error of the estimation
+                double rank = (double) (std::lower_bound(sorted.begin(), sorted.end(), estimation(n)) -
+                                        sorted.begin()) / num_values;
+                REQUIRE(std::abs(rank - q) < 0.02);
+            }
+        }
+        REQUIRE(quantile_sketch_quantile(state, 0)(n_leaves + n_internal - 1) == xt::amin(values)());
+        REQUIRE(quantile_sketch_quantile(state, 1)(n_leaves + n_internal - 1) == xt::amax(values)());
+    }
+}
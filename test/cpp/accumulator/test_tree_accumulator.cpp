@@ -10,6 +10,9 @@
 
 #include "../test_utils.hpp"
 #include "higra/accumulator/tree_accumulator.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
 #include <functional>
 
 
@@ -47,6 +50,11 @@ namespace tree_accumulator {
         array_1d<index_t> ref3{1, 1, 1, 1, 1, 2, 2, 3};
         REQUIRE(xt::allclose(ref3, res3));
 
+        array_1d<double> input2{1, 2, 3, 4, 5, 6, 7, 8};
+        auto res4 = accumulate_parallel(tree, input2, hg::accumulator_mean());
+        array_1d<double> ref4{0, 0, 0, 0, 0, 1.5, 4, 6.5};
+        REQUIRE(xt::allclose(ref4, res4));
+
     }
 
     TEST_CASE("accumulator tree vectorial", "[tree_accumulator]") {
@@ -183,4 +191,103 @@ namespace tree_accumulator {
                            {8,  1}};
         REQUIRE(xt::allclose(ref4, output4));
     }
+
+    TEST_CASE("tree accumulators by levels", "[tree_accumulator]") {
+        using namespace tree_accumulator_detail;
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({100, 100});
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(graph)}, 0, 10);
+        auto tree = quasi_flat_zone_hierarchy(graph, edge_weights).tree;
+        auto n = num_vertices(tree);
+
+        auto levels = internal_nodes_by_height(tree);
+        REQUIRE(levels.nodes.size() == n - num_leaves(tree));
+        REQUIRE(levels.offsets[1] - levels.offsets[0] == 0);
+        REQUIRE(levels.offsets[2] - levels.offsets[1] > level_block_size);
+
+        array_1d<int> vertex_data = xt::random::randint<int>({num_leaves(tree)}, 0, 100);
+        array_2d<int> vertex_data2 = xt::random::randint<int>({num_leaves(tree), (size_t) 3}, 0, 100);
+        array_1d<int> input = xt::random::randint<int>({n}, 0, 100);
+        array_2d<int> input2 = xt::random::randint<int>({n, (size_t) 3}, 0, 100);
+        array_1d<bool> condition = xt::random::randint<int>({n}, 0, 2);
+
+        REQUIRE((accumulate_sequential_impl<false>(tree, vertex_data, accumulator_max(), true) ==
+                 accumulate_sequential_impl<false>(tree, vertex_data, accumulator_max(), false)));
+        REQUIRE((accumulate_sequential_impl<true>(tree, vertex_data2, accumulator_sum(), true) ==
+                 accumulate_sequential_impl<true>(tree, vertex_data2, accumulator_sum(), false)));
+
+        REQUIRE((accumulate_and_combine_sequential_impl<false>(tree, input, vertex_data, accumulator_sum(),
+                                                               std::plus<int>(), true) ==
+                 accumulate_and_combine_sequential_impl<false>(tree, input, vertex_data, accumulator_sum(),
+                                                               std::plus<int>(), false)));
+        REQUIRE((accumulate_and_combine_sequential_impl<true>(tree, input2, vertex_data2, accumulator_min(),
+                                                              std::plus<int>(), true) ==
+                 accumulate_and_combine_sequential_impl<true>(tree, input2, vertex_data2, accumulator_min(),
+                                                              std::plus<int>(), false)));
+
+        REQUIRE((propagate_sequential_impl<false>(tree, input, condition, true) ==
+                 propagate_sequential_impl<false>(tree, input, condition, false)));
+        REQUIRE((propagate_sequential_impl<true>(tree, input2, condition, true) ==
+                 propagate_sequential_impl<true>(tree, input2, condition, false)));
+
+        REQUIRE((propagate_sequential_and_accumulate_impl<false>(tree, input, accumulator_sum(), true) ==
+                 propagate_sequential_and_accumulate_impl<false>(tree, input, accumulator_sum(), false)));
+        REQUIRE((propagate_sequential_and_accumulate_impl<true>(tree, input2, accumulator_max(), true) ==
+                 propagate_sequential_and_accumulate_impl<true>(tree, input2, accumulator_max(), false)));
+    }
+
+    TEST_CASE("accumulator tree output type", "[tree_accumulator]") {
+        auto tree = data.t;
+
+        array_1d<index_t> input{1, 2, 3, 4, 5, 6, 7, 8};
+        auto res1 = accumulate_parallel<hg::tree, array_1d<index_t>, accumulator_mean, double>(
+                tree, input, accumulator_mean());
+        static_assert(std::is_same<decltype(res1)::value_type, double>::value, "Wrong output type.");
+        array_1d<double> ref1{0, 0, 0, 0, 0, 1.5, 4, 6.5};
+        REQUIRE(xt::allclose(ref1, res1));
+
+        array_1d<double> vertex_data{1, 2, 3, 4, 5};
+        auto res2 = accumulate_sequential<hg::tree, array_1d<double>, accumulator_sum, float>(
+                tree, vertex_data, accumulator_sum());
+        static_assert(std::is_same<decltype(res2)::value_type, float>::value, "Wrong output type.");
+        array_1d<float> ref2{1, 2, 3, 4, 5, 3, 12, 15};
+        REQUIRE((ref2 == res2));
+
+        auto res3 = propagate_sequential_and_accumulate<hg::tree, array_1d<index_t>, accumulator_sum, float>(
+                tree, input, accumulator_sum());
+        static_assert(std::is_same<decltype(res3)::value_type, float>::value, "Wrong output type.");
+        array_1d<float> ref3{15, 16, 18, 19, 20, 14, 15, 8};
+        REQUIRE((ref3 == res3));
+    }
+
+    TEST_CASE("accumulator tree single precision sums", "[tree_accumulator]") {
+        // flat tree with many leaves: a naive single precision sum accumulates rounding errors
+        index_t num_leaves = 1 << 20;
+        array_1d<index_t> parents = xt::empty<index_t>({num_leaves + 1});
+        xt::view(parents, xt::range(0, num_leaves)) = num_leaves;
+        parents(num_leaves) = num_leaves;
+        hg::tree tree(parents);
+
+        array_1d<float> vertex_data = xt::empty<float>({num_leaves});
+        for (index_t i = 0; i < num_leaves; i++) {
+            vertex_data(i) = 0.1f + (float) (i % 7) * 0.01f;
+        }
+        double sum = 0;
+        for (auto v: vertex_data) {
+            sum += v;
+        }
+
+        auto res1 = accumulate_sequential(tree, vertex_data, accumulator_sum());
+        REQUIRE(std::fabs(res1(num_leaves) - sum) <= 1e-7 * sum);
+
+        auto res2 = accumulate_sequential(tree, vertex_data, accumulator_mean());
+        REQUIRE(std::fabs(res2(num_leaves) - sum / num_leaves) <= 1e-7 * sum / num_leaves);
+
+        array_2d<float> vertex_data2 = xt::empty<float>({(size_t) num_leaves, (size_t) 2});
+        xt::view(vertex_data2, xt::all(), 0) = vertex_data;
+        xt::view(vertex_data2, xt::all(), 1) = -vertex_data;
+        auto res3 = accumulate_sequential(tree, vertex_data2, accumulator_sum());
+        REQUIRE(std::fabs(res3(num_leaves, 0) - sum) <= 1e-7 * sum);
+        REQUIRE(std::fabs(res3(num_leaves, 1) + sum) <= 1e-7 * sum);
+    }
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
 #include "higra/accumulator/tree_contour_accumulator.hpp"
 #include "higra/image/graph_image.hpp"
 #include "higra/attribute/tree_attribute.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "xtensor/xrandom.hpp"
 
 
 using namespace hg;
@@ -85,4 +87,138 @@ namespace tree_contour_accumulator {
             REQUIRE(xt::allclose(result, expected));
 
     }
-}
\ No newline at end of file
+
+    TEST_CASE("contour accumulator prefix sums", "[tree_contour_accumulator]") {
+        using namespace tree_contour_accumulator_detail;
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({40, 40});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(graph)}) * 10);
+        auto tree = quasi_flat_zone_hierarchy(graph, edge_weights).tree;
+        auto depth = attribute_depth(tree);
+
+        array_1d<int> values = xt::random::randint<int>({num_vertices(tree)}, 0, 20);
+        array_2d<int> values2 = xt::random::randint<int>({num_vertices(tree), (size_t) 2}, -20, 20);
+        array_1d<double> values3 = xt::random::rand<double>({num_vertices(tree)});
+
+        auto check = [&graph, &tree, &depth](const auto &input, const auto &accumulator, accumulators kind) {
+            auto ref = accumulate_on_contours_impl<false>(graph, tree, input, depth, accumulator);
+            if (input.dimension() == 1) {
+                REQUIRE(xt::allclose(ref, accumulate_on_contours_prefix_impl<false>(graph, tree, input, depth,
+                                                                                    accumulator, kind, false)));
+                REQUIRE(xt::allclose(ref, accumulate_on_contours_prefix_impl<false>(graph, tree, input, depth,
+                                                                                    accumulator, kind, true)));
+            } else {
+                auto ref2 = accumulate_on_contours_impl<true>(graph, tree, input, depth, accumulator);
+                REQUIRE(xt::allclose(ref2, accumulate_on_contours_prefix_impl<true>(graph, tree, input, depth,
+                                                                                    accumulator, kind, false)));
+                REQUIRE(xt::allclose(ref2, accumulate_on_contours_prefix_impl<true>(graph, tree, input, depth,
+                                                                                    accumulator, kind, true)));
+            }
+        };
+
+        check(values, accumulator_sum(), accumulators::sum);
+        check(values, accumulator_mean(), accumulators::mean);
+        check(values, accumulator_counter(), accumulators::counter);
+        check(values2, accumulator_sum(), accumulators::sum);
+        check(values3, accumulator_sum(), accumulators::sum);
+        check(values3, accumulator_mean(), accumulators::mean);
+
+        // long contours: lowest common ancestors beyond the walk limit
+        index_t n = 200;
+        array_1d<index_t> parents = array_1d<index_t>::from_shape({(size_t) (2 * n)});
+        for (index_t i = 0; i < n; i++) {
+            parents(i) = n + i;
+            parents(n + i) = (i == n - 1) ? 2 * n - 1 : n + i + 1;
+        }
+        hg::tree chain(parents);
+        auto chain_depth = attribute_depth(chain);
+        ugraph chain_graph(n);
+        for (index_t i = 0; i < n; i++) {
+            add_edge(i, (i * 7 + 3) % n, chain_graph);
+        }
+        array_1d<int> chain_values = xt::random::randint<int>({(size_t) (2 * n)}, 0, 20);
+        REQUIRE((accumulate_on_contours(chain_graph, chain, chain_values, chain_depth, accumulator_sum()) ==
+                 accumulate_on_contours_impl<false>(chain_graph, chain, chain_values, chain_depth,
+                                                    accumulator_sum())));
+
+        REQUIRE((accumulate_on_contours_impl<true>(graph, tree, values2, depth, accumulator_max(), true) ==
+                 accumulate_on_contours_impl<true>(graph, tree, values2, depth, accumulator_max(), false)));
+        REQUIRE((accumulate_on_contours(graph, tree, values, depth, accumulator_sum()) ==
+                 accumulate_on_contours_impl<false>(graph, tree, values, depth, accumulator_sum())));
+    }
+
+    TEST_CASE("contour accumulator binary lifting", "[tree_contour_accumulator]") {
+        using namespace tree_contour_accumulator_detail;
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({40, 40});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(graph)}) * 10);
+        auto tree = quasi_flat_zone_hierarchy(graph, edge_weights).tree;
+        auto depth = attribute_depth(tree);
+
+        array_1d<int> values = xt::random::randint<int>({num_vertices(tree)}, 0, 20);
+        array_2d<double> values2 = xt::random::rand<double>({num_vertices(tree), (size_t) 3});
+
+        REQUIRE((accumulate_on_contours_lifting_impl<false>(graph, tree, values, depth, accumulator_min()) ==
+                 accumulate_on_contours_impl<false>(graph, tree, values, depth, accumulator_min())));
+        REQUIRE((accumulate_on_contours_lifting_impl<false>(graph, tree, values, depth, accumulator_max(), true) ==
+                 accumulate_on_contours_impl<false>(graph, tree, values, depth, accumulator_max())));
+        REQUIRE((accumulate_on_contours_lifting_impl<true>(graph, tree, values2, depth, accumulator_max()) ==
+                 accumulate_on_contours_impl<true>(graph, tree, values2, depth, accumulator_max())));
+        REQUIRE((accumulate_on_contours(graph, tree, values2, depth, accumulator_min()) ==
+                 accumulate_on_contours_impl<true>(graph, tree, values2, depth, accumulator_min())));
+    }
+
+    TEST_CASE("contour accumulator deep chain", "[tree_contour_accumulator]") {
+        using namespace tree_contour_accumulator_detail;
+        xt::random::seed(42);
+        // caterpillar tree: the i-th leaf is a child of the i-th node of a chain of depth n
+        index_t n = 1000;
+        array_1d<index_t> parents = array_1d<index_t>::from_shape({(size_t) (2 * n)});
+        for (index_t i = 0; i < n; i++) {
+            parents(i) = n + i;
+            parents(n + i) = (i == n - 1) ? 2 * n - 1 : n + i + 1;
+        }
+        hg::tree chain(parents);
+        auto depth = attribute_depth(chain);
+        ugraph graph(n);
+        for (index_t i = 0; i < n; i++) {
+            add_edge(i, (i * 7 + 3) % n, graph);
+            add_edge(i, (i + 1) % n, graph);
+        }
+
+        // values close to the root are much larger than the values on most contours
+        array_1d<double> values = xt::random::rand<double>({(size_t) (2 * n)});
+        for (index_t i = 2 * n - 10; i < 2 * n; i++) {
+            values(i) = 1e12;
+        }
+        array_2d<int> values2 = xt::random::randint<int>({(size_t) (2 * n), (size_t) 2}, -1000, 1000);
+
+        auto ref_sum = accumulate_on_contours_impl<false>(graph, chain, values, depth, accumulator_sum());
+        REQUIRE(xt::allclose(accumulate_on_contours(graph, chain, values, depth, accumulator_sum()), ref_sum));
+        auto ref_mean = accumulate_on_contours_impl<false>(graph, chain, values, depth, accumulator_mean());
+        REQUIRE(xt::allclose(accumulate_on_contours(graph, chain, values, depth, accumulator_mean()), ref_mean));
+        REQUIRE((accumulate_on_contours(graph, chain, values2, depth, accumulator_sum()) ==
+                 accumulate_on_contours_impl<true>(graph, chain, values2, depth, accumulator_sum())));
+        REQUIRE((accumulate_on_contours(graph, chain, values, depth, accumulator_min()) ==
+                 accumulate_on_contours_impl<false>(graph, chain, values, depth, accumulator_min())));
+        REQUIRE((accumulate_on_contours(graph, chain, values2, depth, accumulator_max()) ==
+                 accumulate_on_contours_impl<true>(graph, chain, values2, depth, accumulator_max())));
+
+        // integral values with a floating point result: prefix sums must be computed on integers
+        using depth_t = decltype(depth);
+        array_1d<int64_t> values3 = xt::random::randint<int64_t>({(size_t) (2 * n)}, 0, 10);
+        for (index_t i = 2 * n - 10; i < 2 * n; i++) {
+            values3(i) = (int64_t) 1 << 40;
+        }
+        auto res3_sum = accumulate_on_contours<ugraph, hg::tree, array_1d<int64_t>, depth_t, accumulator_sum, float>(
+                graph, chain, values3, depth, accumulator_sum());
+        auto ref3_sum = accumulate_on_contours_impl<false, ugraph, hg::tree, array_1d<int64_t>, depth_t,
+                accumulator_sum, float>(graph, chain, values3, depth, accumulator_sum());
+        REQUIRE((res3_sum == ref3_sum));
+        auto res3_mean = accumulate_on_contours<ugraph, hg::tree, array_1d<int64_t>, depth_t, accumulator_mean,
+                double>(graph, chain, values3, depth, accumulator_mean());
+        auto ref3_mean = accumulate_on_contours_impl<false, ugraph, hg::tree, array_1d<int64_t>, depth_t,
+                accumulator_mean, double>(graph, chain, values3, depth, accumulator_mean());
+        REQUIRE(xt::allclose(res3_mean, ref3_mean));
+    }
+}
@@ -11,7 +11,9 @@
 #include "../test_utils.hpp"
 #include "higra/algo/tree_fusion.hpp"
 #include "higra/hierarchy/component_tree.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
 #include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
 
 using namespace hg;
 
@@ -99,4 +101,22 @@ namespace test_tree_fusion {
         REQUIRE(xt::sum(diff - diff(0))() == 0);
     }
 
+
+    TEST_CASE("tree_fusion_depth_map same trees", "[tree_fusion]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_graph({13, 11});
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 10);
+        auto t = bpt_canonical(g, edge_weights).tree;
+
+        // fusing a tree without any internal node of area 1 with itself gives the depth of the leaves in the tree
+        array_1d<index_t> depth = xt::zeros<index_t>({num_vertices(t)});
+        for (auto i: root_to_leaves_iterator(t, leaves_it::include, root_it::exclude)) {
+            depth(i) = depth(parent(i, t)) + 1;
+        }
+        array_1d<index_t> expected = xt::view(depth, xt::range(0, num_leaves(t)));
+
+        REQUIRE((tree_fusion_depth_map(std::vector<tree *>{&t, &t}) == expected));
+        REQUIRE((tree_fusion_depth_map(std::vector<tree *>{&t, &t, &t}) == expected));
+    }
+
 }
\ No newline at end of file
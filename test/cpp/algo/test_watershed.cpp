@@ -11,6 +11,7 @@
 #include "../test_utils.hpp"
 #include "higra/algo/watershed.hpp"
 #include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
 
 using namespace hg;
 
@@ -45,6 +46,97 @@ namespace test_watershed {
         REQUIRE((labels == expected));
     }
 
+    TEST_CASE("watershed cut parallel simple", "[watershed_cut]") {
+        auto g = hg::get_4_adjacency_graph({4, 4});
+        array_1d<int> edge_weights{1, 2, 5, 5, 5, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 3, 5, 4, 0, 7, 0, 3, 4, 0};
+
+        auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+        array_1d<index_t> expected{1, 1, 1, 2,
+                                   1, 1, 2, 2,
+                                   1, 1, 3, 3,
+                                   1, 1, 3, 3};
+        REQUIRE((labels == expected));
+
+        auto labels2 = hg::labelisation_watershed_parallel(g, edge_weights, false);
+        REQUIRE(is_in_bijection(labels2, expected));
+    }
+
+    TEST_CASE("watershed cut parallel simple 2", "[watershed_cut]") {
+        auto g = hg::get_4_adjacency_graph({3, 3});
+        array_1d<int> edge_weights{1, 1, 0, 0, 0, 1, 0, 0, 2, 2, 0, 2};
+
+        auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+        array_1d<index_t> expected{1, 1, 1,
+                                   2, 1, 1,
+                                   2, 2, 1};
+        REQUIRE((labels == expected));
+    }
+
+    TEST_CASE("watershed cut parallel unique watershed", "[watershed_cut]") {
+        xt::random::seed(42);
+        auto g = hg::get_4_adjacency_graph({31, 27});
+        // all edge weights are different: the watershed cut is unique
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(g)});
+
+        auto ref = hg::labelisation_watershed(g, edge_weights);
+        auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+        REQUIRE((labels == ref));
+
+        auto labels2 = hg::labelisation_watershed_parallel(g, edge_weights, false);
+        REQUIRE(is_in_bijection(labels2, ref));
+    }
+
+    TEST_CASE("watershed cut parallel unique watershed large", "[watershed_cut]") {
+        xt::random::seed(42);
+        // more vertices than a chunk of the union find on minima
+        auto g = hg::get_4_adjacency_graph({300, 251});
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(g)});
+
+        auto ref = hg::labelisation_watershed(g, edge_weights);
+        auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+        REQUIRE((labels == ref));
+
+        auto labels2 = hg::labelisation_watershed_parallel(g, edge_weights, false);
+        REQUIRE(is_in_bijection(labels2, ref));
+    }
+
+    TEST_CASE("watershed cut parallel plateaus", "[watershed_cut]") {
+        // low dynamic integer weights: many plateaus, the result must still be the one of the sequential algorithm
+        xt::random::seed(42);
+        for (auto shape: std::vector<std::vector<size_t>>{{31, 27}, {64, 64}, {300, 251}}) {
+            for (int max_weight: {2, 4, 16}) {
+                auto g = hg::get_4_adjacency_graph(shape);
+                array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, max_weight);
+
+                auto ref = hg::labelisation_watershed(g, edge_weights);
+                auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+                REQUIRE((labels == ref));
+
+                auto labels2 = hg::labelisation_watershed_parallel(g, edge_weights, false);
+                REQUIRE(is_in_bijection(labels2, ref));
+            }
+        }
+    }
+
+    TEST_CASE("watershed cut parallel plateaus adjacency order", "[watershed_cut]") {
+        // the exploration of the plateaus depends on the order of the adjacency lists
+        xt::random::seed(42);
+        ugraph g(100);
+        for (index_t i = 0; i < 400; i++) {
+            auto s = (index_t) xt::random::randint<index_t>({1}, 0, 100)(0);
+            auto t = (index_t) xt::random::randint<index_t>({1}, 0, 100)(0);
+            if (s != t) {
+                g.add_edge(s, t);
+            }
+        }
+        g.add_vertex();
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 3);
+
+        auto ref = hg::labelisation_watershed(g, edge_weights);
+        auto labels = hg::labelisation_watershed_parallel(g, edge_weights);
+        REQUIRE((labels == ref));
+    }
+
     TEST_CASE("seeded watersed 1", "[seeded_watersed_cut]") {
         auto g = hg::get_4_adjacency_graph({4, 4});
         array_1d<int> edge_weights{1, 2, 5, 5, 4, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 2, 5, 2, 0, 7, 0, 3, 4, 0};
@@ -128,4 +220,166 @@ namespace test_watershed {
         REQUIRE((labels == expected));
     }
 
+
+    template<typename T1, typename T2>
+    auto minimax_distances(const ugraph &g, const T1 &edge_weights, const T2 &seeds, int label) {
+        using value_type = typename T1::value_type;
+        std::vector<value_type> dist(num_vertices(g), (std::numeric_limits<value_type>::max)());
+        std::vector<std::pair<value_type, index_t>> heap;
+        auto cmp = [](const std::pair<value_type, index_t> &a, const std::pair<value_type, index_t> &b) {
+            return a.first > b.first;
+        };
+        for (index_t v = 0; v < (index_t) num_vertices(g); v++) {
+            if (seeds(v) == label) {
+                dist[v] = (std::numeric_limits<value_type>::lowest)();
+                heap.emplace_back(dist[v], v);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), cmp);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            auto top = heap.back();
+            heap.pop_back();
+            if (top.first > dist[top.second]) {
+                continue;
+            }
+            for (auto e: out_edge_iterator(top.second, g)) {
+                auto d = (std::max)(top.first, edge_weights(e));
+                if (d < dist[target(e, g)]) {
+                    dist[target(e, g)] = d;
+                    heap.emplace_back(d, target(e, g));
+                    std::push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+        }
+        return dist;
+    }
+
+    TEST_CASE("seeded watersed priority flood", "[seeded_watersed_cut]") {
+        auto g = hg::get_4_adjacency_graph({4, 4});
+        array_1d<int> edge_weights{1, 2, 5, 5, 4, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 2, 5, 2, 0, 7, 0, 3, 4, 0};
+        array_1d<int> seeds{1, 1, 9, 9,
+                            1, 9, 9, 9,
+                            9, 9, 9, 9,
+                            1, 1, 2, 2};
+        auto labels = hg::labelisation_seeded_watershed_priority_flood(g, edge_weights, seeds, 9);
+
+        array_1d<int> expected{1, 1, 2, 2,
+                               1, 1, 2, 2,
+                               1, 1, 2, 2,
+                               1, 1, 2, 2};
+        REQUIRE((labels == expected));
+
+        array_1d<int> seeds2{5, 7, 5,
+                             0, 0, 0};
+        auto g2 = hg::get_4_adjacency_graph({2, 3});
+        array_1d<double> edge_weights2{1, 0, 2, 0, 0, 1, 2};
+        auto labels2 = hg::labelisation_seeded_watershed_priority_flood(g2, edge_weights2, seeds2);
+        array_1d<int> expected2{5, 7, 5,
+                                5, 7, 5};
+        REQUIRE((labels2 == expected2));
+    }
+
+    TEST_CASE("seeded watersed priority flood distinct weights", "[seeded_watersed_cut]") {
+        xt::random::seed(42);
+        auto g = hg::get_4_adjacency_graph({23, 29});
+        array_1d<int> seeds = xt::random::randint<int>({num_vertices(g)}, -30, 4);
+        seeds = xt::maximum(seeds, 0);
+
+        // integers: bucket queue
+        array_1d<int> edge_weights = xt::random::permutation<int>(num_edges(g));
+        REQUIRE((hg::labelisation_seeded_watershed_priority_flood(g, edge_weights, seeds) ==
+                 hg::labelisation_seeded_watershed(g, edge_weights, seeds)));
+
+        // large integers and floats: radix heap
+        array_1d<long long> edge_weights_l = xt::cast<long long>(edge_weights) * 1000000007ll - 5000000000ll;
+        REQUIRE((hg::labelisation_seeded_watershed_priority_flood(g, edge_weights_l, seeds) ==
+                 hg::labelisation_seeded_watershed(g, edge_weights_l, seeds)));
+
+        array_1d<double> edge_weights_d = xt::random::randn<double>({num_edges(g)});
+        REQUIRE((hg::labelisation_seeded_watershed_priority_flood(g, edge_weights_d, seeds) ==
+                 hg::labelisation_seeded_watershed(g, edge_weights_d, seeds)));
+    }
+
+    TEST_CASE("seeded watersed priority flood plateaus", "[seeded_watersed_cut]") {
+        xt::random::seed(42);
+        auto g = hg::get_4_adjacency_graph({21, 19});
+        array_1d<int> seeds = xt::random::randint<int>({num_vertices(g)}, -40, 4);
+        seeds = xt::maximum(seeds, 0);
+        array_1d<unsigned char> edge_weights = xt::random::randint<unsigned char>({num_edges(g)}, 0, 6);
+        array_1d<float> edge_weights_f = xt::cast<float>(edge_weights) - 2.5f;
+
+        auto labels = hg::labelisation_seeded_watershed_priority_flood(g, edge_weights, seeds);
+        auto labels_f = hg::labelisation_seeded_watershed_priority_flood(g, edge_weights_f, seeds);
+
+        // each vertex is labeled by a seed at minimal minimax distance
+        std::vector<std::vector<unsigned char>> dists;
+        for (int l = 1; l < 4; l++) {
+            dists.push_back(minimax_distances(g, edge_weights, seeds, l));
+        }
+        for (index_t v = 0; v < (index_t) num_vertices(g); v++) {
+            auto dmin = (std::min)({dists[0][v], dists[1][v], dists[2][v]});
+            REQUIRE(dists[labels(v) - 1][v] == dmin);
+            REQUIRE(dists[labels_f(v) - 1][v] == dmin);
+        }
+    }
+
+    TEST_CASE("seeded watersed parallel", "[seeded_watersed_cut]") {
+        auto g = hg::get_4_adjacency_graph({2, 4});
+        array_1d<int> edge_weights{0, 1, 0, 2, 0, 2, 0, 1, 2, 1};
+        array_1d<int> seeds{1, 0, 0, 2,
+                            0, 0, 0, 0};
+        auto labels = hg::labelisation_seeded_watershed_parallel(g, edge_weights, seeds);
+        array_1d<int> expected{1, 1, 1, 2,
+                               1, 1, 2, 2};
+        REQUIRE((labels == expected));
+
+        auto g2 = hg::get_4_adjacency_graph({2, 3});
+        array_1d<int> edge_weights2{1, 0, 2, 0, 0, 1, 2};
+        array_1d<int> seeds2{5, 7, 5,
+                             0, 0, 0};
+        auto labels2 = hg::labelisation_seeded_watershed_parallel(g2, edge_weights2, seeds2);
+        array_1d<int> expected2{5, 7, 5,
+                                5, 7, 5};
+        REQUIRE((labels2 == expected2));
+    }
+
+    TEST_CASE("seeded watersed parallel random", "[seeded_watersed_cut]") {
+        xt::random::seed(42);
+        for (index_t i = 0; i < 20; i++) {
+            auto g = hg::get_4_adjacency_graph({17 + i, 23});
+            array_1d<int> seeds = xt::random::randint<int>({num_vertices(g)}, -30 - 10 * i, 4);
+            seeds = xt::maximum(seeds, 0);
+            array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 1 + i);
+            if (i % 2 == 0) {
+                // unreachable vertices
+                for (index_t v = 0; v < 17 + i; v++) {
+                    seeds(v * 23 + 11) = 0;
+                }
+                ugraph g2(num_vertices(g));
+                for (auto e: edge_iterator(g)) {
+                    if (source(e, g) % 23 != 11 && target(e, g) % 23 != 11) {
+                        g2.add_edge(source(e, g), target(e, g));
+                    }
+                }
+                array_1d<int> edge_weights2 = xt::random::randint<int>({num_edges(g2)}, 0, 1 + i);
+                REQUIRE((hg::labelisation_seeded_watershed_parallel(g2, edge_weights2, seeds) ==
+                         hg::labelisation_seeded_watershed(g2, edge_weights2, seeds)));
+            }
+            REQUIRE((hg::labelisation_seeded_watershed_parallel(g, edge_weights, seeds) ==
+                     hg::labelisation_seeded_watershed(g, edge_weights, seeds)));
+        }
+    }
+
+    TEST_CASE("seeded watersed parallel large", "[seeded_watersed_cut]") {
+        xt::random::seed(42);
+        // more active vertices than a block of the compaction
+        auto g = hg::get_4_adjacency_graph({300, 251});
+        array_1d<int> seeds = xt::random::randint<int>({num_vertices(g)}, -2000, 4);
+        seeds = xt::maximum(seeds, 0);
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 8);
+        REQUIRE((hg::labelisation_seeded_watershed_parallel(g, edge_weights, seeds) ==
+                 hg::labelisation_seeded_watershed(g, edge_weights, seeds)));
+    }
+
 }
@@ -0,0 +1,131 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2019)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "higra/assessment/hierarchical_cost.hpp"
+#include "higra/assessment/dendrogram_purity.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "higra/image/graph_image.hpp"
+#include "../test_utils.hpp"
+#include "xtensor/xrandom.hpp"
+
+using namespace hg;
+
+namespace assessment_hierarchical_cost {
+
+    TEST_CASE("dasgupta cost", "[hierarchical_cost]") {
+        auto g = get_4_adjacency_graph({3, 3});
+        array_1d<double> edge_weights{1, 7, 3, 7, 1, 1, 6, 5, 6, 4, 1, 2};
+        auto bpt = bpt_canonical(g, edge_weights);
+
+        auto cost = dasgupta_cost(bpt.tree, g, edge_weights);
+        double ref_cost = 2 / 1. + 4 / 3. + 9 / 7. + 9 / 7. + 2 / 1. + 2 / 1. + 9 / 5. + 9 / 6. + 9 / 6. + 7 / 4. +
+                          2 / 1. + 3 / 2.;
+        REQUIRE(almost_equal(cost, ref_cost));
+
+        array_1d<double> area = attribute_area(bpt.tree) * 2;
+        REQUIRE(almost_equal(dasgupta_cost(bpt.tree, g, edge_weights, area), 2 * ref_cost));
+    }
+
+    TEST_CASE("tree sampling divergence", "[hierarchical_cost]") {
+        auto g = get_4_adjacency_graph({3, 3});
+        array_1d<int> edge_weights{0, 6, 2, 6, 0, 0, 5, 4, 5, 3, 2, 2};
+        auto qfz = quasi_flat_zone_hierarchy(g, edge_weights);
+
+        auto cost = tree_sampling_divergence(qfz.tree, g, edge_weights);
+
+        std::vector<double> p{0., 0., 0., 0.05714286, 0.11428571, 0.08571429, 0.74285714};
+        std::vector<double> q{0.03918367, 0.01142857, 0.13469388, 0.10285714, 0.11673469, 0.39428571, 0.93387755};
+        double ref_cost = 0;
+        for (index_t i = 3; i < 7; i++) {
+            ref_cost += p[i] * std::log(p[i] / q[i]);
+        }
+        REQUIRE(std::fabs(cost - ref_cost) < 1e-6);
+    }
+
+    TEST_CASE("estimate dasgupta cost", "[hierarchical_cost]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_graph({30, 30});
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(g)}) + 0.5;
+        auto tree = bpt_canonical(g, edge_weights).tree;
+        auto area = attribute_area(tree);
+        auto exact = dasgupta_cost(tree, g, edge_weights, area);
+
+        for (auto sampling: {edge_sampling::uniform, edge_sampling::importance}) {
+            auto estimate = estimate_dasgupta_cost(tree, g, edge_weights, area, 20000, sampling, 0.99, 1);
+            REQUIRE(estimate.num_samples == 20000);
+            REQUIRE(estimate.standard_error > 0);
+            REQUIRE(estimate.lower_bound < estimate.value);
+            REQUIRE(estimate.value < estimate.upper_bound);
+            REQUIRE(estimate.lower_bound < exact);
+            REQUIRE(exact < estimate.upper_bound);
+            REQUIRE(std::fabs(estimate.value - exact) < 0.05 * exact);
+
+            auto estimate2 = estimate_dasgupta_cost(tree, g, edge_weights, area, 20000, sampling, 0.99, 1);
+            REQUIRE(estimate.value == estimate2.value);
+        }
+
+        // the importance estimator is exact when the area is constant
+        array_1d<double> ones = xt::ones<double>({num_vertices(tree)});
+        auto estimate = estimate_dasgupta_cost(tree, g, edge_weights, ones, 100, edge_sampling::importance);
+        REQUIRE(std::fabs(estimate.value - dasgupta_cost(tree, g, edge_weights, ones)) < 1e-8 * estimate.value);
+        REQUIRE(estimate.standard_error < 1e-8);
+    }
+
+    TEST_CASE("estimate tree sampling divergence", "[hierarchical_cost]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_graph({30, 30});
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(g)});
+        array_1d<double> dissimilarities = -edge_weights;
+        auto tree = bpt_canonical(g, dissimilarities).tree;
+        auto exact = tree_sampling_divergence(tree, g, edge_weights);
+
+        for (auto sampling: {edge_sampling::uniform, edge_sampling::importance}) {
+            auto estimate = estimate_tree_sampling_divergence(tree, g, edge_weights, 200000, sampling, 0.99, 3);
+            REQUIRE(estimate.standard_error > 0);
+            REQUIRE(estimate.lower_bound < estimate.value);
+            REQUIRE(estimate.value < estimate.upper_bound);
+            REQUIRE(std::fabs(estimate.value - exact) < 0.05 * exact);
+        }
+    }
+
+    TEST_CASE("estimate dendrogram purity", "[hierarchical_cost]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_graph({30, 30});
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 20);
+        auto tree = quasi_flat_zone_hierarchy(g, edge_weights).tree;
+        array_1d<int> labels = xt::random::randint<int>({num_leaves(tree)}, 0, 5);
+        auto exact = dendrogram_purity(tree, labels);
+
+        auto estimate = estimate_dendrogram_purity(tree, labels, 20000, 0.99, 5);
+        REQUIRE(estimate.standard_error > 0);
+        REQUIRE(estimate.lower_bound < exact);
+        REQUIRE(exact < estimate.upper_bound);
+        REQUIRE(std::fabs(estimate.value - exact) < 0.05 * exact);
+
+        array_1d<int> same_labels = xt::zeros<int>({num_leaves(tree)});
+        auto estimate2 = estimate_dendrogram_purity(tree, same_labels, 100);
+        REQUIRE(estimate2.value == 1);
+        REQUIRE(estimate2.standard_error == 0);
+
+        array_1d<int> distinct_labels = xt::arange<int>((int) num_leaves(tree));
+        REQUIRE_THROWS(estimate_dendrogram_purity(tree, distinct_labels, 100));
+    }
+
+    TEST_CASE("discrete sampler zero weights", "[hierarchical_cost]") {
+        array_1d<double> weights{0, 1e-300, 0, 0, 1e300, 0, 0};
+        hierarchical_cost_internal::discrete_sampler sampler(weights.size(), [&weights](index_t i) {
+            return weights(i);
+        });
+        std::mt19937_64 generator(42);
+        for (index_t i = 0; i < 1000; i++) {
+            REQUIRE(weights(sampler(generator)) > 0);
+        }
+    }
+}
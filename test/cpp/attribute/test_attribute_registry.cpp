@@ -0,0 +1,173 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "../test_utils.hpp"
+#include "higra/attribute/attribute_registry.hpp"
+
+namespace attribute_registry {
+
+    using namespace hg;
+    using namespace std;
+
+    struct _data {
+
+        hg::tree t;
+
+        _data() : t(xt::xarray<index_t>{5, 5, 6, 6, 6, 7, 7, 7}) {
+        }
+
+    } data;
+
+    TEST_CASE("attribute registry default attributes", "[attribute_registry]") {
+        auto t = data.t;
+        auto registry = make_tree_attribute_registry(t);
+
+        REQUIRE(registry.contains("area"));
+        REQUIRE(!registry.contains("altitudes"));
+        REQUIRE(!registry.is_cached("area"));
+
+        auto area = registry.get<array_1d<double>>("area");
+        array_1d<double> ref_area{1, 1, 1, 1, 1, 2, 3, 5};
+        REQUIRE((*area == ref_area));
+        REQUIRE(registry.is_cached("area"));
+        REQUIRE(registry.memory_usage() == 8 * sizeof(double));
+        REQUIRE((registry.get<array_1d<double>>("area") == area));
+
+        array_1d<index_t> ref_depth{2, 2, 2, 2, 2, 1, 1, 0};
+        REQUIRE((*registry.get<array_1d<index_t>>("depth") == ref_depth));
+
+        REQUIRE_THROWS(registry.get<array_1d<double>>("volume"));
+        registry.set_input("altitudes", array_1d<double>{0, 0, 0, 0, 0, 2, 1, 4});
+        array_1d<double> ref_volume{0, 0, 0, 0, 0, 4, 9, 13};
+        REQUIRE((*registry.get<array_1d<double>>("volume") == ref_volume));
+
+        registry.set_input("vertex_area", array_1d<double>{2, 1, 1, 3, 2});
+        REQUIRE(!registry.is_cached("area"));
+        REQUIRE(!registry.is_cached("volume"));
+        REQUIRE(registry.is_cached("depth"));
+        array_1d<double> ref_volume2{0, 0, 0, 0, 0, 6, 18, 24};
+        REQUIRE((*registry.get<array_1d<double>>("volume") == ref_volume2));
+        array_1d<double> ref_area2{2, 1, 1, 3, 2, 3, 6, 9};
+        REQUIRE(registry.is_cached("area"));
+        REQUIRE((*registry.get<array_1d<double>>("area") == ref_area2));
+
+        registry.set_input("vertex_weights", array_nd<double>{{1, 2},
+                                                              {3, 4},
+                                                              {5, 6},
+                                                              {7, 8},
+                                                              {9, 10}});
+        array_nd<double> ref_mean{{1,       2},
+                                  {3,       4},
+                                  {5,       6},
+                                  {7,       8},
+                                  {9,       10},
+                                  {5 / 3.0, 8 / 3.0},
+                                  {44 / 6., 50 / 6.},
+                                  {49 / 9., 58 / 9.}};
+        REQUIRE(xt::allclose(*registry.get<array_nd<double>>("mean_vertex_weights"), ref_mean));
+
+        registry.set_input("vertex_weights", array_1d<double>{1, 3, 5, 7, 9});
+        array_nd<double> ref_mean2{1, 3, 5, 7, 9, 5 / 3.0, 44 / 6., 49 / 9.};
+        REQUIRE(xt::allclose(*registry.get<array_nd<double>>("mean_vertex_weights"), ref_mean2));
+
+        REQUIRE_THROWS(registry.get<array_1d<float>>("area"));
+        REQUIRE_THROWS(registry.get<array_1d<double>>("unknown"));
+        REQUIRE_THROWS(registry.set_input("area", array_1d<double>{}));
+    }
+
+    TEST_CASE("attribute registry evicted intermediate", "[attribute_registry]") {
+        auto t = data.t;
+        auto registry = make_tree_attribute_registry(t);
+        registry.set_input("altitudes", array_1d<double>{0, 0, 0, 0, 0, 2, 1, 4});
+        array_1d<double> ref_volume{0, 0, 0, 0, 0, 4, 9, 13};
+        REQUIRE((*registry.get<array_1d<double>>("volume") == ref_volume));
+
+        registry.evict("area");
+        REQUIRE(!registry.is_cached("area"));
+        REQUIRE(registry.is_cached("volume"));
+
+        registry.set_input("vertex_area", array_1d<double>{10, 10, 10, 10, 10});
+        REQUIRE(!registry.is_cached("volume"));
+        array_1d<double> ref_volume2{0, 0, 0, 0, 0, 40, 90, 130};
+        REQUIRE((*registry.get<array_1d<double>>("volume") == ref_volume2));
+    }
+
+    TEST_CASE("attribute registry shared dependencies", "[attribute_registry]") {
+        auto t = data.t;
+        tree_attribute_registry<hg::tree> registry(t);
+
+        int num_calls = 0;
+        registry.declare<array_1d<index_t>>("leaves", {}, [&num_calls](const hg::tree &tree,
+                                                                        tree_attribute_registry<hg::tree> &) {
+            num_calls++;
+            return array_1d<index_t>(attribute_area(tree));
+        });
+        registry.declare<array_1d<index_t>>("leaves_plus_depth", {"leaves"},
+                                            [](const hg::tree &, tree_attribute_registry<hg::tree> &r) {
+                                                array_1d<index_t> res = *r.get<array_1d<index_t>>("leaves") +
+                                                                        *r.get<array_1d<index_t>>("depth");
+                                                return res;
+                                            });
+        registry.declare<array_1d<index_t>>("leaves_times_two", {"leaves"},
+                                            [](const hg::tree &, tree_attribute_registry<hg::tree> &r) {
+                                                array_1d<index_t> res = *r.get<array_1d<index_t>>("leaves") * 2;
+                                                return res;
+                                            });
+
+        array_1d<index_t> ref1{3, 3, 3, 3, 3, 3, 4, 5};
+        array_1d<index_t> ref2{2, 2, 2, 2, 2, 4, 6, 10};
+        REQUIRE((*registry.get<array_1d<index_t>>("leaves_plus_depth") == ref1));
+        REQUIRE((*registry.get<array_1d<index_t>>("leaves_times_two") == ref2));
+        REQUIRE(num_calls == 1);
+
+        registry.evict("leaves");
+        REQUIRE((*registry.get<array_1d<index_t>>("leaves_times_two") == ref2));
+        REQUIRE(num_calls == 1);
+        registry.clear();
+        REQUIRE(registry.memory_usage() == 0);
+        REQUIRE((*registry.get<array_1d<index_t>>("leaves_times_two") == ref2));
+        REQUIRE(num_calls == 2);
+
+        registry.declare<int>("cycle1", {"cycle2"}, [](const hg::tree &, tree_attribute_registry<hg::tree> &r) {
+            return *r.get<int>("cycle2");
+        });
+        registry.declare<int>("cycle2", {"cycle1"}, [](const hg::tree &, tree_attribute_registry<hg::tree> &r) {
+            return *r.get<int>("cycle1");
+        });
+        REQUIRE_THROWS(registry.get<int>("cycle1"));
+    }
+
+    TEST_CASE("attribute registry memory budget", "[attribute_registry]") {
+        auto t = data.t;
+        tree_attribute_registry<hg::tree> registry(t, 2 * 8 * sizeof(double));
+        registry.set_input("altitudes", array_1d<double>{0, 0, 0, 0, 0, 2, 1, 4});
+
+        auto area = registry.get<array_1d<double>>("area");
+        registry.get<array_1d<index_t>>("depth");
+        REQUIRE(registry.memory_usage() == 8 * sizeof(double) + 8 * sizeof(index_t));
+
+        // area has been used to compute volume: depth is the least recently used value
+        auto volume = registry.get<array_1d<double>>("volume");
+        REQUIRE(registry.is_cached("area"));
+        REQUIRE(!registry.is_cached("depth"));
+        REQUIRE(registry.is_cached("volume"));
+        REQUIRE(registry.memory_usage() <= registry.memory_budget());
+
+        // discarded values remain valid for their holders
+        array_1d<double> ref_area{1, 1, 1, 1, 1, 2, 3, 5};
+        REQUIRE((*area == ref_area));
+
+        registry.set_memory_budget(0);
+        REQUIRE(registry.memory_usage() == 0);
+        array_1d<double> ref_volume{0, 0, 0, 0, 0, 4, 9, 13};
+        REQUIRE((*volume == ref_volume));
+        REQUIRE((*registry.get<array_1d<double>>("volume") == ref_volume));
+    }
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "../test_utils.hpp"
+#include "higra/attribute/fused_tree_attributes.hpp"
+#include "higra/attribute/tree_attribute.hpp"
+#include "higra/accumulator/tree_accumulator.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
+
+namespace fused_tree_attributes {
+
+    using namespace hg;
+    using namespace std;
+
+    TEST_CASE("fused tree attributes simple", "[fused_tree_attributes]") {
+        tree t(xt::xarray<index_t>{5, 5, 6, 6, 6, 7, 7, 7});
+        array_1d<double> altitude{0, 0, 0, 0, 0, 2, 1, 4};
+        array_1d<double> leaf_area{2, 1, 1, 3, 2};
+
+        auto res = accumulate_attributes(t,
+                                         fused_area<>(),
+                                         fused_depth(),
+                                         fused_area<array_1d<double>>(leaf_area),
+                                         fused_volume<array_1d<double>>(altitude));
+
+        array_1d<double> ref_area{1, 1, 1, 1, 1, 2, 3, 5};
+        array_1d<index_t> ref_depth{2, 2, 2, 2, 2, 1, 1, 0};
+        array_1d<double> ref_area2{2, 1, 1, 3, 2, 3, 6, 9};
+        array_1d<double> ref_volume{0, 0, 0, 0, 0, 4, 9, 13};
+        REQUIRE((std::get<0>(res) == ref_area));
+        REQUIRE((std::get<1>(res) == ref_depth));
+        REQUIRE((std::get<2>(res) == ref_area2));
+        REQUIRE((std::get<3>(res) == ref_volume));
+    }
+
+    TEST_CASE("fused tree attributes bounding box", "[fused_tree_attributes]") {
+        embedding_grid_2d embedding{2, 3};
+        tree t(xt::xarray<index_t>{6, 6, 7, 6, 7, 7, 8, 8, 8});
+
+        auto res = accumulate_attributes(t, fused_bounding_box<2>(embedding));
+        auto &bbox = std::get<0>(res);
+
+        array_3d<index_t> ref{{{0, 0}, {0, 0}},
+                              {{0, 1}, {0, 1}},
+                              {{0, 2}, {0, 2}},
+                              {{1, 0}, {1, 0}},
+                              {{1, 1}, {1, 1}},
+                              {{1, 2}, {1, 2}},
+                              {{0, 0}, {1, 1}},
+                              {{0, 1}, {1, 2}},
+                              {{0, 0}, {1, 2}}};
+        REQUIRE((bbox == ref));
+    }
+
+    /*
+     * Component giving the same row to every node, the shape of the attribute depends on the content of the component.
+     */
+    struct fused_constant_row {
+        using value_type = double;
+        static const bool top_down = true;
+
+        std::vector<size_t> shape() const {
+            return {m_row.size()};
+        }
+
+        template<typename tree_t>
+        void prepare(const tree_t &) {
+        }
+
+        void initialize(index_t, value_type *row) const {
+            std::copy(m_row.begin(), m_row.end(), row);
+        }
+
+        template<typename tree_t>
+        void process(const tree_t &, index_t, value_type *row, const value_type *, index_t) const {
+            std::copy(m_row.begin(), m_row.end(), row);
+        }
+
+        std::vector<double> m_row;
+    };
+
+    TEST_CASE("fused tree attributes component shape", "[fused_tree_attributes]") {
+        tree t(xt::xarray<index_t>{5, 5, 6, 6, 6, 7, 7, 7});
+
+        auto res = accumulate_attributes(t, fused_depth(), fused_constant_row{{1, 2, 3}});
+        auto &rows = std::get<1>(res);
+
+        REQUIRE((rows.shape() == std::vector<size_t>{8, 3}));
+        for (index_t n = 0; n < 8; n++) {
+            REQUIRE((xt::view(rows, n) == array_1d<double>{1, 2, 3}));
+        }
+    }
+
+    TEST_CASE("fused tree attributes random", "[fused_tree_attributes]") {
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({40, 50});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(graph)}) * 20);
+        auto qfz = quasi_flat_zone_hierarchy(graph, edge_weights);
+        auto &t = qfz.tree;
+        auto &altitude = qfz.altitudes;
+        auto n_leaves = num_leaves(t);
+
+        array_1d<double> leaf_area = xt::floor(xt::random::rand<double>({n_leaves}) * 5) + 1;
+        array_2d<double> color = xt::random::rand<double>({n_leaves, (size_t) 3});
+        array_1d<int> leaf_altitude = xt::random::randint<int>({n_leaves}, 0, 100);
+
+        auto res = accumulate_attributes(t,
+                                         fused_area<array_1d<double>>(leaf_area),
+                                         fused_volume<array_1d<double>, array_1d<double>>(altitude, leaf_area),
+                                         fused_depth(),
+                                         fused_mean_vertex_weights<array_2d<double>, array_1d<double>>(color,
+                                                                                                       leaf_area),
+                                         make_fused_accumulator(leaf_altitude, accumulator_min()),
+                                         make_fused_accumulator(leaf_altitude, accumulator_max()),
+                                         make_fused_accumulator(color, accumulator_sum()),
+                                         fused_bounding_box<2>(embedding_grid_2d{40, 50}));
+
+        auto area = attribute_area(t, leaf_area);
+        REQUIRE(xt::allclose(std::get<0>(res), area));
+        REQUIRE(xt::allclose(std::get<1>(res), attribute_volume(t, altitude, area)));
+        REQUIRE((std::get<2>(res) == attribute_depth(t)));
+
+        array_2d<double> weighted_color = color * xt::view(leaf_area, xt::all(), xt::newaxis());
+        array_2d<double> ref_mean = accumulate_sequential(t, weighted_color, accumulator_sum()) /
+                                    xt::view(area, xt::all(), xt::newaxis());
+        REQUIRE(xt::allclose(std::get<3>(res), ref_mean));
+
+        REQUIRE((std::get<4>(res) == accumulate_sequential(t, leaf_altitude, accumulator_min())));
+        REQUIRE((std::get<5>(res) == accumulate_sequential(t, leaf_altitude, accumulator_max())));
+        REQUIRE(xt::allclose(std::get<6>(res), accumulate_sequential(t, color, accumulator_sum())));
+
+        auto &bbox = std::get<7>(res);
+        REQUIRE((bbox.shape()[0] == num_vertices(t)));
+        REQUIRE((xt::view(bbox, xt::all(), 0, 0) ==
+                 accumulate_sequential(t, xt::eval(xt::arange<index_t>(n_leaves) / 50), accumulator_min())));
+        REQUIRE((xt::view(bbox, xt::all(), 1, 1) ==
+                 accumulate_sequential(t, xt::eval(xt::arange<index_t>(n_leaves) % 50), accumulator_max())));
+    }
+}
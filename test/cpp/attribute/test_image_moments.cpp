@@ -0,0 +1,115 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "../test_utils.hpp"
+#include "higra/attribute/image_moments.hpp"
+#include "higra/attribute/tree_attribute.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
+#include "higra/image/graph_image.hpp"
+#include "xtensor/xrandom.hpp"
+
+namespace image_moments_test {
+
+    using namespace hg;
+    using namespace std;
+
+    TEST_CASE("image moments 2d", "[image_moments]") {
+        embedding_grid_2d embedding{2, 3};
+        tree t(xt::xarray<index_t>{6, 6, 7, 6, 7, 7, 8, 8, 8});
+
+        auto res = attribute_image_moments(t, embedding);
+
+        array_1d<double> ref_area{1, 1, 1, 1, 1, 1, 3, 3, 6};
+        REQUIRE((res.area == ref_area));
+
+        array_2d<double> ref_raw_moments_1{{0, 0}, {0, 1}, {0, 2}, {1, 0}, {1, 1}, {1, 2}, {1, 1}, {2, 5}, {3, 6}};
+        REQUIRE((res.raw_moments_1 == ref_raw_moments_1));
+        array_2d<double> ref_raw_moments_2_6{{1, 0}, {0, 1}};
+        REQUIRE((xt::view(res.raw_moments_2, 6) == ref_raw_moments_2_6));
+        array_2d<double> ref_raw_moments_2_8{{3, 3}, {3, 10}};
+        REQUIRE((xt::view(res.raw_moments_2, 8) == ref_raw_moments_2_8));
+
+        array_2d<double> ref_centroid{{0, 0}, {0, 1}, {0, 2}, {1, 0}, {1, 1}, {1, 2},
+                                      {1 / 3.0, 1 / 3.0}, {2 / 3.0, 5 / 3.0}, {0.5, 1}};
+        REQUIRE(xt::allclose(res.centroid, ref_centroid));
+
+        array_2d<double> ref_central_moments_2_6{{2 / 3.0, -1 / 3.0}, {-1 / 3.0, 2 / 3.0}};
+        REQUIRE(xt::allclose(xt::view(res.central_moments_2, 6), ref_central_moments_2_6));
+        REQUIRE(xt::allclose(xt::view(res.central_moments_2, 7), ref_central_moments_2_6));
+        array_2d<double> ref_central_moments_2_8{{1.5, 0}, {0, 4}};
+        REQUIRE(xt::allclose(xt::view(res.central_moments_2, 8), ref_central_moments_2_8));
+        REQUIRE(xt::allclose(xt::view(res.central_moments_2, 0), xt::zeros<double>({2, 2})));
+
+        array_3d<index_t> ref_bbox{{{0, 0}, {0, 0}},
+                                   {{0, 1}, {0, 1}},
+                                   {{0, 2}, {0, 2}},
+                                   {{1, 0}, {1, 0}},
+                                   {{1, 1}, {1, 1}},
+                                   {{1, 2}, {1, 2}},
+                                   {{0, 0}, {1, 1}},
+                                   {{0, 1}, {1, 2}},
+                                   {{0, 0}, {1, 2}}};
+        REQUIRE((res.bounding_box == ref_bbox));
+
+        double e = 1 - std::sqrt(1 / 3.0);
+        array_1d<double> ref_elongation{0, 0, 0, 0, 0, 0, e, e, 1 - std::sqrt(0.375)};
+        REQUIRE(xt::allclose(res.elongation, ref_elongation));
+
+        double s = std::sqrt(0.5);
+        array_2d<double> ref_orientation{{1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {s, -s}, {s, -s}, {0, 1}};
+        REQUIRE(xt::allclose(res.orientation, ref_orientation));
+    }
+
+    TEST_CASE("image moments 3d random", "[image_moments]") {
+        xt::random::seed(42);
+        embedding_grid_3d embedding{4, 5, 6};
+        auto graph = copy_graph<ugraph>(get_6_adjacency_implicit_graph(embedding));
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({(size_t) num_edges(graph)}) * 10);
+        auto qfz = quasi_flat_zone_hierarchy(graph, edge_weights);
+        auto &t = qfz.tree;
+
+        auto res = attribute_image_moments(t, embedding);
+        auto ordering = attribute_leaf_ordering(t);
+
+        for (index_t n = 0; n < (index_t) num_vertices(t); n++) {
+            auto leaves = ordering.leaves_of(n);
+            array_2d<double> coordinates = xt::zeros<double>({(size_t) leaves.size(), (size_t) 3});
+            for (index_t i = 0; i < (index_t) leaves.size(); i++) {
+                xt::view(coordinates, i) = embedding.lin2grid(leaves(i));
+            }
+            double area = (double) leaves.size();
+            array_1d<double> centroid = xt::mean(coordinates, {0});
+            array_2d<double> centered = coordinates - xt::view(centroid, xt::newaxis(), xt::all());
+            array_2d<double> covariance = xt::zeros<double>({3, 3});
+            for (index_t i = 0; i < 3; i++) {
+                for (index_t j = 0; j < 3; j++) {
+                    covariance(i, j) = xt::sum(xt::view(centered, xt::all(), i) *
+                                               xt::view(centered, xt::all(), j))() / area;
+                }
+            }
+
+            REQUIRE(res.area(n) == area);
+            REQUIRE(xt::allclose(xt::view(res.centroid, n), centroid));
+            REQUIRE(xt::allclose(xt::view(res.central_moments_2, n), covariance * area));
+            REQUIRE((xt::view(res.bounding_box, n, 0) == xt::amin(coordinates, {0})));
+            REQUIRE((xt::view(res.bounding_box, n, 1) == xt::amax(coordinates, {0})));
+
+            // orientation is a unit eigenvector of the covariance matrix
+            array_1d<double> orientation = xt::view(res.orientation, n);
+            REQUIRE(std::fabs(xt::sum(orientation * orientation)() - 1) < 1e-8);
+            array_1d<double> product = xt::sum(covariance * xt::view(orientation, xt::newaxis(), xt::all()), {1});
+            double l_max = xt::sum(product * orientation)();
+            REQUIRE(xt::allclose(product, l_max * orientation, 1e-5, 1e-8));
+            REQUIRE(l_max >= xt::amax(xt::diagonal(covariance))() - 1e-8);
+            REQUIRE(res.elongation(n) >= 0);
+            REQUIRE(res.elongation(n) <= 1);
+        }
+    }
+}
@@ -12,7 +12,9 @@
 #include "higra/attribute/tree_attribute.hpp"
 #include "higra/image/graph_image.hpp"
 #include "higra/hierarchy/component_tree.hpp"
+#include "higra/hierarchy/hierarchy_core.hpp"
 #include "higra/io/tree_io.hpp"
+#include "xtensor/xrandom.hpp"
 
 namespace tree_attributes {
 
@@ -39,6 +41,10 @@ namespace tree_attributes {
         array_1d<index_t> ref2{2, 1, 1, 3, 2, 3, 6, 9};
         auto res2 = attribute_area(t, leaf_area);
         REQUIRE((ref2 == res2));
+
+        auto res3 = attribute_area<hg::tree, array_1d<index_t>, float>(t, leaf_area);
+        static_assert(std::is_same<decltype(res3)::value_type, float>::value, "Wrong output type.");
+        REQUIRE((ref2 == res3));
     }
 
     TEST_CASE("tree attribute volume", "[tree_attributes]") {
@@ -49,6 +55,10 @@ namespace tree_attributes {
         array_1d<index_t> ref{0, 0, 0, 0, 0, 6, 18, 24};
         auto res = attribute_volume(t, node_altitude, node_area);
         REQUIRE((ref == res));
+
+        auto res2 = attribute_volume<hg::tree, array_1d<double>, array_1d<index_t>, float>(t, node_altitude, node_area);
+        static_assert(std::is_same<decltype(res2)::value_type, float>::value, "Wrong output type.");
+        REQUIRE((ref == res2));
     }
 
     TEST_CASE("tree attribute depth", "[tree_attributes]") {
@@ -155,6 +165,54 @@ namespace tree_attributes {
         REQUIRE((ref == res));
     }
 
+    TEST_CASE("tree attribute extinction values", "[tree_attributes]") {
+        tree t(xt::xarray<index_t>{8, 8, 9, 7, 7, 11, 11, 9, 10, 10, 12, 12, 12});
+
+        array_1d<double> altitudes{0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 10};
+        array_2d<double> attributes{{0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {0,  1},
+                                    {3,  2},
+                                    {2,  3},
+                                    {4,  5},
+                                    {2,  5},
+                                    {10, 13}};
+
+        auto res = attribute_extinction_values(t, altitudes, attributes, true);
+        REQUIRE(res.shape()[1] == 2);
+        for (index_t i = 0; i < 2; i++) {
+            array_1d<double> attribute = xt::view(attributes, xt::all(), i);
+            REQUIRE((xt::view(res, xt::all(), i) == attribute_extinction_value(t, altitudes, attribute, true)));
+        }
+    }
+
+    TEST_CASE("tree attribute extinction by levels", "[tree_attributes]") {
+        using namespace tree_attribute_internal;
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({100, 100});
+        array_1d<int> vertex_weights = xt::random::randint<int>({num_vertices(graph)}, 0, 20);
+
+        for (bool increasing: {true, false}) {
+            auto res = increasing ? component_tree_min_tree(graph, vertex_weights) :
+                       component_tree_max_tree(graph, vertex_weights);
+            auto &tree = res.tree;
+            auto &altitudes = res.altitudes;
+
+            REQUIRE((attribute_height_impl(tree, altitudes, increasing, true) ==
+                     attribute_height_impl(tree, altitudes, increasing, false)));
+            REQUIRE((attribute_extrema_impl(tree, altitudes, true) ==
+                     attribute_extrema_impl(tree, altitudes, false)));
+            auto rep = extinction_representatives(tree, altitudes, increasing, true);
+            REQUIRE((rep == extinction_representatives(tree, altitudes, increasing, false)));
+            REQUIRE(xt::any(xt::equal(rep, invalid_index)));
+        }
+    }
+
     TEST_CASE("tree attribute siblings", "[tree_attributes]") {
         auto t = data.t;
 
@@ -206,6 +264,81 @@ namespace tree_attributes {
         REQUIRE(xt::allclose(ref, res));
     }
 
+    TEST_CASE("tree attribute frontier and contour partition tree", "[tree_attributes]") {
+        auto g = get_4_adjacency_graph({3, 3});
+        array_1d<double> edge_weights{0, 6, 2, 6, 0, 0, 5, 4, 5, 3, 0, 1};
+        auto bpt = bpt_canonical(g, edge_weights);
+        auto &t = bpt.tree;
+        array_1d<double> edge_length({num_edges(g)}, 1);
+        array_1d<double> vertex_perimeter({num_vertices(g)}, 4);
+
+        array_1d<double> ref_frontier_length{0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 5};
+        REQUIRE((attribute_frontier_length(t, g, edge_length) == ref_frontier_length));
+
+        array_1d<double> ref_frontier_strength{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 26 / 5.0};
+        REQUIRE(xt::allclose(attribute_frontier_strength(t, g, edge_weights, edge_length), ref_frontier_strength));
+
+        array_1d<double> ref_perimeter{4, 4, 4, 4, 4, 4, 4, 4, 4, 6, 6, 6, 6, 8, 10, 16, 12};
+        REQUIRE(xt::allclose(attribute_contour_length(t, g, vertex_perimeter, edge_length), ref_perimeter));
+
+        array_1d<double> ref_weights{6, 8, 2, 11, 15, 7, 5, 6, 4, 14, 9, 26, 11, 13, 19, 26, 0};
+        REQUIRE(xt::allclose(attribute_contour_strength(t, g, edge_weights, vertex_perimeter, edge_length),
+                             ref_weights / ref_perimeter));
+
+        // perimeter of the root is null when the image border is not counted
+        array_1d<double> vertex_perimeter2{2, 3, 2, 3, 4, 3, 2, 3, 2};
+        array_1d<double> ref_perimeter2{2, 3, 2, 3, 4, 3, 2, 3, 2, 3, 3, 5, 3, 3, 4, 5, 0};
+        REQUIRE(xt::allclose(attribute_contour_length(t, g, vertex_perimeter2, edge_length), ref_perimeter2));
+        ref_perimeter2(16) = 1;
+        REQUIRE(xt::allclose(attribute_contour_strength(t, g, edge_weights, vertex_perimeter2, edge_length),
+                             ref_weights / ref_perimeter2));
+    }
+
+    TEST_CASE("tree attribute contour length component tree generic", "[tree_attributes]") {
+        auto g = get_4_adjacency_graph({4, 4});
+        tree t(array_1d<index_t>{28, 27, 24, 24,
+                                 20, 23, 22, 18,
+                                 26, 25, 24, 27,
+                                 16, 17, 21, 19,
+                                 17, 21, 22, 21, 23, 24, 23, 24, 25, 26, 27, 28, 28},
+               tree_category::component_tree);
+        array_1d<double> vertex_perimeter({num_vertices(g)}, 4);
+        array_1d<double> edge_length({num_edges(g)}, 1);
+        array_1d<double> edge_weights = xt::arange<double>(num_edges(g));
+
+        array_1d<double> ref_perimeter{4, 4, 4, 4,
+                                       4, 4, 4, 4,
+                                       4, 4, 4, 4,
+                                       4, 4, 4, 4,
+                                       4, 6, 4, 4, 4, 10, 6, 10, 22, 20, 18, 16, 16};
+        REQUIRE(xt::allclose(attribute_contour_length(t, g, vertex_perimeter, edge_length), ref_perimeter));
+
+        array_1d<double> ref_weights{1, 5, 11, 10,
+                                     16, 29, 37, 30,
+                                     37, 57, 65, 51,
+                                     36, 60, 64, 43,
+                                     36, 54, 30, 43, 16, 71, 45, 58, 123, 94, 57, 1, 0};
+        REQUIRE(xt::allclose(attribute_contour_strength(t, g, edge_weights, vertex_perimeter, edge_length),
+                             ref_weights / ref_perimeter));
+    }
+
+    TEST_CASE("tree attribute frontier length random", "[tree_attributes]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_graph({30, 40});
+        array_1d<double> edge_weights = xt::floor(xt::random::rand<double>({num_edges(g)}) * 10);
+        array_1d<double> edge_length = xt::random::rand<double>({num_edges(g)});
+        auto qfz = quasi_flat_zone_hierarchy(g, edge_weights);
+        auto &t = qfz.tree;
+
+        lca_fast lca(t);
+        auto lcas = lca.lca(edge_iterator(g));
+        array_1d<double> ref = xt::zeros<double>({num_vertices(t)});
+        for (index_t i = 0; i < (index_t) num_edges(g); i++) {
+            ref(lcas(i)) += edge_length(i);
+        }
+        REQUIRE(xt::allclose(attribute_frontier_length(t, g, edge_length), ref));
+    }
+
     TEST_CASE("tree attribute child number", "[tree_attributes]") {
         auto t = data.t;
 
@@ -214,6 +347,40 @@ namespace tree_attributes {
         REQUIRE((ref == res));
     }
 
+    TEST_CASE("tree attribute leaf ordering", "[tree_attributes]") {
+        array_1d<index_t> pt{11, 11, 8, 8, 10, 9, 9, 9, 10, 12, 11, 12, 12};
+        tree t(pt);
+
+        auto res = attribute_leaf_ordering(t);
+        array_1d<index_t> ref_leaves{5, 6, 7, 0, 1, 4, 2, 3};
+        array_1d<index_t> ref_begin{3, 4, 6, 7, 5, 0, 1, 2, 6, 0, 5, 3, 0};
+        array_1d<index_t> ref_end{4, 5, 7, 8, 6, 1, 2, 3, 8, 3, 8, 8, 8};
+        REQUIRE((res.leaves == ref_leaves));
+        REQUIRE((res.begin == ref_begin));
+        REQUIRE((res.end == ref_end));
+
+        REQUIRE(res.num_leaves(10) == 3);
+        array_1d<index_t> ref_leaves_10{4, 2, 3};
+        REQUIRE((res.leaves_of(10) == ref_leaves_10));
+        REQUIRE(res.has_leaves_included(2, 10));
+        REQUIRE(res.has_leaves_included(8, 11));
+        REQUIRE(res.has_leaves_included(11, 11));
+        REQUIRE(!res.has_leaves_included(5, 11));
+        REQUIRE(!res.has_leaves_included(11, 10));
+
+        // single child chain: a node and its child have the same leaves
+        tree t3(array_1d<index_t>{2, 2, 3, 3});
+        auto res3 = attribute_leaf_ordering(t3);
+        REQUIRE(res3.has_leaves_included(2, 3));
+        REQUIRE(res3.has_leaves_included(3, 2));
+
+        tree t2(array_1d<index_t>{0});
+        auto res2 = attribute_leaf_ordering(t2);
+        REQUIRE((res2.leaves == array_1d<index_t>{0}));
+        REQUIRE((res2.begin == array_1d<index_t>{0}));
+        REQUIRE((res2.end == array_1d<index_t>{1}));
+    }
+
     TEST_CASE("tree attribute smallest enclosing shape ", "[tree_attributes]") {
         array_1d<index_t> pt1{8, 8, 9, 9, 9, 10, 10, 11, 13, 12, 11, 12, 13, 13};
         tree t1(pt1);
@@ -226,6 +393,28 @@ namespace tree_attributes {
         REQUIRE((ref == res));
     }
 
+    TEST_CASE("tree attribute smallest enclosing shape random", "[tree_attributes]") {
+        xt::random::seed(42);
+        auto g = get_4_adjacency_implicit_graph({15, 17});
+        array_1d<int> im1 = xt::random::randint<int>({15 * 17}, 0, 10);
+        array_1d<int> im2 = xt::random::randint<int>({15 * 17}, 0, 10);
+        auto t1 = component_tree_max_tree(g, im1).tree;
+        auto t2 = component_tree_min_tree(g, im2).tree;
+
+        for (auto &ts: {std::make_pair(&t1, &t2), std::make_pair(&t2, &t1)}) {
+            auto &ta = *ts.first;
+            auto &tb = *ts.second;
+            array_1d<index_t> ref({num_vertices(ta)}, invalid_index);
+            xt::view(ref, xt::range(0, num_leaves(ta))) = xt::arange(num_leaves(ta));
+            for (auto i: leaves_to_root_iterator(ta, leaves_it::include, root_it::exclude)) {
+                auto p = parent(i, ta);
+                ref(p) = (ref(p) == invalid_index) ? ref(i) : lowest_common_ancestor(ref(p), ref(i), tb);
+            }
+            auto res = attribute_smallest_enclosing_shape(ta, tb);
+            REQUIRE((ref == res));
+        }
+    }
+
     TEST_CASE("tree attribute children pair sum product scalar", "[tree_attributes]") {
         auto t = data.t; //{5, 5, 6, 6, 6, 7, 7, 7}
 
@@ -246,4 +435,52 @@ namespace tree_attributes {
         REQUIRE(xt::allclose(ref, res));
     }
 
-}
\ No newline at end of file
+    TEST_CASE("tree attribute tree sampling probability", "[tree_attributes]") {
+        auto g = get_4_adjacency_graph({3, 3});
+        array_1d<int> edge_weights{0, 6, 2, 6, 0, 0, 5, 4, 5, 3, 2, 2};
+        auto qfz = quasi_flat_zone_hierarchy(g, edge_weights);
+        auto &t = qfz.tree;
+        double z = 35;
+
+        auto res_edge = attribute_tree_sampling_probability(t, g, edge_weights, tree_sampling_model::edge);
+        array_1d<double> ref_edge{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 3, 26};
+        REQUIRE(xt::allclose(res_edge, ref_edge / z));
+
+        auto res_null = attribute_tree_sampling_probability(t, g, edge_weights, tree_sampling_model::null);
+        array_1d<double> ref_null{0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                  6 * 8, 2 * 7,
+                                  11 * 15,
+                                  6 * 2 + 6 * 7 + 8 * 2 + 8 * 7,
+                                  7 * 9 + 7 * 5 + 9 * 5,
+                                  6 * 7 + 6 * 9 + 6 * 5 + 8 * 7 + 8 * 9 + 8 * 5 + 2 * 7 + 2 * 9 + 2 * 5 + 7 * 7 +
+                                  7 * 9 + 7 * 5,
+                                  6 * 11 + 6 * 15 + 8 * 11 + 8 * 15 + 2 * 11 + 2 * 15 + 11 * 7 + 11 * 7 + 11 * 9 +
+                                  11 * 5 + 15 * 7 + 15 * 7 + 15 * 9 + 15 * 5};
+        REQUIRE(xt::allclose(res_null, ref_null / (z * z)));
+    }
+
+    TEST_CASE("tree attribute edges lowest common ancestor parallel", "[tree_attributes]") {
+        using namespace tree_attribute_internal;
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({300, 300});
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(graph)});
+        auto tree = bpt_canonical(graph, edge_weights).tree;
+        lca_fast lca(tree);
+
+        array_1d<double> ref = xt::zeros<double>({num_vertices(tree)});
+        double ref_sum = 0;
+        for (auto e: edge_iterator(graph)) {
+            index_t n = lca.lca(source(e, graph), target(e, graph));
+            ref(n) += edge_weights(index(e, graph));
+            ref_sum += n * edge_weights(index(e, graph));
+        }
+
+        for (bool parallel: {false, true}) {
+            auto res = accumulate_edges_at_lowest_common_ancestor(lca, graph, edge_weights, parallel);
+            REQUIRE(xt::allclose(res, ref));
+            auto sum = sum_over_edges_lowest_common_ancestor(
+                    lca, graph, [&edge_weights](index_t i, index_t n) { return n * edge_weights(i); }, parallel);
+            REQUIRE(std::fabs(sum - ref_sum) < 1e-6 * ref_sum);
+        }
+    }
+}
@@ -14,6 +14,7 @@
 #include "../test_utils.hpp"
 #include "xtensor/xindex_view.hpp"
 #include "xtensor/xrandom.hpp"
+#include <queue>
 
 namespace hierarchy_core {
 
@@ -29,6 +30,74 @@ namespace hierarchy_core {
 
     } data;
 
+    /**
+     * Sequential reference of simplify_tree with process_leaves = true: new leaves are numbered in increasing order
+     * of their index in the original tree, and the other nodes with a breadth first traversal from the root.
+     */
+    template<typename criterion_t>
+    auto simplify_tree_remove_leaves_reference(const tree &t, const criterion_t &criterion) {
+        const index_t n_nodes = num_vertices(t);
+        array_1d<bool> deleted = xt::zeros<bool>({n_nodes});
+        for (index_t i = 0; i < n_nodes; i++) {
+            deleted(i) = criterion(i) && i != (index_t) root(t);
+        }
+        // true if the node and all its descendants are deleted
+        array_1d<bool> removed_branch = xt::zeros<bool>({n_nodes});
+        for (auto i: leaves_to_root_iterator(t)) {
+            bool flag = deleted(i);
+            for (auto c: children_iterator(i, t)) {
+                flag = flag && removed_branch(c);
+            }
+            removed_branch(i) = flag;
+        }
+
+        std::vector<index_t> new_leaves;
+        for (index_t i = 0; i < n_nodes; i++) {
+            if (!deleted(i)) {
+                bool leaf = true;
+                for (auto c: children_iterator(i, t)) {
+                    leaf = leaf && removed_branch(c);
+                }
+                if (leaf) {
+                    new_leaves.push_back(i);
+                }
+            }
+        }
+        index_t num_nodes_new_tree = n_nodes - (index_t) xt::sum(deleted)();
+        array_1d<index_t> new_order({(size_t) n_nodes}, invalid_index);
+        array_1d<index_t> new_parent = xt::empty<index_t>({num_nodes_new_tree});
+        array_1d<index_t> node_map = xt::empty<index_t>({num_nodes_new_tree});
+        for (index_t i = 0; i < (index_t) new_leaves.size(); i++) {
+            new_order(new_leaves[i]) = i;
+        }
+
+        index_t node_number = num_nodes_new_tree - 1;
+        std::queue<index_t> queue;
+        queue.push(root(t));
+        while (!queue.empty()) {
+            auto e = queue.front();
+            queue.pop();
+            if (!deleted(e)) {
+                new_order(e) = node_number;
+                new_parent(node_number) = new_order(parent(e, t));
+                node_map(node_number) = e;
+                node_number--;
+            } else {
+                new_order(e) = new_order(parent(e, t));
+            }
+            for (auto c: children_iterator(e, t)) {
+                if (new_order(c) == invalid_index && !removed_branch(c)) {
+                    queue.push(c);
+                }
+            }
+        }
+        for (index_t i = 0; i < (index_t) new_leaves.size(); i++) {
+            new_parent(i) = new_order(parent(new_leaves[i], t));
+            node_map(i) = new_leaves[i];
+        }
+        return std::make_pair(std::move(new_parent), std::move(node_map));
+    }
+
     TEST_CASE("canonical binary partition tree trivial", "[hierarchy_core]") {
 
         auto graph = get_4_adjacency_graph({1, 2});
@@ -191,6 +260,55 @@ namespace hierarchy_core {
         REQUIRE((nm.size() == 1 && nm(0) == 2));
     }
 
+    TEST_CASE("simplify tree large", "[hierarchy_core]") {
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({200, 200});
+        array_1d<double> edge_weights = xt::random::rand<double>({num_edges(graph)});
+        auto bpt = bpt_canonical(graph, edge_weights);
+        auto &t = bpt.tree;
+        array_1d<bool> criterion = xt::random::rand<double>({num_vertices(t)}) < 0.7;
+
+        for (bool process_leaves: {false, true}) {
+            auto res = hg::simplify_tree(t, criterion, process_leaves);
+            auto &nt = res.tree;
+            auto &nm = res.node_map;
+
+            array_1d<bool> kept = !criterion;
+            kept(root(t)) = true;
+            if (!process_leaves) {
+                xt::view(kept, xt::range(0, num_leaves(t))) = true;
+            }
+            REQUIRE((index_t) num_vertices(nt) == (index_t) xt::sum(kept)());
+            REQUIRE(nm(root(nt)) == root(t));
+
+            bool valid_nodes = true;
+            bool valid_parents = true;
+            bool ordered = true;
+            index_t previous = -1;
+            for (auto n: leaves_to_root_iterator(nt, leaves_it::include, root_it::exclude)) {
+                valid_nodes = valid_nodes && kept(nm(n));
+                auto ancestor = parent(nm(n), t);
+                while (!kept(ancestor)) {
+                    ancestor = parent(ancestor, t);
+                }
+                valid_parents = valid_parents && nm(parent(n, nt)) == ancestor;
+                if (!process_leaves || is_leaf(n, nt)) {
+                    ordered = ordered && nm(n) > previous;
+                    previous = nm(n);
+                }
+            }
+            REQUIRE(valid_nodes);
+            REQUIRE(valid_parents);
+            REQUIRE(ordered);
+
+            if (process_leaves) {
+                auto ref = simplify_tree_remove_leaves_reference(t, criterion);
+                REQUIRE((hg::parents(nt) == ref.first));
+                REQUIRE((nm == ref.second));
+            }
+        }
+    }
+
     TEST_CASE("quasi flat zone hierarchy", "[hierarchy_core]") {
 
         auto graph = get_4_adjacency_graph({2, 3});
@@ -205,6 +323,79 @@ namespace hierarchy_core {
         REQUIRE(xt::allclose(altitudes, xt::xarray<double>({0, 0, 0, 0, 0, 0, 0, 1, 1, 2})));
     }
 
+    template<typename T>
+    void check_stable_arg_sort_edge_weights(const T &edge_weights) {
+        array_1d<index_t> ref = xt::arange<index_t>(edge_weights.size());
+        std::stable_sort(ref.begin(), ref.end(),
+                         [&edge_weights](index_t i, index_t j) { return edge_weights(i) < edge_weights(j); });
+        REQUIRE((hierarchy_core_internal::stable_arg_sort_edge_weights(edge_weights) == ref));
+    }
+
+    TEST_CASE("stable arg sort edge weights", "[hierarchy_core]") {
+        xt::random::seed(42);
+        array_1d<unsigned char> w1 = xt::random::randint<unsigned char>({1000}, 0, 255);
+        check_stable_arg_sort_edge_weights(w1);
+        array_1d<int> w2 = xt::random::randint<int>({1000}, -100, 100);
+        check_stable_arg_sort_edge_weights(w2);
+        array_1d<long> w3 = xt::random::randint<long>({1000}, -10000000000l, 10000000000l);
+        check_stable_arg_sort_edge_weights(w3);
+        array_1d<double> w4 = xt::cast<double>(w2);
+        check_stable_arg_sort_edge_weights(w4);
+        array_1d<double> w5 = w4 / 3.0;
+        check_stable_arg_sort_edge_weights(w5);
+        array_1d<float> w6 = xt::random::randint<int>({1000}, 0, 5);
+        auto view = xt::view(w6, xt::range(100, 900));
+        check_stable_arg_sort_edge_weights(view);
+        check_stable_arg_sort_edge_weights(array_1d<double>::from_shape({0}));
+    }
+
+    template<typename T>
+    void check_quasi_flat_zone_hierarchy_from_sorted_edges(const ugraph &graph, const T &edge_weights) {
+        auto bpt = bpt_canonical(graph, edge_weights);
+        auto &altitudes = bpt.altitudes;
+        auto ref = simplify_tree(bpt.tree, [&altitudes, &bpt](index_t i) {
+            return altitudes(i) == altitudes(parent(i, bpt.tree));
+        });
+        array_1d<typename T::value_type> ref_altitudes = xt::index_view(altitudes, ref.node_map);
+
+        auto res = hierarchy_core_internal::quasi_flat_zone_hierarchy_from_sorted_edges(
+                graph, edge_weights, hierarchy_core_internal::stable_arg_sort_edge_weights(edge_weights));
+        REQUIRE((res.tree.parents() == ref.tree.parents()));
+        REQUIRE((res.altitudes == ref_altitudes));
+    }
+
+    TEST_CASE("quasi flat zone hierarchy from sorted edges", "[hierarchy_core]") {
+        xt::random::seed(42);
+        for (index_t i = 0; i < 10; i++) {
+            auto graph = get_4_adjacency_graph({7 + i, 11});
+            array_1d<int> w1 = xt::random::randint<int>({num_edges(graph)}, 0, 1 + i);
+            check_quasi_flat_zone_hierarchy_from_sorted_edges(graph, w1);
+            array_1d<double> w2 = xt::random::rand<double>({num_edges(graph)});
+            check_quasi_flat_zone_hierarchy_from_sorted_edges(graph, w2);
+        }
+        ugraph g2(3);
+        add_edge(0, 1, g2);
+        REQUIRE_THROWS(hierarchy_core_internal::quasi_flat_zone_hierarchy_from_sorted_edges(
+                g2, array_1d<int>{1}, array_1d<index_t>{0}));
+    }
+
+    TEST_CASE("quasi flat zone hierarchy large flat zones", "[hierarchy_core]") {
+        xt::random::seed(42);
+        auto graph = get_4_adjacency_graph({30, 25});
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(graph)}, 0, 20);
+        edge_weights = xt::maximum(edge_weights - 15, 0);
+
+        auto res = quasi_flat_zone_hierarchy(graph, edge_weights);
+
+        auto bpt = bpt_canonical(graph, edge_weights);
+        auto altitude_parents = propagate_parallel(bpt.tree, bpt.altitudes);
+        auto ref = simplify_tree(bpt.tree, xt::equal(bpt.altitudes, altitude_parents));
+        array_1d<int> ref_altitudes = xt::index_view(bpt.altitudes, ref.node_map);
+
+        REQUIRE((res.tree.parents() == ref.tree.parents()));
+        REQUIRE((res.altitudes == ref_altitudes));
+    }
+
     TEST_CASE("saliency map", "[hierarchy_core]") {
 
         auto graph = get_4_adjacency_graph({2, 4});
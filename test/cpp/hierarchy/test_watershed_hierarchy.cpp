@@ -12,6 +12,7 @@
 #include "higra/hierarchy/watershed_hierarchy.hpp"
 #include "higra/image/graph_image.hpp"
 #include "higra/algo/tree.hpp"
+#include "xtensor/xrandom.hpp"
 
 namespace watershed_hierarchy {
 
@@ -114,4 +115,36 @@ namespace watershed_hierarchy {
         REQUIRE((altitudes == ref_altitudes));
     }
 
+
+    TEST_CASE("watershed hierarchies by attributes", "[watershed_hierarchy]") {
+        xt::random::seed(42);
+        auto g = hg::get_4_adjacency_graph({17, 13});
+        array_1d<int> edge_weights = xt::random::randint<int>({num_edges(g)}, 0, 10);
+
+        using functor_t = std::function<array_1d<double>(const tree &, const array_1d<int> &)>;
+        std::vector<functor_t> functors{
+                [](const tree &t, const array_1d<int> &altitudes) {
+                    return attribute_area(t);
+                },
+                [](const tree &t, const array_1d<int> &altitudes) {
+                    return attribute_volume(t, altitudes, attribute_area(t));
+                },
+                [](const tree &t, const array_1d<int> &altitudes) {
+                    return attribute_dynamics(t, altitudes, true);
+                }};
+
+        auto res = watershed_hierarchies_by_attributes(g, edge_weights, functors);
+        REQUIRE(res.size() == 3);
+
+        auto check = [](const auto &result, const auto &reference) {
+            REQUIRE((result.tree.parents() == reference.tree.parents()));
+            REQUIRE((result.altitudes == reference.altitudes));
+        };
+        check(res[0], watershed_hierarchy_by_area(g, edge_weights));
+        check(res[1], watershed_hierarchy_by_volume(g, edge_weights));
+        check(res[2], watershed_hierarchy_by_dynamics(g, edge_weights));
+
+        REQUIRE(watershed_hierarchies_by_attributes(g, edge_weights, std::vector<functor_t>()).empty());
+    }
+
 }
\ No newline at end of file
@@ -81,6 +81,39 @@ namespace tree_of_shapes {
         REQUIRE((result == xt::reshape_view(expected_result, {result.shape()[0], result.shape()[1]})));
     }
 
+    TEST_CASE("test implicit_plain_map", "[tree_of_shapes]") {
+        xt::random::seed(42);
+        array_1d<int> image2d = xt::random::randint<int>({5 * 6}, -10, 10);
+
+        auto ref2d = hg::tree_of_shapes_internal::interpolate_plain_map_khalimsky_2d(image2d, {5, 6});
+        hg::tree_of_shapes_internal::implicit_plain_map<int, 2> plain_map2d(array_1d<int>(image2d), {5, 6}, true);
+        REQUIRE(plain_map2d.size() == (index_t) ref2d.shape()[0]);
+        for (index_t i = 0; i < plain_map2d.size(); i++) {
+            REQUIRE(plain_map2d(i, 0) == ref2d(i, 0));
+            REQUIRE(plain_map2d(i, 1) == ref2d(i, 1));
+        }
+
+        array_1d<int> image3d{0, 1,
+                              2, 3};
+        array_2d<int> ref3d{{0, 0}, {0, 1}, {1, 1},
+                            {0, 2}, {0, 3}, {1, 3},
+                            {2, 2}, {2, 3}, {3, 3}};
+        hg::tree_of_shapes_internal::implicit_plain_map<int, 3> plain_map3d(array_1d<int>(image3d), {2, 1, 2}, true);
+        REQUIRE(plain_map3d.size() == (index_t) ref3d.shape()[0]);
+        for (index_t i = 0; i < plain_map3d.size(); i++) {
+            REQUIRE(plain_map3d(i, 0) == ref3d(i, 0));
+            REQUIRE(plain_map3d(i, 1) == ref3d(i, 1));
+        }
+
+        hg::tree_of_shapes_internal::implicit_plain_map<int, 2> plain_map_no_immersion(array_1d<int>(image2d), {5, 6},
+                                                                                       false);
+        REQUIRE(plain_map_no_immersion.size() == 5 * 6);
+        for (index_t i = 0; i < plain_map_no_immersion.size(); i++) {
+            REQUIRE(plain_map_no_immersion(i, 0) == image2d(i));
+            REQUIRE(plain_map_no_immersion(i, 1) == image2d(i));
+        }
+    }
+
     TEST_CASE("test sort_vertices_tree_of_shapes small integers", "[tree_of_shapes]") {
         array_nd<char> plain_map =
                 {{{1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}, {1, 1}},
@@ -399,4 +432,100 @@ TEST_CASE("test tree of shapes self duality", "[tree_of_shapes]") {
     REQUIRE(test_tree_isomorphism(res1.tree, res2.tree));
 }
 
+TEMPLATE_TEST_CASE("test pre_tree_construction_tiled_2d", "[tree_of_shapes]", char, double) {
+    xt::random::seed(42);
+    array_2d <TestType> image = xt::random::randint<int>({7, 9}, 0, 5);
+    std::array<index_t, 2> rshape{13, 17};
+    auto graph = get_4_adjacency_implicit_graph(rshape);
+    tree_of_shapes_internal::implicit_plain_map<TestType, 2> plain_map(xt::flatten(image), {7, 9}, true);
+    auto res_sort = tree_of_shapes_internal::sort_vertices_tree_of_shapes(graph, plain_map);
+
+    auto ref = component_tree_internal::pre_tree_construction(graph, res_sort.first);
+    component_tree_internal::canonize_tree(ref, res_sort.second, res_sort.first);
+
+    for (index_t tile_size: {1, 2, 3, 4, 7, 100}) {
+        auto res = tree_of_shapes_internal::pre_tree_construction_tiled_2d(rshape,
+                                                                           res_sort.second,
+                                                                           res_sort.first,
+                                                                           tile_size);
+        REQUIRE((res == ref));
+    }
+}
+
+TEST_CASE("test tree of shapes parallel", "[tree_of_shapes]") {
+    xt::random::seed(42);
+    array_2d<int> image = xt::random::randint<int>({150, 140}, 0, 10);
+
+    for (auto padding: {tos_padding::none, tos_padding::zero, tos_padding::mean}) {
+        for (bool original_size: {true, false}) {
+            for (bool immersion: {true, false}) {
+                auto ref = component_tree_tree_of_shapes_image2d(image, padding, original_size, immersion);
+                auto res = component_tree_tree_of_shapes_image2d(image, padding, original_size, immersion, 0, true);
+                REQUIRE((res.tree.parents() == ref.tree.parents()));
+                REQUIRE((res.altitudes == ref.altitudes));
+            }
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("test tree of shapes 3d single slice", "[tree_of_shapes]", char, float) {
+    array_2d <TestType> image{{1, 1, 1, 1, 1, 1},
+                              {1, 0, 0, 3, 3, 1},
+                              {1, 0, 1, 1, 3, 1},
+                              {1, 0, 0, 3, 3, 1},
+                              {1, 1, 1, 1, 1, 1}};
+    array_3d <TestType> image3d = xt::reshape_view(image, {1, 5, 6});
+
+    for (bool original_size: {false, true}) {
+        auto res2d = component_tree_tree_of_shapes_image2d(image, tos_padding::none, original_size);
+        auto res3d = component_tree_tree_of_shapes_image3d(image3d, tos_padding::none, original_size);
+        REQUIRE((res2d.tree.parents() == res3d.tree.parents()));
+        REQUIRE((res2d.altitudes == res3d.altitudes));
+    }
+}
+
+TEMPLATE_TEST_CASE("test tree of shapes 3d original space", "[tree_of_shapes]", char, float) {
+    xt::random::seed(42);
+    array_3d <TestType> image = xt::random::randint<int>({4, 5, 3}, 0, 5);
+    index_t num_voxels = image.size();
+
+    for (auto padding: {tos_padding::none, tos_padding::zero, tos_padding::mean}) {
+        for (bool immersion: {true, false}) {
+            if (!immersion && padding == tos_padding::none) {
+                continue;
+            }
+            auto res = component_tree_tree_of_shapes_image3d(image, padding, true, immersion);
+            auto res_full = component_tree_tree_of_shapes_image3d(image, padding, false, immersion);
+
+            // reference: remove nodes of the full tree that do not contain any original voxel
+            index_t border = (padding == tos_padding::none) ? 0 : 1;
+            index_t step = (immersion) ? 2 : 1;
+            std::array<index_t, 3> rshape{(4 + 2 * border - 1) * step + 1,
+                                          (5 + 2 * border - 1) * step + 1,
+                                          (3 + 2 * border - 1) * step + 1};
+            array_1d<bool> deleted_vertices({num_leaves(res_full.tree)}, true);
+            auto deleted = xt::reshape_view(deleted_vertices, {rshape[0], rshape[1], rshape[2]});
+            xt::view(deleted,
+                     xt::range(border * step, rshape[0] - border * step, step),
+                     xt::range(border * step, rshape[1] - border * step, step),
+                     xt::range(border * step, rshape[2] - border * step, step)) = false;
+            auto all_deleted = accumulate_sequential(res_full.tree, deleted_vertices, accumulator_min());
+            auto ref = simplify_tree(res_full.tree, all_deleted, true);
+            array_1d <TestType> ref_altitudes = xt::index_view(res_full.altitudes, ref.node_map);
+
+            REQUIRE(num_leaves(res.tree) == (size_t) num_voxels);
+            REQUIRE((res.tree.parents() == ref.tree.parents()));
+            REQUIRE((res.altitudes == ref_altitudes));
+        }
+    }
+}
+
+TEST_CASE("test tree of shapes 3d self duality", "[tree_of_shapes]") {
+    xt::random::seed(42);
+    array_3d<double> image = xt::random::rand<double>({6, 7, 5});
+    auto res1 = component_tree_tree_of_shapes_image3d(image);
+    auto res2 = component_tree_tree_of_shapes_image3d(-image);
+    REQUIRE(test_tree_isomorphism(res1.tree, res2.tree));
+}
+
 }
@@ -0,0 +1,99 @@
+/***************************************************************************
+* Copyright ESIEE Paris (2018)                                             *
+*                                                                          *
+* Contributor(s) : Benjamin Perret                                         *
+*                                                                          *
+* Distributed under the terms of the CECILL-B License.                     *
+*                                                                          *
+* The full license is in the file LICENSE, distributed with this software. *
+****************************************************************************/
+
+#include "higra/structure/monotone_queue.hpp"
+#include "../test_utils.hpp"
+#include <random>
+#include <queue>
+#include <algorithm>
+
+namespace test_monotone_queue {
+
+    using namespace hg;
+    using namespace std;
+
+    TEST_CASE("bucket queue", "[monotone_queue]") {
+        bucket_queue<index_t> q(5);
+        REQUIRE(q.empty());
+        q.push(3, 30);
+        q.push(1, 10);
+        q.push(3, 31);
+        q.push(4, 40);
+        REQUIRE(q.size() == 4);
+
+        REQUIRE(q.top_priority() == 1);
+        REQUIRE(q.top() == 10);
+        q.pop();
+        REQUIRE(q.top_priority() == 3);
+        REQUIRE(q.top() == 31);
+        q.pop();
+        q.push(0, 0);
+        REQUIRE(q.top_priority() == 0);
+        REQUIRE(q.top() == 0);
+        q.pop();
+        REQUIRE(q.top() == 30);
+        q.pop();
+        REQUIRE(q.top() == 40);
+        q.pop();
+        REQUIRE(q.empty());
+    }
+
+    TEST_CASE("radix heap keys", "[monotone_queue]") {
+        using rh = radix_heap<index_t>;
+        vector<double> vd{-1e300, -5.5, -1, -0.0, 0, 1e-300, 2, 2.5, 1e300};
+        for (index_t i = 1; i < (index_t) vd.size(); i++) {
+            REQUIRE(rh::key(vd[i - 1]) <= rh::key(vd[i]));
+        }
+        vector<float> vf{-1e30f, -5.5f, -1, 0, 1e-30f, 2, 2.5f, 1e30f};
+        for (index_t i = 1; i < (index_t) vf.size(); i++) {
+            REQUIRE(rh::key(vf[i - 1]) < rh::key(vf[i]));
+        }
+        vector<int> vi{(numeric_limits<int>::min)(), -5, -1, 0, 1, 7, (numeric_limits<int>::max)()};
+        for (index_t i = 1; i < (index_t) vi.size(); i++) {
+            REQUIRE(rh::key(vi[i - 1]) < rh::key(vi[i]));
+        }
+        REQUIRE(rh::key((char) -1) < rh::key((char) 1));
+        REQUIRE(rh::key((unsigned char) 1) < rh::key((unsigned char) 255));
+    }
+
+    TEST_CASE("radix heap random", "[monotone_queue]") {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dis(0, 100);
+        std::uniform_int_distribution<int> op(0, 2);
+
+        radix_heap<index_t> heap;
+        using element = std::pair<double, index_t>;
+        std::priority_queue<element, vector<element>, std::greater<element>> ref;
+
+        double last = -10;
+        index_t counter = 0;
+        for (index_t i = 0; i < 5000; i++) {
+            if (ref.empty() || op(gen) > 0) {
+                auto value = last + dis(gen);
+                heap.push(radix_heap<index_t>::key(value), counter);
+                ref.push({value, counter});
+                counter++;
+            } else {
+                REQUIRE(heap.size() == ref.size());
+                REQUIRE(heap.top_priority() == radix_heap<index_t>::key(ref.top().first));
+                REQUIRE(heap.top() == ref.top().second);
+                last = ref.top().first;
+                heap.pop();
+                ref.pop();
+            }
+        }
+        while (!ref.empty()) {
+            REQUIRE(heap.top() == ref.top().second);
+            heap.pop();
+            ref.pop();
+        }
+        REQUIRE(heap.empty());
+    }
+}
@@ -61,6 +61,29 @@ class TestTreeAccumulators(unittest.TestCase):
         ref = np.asarray((-1, -1, -1, -1, -1, 1, 2, 1))
         self.assertTrue(np.allclose(ref, res))
 
+    def test_tree_accumulator_dtype(self):
+        tree = TestTreeAccumulators.get_tree()
+        input_array = np.asarray((1, 2, 3, 4, 5, 6, 7, 8))
+
+        res1 = hg.accumulate_parallel(tree, input_array, hg.Accumulators.mean, dtype=np.float64)
+        ref1 = np.asarray((0, 0, 0, 0, 0, 1.5, 4, 6.5))
+        self.assertTrue(res1.dtype == np.float64)
+        self.assertTrue(np.allclose(ref1, res1))
+
+        leaf_data = np.asarray((1, 2, 3, 4, 5), dtype=np.float64)
+        res2 = hg.accumulate_sequential(tree, leaf_data, hg.Accumulators.sum, dtype=np.float32)
+        ref2 = np.asarray((1, 2, 3, 4, 5, 3, 12, 15))
+        self.assertTrue(res2.dtype == np.float32)
+        self.assertTrue(np.allclose(ref2, res2))
+
+        res3 = hg.propagate_sequential_and_accumulate(tree, input_array, hg.Accumulators.sum, dtype=np.float32)
+        ref3 = np.asarray((15, 16, 18, 19, 20, 14, 15, 8))
+        self.assertTrue(res3.dtype == np.float32)
+        self.assertTrue(np.allclose(ref3, res3))
+
+        with self.assertRaises(Exception):
+            hg.accumulate_sequential(tree, leaf_data, hg.Accumulators.sum, dtype=np.int32)
+
     def test_tree_accumulatorVec(self):
         tree = TestTreeAccumulators.get_tree()
         input_array = np.asarray(((1, 0),
@@ -26,6 +26,29 @@ class TestWatershed(unittest.TestCase):
                     (1, 1, 3, 3))
         self.assertTrue(np.allclose(labels, expected))
 
+    def test_watershed_parallel(self):
+        g = hg.get_4_adjacency_graph((4, 4))
+        edge_weights = np.asarray((1, 2, 5, 5, 5, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 3, 5, 4, 0, 7, 0, 3, 4, 0))
+
+        labels = hg.labelisation_watershed_parallel(g, edge_weights)
+        expected = ((1, 1, 1, 2),
+                    (1, 1, 2, 2),
+                    (1, 1, 3, 3),
+                    (1, 1, 3, 3))
+        self.assertTrue(np.allclose(labels, expected))
+
+        labels = hg.labelisation_watershed_parallel(g, edge_weights, canonical_labels=False)
+        self.assertTrue(hg.is_in_bijection(labels, expected))
+
+    def test_watershed_parallel_unique(self):
+        np.random.seed(42)
+        g = hg.get_4_adjacency_graph((21, 17))
+        edge_weights = np.random.permutation(g.num_edges())
+
+        labels = hg.labelisation_watershed_parallel(g, edge_weights)
+        expected = hg.labelisation_watershed(g, edge_weights)
+        self.assertTrue(np.all(labels == expected))
+
     def test_seeded_watershed(self):
         g = hg.get_4_adjacency_graph((4, 4))
         edge_weights = np.asarray((1, 2, 5, 5, 4, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 2, 5, 2, 0, 7, 0, 3, 4, 0))
@@ -110,6 +133,53 @@ class TestWatershed(unittest.TestCase):
                                (2, 2, 2, 2)))
         self.assertTrue(np.all(labels == expected))
 
+    def test_seeded_watershed_priority_flood(self):
+        g = hg.get_4_adjacency_graph((4, 4))
+        edge_weights = np.asarray((1, 2, 5, 5, 4, 8, 1, 4, 3, 4, 4, 1, 5, 2, 6, 2, 5, 2, 0, 7, 0, 3, 4, 0))
+
+        seeds = np.asarray(((1, 1, 9, 9),
+                            (1, 9, 9, 9),
+                            (9, 9, 9, 9),
+                            (1, 1, 2, 2)))
+
+        labels = hg.labelisation_seeded_watershed_priority_flood(g, edge_weights, seeds, background_label=9)
+
+        expected = np.asarray(((1, 1, 2, 2),
+                               (1, 1, 2, 2),
+                               (1, 1, 2, 2),
+                               (1, 1, 2, 2)))
+        self.assertTrue(np.all(labels == expected))
+
+        np.random.seed(42)
+        g = hg.get_4_adjacency_graph((13, 17))
+        seeds = np.maximum(np.random.randint(-20, 4, (13, 17)), 0)
+        for edge_weights in (np.random.permutation(g.num_edges()).astype(np.uint16),
+                             np.random.rand(g.num_edges())):
+            labels = hg.labelisation_seeded_watershed_priority_flood(g, edge_weights, seeds)
+            expected = hg.labelisation_seeded_watershed(g, edge_weights, seeds)
+            self.assertTrue(np.all(labels == expected))
+
+    def test_seeded_watershed_parallel(self):
+        g = hg.get_4_adjacency_graph((2, 4))
+        edge_weights = np.asarray((0, 1, 0, 2, 0, 2, 0, 1, 2, 1))
+
+        seeds = np.asarray(((1, 0, 0, 2),
+                            (0, 0, 0, 0)))
+
+        labels = hg.labelisation_seeded_watershed_parallel(g, edge_weights, seeds)
+
+        expected = np.asarray(((1, 1, 1, 2),
+                               (1, 1, 2, 2)))
+        self.assertTrue(np.all(labels == expected))
+
+        np.random.seed(42)
+        g = hg.get_4_adjacency_graph((13, 17))
+        seeds = np.maximum(np.random.randint(-20, 4, (13, 17)), 0)
+        edge_weights = np.random.randint(0, 4, g.num_edges())
+        labels = hg.labelisation_seeded_watershed_parallel(g, edge_weights, seeds)
+        expected = hg.labelisation_seeded_watershed(g, edge_weights, seeds)
+        self.assertTrue(np.all(labels == expected))
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -77,6 +77,18 @@ class TestHierarchicalCost(unittest.TestCase):
         ref_cost = 2 / 1 + 4 / 3 + 9 / 7 + 9 / 7 + 2 / 1 + 2 / 1 + 9 / 5 + 9 / 6 + 9 / 6 + 7 / 4 + 2 / 1 + 3 / 2
         self.assertTrue(np.isclose(cost, ref_cost))
 
+    def test_dasgupta_cost_random(self):
+        g = hg.get_4_adjacency_graph((10, 10))
+        np.random.seed(42)
+        edge_weights = np.random.rand(g.num_edges()) + 0.1
+        tree, _ = hg.bpt_canonical(g, edge_weights)
+
+        cost = hg.dasgupta_cost(tree, edge_weights, g)
+
+        area = hg.attribute_area(tree)
+        lca = hg.make_lca_fast(tree).lca(g)
+        self.assertTrue(np.isclose(cost, np.sum(area[lca] / edge_weights)))
+
     def test_tree_sampling_divergence(self):
         g = hg.get_4_adjacency_graph((3, 3))
         edge_weights = np.asarray((0, 6, 2, 6, 0, 0, 5, 4, 5, 3, 2, 2))
@@ -90,3 +102,43 @@ class TestHierarchicalCost(unittest.TestCase):
         ref_cost = p[3] * np.log(p[3] / q[3]) + p[4] * np.log(p[4] / q[4]) + p[5] * np.log(p[5] / q[5]) + p[6] * np.log(
             p[6] / q[6])
         self.assertTrue(np.isclose(cost, ref_cost))
+
+    def test_estimate_dasgupta_cost(self):
+        g = hg.get_4_adjacency_graph((20, 20))
+        np.random.seed(42)
+        edge_weights = np.random.rand(g.num_edges()) + 0.5
+        tree, _ = hg.bpt_canonical(g, edge_weights)
+        exact = hg.dasgupta_cost(tree, edge_weights)
+
+        for sampling in ("uniform", "importance"):
+            estimate = hg.estimate_dasgupta_cost(tree, edge_weights, 20000, sampling, confidence=0.99, seed=1)
+            self.assertTrue(estimate.num_samples == 20000)
+            self.assertTrue(estimate.lower_bound < exact < estimate.upper_bound)
+            self.assertTrue(abs(estimate.value - exact) < 0.05 * exact)
+
+            estimate2 = hg.estimate_dasgupta_cost(tree, edge_weights, 20000, sampling, confidence=0.99, seed=1)
+            self.assertTrue(estimate.value == estimate2.value)
+
+    def test_estimate_tree_sampling_divergence(self):
+        g = hg.get_4_adjacency_graph((20, 20))
+        np.random.seed(42)
+        edge_weights = np.random.rand(g.num_edges())
+        tree, _ = hg.bpt_canonical(g, -edge_weights)
+        exact = hg.tree_sampling_divergence(tree, edge_weights)
+
+        for sampling in ("uniform", "importance"):
+            estimate = hg.estimate_tree_sampling_divergence(tree, edge_weights, 100000, sampling, seed=3)
+            self.assertTrue(estimate.lower_bound < estimate.value < estimate.upper_bound)
+            self.assertTrue(abs(estimate.value - exact) < 0.05 * exact)
+
+    def test_estimate_dendrogram_purity(self):
+        g = hg.get_4_adjacency_graph((20, 20))
+        np.random.seed(42)
+        edge_weights = np.random.randint(0, 20, g.num_edges())
+        tree, _ = hg.quasi_flat_zone_hierarchy(g, edge_weights)
+        labels = np.random.randint(0, 5, (tree.num_leaves(),))
+        exact = hg.dendrogram_purity(tree, labels)
+
+        estimate = hg.estimate_dendrogram_purity(tree, labels, 20000, confidence=0.99, seed=5)
+        self.assertTrue(estimate.lower_bound < exact < estimate.upper_bound)
+        self.assertTrue(abs(estimate.value - exact) < 0.05 * exact)
@@ -77,6 +77,10 @@ class TestAttributes(unittest.TestCase):
         area = hg.attribute_area(tree, vertex_area=leaf_area)
         self.assertTrue(np.allclose(ref_area, area))
 
+        area = hg.attribute_area(tree, vertex_area=leaf_area, dtype=np.float32)
+        self.assertTrue(area.dtype == np.float32)
+        self.assertTrue(np.allclose(ref_area, area))
+
     def test_area_default_param(self):
         g = hg.get_4_adjacency_graph((2, 3))
         edge_weights = np.asarray((1, 4, 6, 5, 2, 7, 3))
@@ -99,6 +103,10 @@ class TestAttributes(unittest.TestCase):
 
         self.assertTrue(np.allclose(ref_attribute, attribute))
 
+        attribute = hg.attribute_volume(tree, altitudes, dtype=np.float32)
+        self.assertTrue(attribute.dtype == np.float32)
+        self.assertTrue(np.allclose(ref_attribute, attribute))
+
     def test_attribute_volume_with_area(self):
         tree = hg.Tree((5, 5, 6, 6, 6, 7, 7, 7))
         altitudes = np.asarray((0, 0, 0, 0, 0, 2, 1, 4.))
@@ -415,6 +423,29 @@ class TestAttributes(unittest.TestCase):
         for i in range(len(ref)):
             self.assertTrue(set(ref[i]) == set(res[i]))
 
+    def test_attribute_leaf_ordering(self):
+        tree = hg.Tree((11, 11, 8, 8, 10, 9, 9, 9, 10, 12, 11, 12, 12))
+
+        leaves, begin, end = hg.attribute_leaf_ordering(tree)
+        self.assertTrue(np.all(leaves == (5, 6, 7, 0, 1, 4, 2, 3)))
+        self.assertTrue(np.all(begin == (3, 4, 6, 7, 5, 0, 1, 2, 6, 0, 5, 3, 0)))
+        self.assertTrue(np.all(end == (4, 5, 7, 8, 6, 1, 2, 3, 8, 3, 8, 8, 8)))
+
+    def test_attribute_image_moments(self):
+        g = hg.get_4_adjacency_graph((2, 3))
+        tree = hg.Tree((6, 6, 7, 6, 7, 7, 8, 8, 8))
+        hg.CptHierarchy.link(tree, g)
+
+        area, m1, m2, centroid, mu2, bbox, elongation, orientation = hg.attribute_image_moments(tree)
+        self.assertTrue(np.all(area == (1, 1, 1, 1, 1, 1, 3, 3, 6)))
+        self.assertTrue(np.all(m1[6:] == ((1, 1), (2, 5), (3, 6))))
+        self.assertTrue(np.all(m2[8] == ((3, 3), (3, 10))))
+        self.assertTrue(np.allclose(centroid[6:], ((1 / 3, 1 / 3), (2 / 3, 5 / 3), (0.5, 1))))
+        self.assertTrue(np.allclose(mu2[8], ((1.5, 0), (0, 4))))
+        self.assertTrue(np.all(bbox[6:] == (((0, 0), (1, 1)), ((0, 1), (1, 2)), ((0, 0), (1, 2)))))
+        self.assertTrue(np.allclose(elongation[6:], (1 - np.sqrt(1 / 3), 1 - np.sqrt(1 / 3), 1 - np.sqrt(0.375))))
+        self.assertTrue(np.allclose(orientation[8], (0, 1)))
+
     def test_attribute_gaussian_region_weights_model_scalar(self):
         tree, altitudes = TestAttributes.get_test_tree()
         vertex_list = hg.attribute_vertex_list(tree)
@@ -504,6 +535,18 @@ class TestAttributes(unittest.TestCase):
         res = hg.attribute_extinction_value(t, altitudes, attribute, "increasing")
         self.assertTrue(np.all(ref == res))
 
+    def test_attribute_extinction_value_multiple(self):
+        t = hg.Tree((8, 8, 9, 7, 7, 11, 11, 9, 10, 10, 12, 12, 12))
+        altitudes = np.asarray((0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 10.))
+        attribute1 = np.asarray((0, 0, 0, 0, 0, 0, 0, 0, 3, 2, 4, 2, 10.))
+        attribute2 = np.asarray((1, 1, 1, 1, 1, 1, 1, 1, 2, 3, 5, 5, 13.))
+        attributes = np.stack((attribute1, attribute2), axis=1)
+
+        res = hg.attribute_extinction_value(t, altitudes, attributes)
+        self.assertTrue(res.shape == (13, 2))
+        self.assertTrue(np.all(res[:, 0] == hg.attribute_extinction_value(t, altitudes, attribute1)))
+        self.assertTrue(np.all(res[:, 1] == hg.attribute_extinction_value(t, altitudes, attribute2)))
+
     def test_attribute_extinction_value2(self):
         graph = hg.get_4_adjacency_implicit_graph((4, 4))
         vertex_weights = np.asarray((0, 1, 4, 4,
@@ -624,6 +667,30 @@ class TestAttributes(unittest.TestCase):
               (Z * Z)
         self.assertTrue(np.allclose(ref, res))
 
+    def test_tree_attribute_registry(self):
+        tree = hg.Tree((5, 5, 6, 6, 6, 7, 7, 7))
+        registry = hg.TreeAttributeRegistry(tree)
+
+        self.assertTrue(np.all(registry.get("area") == (1, 1, 1, 1, 1, 2, 3, 5)))
+        self.assertTrue(registry.is_cached("area"))
+        self.assertTrue(np.all(registry.get("depth") == (2, 2, 2, 2, 2, 1, 1, 0)))
+
+        registry.set_input("altitudes", np.asarray((0, 0, 0, 0, 0, 2, 1, 4)))
+        self.assertTrue(np.all(registry.get("volume") == (0, 0, 0, 0, 0, 4, 9, 13)))
+
+        registry.set_input("vertex_area", np.asarray((2, 1, 1, 3, 2)))
+        self.assertFalse(registry.is_cached("volume"))
+        self.assertTrue(np.all(registry.get("volume") == (0, 0, 0, 0, 0, 6, 18, 24)))
+
+        registry.set_input("vertex_weights", np.asarray(((1, 2), (3, 4), (5, 6), (7, 8), (9, 10))))
+        ref = np.asarray(((1, 2), (3, 4), (5, 6), (7, 8), (9, 10),
+                          (5 / 3, 8 / 3), (44 / 6, 50 / 6), (49 / 9, 58 / 9)))
+        self.assertTrue(np.allclose(registry.get("mean_vertex_weights"), ref))
+
+        registry.set_memory_budget(0)
+        self.assertTrue(registry.memory_usage() == 0)
+        self.assertFalse(registry.is_cached("area"))
+
 
 if __name__ == '__main__':
     unittest.main()
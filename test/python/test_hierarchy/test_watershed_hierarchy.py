@@ -30,6 +30,26 @@ class TestWatershedHierarchy(unittest.TestCase):
         self.assertTrue(hg.test_tree_isomorphism(t, ref_tree))
         self.assertTrue(np.allclose(altitudes, ref_altitudes))
 
+    def test_watershed_hierarchies_by_attributes(self):
+        np.random.seed(42)
+        g = hg.get_4_adjacency_graph((11, 13))
+        edge_weights = np.random.randint(0, 10, g.num_edges())
+
+        res = hg.watershed_hierarchies_by_attributes(g, edge_weights,
+                                                     (lambda tree, _: hg.attribute_area(tree),
+                                                      lambda tree, altitudes: hg.attribute_volume(tree, altitudes),
+                                                      lambda tree, altitudes: hg.attribute_dynamics(tree, altitudes,
+                                                                                                    "increasing")))
+        self.assertTrue(len(res) == 3)
+
+        refs = (hg.watershed_hierarchy_by_area(g, edge_weights),
+                hg.watershed_hierarchy_by_volume(g, edge_weights),
+                hg.watershed_hierarchy_by_dynamics(g, edge_weights))
+
+        for (t, altitudes), (ref_tree, ref_altitudes) in zip(res, refs):
+            self.assertTrue(np.all(t.parents() == ref_tree.parents()))
+            self.assertTrue(np.allclose(altitudes, ref_altitudes))
+
     def test_watershed_hierarchy_by_minima_ordering(self):
         g = hg.get_4_adjacency_graph((1, 7))
         edge_weights = np.asarray((1, 4, 1, 0, 10, 8))
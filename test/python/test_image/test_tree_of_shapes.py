@@ -251,6 +251,48 @@ class TestTreeOfShapesImage(unittest.TestCase):
 
         self.assertTrue(hg.test_tree_isomorphism(tree1, tree2))
 
+    def test_tree_of_shapes_parallel(self):
+        np.random.seed(42)
+        image = np.random.randint(0, 10, (150, 140))
+
+        for padding in ('none', 'zero', 'mean'):
+            for original_size in (False, True):
+                tree1, altitudes1 = hg.component_tree_tree_of_shapes_image2d(image, padding, original_size)
+                tree2, altitudes2 = hg.component_tree_tree_of_shapes_image2d(image, padding, original_size,
+                                                                             parallel=True)
+                self.assertTrue(np.all(tree1.parents() == tree2.parents()))
+                self.assertTrue(np.all(altitudes1 == altitudes2))
+
+    def test_tree_of_shapes_3d_single_slice(self):
+        image = np.asarray(((1, 1, 1, 1, 1, 1),
+                            (1, 0, 0, 3, 3, 1),
+                            (1, 0, 1, 1, 3, 1),
+                            (1, 0, 0, 3, 3, 1),
+                            (1, 1, 1, 1, 1, 1)), dtype=np.int8)
+
+        for original_size in (False, True):
+            tree2d, altitudes2d = hg.component_tree_tree_of_shapes_image2d(image, 'none', original_size)
+            tree3d, altitudes3d = hg.component_tree_tree_of_shapes_image3d(image.reshape((1, 5, 6)), 'none',
+                                                                           original_size)
+            self.assertTrue(np.all(tree2d.parents() == tree3d.parents()))
+            self.assertTrue(np.all(altitudes2d == altitudes3d))
+
+            leaf_graph = hg.CptHierarchy.get_leaf_graph(tree3d)
+            res_shape = hg.CptGridGraph.get_shape(leaf_graph)
+            self.assertTrue(len(res_shape) == 3)
+            self.assertTrue(res_shape[0] * res_shape[1] * res_shape[2] == tree3d.num_leaves())
+
+    def test_tree_of_shapes_3d_self_dual(self):
+        np.random.seed(42)
+        image = np.random.rand(6, 7, 5)
+        neg_image = -1 * image
+
+        tree1, altitudes1 = hg.component_tree_tree_of_shapes_image3d(image)
+        tree2, altitudes2 = hg.component_tree_tree_of_shapes_image3d(neg_image)
+
+        self.assertTrue(tree1.num_leaves() == image.size)
+        self.assertTrue(hg.test_tree_isomorphism(tree1, tree2))
+
     def test_component_tree_multivariate_tree_of_shapes_image2d_sanity(self):
         image = np.asarray(((1, 1),
                             (1, -2),